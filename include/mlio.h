@@ -17,6 +17,7 @@
 
 #include "mlio/config.h"                               // IWYU pragma: export
 #include "mlio/cpu_array.h"                            // IWYU pragma: export
+#include "mlio/cpu_array_pool.h"                       // IWYU pragma: export
 #include "mlio/csv_reader.h"                           // IWYU pragma: export
 #include "mlio/data_reader.h"                          // IWYU pragma: export
 #include "mlio/data_reader_base.h"                     // IWYU pragma: export
@@ -52,6 +53,7 @@
 #include "mlio/memory/util.h"                          // IWYU pragma: export
 #include "mlio/not_supported_error.h"                  // IWYU pragma: export
 #include "mlio/parallel_data_reader.h"                 // IWYU pragma: export
+#include "mlio/parquet_reader.h"                       // IWYU pragma: export
 #include "mlio/parser.h"                               // IWYU pragma: export
 #include "mlio/record_readers/record.h"                // IWYU pragma: export
 #include "mlio/record_readers/record_error.h"          // IWYU pragma: export
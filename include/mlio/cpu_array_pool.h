@@ -0,0 +1,108 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "mlio/config.h"
+#include "mlio/data_type.h"
+#include "mlio/device_array.h"
+#include "mlio/intrusive_ref_counter.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+
+/// @addtogroup tensors Tensors
+/// @{
+
+namespace detail {
+
+struct Cpu_array_pool_access;
+
+struct Pooled_storage_deleter {
+    void operator()(void *ptr) const noexcept;
+};
+
+using Pooled_storage = std::unique_ptr<void, Pooled_storage_deleter>;
+
+}  // namespace detail
+
+/// Represents a pool that recycles the buffers of @ref Cpu_array
+/// instances.
+///
+/// Once an array allocated from the pool gets destructed, its buffer
+/// is returned to the pool instead of being freed and is handed out
+/// again to the next allocation of the same byte size.
+class MLIO_API Cpu_array_pool : public Intrusive_ref_counter<Cpu_array_pool> {
+    friend struct detail::Cpu_array_pool_access;
+
+public:
+    /// @param max_size
+    ///     The maximum number of bytes the pool keeps for reuse. Buffers
+    ///     returned to a full pool are freed.
+    explicit Cpu_array_pool(std::size_t max_size) noexcept;
+
+    Cpu_array_pool(const Cpu_array_pool &) = delete;
+
+    Cpu_array_pool &operator=(const Cpu_array_pool &) = delete;
+
+    Cpu_array_pool(Cpu_array_pool &&) = delete;
+
+    Cpu_array_pool &operator=(Cpu_array_pool &&) = delete;
+
+    ~Cpu_array_pool();
+
+    /// Allocates a @ref Cpu_array with the specified data type and
+    /// size; recycling a pooled buffer if one is available.
+    ///
+    /// @param zero_init
+    ///     A boolean value indicating whether the array should be
+    ///     zero-initialized. Callers that overwrite every element of
+    ///     the array can set it to false to avoid a redundant memset.
+    ///
+    /// @remark
+    ///     Arrays of type @ref Data_type::string are not pooled.
+    std::unique_ptr<Device_array> allocate(Data_type dt, std::size_t size, bool zero_init = true);
+
+    /// Frees all buffers held by the pool.
+    void clear() noexcept;
+
+    /// Gets the number of bytes currently held by the pool.
+    std::size_t size() const noexcept;
+
+    std::size_t max_size() const noexcept
+    {
+        return max_size_;
+    }
+
+private:
+    MLIO_HIDDEN
+    void release(std::size_t num_bytes, detail::Pooled_storage &&storage) noexcept;
+
+    std::size_t max_size_;
+    std::size_t size_{};
+    std::unordered_map<std::size_t, std::vector<detail::Pooled_storage>> buffers_{};
+    mutable std::mutex mutex_{};
+};
+
+/// @}
+
+}  // namespace abi_v1
+}  // namespace mlio
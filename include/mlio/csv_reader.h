@@ -132,8 +132,6 @@ public:
 
     ~Csv_reader() final;
 
-    void reset() noexcept final;
-
 private:
     struct Decoder_state;
 
@@ -171,7 +169,7 @@ private:
     Intrusive_ptr<Example> decode(const Instance_batch &batch) const final;
 
     MLIO_HIDDEN
-    std::vector<Intrusive_ptr<Tensor>> make_tensors(std::size_t batch_size) const;
+    std::vector<Intrusive_ptr<Tensor>> make_tensors(std::size_t batch_size, bool zero_init) const;
 
     MLIO_HIDDEN
     std::optional<std::size_t> decode_ser(Decoder_state &state, const Instance_batch &batch) const;
@@ -188,7 +186,6 @@ private:
     std::vector<Data_type> column_types_{};
     std::vector<int> column_ignores_{};
     std::vector<Parser> column_parsers_{};
-    bool should_read_header = true;
 };
 
 /// @}
@@ -76,6 +76,21 @@ enum class Bad_example_handling {
     pad_warn
 };
 
+/// Specifies how a dataset should be split into shards.
+enum class Sharding_strategy {
+    /// Assign every num_shards'th @ref Instance to the shard. Every
+    /// shard reads and discards the whole dataset.
+    instance,
+    /// Assign whole @ref Data_store "data stores" to the shard. The data
+    /// stores are balanced across the shards based on their sizes and
+    /// every shard only reads its own data stores.
+    data_store,
+    /// Distribute the row groups of each @ref Data_store across the
+    /// shards in a round-robin fashion. Every shard only reads its own
+    /// row groups. Only supported by @ref Parquet_reader.
+    row_group
+};
+
 /// Contains the parameters that are common to all @ref Data_reader
 /// "data readers".
 struct MLIO_API Data_reader_params {
@@ -94,6 +109,21 @@ struct MLIO_API Data_reader_params {
     /// should be prefetched, this parameter can be used to avoid
     /// thread oversubscription.
     std::size_t num_parallel_reads{};
+    /// The number of upcoming data stores to open in background while
+    /// the current one is being read. This hides the latency of opening
+    /// a data store (e.g. an S3 request) when moving from one data
+    /// store to the next. If zero, data stores are opened on demand.
+    std::size_t num_prefetched_data_stores{};
+    /// The lower bound of the chunk size used when reading data stores
+    /// as streams. The chunk size is tuned while reading based on the
+    /// record sizes, the speed of the stream, and how long the chunks
+    /// are referenced by the decoded instances. If zero, defaults to 1
+    /// MiB, or to @ref max_chunk_size if it is smaller.
+    std::size_t min_chunk_size{};
+    /// The upper bound of the chunk size. It is exceeded only if a
+    /// single record does not fit into a chunk. If zero, defaults to 256
+    /// MiB.
+    std::size_t max_chunk_size{};
     /// See @ref Last_example_handling.
     Last_example_handling last_example_handling = Last_example_handling::none;
     /// See @ref Bad_example_handling.
@@ -101,17 +131,63 @@ struct MLIO_API Data_reader_params {
     /// A boolean value indicating whether a warning will be output for
     /// each bad Instance.
     bool warn_bad_instances = false;
+    /// A boolean value indicating whether text readers such as @ref
+    /// Csv_reader and @ref Text_line_reader should verify that every
+    /// @ref Instance is valid UTF-8 before decoding it. An Instance
+    /// with an invalid byte sequence is treated as a bad Instance; see
+    /// @ref bad_example_handling.
+    bool validate_utf8 = false;
     /// The number of @ref Instance "data instances" to skip from the
     /// beginning of the dataset.
     std::size_t num_instances_to_skip{};
     /// The number of @ref Instance "data instances" to read. The rest
     /// of the dataset will be ignored.
     std::optional<std::size_t> num_instances_to_read{};
+    /// A boolean value indicating whether to use record index files to
+    /// seek directly to the first @ref Instance to read instead of
+    /// reading and discarding the ones before it.
+    ///
+    /// The index of a data store is kept in a sidecar file next to it
+    /// with the ".mlioidx" extension. If the index does not exist, it is
+    /// built the first time the data store is read in full.
+    ///
+    /// @remark
+    ///     Only uncompressed @ref File "files" and gzip files with a
+    ///     random-access index (see @ref build_gzip_index) can be
+    ///     indexed. An index is specific to the size and modification
+    ///     time of the data store, the reader type, and the parameters
+    ///     used to build it (e.g. the delimiter or the header row of a
+    ///     CSV file). A mismatching index is ignored and rebuilt.
+    bool use_record_index = false;
+    /// The number of @ref Instance "data instances" between two
+    /// consecutive offsets stored in a record index.
+    std::size_t record_index_interval = 1024;
     /// The index of the shard to read.
     std::size_t shard_index{};
     /// The number of shards the dataset should be split into. The
     /// reader will only read 1/num_shards of the dataset.
     std::size_t num_shards{};
+    /// See @ref Sharding_strategy.
+    ///
+    /// @remark
+    ///     With @ref Sharding_strategy::data_store, @ref
+    ///     num_instances_to_skip and @ref num_instances_to_read apply to
+    ///     the data stores of the shard rather than the whole dataset.
+    Sharding_strategy sharding_strategy = Sharding_strategy::instance;
+    /// The number of data stores to read concurrently. If greater than
+    /// one, the @ref Instance "data instances" of that many data stores
+    /// are interleaved, each data store being read by a separate
+    /// background thread. This can hide the latency of high-latency
+    /// data stores such as S3 objects.
+    std::size_t interleave_cycle_length{};
+    /// The number of consecutive @ref Instance "data instances" to read
+    /// from a data store before moving to the next one in the cycle.
+    std::size_t interleave_block_length = 1;
+    /// A boolean value indicating whether the interleaved @ref Instance
+    /// "data instances" should be returned in a deterministic order. If
+    /// false, they are returned in the order they become available
+    /// which avoids waiting on a slow data store.
+    bool deterministic_interleave = true;
     /// A ratio between zero and one indicating how much of the dataset
     /// should be read. The dataset will be sampled based on this
     /// number.
@@ -124,7 +200,12 @@ struct MLIO_API Data_reader_params {
     /// new data instances read from the dataset.
     ///
     /// A value of zero means perfect shuffling and requires loading the
-    /// whole dataset into memory first.
+    /// whole dataset into memory first. If @ref use_record_index is
+    /// set, the data instances are instead read in random order at
+    /// their indexed offsets which only requires the record index to
+    /// be kept in memory. If a data store does not support random
+    /// access (e.g. a compressed file without an index), the whole
+    /// dataset is loaded into memory instead.
     std::size_t shuffle_window{};
     /// The seed that will be used for initializing the sampling
     /// distribution. If not specified, a random seed will be generated
@@ -133,6 +214,17 @@ struct MLIO_API Data_reader_params {
     /// A boolean value indicating whether the dataset should be
     /// reshuffled after every @ref Data_reader::reset() call.
     bool reshuffle_each_epoch = true;
+    /// If specified, the data of the buffered @ref Instance "data
+    /// instances" is packed contiguously into an arena instead of being
+    /// kept in separate heap allocations. Once the arena grows beyond
+    /// the specified number of bytes, it continues in temporary files
+    /// mapped into memory so that large shuffle windows do not have to
+    /// fit in physical memory.
+    std::optional<std::size_t> shuffle_buffer_memory_threshold{};
+    /// The maximum number of bytes of tensor memory to keep for reuse
+    /// once the @ref Example "examples" holding them are destroyed. If
+    /// zero, a new buffer is allocated for every tensor.
+    std::size_t tensor_pool_size{};
 };
 
 /// Represents an interface for classes that read @ref Example "examples"
@@ -15,9 +15,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <optional>
+
 #include "mlio/config.h"
 #include "mlio/data_reader.h"
 #include "mlio/example.h"
+#include "mlio/instance_batch.h"
 #include "mlio/intrusive_ptr.h"
 
 namespace mlio {
@@ -50,6 +54,28 @@ protected:
         return warn_bad_instances_;
     }
 
+    /// Gets a boolean value indicating whether the bad instances of an
+    /// example should be padded.
+    bool pad_bad_examples() const noexcept
+    {
+        return params_.bad_example_handling == Bad_example_handling::pad ||
+               params_.bad_example_handling == Bad_example_handling::pad_warn;
+    }
+
+    /// Returns a boolean value indicating whether an example that has a
+    /// bad instance should be skipped as opposed to padded.
+    ///
+    /// @exception std::invalid_argument
+    ///     The bad example handling is neither skip nor pad.
+    bool skip_bad_example() const;
+
+    /// Outputs a warning if requested by the bad example handling and
+    /// the specified example, of which only num_instances_read
+    /// instances could be decoded, was padded or, if num_instances_read
+    /// is empty, skipped.
+    void warn_bad_example(const Instance_batch &batch,
+                          std::optional<std::size_t> num_instances_read) const;
+
 private:
     /// When implemented in a derived class, returns the next @ref
     /// Example read from the dataset.
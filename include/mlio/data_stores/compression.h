@@ -28,13 +28,43 @@ inline namespace abi_v1 {
 /// @{
 
 /// Specifies the compression type of a data store.
-enum class Compression { none, infer, gzip, bzip2, zip };
+enum class Compression { none, infer, gzip, bzip2, zip, zstd, lz4 };
+
+/// Specifies the library used to inflate gzip and zlib data.
+enum class Inflate_backend {
+    /// zlib, or a compatible library such as zlib-ng in compat mode,
+    /// that MLIO was built against.
+    zlib,
+    /// Intel ISA-L.
+    isal,
+    /// libdeflate; since it can only inflate whole buffers, it is used
+    /// for memory-mapped files and for the members inflated in
+    /// parallel. Streams are inflated by ISA-L if available; otherwise
+    /// by zlib.
+    libdeflate,
+};
+
+/// Returns a boolean value indicating whether the library was built
+/// with the specified inflate backend.
+MLIO_API
+bool supports_inflate_backend(Inflate_backend backend) noexcept;
+
+/// Returns the fastest inflate backend the library was built with.
+MLIO_API
+Inflate_backend default_inflate_backend() noexcept;
 
 /// Constructs a new inflate stream by wrapping the specified input
-/// stream.
+/// stream. Throws a @ref Not_supported_error if the library was not
+/// built with support for the specified compression.
+///
+/// @param backend
+///     The library used to inflate gzip data. Throws a @ref
+///     Not_supported_error if the library was not built with it.
 MLIO_API
 Intrusive_ptr<Input_stream>
-make_inflate_stream(Intrusive_ptr<Input_stream> &&stream, Compression compression);
+make_inflate_stream(Intrusive_ptr<Input_stream> &&stream,
+                    Compression compression,
+                    Inflate_backend backend = default_inflate_backend());
 
 MLIO_API
 inline std::ostream &operator<<(std::ostream &s, Compression compression)
@@ -55,6 +85,29 @@ inline std::ostream &operator<<(std::ostream &s, Compression compression)
     case Compression::zip:
         s << "zip";
         break;
+    case Compression::zstd:
+        s << "zstd";
+        break;
+    case Compression::lz4:
+        s << "lz4";
+        break;
+    }
+    return s;
+}
+
+MLIO_API
+inline std::ostream &operator<<(std::ostream &s, Inflate_backend backend)
+{
+    switch (backend) {
+    case Inflate_backend::zlib:
+        s << "zlib";
+        break;
+    case Inflate_backend::isal:
+        s << "isal";
+        break;
+    case Inflate_backend::libdeflate:
+        s << "libdeflate";
+        break;
     }
     return s;
 }
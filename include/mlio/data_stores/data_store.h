@@ -15,8 +15,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <optional>
 #include <string>
 
 #include "mlio/config.h"
@@ -48,6 +50,11 @@ public:
     /// Returns an @ref Input_stream for reading from the data store.
     virtual Intrusive_ptr<Input_stream> open_read() const = 0;
 
+    /// Returns the size of the data store in bytes if it can be
+    /// determined without opening it; otherwise, returns an empty
+    /// value.
+    virtual std::optional<std::size_t> size_hint() const;
+
     virtual std::string repr() const = 0;
 
     /// Returns a unique identifier for the data store.
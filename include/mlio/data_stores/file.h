@@ -15,7 +15,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <iostream>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -25,6 +28,7 @@
 #include "mlio/data_stores/data_store.h"
 #include "mlio/fwd.h"
 #include "mlio/intrusive_ptr.h"
+#include "mlio/memory/file_mapped_memory_block.h"
 #include "mlio/span.h"
 
 namespace mlio {
@@ -33,9 +37,68 @@ inline namespace abi_v1 {
 /// @addtogroup data_stores Data Stores
 /// @{
 
+/// Specifies how a file that is not memory-mapped should be read.
+enum class File_io_method {
+    /// Read the file using blocking system calls.
+    blocking,
+    /// Read the file using Linux io_uring, keeping multiple large reads
+    /// in flight. Falls back to @c blocking if io_uring is not
+    /// available.
+    io_uring,
+    /// Read the file using direct I/O (O_DIRECT), bypassing the page
+    /// cache. Useful for large datasets that are read only once per
+    /// epoch and would otherwise evict other data from the cache.
+    direct
+};
+
+MLIO_API
+inline std::ostream &operator<<(std::ostream &s, File_io_method io_method)
+{
+    switch (io_method) {
+    case File_io_method::blocking:
+        s << "blocking";
+        break;
+    case File_io_method::io_uring:
+        s << "io_uring";
+        break;
+    case File_io_method::direct:
+        s << "direct";
+        break;
+    }
+    return s;
+}
+
+/// Holds the options used to read a @ref File.
+struct MLIO_API File_options {
+    /// A boolean value indicating whether the file should be
+    /// memory-mapped.
+    bool memory_map = true;
+    /// The compression type of the file. If set to @c infer, the
+    /// compression will be inferred from the filename.
+    Compression compression = Compression::infer;
+    /// The method used to read the file if it is not memory-mapped.
+    File_io_method io_method = File_io_method::blocking;
+    /// The options used to read the file if it is memory-mapped.
+    Memory_map_options mmap_options{};
+    /// If not zero and the file is a gzip file without an up-to-date
+    /// index, the interval between the access points of the index that
+    /// is built the first time the file is read to its end; see @ref
+    /// build_gzip_index. Building an index prevents the file from being
+    /// inflated in parallel.
+    std::size_t gzip_index_interval{};
+    /// The library used to inflate the file if it is a gzip file.
+    Inflate_backend inflate_backend = default_inflate_backend();
+};
+
 /// Represents a file as a @ref Data_store.
 class MLIO_API File final : public Data_store {
 public:
+    /// @param opts
+    ///     The options used to read the file. Throws a @ref
+    ///     Not_supported_error if the library was not built with the
+    ///     specified inflate backend.
+    explicit File(std::string path, const File_options &opts = {});
+
     /// @param memory_map
     ///     A boolean value indicating whether the file should be
     ///     memory-mapped.
@@ -43,12 +106,12 @@ public:
     /// @param compression
     ///     The compression type of the file. If set to @c infer, the
     ///     compression will be inferred from the filename.
-    explicit File(std::string path,
-                  bool memory_map = true,
-                  Compression compression = Compression::infer);
+    explicit File(std::string path, bool memory_map, Compression compression = Compression::infer);
 
     Intrusive_ptr<Input_stream> open_read() const final;
 
+    std::optional<std::size_t> size_hint() const final;
+
     std::string repr() const final;
 
     const std::string &id() const noexcept final
@@ -58,8 +121,7 @@ public:
 
 private:
     std::string path_;
-    bool memory_map_;
-    Compression compression_;
+    File_options opts_;
 };
 
 struct MLIO_API File_list_options {
@@ -75,6 +137,16 @@ struct MLIO_API File_list_options {
     /// The compression type of the files. If set to @c infer, the
     /// compression will be inferred from the filenames.
     Compression compression = Compression::infer;
+    /// The method used to read the files if they are not
+    /// memory-mapped.
+    File_io_method io_method = File_io_method::blocking;
+    /// The options used to read the files if they are memory-mapped.
+    Memory_map_options mmap_options{};
+    /// If not zero, the interval between the access points of the
+    /// indices built for gzip files that have none.
+    std::size_t gzip_index_interval{};
+    /// The library used to inflate gzip files.
+    Inflate_backend inflate_backend = default_inflate_backend();
 };
 
 /// Recursively lists all files residing under the specified paths.
@@ -86,6 +158,20 @@ MLIO_API
 std::vector<Intrusive_ptr<Data_store>>
 list_files(const std::string &path, const std::string_view pattern = {});
 
+/// Builds the random-access index of the specified gzip file and saves
+/// it next to the file with the ".mliogzidx" suffix. A gzip @ref File
+/// with an up-to-date index is read as a seekable stream that inflates
+/// only the data following the access point closest to a seek position.
+/// When read sequentially, the ranges between the access points are
+/// inflated in parallel. An index is specific to the size and the
+/// modification time of the file.
+///
+/// @param interval
+///     The number of inflated bytes between two access points. Each
+///     access point takes up to 32 KiB in the index.
+MLIO_API
+void build_gzip_index(const std::string &path, std::size_t interval = 0x100'0000);  // 16 MiB
+
 /// @}
 
 }  // namespace abi_v1
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <optional>
 #include <string>
 
 #include "mlio/config.h"
@@ -37,6 +39,11 @@ public:
 
     Intrusive_ptr<Input_stream> open_read() const final;
 
+    std::optional<std::size_t> size_hint() const final
+    {
+        return chunk_.size();
+    }
+
     std::string repr() const final;
 
     const std::string &id() const final;
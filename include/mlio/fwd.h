@@ -21,15 +21,17 @@ namespace detail {
 
 class Chunk_reader;
 class Coo_tensor_builder;
-class Iconv_desc;
+class Inflater;
 class Instance_batch_reader;
 class Instance_reader;
-class Zlib_inflater;
+class Parallel_s3_reader;
+class Text_converter;
 
 }  // namespace detail
 
 class Attribute;
 class Coo_tensor;
+class Cpu_array_pool;
 class Csr_tensor;
 class Data_store;
 class Dense_tensor;
@@ -41,6 +43,7 @@ class Memory_slice;
 class Mutable_memory_block;
 class Record;
 class Record_reader;
+class Stream_record_reader;
 class Tensor;
 class Tensor_visitor;
 class Text_encoding;
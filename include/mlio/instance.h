@@ -18,10 +18,12 @@
 #include <cstddef>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "mlio/config.h"
 #include "mlio/fwd.h"
 #include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
 
 namespace mlio {
 inline namespace abi_v1 {
@@ -47,6 +49,19 @@ public:
         : store_{&store}, index_{index}, bits_{std::move(bits)}
     {}
 
+    /// @param store
+    ///     The data store from which the Instance was read.
+    /// @param index
+    ///     The position of the Instance in the data store.
+    /// @param fragments
+    ///     The raw data of the Instance split into multiple fragments
+    ///     (e.g. the parts of a split RecordIO record).
+    explicit Instance(const Data_store &store,
+                      std::size_t index,
+                      std::vector<Memory_slice> &&fragments) noexcept
+        : store_{&store}, index_{index}, fragments_{std::move(fragments)}
+    {}
+
     const Data_store &data_store() const noexcept
     {
         return *store_;
@@ -57,18 +72,60 @@ public:
         return index_;
     }
 
+    /// Gets a boolean value indicating whether the data of the Instance
+    /// is already in memory.
+    bool has_bits() const noexcept
+    {
+        return bits_ != std::nullopt || !fragments_.empty();
+    }
+
+    /// Gets a boolean value indicating whether the data of the Instance
+    /// is split into multiple fragments.
+    bool has_fragments() const noexcept
+    {
+        return !fragments_.empty();
+    }
+
+    /// Returns the data of the Instance as a single contiguous slice.
+    ///
+    /// @remark
+    ///     If the Instance consists of multiple fragments, they are
+    ///     copied into a single buffer on first access. Decoders that
+    ///     can consume the data piecewise should use @ref fragments()
+    ///     instead.
     const Memory_slice &bits() const
     {
-        // If we do not have instance data, it means that we should
-        // treat the whole data store as a single instance.
         if (bits_ == std::nullopt) {
-            bits_ = load_bits_from_store();
+            if (fragments_.empty()) {
+                // If we do not have instance data, it means that we
+                // should treat the whole data store as a single
+                // instance.
+                bits_ = load_bits_from_store();
+            }
+            else {
+                bits_ = merge_fragments();
+            }
         }
 
         return *bits_;
     }
 
+    /// Returns the data of the Instance as a sequence of fragments
+    /// without copying it.
+    stdx::span<const Memory_slice> fragments() const
+    {
+        if (fragments_.empty()) {
+            return {&bits(), 1};
+        }
+        return fragments_;
+    }
+
+    /// Returns the size of the data of the Instance in bytes.
+    std::size_t size() const;
+
 private:
+    Memory_slice merge_fragments() const;
+
     Memory_slice load_bits_from_store() const;
 
     Memory_slice read_stream(Input_stream &stream) const;
@@ -78,6 +135,7 @@ private:
     const Data_store *store_;
     std::size_t index_{};
     mutable std::optional<Memory_slice> bits_{};
+    std::vector<Memory_slice> fragments_{};
 };
 
 /// @}
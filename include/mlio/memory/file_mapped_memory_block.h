@@ -27,10 +27,27 @@ inline namespace abi_v1 {
 /// @addtogroup memory Memory
 /// @{
 
+/// Specifies how a file should be memory-mapped and read.
+struct MLIO_API Memory_map_options {
+    /// If not zero, the mapped file is read in windows of the specified
+    /// size instead of as a single chunk. The kernel is advised to read
+    /// ahead of the current window and the pages behind the oldest
+    /// window still referenced by the data instances are released, so
+    /// that the resident memory stays bounded regardless of the file
+    /// size. Only applies to uncompressed files.
+    std::size_t window_size{};
+    /// A boolean value indicating whether the whole file should be read
+    /// into memory while mapping (MAP_POPULATE).
+    bool populate = false;
+    /// A boolean value indicating whether the mapping should be aligned
+    /// to and backed by huge pages where the file system supports it.
+    bool huge_pages = false;
+};
+
 /// Represents a File-mapped read-only memory block.
 class MLIO_API File_mapped_memory_block final : public Memory_block {
 public:
-    explicit File_mapped_memory_block(std::string path);
+    explicit File_mapped_memory_block(std::string path, const Memory_map_options &opts = {});
 
     File_mapped_memory_block(const File_mapped_memory_block &) = delete;
 
@@ -56,7 +73,11 @@ private:
     MLIO_HIDDEN
     void init_memory_map();
 
+    static constexpr std::size_t huge_page_size_ = 0x20'0000;  // 2 MiB
+
     std::string path_;
+    bool populate_;
+    bool huge_pages_;
     std::byte *data_{};
     std::size_t size_{};
 };
@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <exception>
 #include <memory>
@@ -27,6 +28,8 @@
 #include "mlio/config.h"
 #include "mlio/data_reader.h"
 #include "mlio/data_reader_base.h"
+#include "mlio/data_type.h"
+#include "mlio/device_array.h"
 #include "mlio/fwd.h"
 #include "mlio/intrusive_ptr.h"
 
@@ -57,7 +60,11 @@ public:
     std::size_t num_bytes_read() const noexcept final;
 
 protected:
-    explicit Parallel_data_reader(Data_reader_params &&params);
+    /// @param shards_row_groups
+    ///     A boolean value indicating whether the derived class applies
+    ///     @ref Sharding_strategy::row_group itself. If false, the
+    ///     strategy is rejected.
+    explicit Parallel_data_reader(Data_reader_params &&params, bool shards_row_groups = false);
 
     /// Stops the background threads. This function must be called in
     /// the destructor of the derived class to ensure that all
@@ -69,6 +76,17 @@ protected:
         return schema_;
     }
 
+    /// Allocates a new @ref Cpu_array for a feature tensor. If
+    /// @ref Data_reader_params::tensor_pool_size is non-zero, the
+    /// array is recycled from the tensor pool of the reader.
+    ///
+    /// @param zero_init
+    ///     A boolean value indicating whether the array should be
+    ///     zero-initialized. Decoders that overwrite every element of
+    ///     the array can set it to false.
+    std::unique_ptr<Device_array>
+    make_feature_array(Data_type dt, std::size_t size, bool zero_init = true) const;
+
 private:
     enum class Run_state { not_started, running, stopped, faulted };
 
@@ -78,7 +96,8 @@ private:
     /// Record_reader from the specified data store.
     virtual Intrusive_ptr<Record_reader> make_record_reader(const Data_store &store) = 0;
 
-    MLIO_HIDDEN
+    // Not hidden, since the vtables of derived data readers outside of
+    // the library refer to it.
     Intrusive_ptr<Example> read_example_core() final;
 
     MLIO_HIDDEN
@@ -120,6 +139,7 @@ private:
     std::exception_ptr exception_ptr_{};
     std::atomic_size_t num_bytes_read_{};
     Intrusive_ptr<const Schema> schema_{};
+    Intrusive_ptr<Cpu_array_pool> array_pool_{};
 };
 
 /// @}
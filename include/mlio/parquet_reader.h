@@ -0,0 +1,101 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mlio/config.h"
+#include "mlio/data_type.h"
+#include "mlio/fwd.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/parallel_data_reader.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+
+/// @addtogroup data_readers Data Readers
+/// @{
+
+/// Holds the parameters for @ref Parquet_reader.
+struct MLIO_API Parquet_params final {
+    /// The columns that should be read. If empty, all columns that have
+    /// a supported type are read.
+    std::vector<std::string> column_names{};
+};
+
+/// Represents a @ref Data_reader that decodes Parquet files directly
+/// into dense tensors, one tensor per column.
+///
+/// The row groups of a file are decoded in parallel in background and
+/// only the requested columns are read from the data store.
+///
+/// @remark
+///     Only flat columns of type BOOLEAN, INT32, INT64, FLOAT, and
+///     DOUBLE are supported; they are decoded as uint8, int32, int64,
+///     float32, and float64 respectively. Null values are read as NaN
+///     for floating-point columns and as zero for all others. The pages
+///     can be compressed with Snappy or GZIP.
+class MLIO_API Parquet_reader final : public Parallel_data_reader {
+    struct Column {
+        std::string name{};
+        Data_type data_type{};
+        std::size_t size{};
+        // The offset of the value within a decoded row.
+        std::size_t offset{};
+    };
+
+public:
+    explicit Parquet_reader(Data_reader_params params, Parquet_params pq_params = {});
+
+    Parquet_reader(const Parquet_reader &) = delete;
+
+    Parquet_reader &operator=(const Parquet_reader &) = delete;
+
+    Parquet_reader(Parquet_reader &&) = delete;
+
+    Parquet_reader &operator=(Parquet_reader &&) = delete;
+
+    ~Parquet_reader() final;
+
+private:
+    Intrusive_ptr<Record_reader> make_record_reader(const Data_store &store) final;
+
+    Intrusive_ptr<const Schema> infer_schema(const std::optional<Instance> &instance) final;
+
+    Intrusive_ptr<Example> decode(const Instance_batch &batch) const final;
+
+    Parquet_params params_;
+    // Maps the ids of the data stores to their index in the dataset;
+    // used to distribute the row groups across shards. Keyed by id since
+    // the record reader factory might be called with a proxy store.
+    std::unordered_map<std::string, std::size_t> store_indices_{};
+    // The columns are resolved from the first data store opened; the
+    // rest of the data stores must have the same columns.
+    std::vector<Column> columns_{};
+    bool has_columns_{};
+    std::size_t stride_{};
+    std::mutex mutex_{};
+};
+
+/// @}
+
+}  // namespace abi_v1
+}  // namespace mlio
@@ -18,7 +18,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "mlio/config.h"
 #include "mlio/fwd.h"
@@ -38,16 +40,42 @@ namespace detail {
 /// Represents a @ref Record_reader for reading Parquet records.
 class MLIO_API Parquet_record_reader final : public Stream_record_reader {
 public:
-    explicit Parquet_record_reader(Intrusive_ptr<Input_stream> stream)
-        : Stream_record_reader{std::move(stream)}
-    {}
+    /// @remark
+    ///     If the stream is seekable, the boundaries of the Parquet files
+    ///     are found by walking backwards through their footers. Otherwise
+    ///     the stream is scanned for them.
+    explicit Parquet_record_reader(Intrusive_ptr<Input_stream> stream);
+
+    /// @param file_ends
+    ///     The offsets, as reported by @ref position(), at which the
+    ///     Parquet files in the stream end, in increasing order. If
+    ///     empty, the stream is scanned for the boundaries.
+    explicit Parquet_record_reader(Intrusive_ptr<Input_stream> stream,
+                                   std::vector<std::size_t> file_ends);
+
+    std::string framing_key() const final;
 
 private:
+    MLIO_HIDDEN
+    std::optional<Record> read_record_core() final;
+
     static constexpr std::size_t magic_number_size_ = sizeof(std::uint32_t);
 
+    MLIO_HIDDEN
+    static std::vector<std::size_t> find_file_ends(Input_stream &stream);
+
+    MLIO_HIDDEN
+    void set_file_ends(std::vector<std::size_t> &&file_ends);
+
     MLIO_HIDDEN
     std::optional<Record> decode_record(Memory_slice &chunk, bool ignore_leftover) final;
 
+    MLIO_HIDDEN
+    std::optional<Record> decode_framed_record(Memory_slice &chunk, bool ignore_leftover);
+
+    MLIO_HIDDEN
+    std::optional<Record> scan_record(Memory_slice &chunk, bool ignore_leftover);
+
     MLIO_HIDDEN
     static bool is_magic_number(Memory_block::iterator pos) noexcept;
 
@@ -60,6 +88,11 @@ private:
     template<typename T>
     MLIO_HIDDEN
     static T as(Memory_block::iterator pos) noexcept;
+
+    std::vector<std::size_t> file_ends_{};
+    // Indicates whether the files are read one by one via ranged seeks.
+    bool read_files_directly_{};
+    bool past_last_file_{};
 };
 
 }  // namespace detail
@@ -35,6 +35,14 @@ public:
 
     virtual std::optional<Record> read_record_core() = 0;
 
+protected:
+    /// Discards the record, if any, returned by the last @ref
+    /// peek_record() call.
+    void discard_peeked_record() noexcept
+    {
+        peeked_record_ = std::nullopt;
+    }
+
 private:
     std::optional<Record> peeked_record_{};
 };
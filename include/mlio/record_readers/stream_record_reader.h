@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "mlio/config.h"
 #include "mlio/fwd.h"
@@ -54,13 +55,76 @@ public:
     ///     should read-ahead from the underlying @ref Input_stream.
     void set_record_size_hint(std::size_t value) noexcept;
 
+    /// Sets the range within which the size of the chunks read from the
+    /// underlying @ref Input_stream is tuned.
+    ///
+    /// @remark
+    ///     A zero value leaves the corresponding bound unchanged. The
+    ///     upper bound is exceeded if a single record does not fit.
+    void set_chunk_size_bounds(std::size_t min_size, std::size_t max_size) noexcept;
+
+    /// Gets a boolean value indicating whether the reader can be
+    /// repositioned via @ref seek().
+    bool seekable() const noexcept;
+
+    /// Repositions the reader so that the next record is decoded
+    /// starting at the specified byte offset of the underlying @ref
+    /// Input_stream.
+    ///
+    /// @remark
+    ///     The offset must point to the beginning of a record; typically
+    ///     one that was previously returned by @ref record_offset().
+    void seek(std::size_t offset);
+
+    /// Repositions the reader like @ref seek(), but limits it to at
+    /// most the next @p size bytes of the underlying @ref Input_stream
+    /// which are read at once without any read-ahead. Once they are
+    /// consumed, @ref read_record() returns an empty value until the
+    /// reader gets repositioned.
+    ///
+    /// @remark
+    ///     Meant for random access where reading a whole chunk for a
+    ///     few records would be wasteful. If the range lies within the
+    ///     range of the previous call, it is not read again; so callers
+    ///     can read a large range once and then jump between the records
+    ///     in it.
+    void seek(std::size_t offset, std::size_t size);
+
+    /// Gets the byte offset of the most recently decoded record in the
+    /// underlying @ref Input_stream.
+    std::size_t record_offset() const noexcept
+    {
+        return record_offset_;
+    }
+
+    /// Gets the byte offset in the underlying @ref Input_stream at which
+    /// the next record will be decoded.
+    std::size_t position() const noexcept
+    {
+        return chunk_offset_;
+    }
+
+    /// Gets a string that identifies how the reader frames records.
+    /// Record offsets can only be shared between readers that have the
+    /// same framing key. An empty key, which is the default, means that
+    /// the offsets cannot be shared.
+    ///
+    /// @remark
+    ///     The key is persisted in record indexes; therefore derived
+    ///     classes should return a stable string that includes every
+    ///     parameter that affects the framing, including the number of
+    ///     leading bytes skipped before the first record.
+    virtual std::string framing_key() const;
+
 protected:
     explicit Stream_record_reader(Intrusive_ptr<Input_stream> stream);
 
-private:
-    MLIO_HIDDEN
-    std::optional<Record> read_record_core() final;
+    /// @remark
+    ///     Derived classes can override this function to reposition the
+    ///     reader (e.g. via @ref seek()) before a record gets decoded.
+    std::optional<Record> read_record_core() override;
 
+private:
     /// When implemented in a derived class, tries to decode a Record
     /// from the specified chunk.
     ///
@@ -72,8 +136,16 @@ private:
     ///     reader should throw an exception with a descriptive message.
     virtual std::optional<Record> decode_record(Memory_slice &chunk, bool ignore_leftover) = 0;
 
+    Intrusive_ptr<Input_stream> stream_;
     std::unique_ptr<detail::Chunk_reader> chunk_reader_;
     Memory_slice chunk_{};
+    std::size_t record_size_hint_{};
+    std::size_t min_chunk_size_{};
+    std::size_t max_chunk_size_{};
+    std::size_t chunk_offset_{};
+    std::size_t record_offset_{};
+    Memory_slice range_{};
+    std::size_t range_offset_{};
 };
 
 /// @}
@@ -15,7 +15,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "mlio/config.h"
 #include "mlio/data_type.h"
@@ -23,24 +30,41 @@
 #include "mlio/intrusive_ptr.h"
 #include "mlio/parallel_data_reader.h"
 
-namespace aialgs::data {
-
-class Record;
-class Value;
-
-}  // namespace aialgs::data
-
 namespace mlio {
 inline namespace abi_v1 {
+namespace detail {
+
+class Protobuf_tensor_view;
+struct Protobuf_feature_view;
+class Sparse_tensor_builder;
+
+}  // namespace detail
 
 /// @addtogroup data_readers Data Readers
 /// @{
 
+/// Specifies the tensor type of the sparse features.
+enum class Sparse_tensor_format {
+    coo,  ///< A @ref Coo_tensor.
+    csr   ///< A @ref Csr_tensor.
+};
+
+/// Holds the parameters for @ref Recordio_protobuf_reader.
+struct MLIO_API Recordio_protobuf_params final {
+    /// See @ref Sparse_tensor_format.
+    ///
+    /// @remark
+    ///     Only sparse features with a single dimension can be read as
+    ///     CSR tensors. The rest are always read as COO tensors.
+    Sparse_tensor_format sparse_tensor_format{Sparse_tensor_format::coo};
+};
+
 /// Represents a @ref Data_reader for reading Amazon SageMaker
 /// RecordIO-protobuf datasets.
 class MLIO_API Recordio_protobuf_reader final : public Parallel_data_reader {
 public:
-    explicit Recordio_protobuf_reader(Data_reader_params params);
+    explicit Recordio_protobuf_reader(Data_reader_params params,
+                                      Recordio_protobuf_params rp_params = {});
 
     Recordio_protobuf_reader(const Recordio_protobuf_reader &) = delete;
 
@@ -63,22 +87,28 @@ private:
     Intrusive_ptr<const Schema> infer_schema(const std::optional<Instance> &instance) final;
 
     MLIO_HIDDEN
-    Attribute make_attribute(const Instance &instance,
-                             const std::string &name,
-                             const aialgs::data::Value &value);
+    Attribute make_attribute(const Instance &instance, const detail::Protobuf_feature_view &feature);
 
-    template<Data_type dt, typename Protobuf_tensor>
+    template<Data_type dt>
     MLIO_HIDDEN
     Attribute make_attribute(const Instance &instance,
                              const std::string &name,
-                             const Protobuf_tensor &tensor);
+                             const detail::Protobuf_tensor_view &tensor);
 
-    template<typename Protobuf_tensor>
     MLIO_HIDDEN
     void copy_shape(const Instance &instance,
                     const std::string &name,
                     Size_vector &shape,
-                    const Protobuf_tensor &tensor);
+                    const detail::Protobuf_tensor_view &tensor);
+
+    MLIO_HIDDEN
+    bool builds_csr_tensor(const Attribute &attr) const noexcept;
+
+    MLIO_HIDDEN
+    std::unique_ptr<detail::Sparse_tensor_builder>
+    make_sparse_tensor_builder(const Attribute &attr,
+                               std::size_t batch_size,
+                               std::size_t row_idx) const;
 
     MLIO_HIDDEN
     Intrusive_ptr<Example> decode(const Instance_batch &batch) const final;
@@ -92,10 +122,20 @@ private:
     decode_parallel(Decoder_state &state, const Instance_batch &batch) const;
 
     MLIO_HIDDEN
-    static const aialgs::data::Record *parse_proto(const Instance &instance);
+    static bool parse_record(const Instance &instance,
+                             std::vector<detail::Protobuf_feature_view> &features);
+
+    static constexpr std::string_view label_prefix_ = "label_";
 
+    Recordio_protobuf_params params_;
     bool has_sparse_feature_{};
     std::size_t num_values_per_instance_{};
+    // The estimated number of values per instance of each sparse
+    // feature; updated as we decode the examples.
+    mutable std::vector<std::atomic_size_t> num_sparse_values_{};
+    // Maps the names of the features and labels to attribute indices.
+    std::unordered_map<std::string_view, std::size_t> feature_indices_{};
+    std::unordered_map<std::string_view, std::size_t> label_indices_{};
 };
 
 /// @}
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -38,7 +39,9 @@ inline namespace abi_v1 {
 /// Represents a client to access Amazon S3.
 class MLIO_API S3_client : public Intrusive_ref_counter<S3_client> {
 public:
-    explicit S3_client(std::unique_ptr<Aws::S3::S3Client> native_client) noexcept;
+    explicit S3_client(std::unique_ptr<Aws::S3::S3Client> native_client,
+                       std::size_t read_ahead_part_size = 0,
+                       std::size_t num_read_ahead_parts = 0) noexcept;
 
     S3_client(const S3_client &) = delete;
 
@@ -64,8 +67,24 @@ public:
                                  std::string_view key,
                                  std::string_view version_id) const;
 
+    /// Gets the size of the ranged requests issued while reading an S3
+    /// object sequentially.
+    std::size_t read_ahead_part_size() const noexcept
+    {
+        return read_ahead_part_size_;
+    }
+
+    /// Gets the number of ranged requests kept in flight while reading
+    /// an S3 object sequentially.
+    std::size_t num_read_ahead_parts() const noexcept
+    {
+        return num_read_ahead_parts_;
+    }
+
 private:
     std::unique_ptr<Aws::S3::S3Client> native_client_;
+    std::size_t read_ahead_part_size_;
+    std::size_t num_read_ahead_parts_;
 };
 
 struct MLIO_API S3_client_options {
@@ -75,6 +94,12 @@ struct MLIO_API S3_client_options {
     std::string_view profile{};
     std::string_view region{};
     bool use_https{true};
+    /// The size of the ranged requests issued while reading an S3
+    /// object sequentially. If zero, defaults to 8 MiB.
+    std::size_t read_ahead_part_size{};
+    /// The number of ranged requests kept in flight while reading an S3
+    /// object sequentially. If zero, defaults to 8.
+    std::size_t num_read_ahead_parts{};
 };
 
 MLIO_API
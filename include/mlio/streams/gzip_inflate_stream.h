@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "mlio/config.h"
+#include "mlio/data_stores/compression.h"
 #include "mlio/fwd.h"
 #include "mlio/intrusive_ptr.h"
 #include "mlio/memory/memory_block.h"
@@ -36,7 +37,12 @@ inline namespace abi_v1 {
 /// stream that was deflated with gzip or zlib.
 class MLIO_API Gzip_inflate_stream final : public Input_stream_base {
 public:
-    explicit Gzip_inflate_stream(Intrusive_ptr<Input_stream> inner);
+    /// @param backend
+    ///     The library used to inflate the stream. Since libdeflate
+    ///     cannot inflate streams, ISA-L is used in its place if
+    ///     available; otherwise zlib.
+    explicit Gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                 Inflate_backend backend = default_inflate_backend());
 
     Gzip_inflate_stream(const Gzip_inflate_stream &) = delete;
 
@@ -61,7 +67,7 @@ private:
     void check_if_closed() const;
 
     Intrusive_ptr<Input_stream> inner_;
-    std::unique_ptr<detail::Zlib_inflater> inflater_;
+    std::unique_ptr<detail::Inflater> inflater_;
     Memory_slice buffer_{};
     Memory_block::iterator buffer_pos_ = buffer_.begin();
 };
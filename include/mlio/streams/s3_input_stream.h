@@ -16,9 +16,11 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
 #include "mlio/config.h"
+#include "mlio/fwd.h"
 #include "mlio/intrusive_ptr.h"
 #include "mlio/s3_client.h"
 #include "mlio/span.h"
@@ -35,10 +37,26 @@ struct S3_input_stream_access;
 /// @addtogroup streams Streams
 /// @{
 
+/// Represents an S3 object as an input stream.
+///
+/// @remark
+///     Once the stream is read sequentially, the rest of the object is
+///     read ahead using multiple concurrent ranged requests; see @ref
+///     S3_client_options.
 class MLIO_API S3_input_stream final : public Input_stream_base {
     friend struct detail::S3_input_stream_access;
 
 public:
+    S3_input_stream(const S3_input_stream &) = delete;
+
+    S3_input_stream &operator=(const S3_input_stream &) = delete;
+
+    S3_input_stream(S3_input_stream &&) = delete;
+
+    S3_input_stream &operator=(S3_input_stream &&) = delete;
+
+    ~S3_input_stream() final;
+
     using Input_stream_base::read;
 
     std::size_t read(Mutable_memory_span destination) final;
@@ -86,6 +104,10 @@ private:
     bool closed_{};
     std::size_t size_{};
     std::size_t position_{};
+    // Indicates whether the stream has been read since it was opened or
+    // last repositioned.
+    bool sequential_{};
+    std::unique_ptr<detail::Parallel_s3_reader> reader_{};
 };
 
 MLIO_API
@@ -83,7 +83,7 @@ private:
 
     Intrusive_ptr<Input_stream> inner_;
     bool is_utf8_;
-    std::unique_ptr<detail::Iconv_desc> converter_;
+    std::unique_ptr<detail::Text_converter> converter_;
     Intrusive_ptr<Mutable_memory_block> buffer_{};
     Mutable_memory_block::iterator buffer_pos_{};
     Mutable_memory_block::iterator buffer_end_{};
@@ -203,11 +203,21 @@ public:
         return Device_array_view{*data_};
     }
 
+    Device_array_span indices() noexcept
+    {
+        return Device_array_span{*indices_};
+    }
+
     Device_array_view indices() const noexcept
     {
         return Device_array_view{*indices_};
     }
 
+    Device_array_span indptr() noexcept
+    {
+        return Device_array_span{*indptr_};
+    }
+
     Device_array_view indptr() const noexcept
     {
         return Device_array_view{*indptr_};
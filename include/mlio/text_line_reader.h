@@ -51,6 +51,8 @@ private:
 
     Intrusive_ptr<Example> decode(const Instance_batch &batch) const final;
 
+    bool validate_utf8(const Instance &instance) const;
+
     static Intrusive_ptr<Dense_tensor> make_tensor(std::size_t batch_size);
 };
 
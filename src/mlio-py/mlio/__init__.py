@@ -22,6 +22,7 @@ from mlio._core import\
     BadExampleHandling,\
     Compression,\
     CooTensor,\
+    CsrTensor,\
     CorruptFooterError,\
     CorruptHeaderError,\
     CorruptRecordError,\
@@ -38,10 +39,12 @@ from mlio._core import\
     DeviceKind,\
     Example,\
     File,\
+    FileIoMethod,\
     ImageFrame,\
     ImageReader,\
     ImageReaderParams,\
     InMemoryStore,\
+    InflateBackend,\
     InflateError,\
     InputStream,\
     InvalidInstanceError,\
@@ -51,10 +54,13 @@ from mlio._core import\
     MaxFieldLengthHandling,\
     MemorySlice,\
     NotSupportedError,\
+    ParquetParams,\
+    ParquetReader,\
     ParquetRecordReader,\
     ParserParams,\
     Record,\
     RecordError,\
+    RecordIOProtobufParams,\
     RecordIOProtobufReader,\
     RecordKind,\
     RecordReader,\
@@ -64,14 +70,19 @@ from mlio._core import\
     SageMakerPipe,\
     Schema,\
     SchemaError,\
+    ShardingStrategy,\
+    SparseTensorFormat,\
     StreamError,\
     Tensor,\
     TextLineReader,\
+    build_gzip_index,\
     deallocate_aws_sdk,\
+    default_inflate_backend,\
     initialize_aws_sdk,\
     list_files,\
     list_s3_objects,\
     supports_image_reader,\
+    supports_inflate_backend,\
     supports_s3
 
 
@@ -83,6 +94,7 @@ __all__ = [
     'BadExampleHandling',
     'Compression',
     'CooTensor',
+    'CsrTensor',
     'CorruptFooterError',
     'CorruptHeaderError',
     'CorruptRecordError',
@@ -99,10 +111,12 @@ __all__ = [
     'DeviceKind',
     'Example',
     'File',
+    'FileIoMethod',
     'ImageFrame',
     'ImageReader',
     'ImageReaderParams',
     'InMemoryStore',
+    'InflateBackend',
     'InflateError',
     'InputStream',
     'InvalidInstanceError',
@@ -112,10 +126,13 @@ __all__ = [
     'MaxFieldLengthHandling',
     'MemorySlice',
     'NotSupportedError',
+    'ParquetParams',
+    'ParquetReader',
     'ParquetRecordReader',
     'ParserParams',
     'Record',
     'RecordError',
+    'RecordIOProtobufParams',
     'RecordIOProtobufReader',
     'RecordKind',
     'RecordReader',
@@ -125,14 +142,19 @@ __all__ = [
     'SageMakerPipe',
     'Schema',
     'SchemaError',
+    'ShardingStrategy',
+    'SparseTensorFormat',
     'StreamError',
     'Tensor',
     'TextLineReader',
+    'build_gzip_index',
     'deallocate_aws_sdk',
+    'default_inflate_backend',
     'initialize_aws_sdk',
     'list_files',
     'list_s3_objects',
     'supports_image_reader',
+    'supports_inflate_backend',
     'supports_s3']
 
 
@@ -113,18 +113,30 @@ Data_reader_params make_data_reader_params(std::vector<Intrusive_ptr<Data_store>
                                            std::size_t batch_size,
                                            std::size_t num_prefetched_examples,
                                            std::size_t num_parallel_reads,
+                                           std::size_t num_prefetched_data_stores,
+                                           std::size_t min_chunk_size,
+                                           std::size_t max_chunk_size,
                                            Last_example_handling last_example_handling,
                                            Bad_example_handling bad_example_handling,
                                            bool warn_bad_instances,
+                                           bool validate_utf8,
                                            std::size_t num_instances_to_skip,
                                            std::optional<std::size_t> num_instances_to_read,
+                                           bool use_record_index,
+                                           std::size_t record_index_interval,
                                            std::size_t shard_index,
                                            std::size_t num_shards,
+                                           Sharding_strategy sharding_strategy,
+                                           std::size_t interleave_cycle_length,
+                                           std::size_t interleave_block_length,
+                                           bool deterministic_interleave,
                                            std::optional<float> sample_ratio,
                                            bool shuffle_instances,
                                            std::size_t shuffle_window,
                                            std::optional<std::size_t> shuffle_seed,
-                                           bool reshuffle_each_epoch)
+                                           bool reshuffle_each_epoch,
+                                           std::optional<std::size_t> shuffle_buffer_memory_threshold,
+                                           std::size_t tensor_pool_size)
 {
     Data_reader_params params{};
 
@@ -132,18 +144,30 @@ Data_reader_params make_data_reader_params(std::vector<Intrusive_ptr<Data_store>
     params.batch_size = batch_size;
     params.num_prefetched_examples = num_prefetched_examples;
     params.num_parallel_reads = num_parallel_reads;
+    params.num_prefetched_data_stores = num_prefetched_data_stores;
+    params.min_chunk_size = min_chunk_size;
+    params.max_chunk_size = max_chunk_size;
     params.last_example_handling = last_example_handling;
     params.bad_example_handling = bad_example_handling;
     params.warn_bad_instances = warn_bad_instances;
+    params.validate_utf8 = validate_utf8;
     params.num_instances_to_skip = num_instances_to_skip;
     params.num_instances_to_read = num_instances_to_read;
+    params.use_record_index = use_record_index;
+    params.record_index_interval = record_index_interval;
     params.shard_index = shard_index;
     params.num_shards = num_shards;
+    params.sharding_strategy = sharding_strategy;
+    params.interleave_cycle_length = interleave_cycle_length;
+    params.interleave_block_length = interleave_block_length;
+    params.deterministic_interleave = deterministic_interleave;
     params.sample_ratio = sample_ratio;
     params.shuffle_instances = shuffle_instances;
     params.shuffle_window = shuffle_window;
     params.shuffle_seed = shuffle_seed;
     params.reshuffle_each_epoch = reshuffle_each_epoch;
+    params.shuffle_buffer_memory_threshold = shuffle_buffer_memory_threshold;
+    params.tensor_pool_size = tensor_pool_size;
 
     return params;
 }
@@ -238,11 +262,45 @@ make_image_reader(Data_reader_params params, Image_reader_params img_params)
     return make_intrusive<Image_reader>(std::move(params), std::move(img_params));
 }
 
-Intrusive_ptr<Recordio_protobuf_reader> make_recordio_protobuf_reader(Data_reader_params params)
+Recordio_protobuf_params make_recordio_protobuf_params(Sparse_tensor_format sparse_tensor_format)
 {
+    Recordio_protobuf_params rp_params{};
+
+    rp_params.sparse_tensor_format = sparse_tensor_format;
+
+    return rp_params;
+}
+
+Intrusive_ptr<Recordio_protobuf_reader>
+make_recordio_protobuf_reader(Data_reader_params params,
+                              std::optional<Recordio_protobuf_params> rp_params)
+{
+    if (rp_params) {
+        return make_intrusive<Recordio_protobuf_reader>(std::move(params), *rp_params);
+    }
+
     return make_intrusive<Recordio_protobuf_reader>(std::move(params));
 }
 
+Parquet_params make_parquet_params(std::vector<std::string> column_names)
+{
+    Parquet_params pq_params{};
+
+    pq_params.column_names = std::move(column_names);
+
+    return pq_params;
+}
+
+Intrusive_ptr<Parquet_reader>
+make_parquet_reader(Data_reader_params params, std::optional<Parquet_params> pq_params)
+{
+    if (pq_params) {
+        return make_intrusive<Parquet_reader>(std::move(params), std::move(pq_params.value()));
+    }
+
+    return make_intrusive<Parquet_reader>(std::move(params));
+}
+
 Intrusive_ptr<Text_line_reader> make_text_line_reader(Data_reader_params params)
 {
     return make_intrusive<Text_line_reader>(std::move(params));
@@ -288,6 +346,23 @@ void register_data_readers(py::module &m)
                Bad_example_handling::pad_warn,
                "Skip bad instances, pad the ``Example`` to the batch size, and warn.");
 
+    py::enum_<Sharding_strategy>(
+        m, "ShardingStrategy", "Specifies how a dataset should be split into shards.")
+        .value("INSTANCE",
+               Sharding_strategy::instance,
+               "Assign every num_shards'th data instance to the shard. Every "
+               "shard reads and discards the whole dataset.")
+        .value("DATA_STORE",
+               Sharding_strategy::data_store,
+               "Assign whole data stores to the shard. The data stores are "
+               "balanced across the shards based on their sizes and every "
+               "shard only reads its own data stores.")
+        .value("ROW_GROUP",
+               Sharding_strategy::row_group,
+               "Distribute the row groups of each data store across the shards "
+               "in a round-robin fashion. Every shard only reads its own row "
+               "groups. Only supported by ``ParquetReader``.");
+
     py::enum_<Max_field_length_handling>(
         m,
         "MaxFieldLengthHandling",
@@ -304,6 +379,13 @@ void register_data_readers(py::module &m)
         .value("NONE", Image_frame::none, "none.")
         .value("RECORDIO", Image_frame::recordio, "For recordio files.");
 
+    py::enum_<Sparse_tensor_format>(
+        m, "SparseTensorFormat", "Specifies the tensor type of the sparse features.")
+        .value("COO", Sparse_tensor_format::coo, "Read the sparse features as ``CooTensor``.")
+        .value("CSR",
+               Sparse_tensor_format::csr,
+               "Read the one-dimensional sparse features as ``CsrTensor``.");
+
     py::class_<Py_data_iterator>(m, "DataIterator")
         .def("__iter__",
              [](Py_data_iterator &it) -> Py_data_iterator & {
@@ -318,18 +400,30 @@ void register_data_readers(py::module &m)
              "batch_size"_a,
              "num_prefetched_examples"_a = 0,
              "num_parallel_reads"_a = 0,
+             "num_prefetched_data_stores"_a = 0,
+             "min_chunk_size"_a = 0,
+             "max_chunk_size"_a = 0,
              "last_example_handling"_a = Last_example_handling::none,
              "bad_example_handling"_a = Bad_example_handling::error,
              "warn_bad_instances"_a = false,
+             "validate_utf8"_a = false,
              "num_instances_to_skip"_a = 0,
              "num_instances_to_read"_a = std::nullopt,
+             "use_record_index"_a = false,
+             "record_index_interval"_a = 1024,
              "shard_index"_a = 0,
              "num_shards"_a = 0,
+             "sharding_strategy"_a = Sharding_strategy::instance,
+             "interleave_cycle_length"_a = 0,
+             "interleave_block_length"_a = 1,
+             "deterministic_interleave"_a = true,
              "sample_ratio"_a = std::nullopt,
              "shuffle_instances"_a = false,
              "shuffle_window"_a = 0,
              "shuffle_seed"_a = std::nullopt,
              "reshuffle_each_epoch"_a = true,
+             "shuffle_buffer_memory_threshold"_a = std::nullopt,
+             "tensor_pool_size"_a = 0,
              R"(
             Parameters
             ----------
@@ -347,6 +441,22 @@ void register_data_readers(py::module &m)
                 to `num_prefetched_examples`. In case a large number of examples
                 should be prefetched, this parameter can be used to avoid
                 thread oversubscription.
+            num_prefetched_data_stores : int, optional
+                The number of upcoming data stores to open in background while
+                the current one is being read. This hides the latency of
+                opening a data store (e.g. an S3 request) when moving from one
+                data store to the next. If zero, data stores are opened on
+                demand.
+            min_chunk_size : int, optional
+                The lower bound of the chunk size used when reading data
+                stores as streams. The chunk size is tuned while reading based
+                on the record sizes, the speed of the stream, and how long the
+                chunks are referenced by the decoded instances. If zero,
+                defaults to 1 MiB, or to `max_chunk_size` if it is smaller.
+            max_chunk_size : int, optional
+                The upper bound of the chunk size. It is exceeded only if a
+                single record does not fit into a chunk. If zero, defaults to
+                256 MiB.
             last_example_handling : LastExampleHandling
                 See ``LastExampleHandling``.
             bad_example_handling : BadExampleHandling
@@ -354,17 +464,53 @@ void register_data_readers(py::module &m)
             warn_bad_instances : bool, optional
                 A boolean value indicating whether a warning will be output for
                 each bad Instance.
+            validate_utf8 : bool, optional
+                A boolean value indicating whether text readers such as
+                ``CsvReader`` and ``TextLineReader`` should verify that every
+                data instance is valid UTF-8 before decoding it. A data
+                instance with an invalid byte sequence is treated as a bad
+                instance; see `bad_example_handling`.
             num_instances_to_skip : int, optional
                 The number of data instances to skip from the beginning of the
                 dataset.
             num_instances_to_read : int, optional
                 The number of data instances to read. The rest of the dataset
                 will be ignored.
+            use_record_index : bool, optional
+                A boolean value indicating whether to use record index files to
+                seek directly to the first data instance to read instead of
+                reading and discarding the ones before it. The index of a data
+                store is kept in a sidecar file next to it with the ".mlioidx"
+                extension and is built the first time the data store is read in
+                full. Only uncompressed files and gzip files with a gzip index
+                can be indexed. An index is specific to the size and
+                modification time of the data store, the reader type, and the
+                parameters used to build it; a mismatching index is ignored and
+                rebuilt.
+            record_index_interval : int, optional
+                The number of data instances between two consecutive offsets
+                stored in a record index.
             shard_index : int, optional
                 The index of the shard to read.
             num_shards : int, optional
                 The number of shards the dataset should be split into. The
                 reader will only read 1/num_shards of the dataset.
+            sharding_strategy : ShardingStrategy, optional
+                See ``ShardingStrategy``.
+            interleave_cycle_length : int, optional
+                The number of data stores to read concurrently. If greater than
+                one, the data instances of that many data stores are
+                interleaved, each data store being read by a separate background
+                thread. This can hide the latency of high-latency data stores
+                such as S3 objects.
+            interleave_block_length : int, optional
+                The number of consecutive data instances to read from a data
+                store before moving to the next one in the cycle.
+            deterministic_interleave : bool, optional
+                A boolean value indicating whether the interleaved data
+                instances should be returned in a deterministic order. If
+                false, they are returned in the order they become available
+                which avoids waiting on a slow data store.
             sample_ratio : float, optional
                 A ratio between zero and one indicating how much of the dataset
                 should be read. The dataset will be sampled based on this
@@ -378,7 +524,12 @@ void register_data_readers(py::module &m)
                 read from the dataset.
 
                 A value of zero means perfect shuffling and requires loading the
-                whole dataset into memory first.
+                whole dataset into memory first. If `use_record_index` is set,
+                the data instances are instead read in random order at their
+                indexed offsets which only requires the record index to be kept
+                in memory. If a data store does not support random access
+                (e.g. a compressed file without an index), the whole dataset is
+                loaded into memory instead.
             shuffle_seed : int, optional
                 The seed that will be used for initializing the sampling
                 distribution. If not specified, a random seed will be generated
@@ -386,22 +537,47 @@ void register_data_readers(py::module &m)
             reshuffle_each_epoch : bool, optional
                 A boolean value indicating whether the dataset should be
                 reshuffled after every `Data_reader.reset()` call.
+            shuffle_buffer_memory_threshold : int, optional
+                If specified, the data of the buffered data instances is packed
+                contiguously into an arena instead of being kept in separate
+                heap allocations. Once the arena grows beyond the specified
+                number of bytes, it continues in temporary files mapped into
+                memory so that large shuffle windows do not have to fit in
+                physical memory.
+            tensor_pool_size : int, optional
+                The maximum number of bytes of tensor memory to keep for reuse
+                once the examples holding them are destroyed. If zero, a new
+                buffer is allocated for every tensor.
             )")
         .def_readwrite("dataset", &Data_reader_params::dataset)
         .def_readwrite("batch_size", &Data_reader_params::batch_size)
         .def_readwrite("num_prefetched_examples", &Data_reader_params::num_prefetched_examples)
         .def_readwrite("num_parallel_reads", &Data_reader_params::num_parallel_reads)
+        .def_readwrite("num_prefetched_data_stores",
+                       &Data_reader_params::num_prefetched_data_stores)
+        .def_readwrite("min_chunk_size", &Data_reader_params::min_chunk_size)
+        .def_readwrite("max_chunk_size", &Data_reader_params::max_chunk_size)
         .def_readwrite("last_example_handling", &Data_reader_params::last_example_handling)
         .def_readwrite("bad_example_handling", &Data_reader_params::bad_example_handling)
+        .def_readwrite("validate_utf8", &Data_reader_params::validate_utf8)
         .def_readwrite("num_instances_to_skip", &Data_reader_params::num_instances_to_skip)
         .def_readwrite("num_instances_to_read", &Data_reader_params::num_instances_to_read)
+        .def_readwrite("use_record_index", &Data_reader_params::use_record_index)
+        .def_readwrite("record_index_interval", &Data_reader_params::record_index_interval)
         .def_readwrite("shard_index", &Data_reader_params::shard_index)
         .def_readwrite("num_shards", &Data_reader_params::num_shards)
+        .def_readwrite("sharding_strategy", &Data_reader_params::sharding_strategy)
+        .def_readwrite("interleave_cycle_length", &Data_reader_params::interleave_cycle_length)
+        .def_readwrite("interleave_block_length", &Data_reader_params::interleave_block_length)
+        .def_readwrite("deterministic_interleave", &Data_reader_params::deterministic_interleave)
         .def_readwrite("sample_ratio", &Data_reader_params::sample_ratio)
         .def_readwrite("shuffle_instances", &Data_reader_params::shuffle_instances)
         .def_readwrite("shuffle_window", &Data_reader_params::shuffle_window)
         .def_readwrite("shuffle_seed", &Data_reader_params::shuffle_seed)
-        .def_readwrite("reshuffle_each_epoch", &Data_reader_params::reshuffle_each_epoch);
+        .def_readwrite("reshuffle_each_epoch", &Data_reader_params::reshuffle_each_epoch)
+        .def_readwrite("shuffle_buffer_memory_threshold",
+                       &Data_reader_params::shuffle_buffer_memory_threshold)
+        .def_readwrite("tensor_pool_size", &Data_reader_params::tensor_pool_size);
 
     py::class_<Csv_params>(
         m, "CsvParams", "Represents the optional parameters of a ``CsvReader`` object.")
@@ -565,6 +741,39 @@ void register_data_readers(py::module &m)
         .def_readwrite("image_dimensions", &Image_reader_params::image_dimensions)
         .def_readwrite("to_rgb", &Image_reader_params::to_rgb);
 
+    py::class_<Recordio_protobuf_params>(
+        m,
+        "RecordIOProtobufParams",
+        "Represents the optional parameters of a ``RecordIOProtobufReader`` object.")
+        .def(py::init(&make_recordio_protobuf_params),
+             "sparse_tensor_format"_a = Sparse_tensor_format::coo,
+             R"(
+            Parameters
+            ----------
+            sparse_tensor_format : SparseTensorFormat
+                The tensor type of the sparse features. Only sparse features
+                with a single dimension can be read as ``CsrTensor``; the
+                rest are always read as ``CooTensor``.
+            )")
+        .def_readwrite("sparse_tensor_format", &Recordio_protobuf_params::sparse_tensor_format);
+
+    py::class_<Parquet_params>(
+        m, "ParquetParams", "Represents the optional parameters of a ``ParquetReader`` object.")
+        .def(py::init(&make_parquet_params),
+             "column_names"_a = std::vector<std::string>{},
+             R"(
+            Parameters
+            ----------
+            column_names : list of strs
+                The columns that should be read. If empty, all columns that
+                have a supported type are read.
+
+                Due to a shortcoming in pybind11, values cannot be added to
+                container types, and updates must instead be made via
+                assignment.
+            )")
+        .def_readwrite("column_names", &Parquet_params::column_names);
+
     py::class_<Parser_options>(m, "ParserParams")
         .def(py::init(&make_parser_options),
              "nan_values"_a = std::unordered_set<std::string>{},
@@ -657,11 +866,31 @@ void register_data_readers(py::module &m)
         m, "RecordIOProtobufReader")
         .def(py::init<>(&make_recordio_protobuf_reader),
              "data_reader_params"_a,
+             "recordio_protobuf_params"_a = std::nullopt,
+             R"(
+            Parameters
+            ----------
+            data_reader_params : DataReaderParams
+                See ``DataReaderParams``.
+            recordio_protobuf_params : RecordIOProtobufParams, optional
+                See ``RecordIOProtobufParams``.
+            )");
+
+    py::class_<Parquet_reader, Data_reader, Intrusive_ptr<Parquet_reader>>(
+        m,
+        "ParquetReader",
+        "Represents a ``Data_reader`` that decodes Parquet files directly "
+        "into dense tensors, one tensor per column.")
+        .def(py::init<>(&make_parquet_reader),
+             "data_reader_params"_a,
+             "parquet_params"_a = std::nullopt,
              R"(
             Parameters
             ----------
             data_reader_params : DataReaderParams
                 See ``DataReaderParams``.
+            parquet_params : ParquetParams, optional
+                See ``ParquetParams``.
             )");
 
     py::class_<Text_line_reader, Data_reader, Intrusive_ptr<Text_line_reader>>(m, "TextLineReader")
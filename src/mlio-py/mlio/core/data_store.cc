@@ -64,6 +64,24 @@ const std::string &Py_data_store::id() const noexcept
     }
 }
 
+Intrusive_ptr<File> make_file(std::string path,
+                              bool memory_map,
+                              Compression compression,
+                              File_io_method io_method,
+                              std::size_t mmap_window_size,
+                              bool mmap_populate,
+                              bool mmap_huge_pages,
+                              std::size_t gzip_index_interval,
+                              Inflate_backend inflate_backend)
+{
+    Memory_map_options mmap_options{mmap_window_size, mmap_populate, mmap_huge_pages};
+
+    return make_intrusive<File>(
+        std::move(path),
+        File_options{
+            memory_map, compression, io_method, mmap_options, gzip_index_interval, inflate_backend});
+}
+
 Intrusive_ptr<In_memory_store> make_in_memory_store(const py::buffer &buf, Compression compression)
 {
     return make_intrusive<In_memory_store>(make_intrusive<Py_memory_block>(buf), compression);
@@ -74,9 +92,25 @@ py_list_files(const std::vector<std::string> &paths,
               const std::string &pattern,
               File_list_options::Predicate_callback &predicate,
               bool memory_map,
-              Compression compression)
+              Compression compression,
+              File_io_method io_method,
+              std::size_t mmap_window_size,
+              bool mmap_populate,
+              bool mmap_huge_pages,
+              std::size_t gzip_index_interval,
+              Inflate_backend inflate_backend)
 {
-    return list_files(paths, {pattern, &predicate, memory_map, compression});
+    Memory_map_options mmap_options{mmap_window_size, mmap_populate, mmap_huge_pages};
+
+    return list_files(paths,
+                      {pattern,
+                       &predicate,
+                       memory_map,
+                       compression,
+                       io_method,
+                       mmap_options,
+                       gzip_index_interval,
+                       inflate_backend});
 }
 
 std::vector<Intrusive_ptr<Data_store>>
@@ -98,7 +132,28 @@ void register_data_stores(py::module &m)
         .value("INFER", Compression::infer)
         .value("GZIP", Compression::gzip)
         .value("BZIP2", Compression::bzip2)
-        .value("ZIP", Compression::zip);
+        .value("ZIP", Compression::zip)
+        .value("ZSTD", Compression::zstd)
+        .value("LZ4", Compression::lz4);
+
+    py::enum_<Inflate_backend>(
+        m, "InflateBackend", "Specifies the library used to inflate gzip and zlib data.")
+        .value("ZLIB", Inflate_backend::zlib, "zlib, or a compatible library such as zlib-ng.")
+        .value("ISAL", Inflate_backend::isal, "Intel ISA-L.")
+        .value("LIBDEFLATE",
+               Inflate_backend::libdeflate,
+               "libdeflate; used for in-memory data, streams fall back to ISA-L or zlib.");
+
+    py::enum_<File_io_method>(
+        m, "FileIoMethod", "Specifies how a file that is not memory-mapped should be read.")
+        .value("BLOCKING", File_io_method::blocking, "Read the file using blocking system calls.")
+        .value("IO_URING",
+               File_io_method::io_uring,
+               "Read the file using Linux io_uring, keeping multiple large reads in flight. "
+               "Falls back to ``BLOCKING`` if io_uring is not available.")
+        .value("DIRECT",
+               File_io_method::direct,
+               "Read the file using direct I/O (O_DIRECT), bypassing the page cache.");
 
     py::class_<Data_store, Py_data_store, Intrusive_ptr<Data_store>>(
         m, "DataStore", "Represents a repository of data.")
@@ -121,10 +176,16 @@ void register_data_stores(py::module &m)
 
     py::class_<File, Data_store, Intrusive_ptr<File>>(
         m, "File", "Represents a File as a ``DataStore``.")
-        .def(py::init<std::string, bool, Compression>(),
+        .def(py::init(&make_file),
              "path"_a,
              "memory_map"_a = true,
              "compression"_a = Compression::infer,
+             "io_method"_a = File_io_method::blocking,
+             "mmap_window_size"_a = 0,
+             "mmap_populate"_a = false,
+             "mmap_huge_pages"_a = false,
+             "gzip_index_interval"_a = 0,
+             "inflate_backend"_a = default_inflate_backend(),
              R"(
             Parameters
             ----------
@@ -136,6 +197,28 @@ void register_data_stores(py::module &m)
             compression : compression
                 The compression type of the File. If set to `INFER`, the
                 compression will be inferred from the filename.
+            io_method : FileIoMethod
+                The method used to read the File if it is not
+                memory-mapped.
+            mmap_window_size : int
+                If not zero, the memory-mapped File is read in windows of
+                the specified size. The kernel is advised to read ahead of
+                the current window and the pages behind the oldest window
+                still in use are released, so that the resident memory
+                stays bounded. Only applies to uncompressed files.
+            mmap_populate : bool
+                A boolean value indicating whether the whole File should be
+                read into memory while mapping.
+            mmap_huge_pages : bool
+                A boolean value indicating whether the mapping should be
+                aligned to and backed by huge pages where supported.
+            gzip_index_interval : int
+                If not zero and the File is a gzip file without an
+                up-to-date index, an index with the specified interval
+                is built the first time the File is read to its end.
+            inflate_backend : InflateBackend
+                The library used to inflate the File if it is a gzip
+                file.
             )");
 
     py::class_<In_memory_store, Data_store, Intrusive_ptr<In_memory_store>>(
@@ -194,6 +277,33 @@ void register_data_stores(py::module &m)
                 The compression type of the data.
             )");
 
+    m.def("supports_inflate_backend",
+          &supports_inflate_backend,
+          "backend"_a,
+          "Return a boolean value indicating whether the library was built with the "
+          "specified inflate backend.");
+
+    m.def("default_inflate_backend",
+          &default_inflate_backend,
+          "Return the fastest inflate backend the library was built with.");
+
+    m.def("build_gzip_index",
+          &build_gzip_index,
+          "path"_a,
+          "interval"_a = 0x100'0000,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(
+        Build the random-access index of a gzip file and save it next to
+        the file. A gzip file with an index is read as a seekable stream.
+
+        Parameters
+        ----------
+        path : str
+            The path to the gzip file.
+        interval : int, optional
+            The number of inflated bytes between two access points.
+        )");
+
     m.def("list_files",
           &py_list_files,
           "paths"_a,
@@ -201,6 +311,12 @@ void register_data_stores(py::module &m)
           "predicate"_a = nullptr,
           "memory_map"_a = true,
           "compression"_a = Compression::infer,
+          "io_method"_a = File_io_method::blocking,
+          "mmap_window_size"_a = 0,
+          "mmap_populate"_a = false,
+          "mmap_huge_pages"_a = false,
+          "gzip_index_interval"_a = 0,
+          "inflate_backend"_a = default_inflate_backend(),
           R"(
         Recursively list all files residing under the specified paths.
 
@@ -218,6 +334,24 @@ void register_data_stores(py::module &m)
         compression : compression
             The compression type of the files. If set to `INFER`, the
             compression will be inferred from the filenames.
+        io_method : FileIoMethod
+            The method used to read the files if they are not
+            memory-mapped.
+        mmap_window_size : int
+            If not zero, the memory-mapped files are read in windows of the
+            specified size to keep the resident memory bounded.
+        mmap_populate : bool
+            A boolean value indicating whether the whole files should be
+            read into memory while mapping.
+        mmap_huge_pages : bool
+            A boolean value indicating whether the mappings should be
+            aligned to and backed by huge pages where supported.
+        gzip_index_interval : int
+            If not zero, the interval of the indices built for the gzip
+            files that have none the first time they are read to their
+            end.
+        inflate_backend : InflateBackend
+            The library used to inflate the gzip files.
         )");
 
     m.def("list_files",
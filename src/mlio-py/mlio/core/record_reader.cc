@@ -53,6 +53,18 @@ private:
     py::object parent_;
 };
 
+Intrusive_ptr<mlio::detail::Parquet_record_reader>
+make_parquet_record_reader(Intrusive_ptr<Input_stream> stream,
+                           std::optional<std::vector<std::size_t>> file_ends)
+{
+    if (file_ends) {
+        return make_intrusive<mlio::detail::Parquet_record_reader>(std::move(stream),
+                                                                   std::move(*file_ends));
+    }
+
+    return make_intrusive<mlio::detail::Parquet_record_reader>(std::move(stream));
+}
+
 }  // namespace
 
 void register_record_readers(py::module &m)
@@ -94,7 +106,7 @@ void register_record_readers(py::module &m)
                Record_reader,
                Intrusive_ptr<mlio::detail::Parquet_record_reader>>(
         m, "ParquetRecordReader", "Represents a ``Record_reader`` for reading Parquet records.")
-        .def(py::init<Intrusive_ptr<Input_stream>>(), "stream"_a);
+        .def(py::init(&make_parquet_record_reader), "stream"_a, "file_ends"_a = std::nullopt);
 }
 
 }  // namespace pymlio
@@ -15,6 +15,7 @@
 
 #include "module.h"
 
+#include <cstddef>
 #include <string>
 
 namespace py = pybind11;
@@ -30,9 +31,18 @@ Intrusive_ptr<S3_client> py_make_s3_client(const std::string &access_key_id,
                                            const std::string &session_token,
                                            const std::string &profile,
                                            const std::string &region,
-                                           bool use_https)
+                                           bool use_https,
+                                           std::size_t read_ahead_part_size,
+                                           std::size_t num_read_ahead_parts)
 {
-    S3_client_options opts{access_key_id, secret_key, session_token, profile, region, use_https};
+    S3_client_options opts{access_key_id,
+                           secret_key,
+                           session_token,
+                           profile,
+                           region,
+                           use_https,
+                           read_ahead_part_size,
+                           num_read_ahead_parts};
     return make_s3_client(opts);
 }
 
@@ -48,7 +58,33 @@ void register_s3_client(py::module &m)
              "session_token"_a = "",
              "profile"_a = "",
              "region"_a = "",
-             "use_https"_a = true);
+             "use_https"_a = true,
+             "read_ahead_part_size"_a = 0,
+             "num_read_ahead_parts"_a = 0,
+             R"(
+            Parameters
+            ----------
+            access_key_id : str, optional
+                The access key ID to use.
+            secret_key : str, optional
+                The secret key to use.
+            session_token : str, optional
+                The session token to use.
+            profile : str, optional
+                The profile name to use.
+            region : str, optional
+                The region to use.
+            use_https : bool, optional
+                A boolean value indicating whether to use HTTPS.
+            read_ahead_part_size : int, optional
+                The size of the ranged requests issued while reading an S3
+                object sequentially. If zero, defaults to 8 MiB.
+            num_read_ahead_parts : int, optional
+                The number of ranged requests kept in flight while reading an
+                S3 object sequentially. If zero, defaults to 8.
+            )")
+        .def_property_readonly("read_ahead_part_size", &S3_client::read_ahead_part_size)
+        .def_property_readonly("num_read_ahead_parts", &S3_client::num_read_ahead_parts);
 
     m.def("initialize_aws_sdk", initialize_aws_sdk, "Initialize AWS C++ SDK");
     m.def("deallocate_aws_sdk",
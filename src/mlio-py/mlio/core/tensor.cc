@@ -60,6 +60,17 @@ make_coo_tensor(Size_vector shape, py::buffer &data, std::vector<py::buffer> &co
     return make_intrusive<Coo_tensor>(std::move(shape), std::move(arr), std::move(coordinates));
 }
 
+Intrusive_ptr<Csr_tensor> make_csr_tensor(
+    Size_vector shape, py::buffer &data, py::buffer &indices, py::buffer &indptr, bool cpy)
+{
+    std::unique_ptr<Device_array> arr = make_device_array(data, cpy);
+
+    return make_intrusive<Csr_tensor>(std::move(shape),
+                                      std::move(arr),
+                                      make_device_array(indices, cpy),
+                                      make_device_array(indptr, cpy));
+}
+
 py::buffer_info to_py_buffer(Dense_tensor &tensor)
 {
     auto buf = py::cast(tensor).attr("data").cast<py::buffer>();
@@ -161,6 +172,35 @@ void register_tensors(py::module &m)
             },
             "dim"_a,
             "Gets the indices for the specified dimension.");
+
+    py::class_<Csr_tensor, Tensor, Intrusive_ptr<Csr_tensor>>(
+        m,
+        "CsrTensor",
+        "Represents a Tensor that stores its data as a Compressed Sparse Row matrix.")
+        .def(py::init<>(&make_csr_tensor),
+             "shape"_a,
+             "data"_a,
+             "indices"_a,
+             "indptr"_a,
+             "copy"_a = true)
+        .def_property_readonly(
+            "data",
+            [](Csr_tensor &self) {
+                return Py_device_array{wrap_intrusive(&self), self.data()};
+            },
+            "Gets the data of the Tensor.")
+        .def_property_readonly(
+            "indices",
+            [](Csr_tensor &self) {
+                return Py_device_array{wrap_intrusive(&self), self.indices()};
+            },
+            "Gets the column indices of the Tensor.")
+        .def_property_readonly(
+            "indptr",
+            [](Csr_tensor &self) {
+                return Py_device_array{wrap_intrusive(&self), self.indptr()};
+            },
+            "Gets the index pointer array of the Tensor.");
 }
 
 }  // namespace pymlio
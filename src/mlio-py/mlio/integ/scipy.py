@@ -13,8 +13,8 @@
 
 import numpy as np
 
-from mlio._core import CooTensor
-from scipy.sparse import coo_matrix
+from mlio._core import CooTensor, CsrTensor
+from scipy.sparse import coo_matrix, csr_matrix
 
 
 def to_coo_matrix(tensor):
@@ -41,6 +41,26 @@ def to_coo_matrix(tensor):
     return coo_matrix((data, (rows, cols)), s, copy=True)
 
 
+def to_csr_matrix(tensor):
+    """
+    Converts the specified Tensor to a ``csr_matrix``.
+    """
+
+    if not isinstance(tensor, CsrTensor):
+        raise ValueError("The Tensor must be an Instance of CsrTensor.")
+
+    s = tensor.shape
+
+    if len(s) == 1:
+        s = (1,) + s
+
+    data = np.array(tensor.data, copy=False)
+    indices = np.array(tensor.indices, copy=False)
+    indptr = np.array(tensor.indptr, copy=False)
+
+    return csr_matrix((data, indices, indptr), s, copy=True)
+
+
 def to_tensor(mtx):
     """
     Converts the specified ``coo_matrix`` to a Tensor.
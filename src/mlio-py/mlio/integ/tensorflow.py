@@ -14,16 +14,19 @@
 import numpy as np
 import tensorflow as tf
 
-from mlio import DenseTensor
+from mlio import CsrTensor, DenseTensor
 from mlio.integ.numpy import as_numpy
-from mlio.integ.scipy import to_coo_matrix
+from mlio.integ.scipy import to_coo_matrix, to_csr_matrix
 
 
 def to_tf(tensor):
     if isinstance(tensor, DenseTensor):
         return tf.convert_to_tensor(as_numpy(tensor))
 
-    mtx = to_coo_matrix(tensor).tocsr()
+    if isinstance(tensor, CsrTensor):
+        mtx = to_csr_matrix(tensor)
+    else:
+        mtx = to_coo_matrix(tensor).tocsr()
 
     non_zero_row_col = mtx.nonzero()
     indices = np.asmatrix([non_zero_row_col[0], non_zero_row_col[1]])
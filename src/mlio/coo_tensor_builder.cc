@@ -15,6 +15,11 @@
 
 #include "mlio/coo_tensor_builder.h"
 
+#include <algorithm>
+#include <vector>
+
+#include <tbb/tbb.h>
+
 #include "mlio/util/cast.h"
 
 namespace mlio {
@@ -73,6 +78,54 @@ bool Coo_tensor_builder::append_indices(stdx::span<const std::uint64_t> indices)
     return true;
 }
 
+void Coo_tensor_builder::merge(stdx::span<Sparse_tensor_builder *const> builders)
+{
+    if (builders.empty()) {
+        return;
+    }
+
+    // The offset of each builder's contents in the merged arrays.
+    std::vector<std::size_t> offsets(builders.size());
+
+    std::size_t num_values = this->num_values();
+    for (std::size_t i = 0; i < builders.size(); i++) {
+        offsets[i] = num_values;
+
+        num_values += builders[i]->num_values();
+    }
+
+    for (std::vector<std::size_t> &indices : coordinates_) {
+        indices.resize(num_values);
+    }
+
+    resize_data(num_values);
+
+    tbb::parallel_for(std::size_t{}, builders.size(), [this, &builders, &offsets](std::size_t i) {
+        const auto &other = static_cast<const Coo_tensor_builder &>(*builders[i]);
+
+        auto offset = as_ssize(offsets[i]);
+
+        for (std::size_t dim = 0; dim < coordinates_.size(); dim++) {
+            const std::vector<std::size_t> &indices = other.coordinates_[dim];
+
+            std::copy(indices.begin(), indices.end(), coordinates_[dim].begin() + offset);
+        }
+
+        copy_data(other, offsets[i]);
+    });
+
+    row_idx_ = static_cast<const Coo_tensor_builder &>(*builders[builders.size() - 1]).row_idx_;
+}
+
+void Coo_tensor_builder::reserve(std::size_t num_values)
+{
+    for (std::vector<std::size_t> &indices : coordinates_) {
+        indices.reserve(num_values);
+    }
+
+    reserve_data(num_values);
+}
+
 Intrusive_ptr<Tensor> Coo_tensor_builder::build_core(std::unique_ptr<Device_array> &&data)
 {
     // Wrap index lists into device arrays.
@@ -15,7 +15,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #include <tbb/iterators.h>
@@ -25,16 +27,26 @@
 #include "mlio/intrusive_ptr.h"
 #include "mlio/schema.h"
 #include "mlio/span.h"
+#include "mlio/sparse_tensor_builder.h"
 #include "mlio/tensor.h"
+#include "mlio/util/cast.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
-class Coo_tensor_builder {
+class Coo_tensor_builder : public Sparse_tensor_builder {
 public:
-    explicit Coo_tensor_builder(const Attribute &attr, std::size_t batch_size)
-        : attr_{&attr}, batch_size_{batch_size}, coordinates_(attr.shape().size())
+    // The row_idx argument specifies the batch row of the first instance
+    // appended to the builder; a builder can be used for a range of rows
+    // and merged later with the builders of the other ranges.
+    explicit Coo_tensor_builder(const Attribute &attr,
+                                std::size_t batch_size,
+                                std::size_t row_idx = 0)
+        : attr_{&attr}
+        , batch_size_{batch_size}
+        , row_idx_{row_idx}
+        , coordinates_(attr.shape().size())
     {}
 
     Coo_tensor_builder(const Coo_tensor_builder &) = delete;
@@ -45,13 +57,28 @@ public:
 
     Coo_tensor_builder &operator=(Coo_tensor_builder &&) = delete;
 
-    virtual ~Coo_tensor_builder();
+    ~Coo_tensor_builder() override;
 
-    virtual Intrusive_ptr<Tensor> build() = 0;
+    void merge(stdx::span<Sparse_tensor_builder *const> builders) final;
+
+    void reserve(std::size_t num_values) final;
+
+    std::size_t num_values() const noexcept final
+    {
+        return coordinates_[0].size();
+    }
 
 protected:
     bool append_indices(stdx::span<const std::uint64_t> indices);
 
+    virtual void reserve_data(std::size_t size) = 0;
+
+    virtual void resize_data(std::size_t size) = 0;
+
+    // Copies the values of the specified builder to the specified
+    // offset of this builder's values.
+    virtual void copy_data(const Coo_tensor_builder &other, std::size_t offset) = 0;
+
     Intrusive_ptr<Tensor> build_core(std::unique_ptr<Device_array> &&data);
 
 private:
@@ -73,6 +100,23 @@ public:
     Intrusive_ptr<Tensor> build() final;
 
 private:
+    void reserve_data(std::size_t size) final
+    {
+        data_.reserve(size);
+    }
+
+    void resize_data(std::size_t size) final
+    {
+        data_.resize(size);
+    }
+
+    void copy_data(const Coo_tensor_builder &other, std::size_t offset) final
+    {
+        const auto &data = static_cast<const Coo_tensor_builder_impl &>(other).data_;
+
+        std::copy(data.begin(), data.end(), data_.begin() + as_ssize(offset));
+    }
+
     std::vector<value_type> data_{};
 };
 
@@ -95,16 +139,17 @@ Intrusive_ptr<Tensor> Coo_tensor_builder_impl<dt>::build()
 
 template<Data_type dt>
 struct make_coo_tensor_builder_op {
-    std::unique_ptr<Coo_tensor_builder> operator()(const Attribute &attr, std::size_t batch_size)
+    std::unique_ptr<Coo_tensor_builder>
+    operator()(const Attribute &attr, std::size_t batch_size, std::size_t row_idx)
     {
-        return std::make_unique<Coo_tensor_builder_impl<dt>>(attr, batch_size);
+        return std::make_unique<Coo_tensor_builder_impl<dt>>(attr, batch_size, row_idx);
     }
 };
 
 inline std::unique_ptr<Coo_tensor_builder>
-make_coo_tensor_builder(const Attribute &attr, std::size_t batch_size)
+make_coo_tensor_builder(const Attribute &attr, std::size_t batch_size, std::size_t row_idx = 0)
 {
-    return dispatch<make_coo_tensor_builder_op>(attr.data_type(), attr, batch_size);
+    return dispatch<make_coo_tensor_builder_op>(attr.data_type(), attr, batch_size, row_idx);
 }
 
 }  // namespace detail
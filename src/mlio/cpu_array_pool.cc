@@ -0,0 +1,219 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/cpu_array_pool.h"
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "mlio/cpu_array.h"
+#include "mlio/intrusive_ptr.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+void Pooled_storage_deleter::operator()(void *ptr) const noexcept
+{
+    ::operator delete(ptr);
+}
+
+struct Cpu_array_pool_access {
+    static Pooled_storage acquire(Cpu_array_pool &pool, std::size_t num_bytes)
+    {
+        {
+            std::unique_lock<std::mutex> lock{pool.mutex_};
+
+            auto pos = pool.buffers_.find(num_bytes);
+            if (pos != pool.buffers_.end() && !pos->second.empty()) {
+                Pooled_storage storage = std::move(pos->second.back());
+
+                pos->second.pop_back();
+
+                pool.size_ -= num_bytes;
+
+                return storage;
+            }
+        }
+
+        return Pooled_storage{::operator new(num_bytes)};
+    }
+
+    static void release(Cpu_array_pool &pool, std::size_t num_bytes, Pooled_storage &&storage)
+    {
+        pool.release(num_bytes, std::move(storage));
+    }
+};
+
+namespace {
+
+// A minimal sequence container that returns its storage to the pool it
+// was allocated from instead of freeing it.
+template<typename T>
+class Pooled_buffer {
+public:
+    using value_type = T;
+
+    explicit Pooled_buffer(Intrusive_ptr<Cpu_array_pool> pool,
+                           Pooled_storage &&storage,
+                           std::size_t size) noexcept
+        : pool_{std::move(pool)}, storage_{std::move(storage)}, size_{size}
+    {}
+
+    Pooled_buffer(const Pooled_buffer &) = delete;
+
+    Pooled_buffer &operator=(const Pooled_buffer &) = delete;
+
+    Pooled_buffer(Pooled_buffer &&) noexcept = default;
+
+    Pooled_buffer &operator=(Pooled_buffer &&) = delete;
+
+    ~Pooled_buffer()
+    {
+        if (storage_ != nullptr) {
+            Cpu_array_pool_access::release(*pool_, size_ * sizeof(T), std::move(storage_));
+        }
+    }
+
+    T *data() noexcept
+    {
+        return static_cast<T *>(storage_.get());
+    }
+
+    const T *data() const noexcept
+    {
+        return static_cast<const T *>(storage_.get());
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    const T *begin() const noexcept
+    {
+        return data();
+    }
+
+    const T *end() const noexcept
+    {
+        return data() + size_;
+    }
+
+private:
+    Intrusive_ptr<Cpu_array_pool> pool_;
+    Pooled_storage storage_;
+    std::size_t size_;
+};
+
+template<Data_type dt>
+struct allocate_pooled_array_op {
+    std::unique_ptr<Device_array>
+    operator()(Cpu_array_pool &pool, std::size_t size, bool zero_init)
+    {
+        using T = data_type_t<dt>;
+
+        // Strings own heap memory on their own; there is no point in
+        // recycling their buffers.
+        if constexpr (std::is_same<T, std::string>::value) {
+            return make_cpu_array(dt, size);
+        }
+        else {
+            std::size_t num_bytes = size * sizeof(T);
+            if (num_bytes == 0) {
+                return make_cpu_array(dt, size);
+            }
+
+            Pooled_storage storage = Cpu_array_pool_access::acquire(pool, num_bytes);
+
+            if (zero_init) {
+                std::memset(storage.get(), 0, num_bytes);
+            }
+
+            Pooled_buffer<T> buffer{Intrusive_ptr<Cpu_array_pool>{&pool}, std::move(storage), size};
+
+            return Cpu_array_access::wrap(dt, std::move(buffer));
+        }
+    }
+};
+
+}  // namespace
+}  // namespace detail
+
+Cpu_array_pool::Cpu_array_pool(std::size_t max_size) noexcept : max_size_{max_size}
+{}
+
+Cpu_array_pool::~Cpu_array_pool() = default;
+
+std::unique_ptr<Device_array>
+Cpu_array_pool::allocate(Data_type dt, std::size_t size, bool zero_init)
+{
+    return dispatch<detail::allocate_pooled_array_op>(dt, *this, size, zero_init);
+}
+
+void Cpu_array_pool::release(std::size_t num_bytes, detail::Pooled_storage &&storage) noexcept
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        if (size_ + num_bytes <= max_size_) {
+            try {
+                buffers_[num_bytes].emplace_back(std::move(storage));
+            }
+            catch (const std::bad_alloc &) {
+                return;
+            }
+
+            size_ += num_bytes;
+
+            return;
+        }
+    }
+
+    // If the pool is full, the storage gets freed here outside of the
+    // lock.
+    storage = nullptr;
+}
+
+void Cpu_array_pool::clear() noexcept
+{
+    std::unordered_map<std::size_t, std::vector<detail::Pooled_storage>> buffers{};
+
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        buffers.swap(buffers_);
+
+        size_ = 0;
+    }
+}
+
+std::size_t Cpu_array_pool::size() const noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    return size_;
+}
+
+}  // namespace abi_v1
+}  // namespace mlio
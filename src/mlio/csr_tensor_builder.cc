@@ -0,0 +1,228 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/csr_tensor_builder.h"
+
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <tbb/tbb.h>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr auto max_int32_index = static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+
+template<typename T>
+using index_type_t = typename std::decay_t<T>::value_type;
+
+}  // namespace
+
+Csr_tensor_builder::Csr_tensor_builder(const Attribute &attr, std::size_t batch_size)
+    : attr_{&attr}, batch_size_{batch_size}, num_columns_{attr.shape()[1]}
+{
+    if (num_columns_ > max_int32_index) {
+        index_arrays_ = Csr_index_arrays<std::int64_t>{};
+    }
+}
+
+Csr_tensor_builder::~Csr_tensor_builder() = default;
+
+void Csr_tensor_builder::merge(stdx::span<Sparse_tensor_builder *const> builders)
+{
+    if (builders.empty()) {
+        return;
+    }
+
+    // The offsets of each builder's values and rows in the merged arrays.
+    std::vector<std::size_t> offsets(builders.size());
+    std::vector<std::size_t> row_offsets(builders.size());
+
+    std::size_t num_values = this->num_values();
+    std::size_t num_rows = this->num_rows();
+
+    bool wide = false;
+
+    for (std::size_t i = 0; i < builders.size(); i++) {
+        const auto &other = static_cast<const Csr_tensor_builder &>(*builders[i]);
+
+        offsets[i] = num_values;
+        row_offsets[i] = num_rows;
+
+        num_values += other.num_values();
+        num_rows += other.num_rows();
+
+        if (std::holds_alternative<Csr_index_arrays<std::int64_t>>(other.index_arrays_)) {
+            wide = true;
+        }
+    }
+
+    if (wide || num_values > max_int32_index) {
+        widen_indices();
+    }
+
+    resize_data(num_values);
+
+    std::visit(
+        [this, &builders, &offsets, &row_offsets, num_values, num_rows](auto &arrays) {
+            using T = index_type_t<decltype(arrays.indices)>;
+
+            arrays.indices.resize(num_values);
+            arrays.indptr.resize(num_rows + 1);
+
+            tbb::parallel_for(std::size_t{}, builders.size(), [&](std::size_t i) {
+                const auto &other = static_cast<const Csr_tensor_builder &>(*builders[i]);
+
+                std::visit(
+                    [&arrays, offset = offsets[i], row_offset = row_offsets[i]](
+                        const auto &other_arrays) {
+                        const auto &indices = other_arrays.indices;
+                        const auto &indptr = other_arrays.indptr;
+
+                        std::copy(indices.begin(),
+                                  indices.end(),
+                                  arrays.indices.begin() + as_ssize(offset));
+
+                        // Skip the leading zero of the other builder.
+                        std::transform(indptr.begin() + 1,
+                                       indptr.end(),
+                                       arrays.indptr.begin() + as_ssize(row_offset + 1),
+                                       [offset](auto row_end) {
+                                           return static_cast<T>(
+                                               offset + static_cast<std::size_t>(row_end));
+                                       });
+                    },
+                    other.index_arrays_);
+
+                copy_data(other, offsets[i]);
+            });
+        },
+        index_arrays_);
+}
+
+void Csr_tensor_builder::reserve(std::size_t num_values)
+{
+    std::visit(
+        [num_values](auto &arrays) {
+            arrays.indices.reserve(num_values);
+        },
+        index_arrays_);
+
+    reserve_data(num_values);
+}
+
+std::size_t Csr_tensor_builder::num_values() const noexcept
+{
+    return std::visit(
+        [](const auto &arrays) {
+            return arrays.indices.size();
+        },
+        index_arrays_);
+}
+
+std::size_t Csr_tensor_builder::num_rows() const noexcept
+{
+    return std::visit(
+        [](const auto &arrays) {
+            return arrays.indptr.size() - 1;
+        },
+        index_arrays_);
+}
+
+bool Csr_tensor_builder::append_indices(stdx::span<const std::uint64_t> keys)
+{
+    for (std::uint64_t key : keys) {
+        // Make sure that the key is within the dimension.
+        if (key >= num_columns_) {
+            return false;
+        }
+    }
+
+    // The row offsets can exceed the int32 range even if the column
+    // indices do not.
+    if (num_values() + keys.size() > max_int32_index) {
+        widen_indices();
+    }
+
+    std::visit(
+        [keys](auto &arrays) {
+            using T = index_type_t<decltype(arrays.indices)>;
+
+            std::size_t size = arrays.indices.size();
+
+            arrays.indices.resize(size + keys.size());
+
+            std::transform(keys.begin(),
+                           keys.end(),
+                           arrays.indices.begin() + as_ssize(size),
+                           [](std::uint64_t key) {
+                               return static_cast<T>(key);
+                           });
+
+            arrays.indptr.emplace_back(static_cast<T>(arrays.indices.size()));
+        },
+        index_arrays_);
+
+    return true;
+}
+
+void Csr_tensor_builder::widen_indices()
+{
+    auto *arrays = std::get_if<Csr_index_arrays<std::int32_t>>(&index_arrays_);
+    if (arrays == nullptr) {
+        return;
+    }
+
+    Csr_index_arrays<std::int64_t> wide_arrays{};
+
+    wide_arrays.indices.assign(arrays->indices.begin(), arrays->indices.end());
+    wide_arrays.indptr.assign(arrays->indptr.begin(), arrays->indptr.end());
+
+    index_arrays_ = std::move(wide_arrays);
+}
+
+Intrusive_ptr<Tensor> Csr_tensor_builder::build_core(std::unique_ptr<Device_array> &&data)
+{
+    Size_vector shape = attr_->shape();
+
+    // The provided batch size can be less than the actual batch size if
+    // there is padding.
+    shape[0] = batch_size_;
+
+    return std::visit(
+        [this, &data, &shape](auto &arrays) -> Intrusive_ptr<Tensor> {
+            using T = index_type_t<decltype(arrays.indices)>;
+
+            constexpr Data_type index_dt =
+                std::is_same_v<T, std::int32_t> ? Data_type::int32 : Data_type::int64;
+
+            // The rows of the padded instances are empty.
+            arrays.indptr.resize(batch_size_ + 1, arrays.indptr.back());
+
+            auto indices = wrap_cpu_array<index_dt>(std::move(arrays.indices));
+            auto indptr = wrap_cpu_array<index_dt>(std::move(arrays.indptr));
+
+            return make_intrusive<Csr_tensor>(
+                std::move(shape), std::move(data), std::move(indices), std::move(indptr));
+        },
+        index_arrays_);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
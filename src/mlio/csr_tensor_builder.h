@@ -0,0 +1,166 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "mlio/cpu_array.h"
+#include "mlio/data_type.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/schema.h"
+#include "mlio/span.h"
+#include "mlio/sparse_tensor_builder.h"
+#include "mlio/tensor.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+template<typename T>
+struct Csr_index_arrays {
+    std::vector<T> indices{};
+    // The offsets of the rows appended so far, relative to the first
+    // value of the builder, followed by the end of the last row.
+    std::vector<T> indptr{T{}};
+};
+
+// Builds a CSR tensor out of a one-dimensional sparse feature. As
+// opposed to a COO tensor, the keys of a feature are used directly as
+// column indices and each row is represented by a single offset. The
+// indices are stored as int32 if the batch fits, otherwise as int64.
+class Csr_tensor_builder : public Sparse_tensor_builder {
+public:
+    explicit Csr_tensor_builder(const Attribute &attr, std::size_t batch_size);
+
+    Csr_tensor_builder(const Csr_tensor_builder &) = delete;
+
+    Csr_tensor_builder &operator=(const Csr_tensor_builder &) = delete;
+
+    Csr_tensor_builder(Csr_tensor_builder &&) = delete;
+
+    Csr_tensor_builder &operator=(Csr_tensor_builder &&) = delete;
+
+    ~Csr_tensor_builder() override;
+
+    void merge(stdx::span<Sparse_tensor_builder *const> builders) final;
+
+    void reserve(std::size_t num_values) final;
+
+    std::size_t num_values() const noexcept final;
+
+protected:
+    bool append_indices(stdx::span<const std::uint64_t> keys);
+
+    virtual void reserve_data(std::size_t size) = 0;
+
+    virtual void resize_data(std::size_t size) = 0;
+
+    // Copies the values of the specified builder to the specified
+    // offset of this builder's values.
+    virtual void copy_data(const Csr_tensor_builder &other, std::size_t offset) = 0;
+
+    Intrusive_ptr<Tensor> build_core(std::unique_ptr<Device_array> &&data);
+
+private:
+    std::size_t num_rows() const noexcept;
+
+    // Switches to int64 indices.
+    void widen_indices();
+
+    const Attribute *attr_;
+    std::size_t batch_size_;
+    std::size_t num_columns_;
+    std::variant<Csr_index_arrays<std::int32_t>, Csr_index_arrays<std::int64_t>> index_arrays_{};
+};
+
+template<Data_type dt>
+class Csr_tensor_builder_impl final : public Csr_tensor_builder {
+public:
+    using value_type = data_type_t<dt>;
+
+    using Csr_tensor_builder::Csr_tensor_builder;
+
+    bool append(stdx::span<const value_type> values, stdx::span<const std::uint64_t> keys);
+
+    Intrusive_ptr<Tensor> build() final;
+
+private:
+    void reserve_data(std::size_t size) final
+    {
+        data_.reserve(size);
+    }
+
+    void resize_data(std::size_t size) final
+    {
+        data_.resize(size);
+    }
+
+    void copy_data(const Csr_tensor_builder &other, std::size_t offset) final
+    {
+        const auto &data = static_cast<const Csr_tensor_builder_impl &>(other).data_;
+
+        std::copy(data.begin(), data.end(), data_.begin() + as_ssize(offset));
+    }
+
+    std::vector<value_type> data_{};
+};
+
+template<Data_type dt>
+bool Csr_tensor_builder_impl<dt>::append(stdx::span<const value_type> values,
+                                         stdx::span<const std::uint64_t> keys)
+{
+    // Unlike the COO builder we validate the keys before appending
+    // anything; a bad instance therefore leaves the builder intact.
+    if (!append_indices(keys)) {
+        return false;
+    }
+
+    data_.insert(data_.end(), values.begin(), values.end());
+
+    return true;
+}
+
+template<Data_type dt>
+Intrusive_ptr<Tensor> Csr_tensor_builder_impl<dt>::build()
+{
+    auto data = wrap_cpu_array<dt>(std::move(data_));
+
+    return build_core(std::move(data));
+}
+
+template<Data_type dt>
+struct make_csr_tensor_builder_op {
+    std::unique_ptr<Csr_tensor_builder> operator()(const Attribute &attr, std::size_t batch_size)
+    {
+        return std::make_unique<Csr_tensor_builder_impl<dt>>(attr, batch_size);
+    }
+};
+
+inline std::unique_ptr<Csr_tensor_builder>
+make_csr_tensor_builder(const Attribute &attr, std::size_t batch_size)
+{
+    return dispatch<make_csr_tensor_builder_op>(attr.data_type(), attr, batch_size);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -26,11 +26,12 @@
 #include <fmt/format.h>
 #include <tbb/tbb.h>
 
-#include "mlio/cpu_array.h"
 #include "mlio/csv_record_tokenizer.h"
 #include "mlio/data_reader.h"
 #include "mlio/data_reader_error.h"
 #include "mlio/data_stores/data_store.h"
+#include "mlio/detail/utf8.h"
+#include "mlio/device_array.h"
 #include "mlio/example.h"
 #include "mlio/instance.h"
 #include "mlio/instance_batch.h"
@@ -58,6 +59,7 @@ struct Csv_reader::Decoder_state {
     std::vector<Intrusive_ptr<Tensor>> *tensors;
     bool warn_bad_instance;
     bool error_bad_example;
+    bool validate_utf8;
 };
 
 template<typename Col_iter>
@@ -90,33 +92,42 @@ Csv_reader::~Csv_reader()
     stop();
 }
 
-void Csv_reader::reset() noexcept
+Intrusive_ptr<Record_reader> Csv_reader::make_record_reader(const Data_store &store)
 {
-    Parallel_data_reader::reset();
+    // Data stores are not necessarily opened in dataset order (e.g. when
+    // sharded by data store or interleaved); so instead of relying on the
+    // call order we check whether the data store is the first one of the
+    // dataset.
+    const Data_store &first_store = *this->params().dataset.front();
 
-    should_read_header = true;
-}
+    bool has_header = params_.header_row_index &&
+                      (!params_.has_single_header || store.id() == first_store.id());
 
-Intrusive_ptr<Record_reader> Csv_reader::make_record_reader(const Data_store &store)
-{
     auto stream = make_utf8_stream(store.open_read(), params_.encoding);
 
-    auto reader = make_intrusive<Csv_record_reader>(std::move(stream), params_);
+    auto reader = make_intrusive<Csv_record_reader>(std::move(stream), params_, has_header);
 
     if (params_.header_row_index) {
         // Check if the caller did not explicitly specified the column
         // names and requested us to infer them from the header.
         if (column_names_.empty()) {
-            read_names_from_header(store, *reader);
+            if (has_header) {
+                read_names_from_header(store, *reader);
+            }
+            else {
+                auto hdr_stream = make_utf8_stream(first_store.open_read(), params_.encoding);
+
+                auto hdr_reader = make_intrusive<Csv_record_reader>(std::move(hdr_stream), params_);
+
+                read_names_from_header(first_store, *hdr_reader);
+            }
         }
-        else if (should_read_header || !params_.has_single_header) {
+        else if (has_header) {
             skip_to_header_row(*reader);
 
             // Discard the header row.
             reader->read_record();
         }
-
-        should_read_header = false;
     }
 
     return std::move(reader);
@@ -415,7 +426,11 @@ bool Csv_reader::should_skip(std::size_t index, const std::string &name) const n
 
 Intrusive_ptr<Example> Csv_reader::decode(const Instance_batch &batch) const
 {
-    auto tensors = make_tensors(batch.size());
+    // Unless the example can be padded, every good row overwrites all
+    // of its elements; so there is no need to zero-initialize.
+    bool zero_init = batch.instances().size() != batch.size() || pad_bad_examples();
+
+    auto tensors = make_tensors(batch.size(), zero_init);
 
     Decoder_state state{*this, tensors};
 
@@ -427,8 +442,7 @@ Intrusive_ptr<Example> Csv_reader::decode(const Instance_batch &batch) const
         // If bad example handling mode is pad, we cannot parallelize
         // decoding as good records must be stacked together without
         // any gap in between.
-        params().bad_example_handling == Bad_example_handling::pad ||
-        params().bad_example_handling == Bad_example_handling::pad_warn ||
+        pad_bad_examples() ||
         // If the number of values (e.g. integers, floating-points) we
         // need to decode is below the cut-off threshold, avoid parallel
         // execution; otherwise the threading overhead will potentially
@@ -443,25 +457,14 @@ Intrusive_ptr<Example> Csv_reader::decode(const Instance_batch &batch) const
         num_instances_read = decode_prl(state, batch);
     }
 
+    warn_bad_example(batch, num_instances_read);
+
     // Check if we failed to decode the example and return a null
     // pointer if that is the case.
     if (num_instances_read == std::nullopt) {
-        if (params().bad_example_handling == Bad_example_handling::skip_warn) {
-            logger::warn("The example #{0:n} has been skipped as it had at least one bad instance.",
-                         batch.index());
-        }
-
         return nullptr;
     }
 
-    if (num_instances != *num_instances_read) {
-        if (params().bad_example_handling == Bad_example_handling::pad_warn) {
-            logger::warn("The example #{0:n} has been padded as it had {1:n} bad instance(s).",
-                         batch.index(),
-                         num_instances - *num_instances_read);
-        }
-    }
-
     auto example = make_intrusive<Example>(schema(), std::move(tensors));
 
     example->padding = batch.size() - *num_instances_read;
@@ -469,7 +472,8 @@ Intrusive_ptr<Example> Csv_reader::decode(const Instance_batch &batch) const
     return example;
 }
 
-std::vector<Intrusive_ptr<Tensor>> Csv_reader::make_tensors(std::size_t batch_size) const
+std::vector<Intrusive_ptr<Tensor>>
+Csv_reader::make_tensors(std::size_t batch_size, bool zero_init) const
 {
     std::vector<Intrusive_ptr<Tensor>> tensors{};
     tensors.reserve(column_types_.size() - column_ignores_.size());
@@ -493,7 +497,7 @@ std::vector<Intrusive_ptr<Tensor>> Csv_reader::make_tensors(std::size_t batch_si
 
         Data_type dt = std::get<0>(*col_pos);
 
-        std::unique_ptr<Device_array> arr = make_cpu_array(dt, batch_size);
+        std::unique_ptr<Device_array> arr = make_feature_array(dt, batch_size, zero_init);
 
         tensors.emplace_back(make_intrusive<Dense_tensor>(std::move(shape), std::move(arr)));
     }
@@ -543,14 +547,9 @@ Csv_reader::decode_ser(Decoder_state &state, const Instance_batch &batch) const
         else {
             // If the user requested to skip the example in case of an
             // error, shortcut the loop and return immediately.
-            if (params().bad_example_handling == Bad_example_handling::skip ||
-                params().bad_example_handling == Bad_example_handling::skip_warn) {
+            if (skip_bad_example()) {
                 return {};
             }
-            if (params().bad_example_handling != Bad_example_handling::pad &&
-                params().bad_example_handling != Bad_example_handling::pad_warn) {
-                throw std::invalid_argument{"The specified bad example handling is invalid."};
-            }
         }
     }
 
@@ -594,14 +593,11 @@ Csv_reader::decode_prl(Decoder_state &state, const Instance_batch &batch) const
             if (!decoder.decode(std::get<0>(instance_zip), std::get<1>(instance_zip))) {
                 // If we failed to decode the instance, we can terminate
                 // the task right away and skip this example.
-                if (params().bad_example_handling == Bad_example_handling::skip ||
-                    params().bad_example_handling == Bad_example_handling::skip_warn) {
+                if (skip_bad_example()) {
                     skip_example = true;
 
                     return;
                 }
-
-                throw std::invalid_argument{"The specified bad example handling is invalid."};
             }
         }
     };
@@ -621,6 +617,7 @@ Csv_reader::Decoder_state::Decoder_state(const Csv_reader &r,
     , tensors{&t}
     , warn_bad_instance{r.warn_bad_instances()}
     , error_bad_example{r.params().bad_example_handling == Bad_example_handling::error}
+    , validate_utf8{r.params().validate_utf8}
 {}
 
 template<typename Col_iter>
@@ -630,6 +627,29 @@ bool Csv_reader::Decoder<Col_iter>::decode(std::size_t row_idx, const Instance &
 
     auto tsr_pos = state_->tensors->begin();
 
+    if (state_->validate_utf8) {
+        std::optional<std::size_t> offset = detail::find_invalid_utf8(instance.bits());
+        if (offset) {
+            if (state_->warn_bad_instance || state_->error_bad_example) {
+                auto msg = fmt::format(
+                    "The row #{1:n} in the data store '{0}' contains an invalid UTF-8 byte sequence at the byte offset {2:n} of the row.",
+                    instance.data_store().id(),
+                    instance.index(),
+                    *offset);
+
+                if (state_->warn_bad_instance) {
+                    logger::warn(msg);
+                }
+
+                if (state_->error_bad_example) {
+                    throw Invalid_instance_error{msg};
+                }
+            }
+
+            return false;
+        }
+    }
+
     tokenizer_->reset(instance.bits());
 
     while (tokenizer_->next()) {
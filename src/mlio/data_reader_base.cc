@@ -15,6 +15,7 @@
 
 #include "mlio/data_reader_base.h"
 
+#include <stdexcept>
 #include <utility>
 
 #include "mlio/logger.h"
@@ -51,5 +52,40 @@ Data_reader_base::Data_reader_base(Data_reader_params &&params) noexcept
     }
 }
 
+bool Data_reader_base::skip_bad_example() const
+{
+    if (params_.bad_example_handling == Bad_example_handling::skip ||
+        params_.bad_example_handling == Bad_example_handling::skip_warn) {
+        return true;
+    }
+    if (pad_bad_examples()) {
+        return false;
+    }
+    throw std::invalid_argument{"The specified bad example handling is invalid."};
+}
+
+void Data_reader_base::warn_bad_example(const Instance_batch &batch,
+                                        std::optional<std::size_t> num_instances_read) const
+{
+    if (num_instances_read == std::nullopt) {
+        if (params_.bad_example_handling == Bad_example_handling::skip_warn) {
+            logger::warn("The example #{0:n} has been skipped as it had at least one bad instance.",
+                         batch.index());
+        }
+
+        return;
+    }
+
+    std::size_t num_instances = batch.instances().size();
+
+    if (num_instances != *num_instances_read) {
+        if (params_.bad_example_handling == Bad_example_handling::pad_warn) {
+            logger::warn("The example #{0:n} has been padded as it had {1:n} bad instance(s).",
+                         batch.index(),
+                         num_instances - *num_instances_read);
+        }
+    }
+}
+
 }  // namespace abi_v1
 }  // namespace mlio
@@ -15,34 +15,103 @@
 
 #include "mlio/data_stores/compression.h"
 
+#include <memory>
 #include <stdexcept>
 #include <utility>
 
 #include "mlio/not_supported_error.h"
-#include "mlio/streams/gzip_inflate_stream.h"
+
+#include "mlio/streams/detail/bzip2.h"
+#include "mlio/streams/detail/inflate_stream.h"
+#include "mlio/streams/detail/lz4.h"
+#include "mlio/streams/detail/parallel_gzip_inflate_stream.h"
+#include "mlio/streams/detail/parallel_zstd_inflate_stream.h"
+#include "mlio/streams/detail/zip_inflate_stream.h"
 #include "mlio/streams/input_stream.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 
-Intrusive_ptr<Input_stream>
-make_inflate_stream(Intrusive_ptr<Input_stream> &&stream, Compression compression)
+Intrusive_ptr<Input_stream> make_inflate_stream(Intrusive_ptr<Input_stream> &&stream,
+                                                Compression compression,
+                                                Inflate_backend backend)
 {
+    if (!supports_inflate_backend(backend)) {
+        throw Not_supported_error{"The library was not built with the specified inflate backend."};
+    }
+
     switch (compression) {
     case Compression::none:
     case Compression::infer:
         return std::move(stream);
 
     case Compression::gzip:
-        return make_intrusive<Gzip_inflate_stream>(std::move(stream));
+        return make_intrusive<detail::Parallel_gzip_inflate_stream>(std::move(stream), backend);
 
     case Compression::bzip2:
+#ifdef MLIO_BUILD_BZIP2
+        return make_intrusive<detail::Inflate_stream>(std::move(stream),
+                                                      std::make_unique<detail::Bzip2_inflater>());
+#else
+        throw Not_supported_error{"The library was not built with bzip2 support."};
+#endif
+
     case Compression::zip:
-        throw Not_supported_error{"bzip2 and zip compressions are not supported yet."};
+        return make_intrusive<detail::Zip_inflate_stream>(std::move(stream));
+
+    case Compression::zstd:
+#ifdef MLIO_BUILD_ZSTD
+        return make_intrusive<detail::Parallel_zstd_inflate_stream>(std::move(stream));
+#else
+        throw Not_supported_error{"The library was not built with Zstandard support."};
+#endif
+
+    case Compression::lz4:
+#ifdef MLIO_BUILD_LZ4
+        return make_intrusive<detail::Inflate_stream>(std::move(stream),
+                                                      std::make_unique<detail::Lz4_inflater>());
+#else
+        throw Not_supported_error{"The library was not built with LZ4 support."};
+#endif
     }
 
     throw std::invalid_argument{"The specified compression is not supported."};
 }
 
+bool supports_inflate_backend(Inflate_backend backend) noexcept
+{
+    switch (backend) {
+    case Inflate_backend::zlib:
+        return true;
+
+    case Inflate_backend::isal:
+#ifdef MLIO_BUILD_ISAL
+        return true;
+#else
+        return false;
+#endif
+
+    case Inflate_backend::libdeflate:
+#ifdef MLIO_BUILD_LIBDEFLATE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+Inflate_backend default_inflate_backend() noexcept
+{
+#if defined(MLIO_BUILD_LIBDEFLATE)
+    return Inflate_backend::libdeflate;
+#elif defined(MLIO_BUILD_ISAL)
+    return Inflate_backend::isal;
+#else
+    return Inflate_backend::zlib;
+#endif
+}
+
 }  // namespace abi_v1
 }  // namespace mlio
@@ -20,5 +20,10 @@ inline namespace abi_v1 {
 
 Data_store::~Data_store() = default;
 
+std::optional<std::size_t> Data_store::size_hint() const
+{
+    return {};
+}
+
 }  // namespace abi_v1
 }  // namespace mlio
@@ -23,23 +23,27 @@ namespace detail {
 
 Compression infer_compression(std::string_view path) noexcept
 {
-    std::size_t len = path.size();
-
-    if (len > 3 && path[len - 3] == '.') {
-        if (path[len - 2] == 'g' && path[len - 1] == 'z') {
-            return Compression::gzip;
-        }
+    std::size_t pos = path.rfind('.');
+    if (pos == std::string_view::npos || pos == 0) {
         return Compression::none;
     }
 
-    if (len > 4 && path[len - 4] == '.') {
-        if (path[len - 3] == 'b' && path[len - 2] == 'z' && path[len - 1] == '2') {
-            return Compression::bzip2;
-        }
+    std::string_view ext = path.substr(pos + 1);
 
-        if (path[len - 3] == 'z' && path[len - 2] == 'i' && path[len - 1] == 'p') {
-            return Compression::zip;
-        }
+    if (ext == "gz") {
+        return Compression::gzip;
+    }
+    if (ext == "bz2") {
+        return Compression::bzip2;
+    }
+    if (ext == "zip") {
+        return Compression::zip;
+    }
+    if (ext == "zst" || ext == "zstd") {
+        return Compression::zstd;
+    }
+    if (ext == "lz4") {
+        return Compression::lz4;
     }
 
     return Compression::none;
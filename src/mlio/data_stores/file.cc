@@ -15,54 +15,194 @@
 
 #include "mlio/data_stores/file.h"
 
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
 #include <utility>
+#include <vector>
+
+#include <sys/stat.h>
 
 #include <fmt/format.h>
 
 #include "mlio/data_stores/detail/util.h"
+#include "mlio/detail/error.h"
+#include "mlio/detail/io_uring.h"
 #include "mlio/detail/path.h"
 #include "mlio/logger.h"
 #include "mlio/memory/file_mapped_memory_block.h"
+#include "mlio/not_supported_error.h"
+#include "mlio/streams/detail/direct_file_input_stream.h"
+#include "mlio/streams/detail/gzip_index.h"
+#include "mlio/streams/detail/indexed_gzip_inflate_stream.h"
+#include "mlio/streams/detail/io_uring_file_input_stream.h"
+#include "mlio/streams/detail/mapped_file_input_stream.h"
 #include "mlio/streams/file_input_stream.h"
 #include "mlio/streams/input_stream.h"
 #include "mlio/streams/memory_input_stream.h"
 
 namespace mlio {
 inline namespace abi_v1 {
+namespace {
 
-File::File(std::string path, bool memory_map, Compression compression)
-    : path_{std::move(path)}, memory_map_{memory_map}, compression_{compression}
+Intrusive_ptr<Input_stream> make_gzip_inflate_stream(Intrusive_ptr<Input_stream> &&stream,
+                                                     const std::string &path,
+                                                     std::size_t index_interval,
+                                                     Inflate_backend backend)
+{
+    if (!stream->seekable()) {
+        return make_inflate_stream(std::move(stream), Compression::gzip, backend);
+    }
+
+    std::optional<detail::Gzip_index_key> key = detail::make_gzip_index_key(path);
+    if (key == std::nullopt) {
+        return make_inflate_stream(std::move(stream), Compression::gzip, backend);
+    }
+
+    std::string index_path = detail::gzip_index_path(path);
+
+    std::optional<detail::Gzip_index> index = detail::load_gzip_index(index_path, *key);
+    if (index) {
+        return make_intrusive<detail::Indexed_gzip_inflate_stream>(
+            std::move(stream), std::make_shared<const detail::Gzip_index>(std::move(*index)));
+    }
+
+    if (index_interval != 0) {
+        return make_intrusive<detail::Indexed_gzip_inflate_stream>(
+            std::move(stream), index_interval, std::move(index_path), *key);
+    }
+
+    return make_inflate_stream(std::move(stream), Compression::gzip, backend);
+}
+
+}  // namespace
+
+File::File(std::string path, const File_options &opts) : path_{std::move(path)}, opts_{opts}
 {
     detail::validate_file_path(path_);
 
-    if (compression_ == Compression::infer) {
-        compression_ = detail::infer_compression(path_);
+    if (!supports_inflate_backend(opts_.inflate_backend)) {
+        throw Not_supported_error{"The library was not built with the specified inflate backend."};
+    }
+
+    if (opts_.compression == Compression::infer) {
+        opts_.compression = detail::infer_compression(path_);
     }
 }
 
+File::File(std::string path, bool memory_map, Compression compression)
+    : File{std::move(path), File_options{memory_map, compression}}
+{}
+
 Intrusive_ptr<Input_stream> File::open_read() const
 {
     logger::info("The file '{0}' is being opened.", path_);
 
     Intrusive_ptr<Input_stream> stream{};
-    if (memory_map_) {
-        auto block = make_intrusive<File_mapped_memory_block>(path_);
-        stream = make_intrusive<Memory_input_stream>(std::move(block));
+    if (opts_.memory_map) {
+        auto block = make_intrusive<File_mapped_memory_block>(path_, opts_.mmap_options);
+
+        // Windows are only meaningful if the records are read straight
+        // from the mapping.
+        if (opts_.mmap_options.window_size != 0 && opts_.compression == Compression::none) {
+            stream = make_intrusive<detail::Mapped_file_input_stream>(
+                std::move(block), opts_.mmap_options.window_size);
+        }
+        else {
+            stream = make_intrusive<Memory_input_stream>(std::move(block));
+        }
+    }
+    else if (opts_.io_method == File_io_method::io_uring && detail::io_uring_supported()) {
+        stream = make_intrusive<detail::Io_uring_file_input_stream>(path_);
+    }
+    else if (opts_.io_method == File_io_method::direct) {
+        stream = make_intrusive<detail::Direct_file_input_stream>(path_);
     }
     else {
         stream = make_intrusive<File_input_stream>(path_);
     }
 
-    if (compression_ == Compression::none) {
+    if (opts_.compression == Compression::none) {
         return stream;
     }
-    return make_inflate_stream(std::move(stream), compression_);
+
+    // A gzip file might have a random-access index.
+    if (opts_.compression == Compression::gzip) {
+        return make_gzip_inflate_stream(
+            std::move(stream), path_, opts_.gzip_index_interval, opts_.inflate_backend);
+    }
+
+    return make_inflate_stream(std::move(stream), opts_.compression, opts_.inflate_backend);
+}
+
+std::optional<std::size_t> File::size_hint() const
+{
+    struct ::stat buf = {};
+    if (::stat(path_.c_str(), &buf) == -1) {
+        return {};
+    }
+
+    // For compressed files this is the compressed size which is still a
+    // good enough approximation for balancing purposes.
+    return static_cast<std::size_t>(buf.st_size);
 }
 
 std::string File::repr() const
 {
-    return fmt::format(
-        "<File path='{0}' memory_map='{1}' compression='{2}'>", path_, memory_map_, compression_);
+    std::string repr = fmt::format("<File path='{0}' memory_map='{1}' compression='{2}'",
+                                   path_,
+                                   opts_.memory_map,
+                                   opts_.compression);
+
+    // The rest of the options are only shown if they are not set to
+    // their default values.
+    const File_options defaults{};
+
+    if (opts_.io_method != defaults.io_method) {
+        repr += fmt::format(" io_method='{0}'", opts_.io_method);
+    }
+    if (opts_.mmap_options.window_size != defaults.mmap_options.window_size) {
+        repr += fmt::format(" mmap_window_size='{0}'", opts_.mmap_options.window_size);
+    }
+    if (opts_.mmap_options.populate != defaults.mmap_options.populate) {
+        repr += fmt::format(" mmap_populate='{0}'", opts_.mmap_options.populate);
+    }
+    if (opts_.mmap_options.huge_pages != defaults.mmap_options.huge_pages) {
+        repr += fmt::format(" mmap_huge_pages='{0}'", opts_.mmap_options.huge_pages);
+    }
+    if (opts_.gzip_index_interval != defaults.gzip_index_interval) {
+        repr += fmt::format(" gzip_index_interval='{0}'", opts_.gzip_index_interval);
+    }
+    if (opts_.inflate_backend != defaults.inflate_backend) {
+        repr += fmt::format(" inflate_backend='{0}'", opts_.inflate_backend);
+    }
+
+    repr += ">";
+
+    return repr;
+}
+
+void build_gzip_index(const std::string &path, std::size_t interval)
+{
+    if (interval == 0) {
+        throw std::invalid_argument{"The interval must be greater than zero."};
+    }
+
+    detail::validate_file_path(path);
+
+    std::optional<detail::Gzip_index_key> key = detail::make_gzip_index_key(path);
+    if (key == std::nullopt) {
+        throw std::system_error{detail::current_error_code(), "The file cannot be accessed."};
+    }
+
+    auto stream = make_intrusive<detail::Indexed_gzip_inflate_stream>(
+        make_intrusive<File_input_stream>(path), interval, detail::gzip_index_path(path), *key);
+
+    // The index is saved once the end of the file is reached.
+    std::vector<std::byte> buffer(0x10'0000);  // 1 MiB
+    while (stream->read(make_span(buffer)) != 0) {
+    }
 }
 
 }  // namespace abi_v1
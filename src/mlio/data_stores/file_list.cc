@@ -93,6 +93,14 @@ list_files(stdx::span<const std::string> paths, const File_list_options &opts)
 
     std::string pattern{opts.pattern};
 
+    File_options file_opts{};
+    file_opts.memory_map = opts.memory_map;
+    file_opts.compression = opts.compression;
+    file_opts.io_method = opts.io_method;
+    file_opts.mmap_options = opts.mmap_options;
+    file_opts.gzip_index_interval = opts.gzip_index_interval;
+    file_opts.inflate_backend = opts.inflate_backend;
+
     std::vector<Intrusive_ptr<Data_store>> result{};
 
     ::FTSENT *e{};
@@ -131,7 +139,7 @@ list_files(stdx::span<const std::string> paths, const File_list_options &opts)
             }
         }
 
-        auto file = make_intrusive<File>(e->fts_accpath, opts.memory_map, opts.compression);
+        auto file = make_intrusive<File>(e->fts_accpath, file_opts);
 
         result.emplace_back(std::move(file));
     }
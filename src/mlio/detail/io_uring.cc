@@ -0,0 +1,314 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/io_uring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mlio/config.h"
+#include "mlio/detail/error.h"
+#include "mlio/logger.h"
+
+#if defined(MLIO_PLATFORM_LINUX) && defined(__NR_io_uring_setup)
+#define MLIO_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+#ifdef MLIO_HAS_IO_URING
+
+namespace {
+
+template<typename T>
+inline T *ring_field(void *ring, std::uint32_t offset) noexcept
+{
+    return reinterpret_cast<T *>(static_cast<std::byte *>(ring) + offset);
+}
+
+void *map_ring(int fd, std::size_t size, ::off_t offset)
+{
+    void *ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    if (ptr == MAP_FAILED) {
+        throw std::system_error{current_error_code(), "The io_uring ring cannot be mapped."};
+    }
+    return ptr;
+}
+
+}  // namespace
+
+Io_uring::Io_uring(unsigned num_entries)
+{
+    ::io_uring_params params{};
+
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, num_entries, &params));
+    if (fd == -1) {
+        throw std::system_error{current_error_code(), "The io_uring instance cannot be set up."};
+    }
+
+    fd_ = fd;
+
+    try {
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+
+        bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+        single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+        if (single_mmap) {
+            sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+
+        sq_ring_ = map_ring(fd_.get(), sq_ring_size_, IORING_OFF_SQ_RING);
+
+        if (single_mmap) {
+            cq_ring_ = sq_ring_;
+        }
+        else {
+            cq_ring_ = map_ring(fd_.get(), cq_ring_size_, IORING_OFF_CQ_RING);
+        }
+
+        sqes_size_ = params.sq_entries * sizeof(::io_uring_sqe);
+
+        sqes_ = static_cast<::io_uring_sqe *>(map_ring(fd_.get(), sqes_size_, IORING_OFF_SQES));
+    }
+    catch (...) {
+        unmap();
+
+        throw;
+    }
+
+    sq_tail_ = ring_field<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = ring_field<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = ring_field<unsigned>(sq_ring_, params.sq_off.array);
+
+    cq_head_ = ring_field<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = ring_field<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = ring_field<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = ring_field<::io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+}
+
+Io_uring::~Io_uring()
+{
+    unmap();
+}
+
+bool Io_uring::register_buffer(const ::iovec &buffer) noexcept
+{
+    long r = ::syscall(__NR_io_uring_register, fd_.get(), IORING_REGISTER_BUFFERS, &buffer, 1);
+    if (r == -1) {
+        return false;
+    }
+
+    registered_buffer_ = buffer;
+
+    return true;
+}
+
+void Io_uring::queue_read(int fd,
+                          const ::iovec &destination,
+                          std::size_t offset,
+                          std::uint64_t user_data)
+{
+    // The queued entries follow the tail; the kernel does not see them
+    // until submit() moves the tail past them.
+    unsigned tail = *sq_tail_ + num_queued_;
+    unsigned idx = tail & *sq_mask_;
+
+    ::io_uring_sqe &sqe = sqes_[idx];
+
+    std::memset(&sqe, 0, sizeof(sqe));
+
+    sqe.fd = fd;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+
+    auto *first = static_cast<std::byte *>(destination.iov_base);
+
+    bool is_registered = false;
+    if (registered_buffer_) {
+        auto *reg_first = static_cast<std::byte *>(registered_buffer_->iov_base);
+        auto *reg_last = reg_first + registered_buffer_->iov_len;
+
+        is_registered = first >= reg_first && first + destination.iov_len <= reg_last;
+    }
+
+    if (is_registered) {
+        sqe.opcode = IORING_OP_READ_FIXED;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(first);
+        sqe.len = static_cast<std::uint32_t>(destination.iov_len);
+        sqe.buf_index = 0;
+    }
+    else {
+        sqe.opcode = IORING_OP_READV;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(&destination);
+        sqe.len = 1;
+    }
+
+    sq_array_[idx] = idx;
+
+    num_queued_++;
+}
+
+void Io_uring::submit()
+{
+    if (num_queued_ == 0) {
+        return;
+    }
+
+    unsigned tail = *sq_tail_ + num_queued_;
+
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // The kernel might accept fewer entries than it was handed, e.g. if
+    // it is short of memory; the rest stay in the ring.
+    while (num_queued_ > 0) {
+        try {
+            unsigned num_submitted = enter(num_queued_, 0, 0);
+            if (num_submitted == 0) {
+                throw std::system_error{
+                    std::make_error_code(std::errc::resource_unavailable_try_again),
+                    "The io_uring request cannot be submitted."};
+            }
+
+            num_queued_ -= std::min(num_submitted, num_queued_);
+        }
+        catch (const std::system_error &) {
+            // Take back the entries that the kernel has not consumed so
+            // that a later call does not submit them behind our back.
+            __atomic_store_n(sq_tail_, tail - num_queued_, __ATOMIC_RELEASE);
+
+            throw;
+        }
+    }
+}
+
+Io_uring::Completion Io_uring::wait_completion()
+{
+    while (true) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+        if (head != tail) {
+            const ::io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+
+            Completion completion{cqe.user_data, cqe.res};
+
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+            return completion;
+        }
+
+        enter(0, 1, IORING_ENTER_GETEVENTS);
+    }
+}
+
+unsigned Io_uring::enter(unsigned num_submit, unsigned min_complete, unsigned flags)
+{
+    long r{};
+    do {
+        r = ::syscall(
+            __NR_io_uring_enter, fd_.get(), num_submit, min_complete, flags, nullptr, 0);
+    } while (r == -1 && errno == EINTR);
+
+    if (r == -1) {
+        throw std::system_error{current_error_code(), "The io_uring request cannot be submitted."};
+    }
+
+    return static_cast<unsigned>(r);
+}
+
+void Io_uring::unmap() noexcept
+{
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_size_);
+    }
+
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+
+    if (sq_ring_ != nullptr) {
+        ::munmap(sq_ring_, sq_ring_size_);
+    }
+
+    sqes_ = nullptr;
+    cq_ring_ = nullptr;
+    sq_ring_ = nullptr;
+}
+
+bool io_uring_supported() noexcept
+{
+    static const bool supported = [] {
+        try {
+            Io_uring ring{1};
+        }
+        catch (const std::system_error &e) {
+            logger::warn("io_uring is not available ({0}); files will be read using blocking I/O.",
+                         e.code().message());
+
+            return false;
+        }
+        return true;
+    }();
+
+    return supported;
+}
+
+#else
+
+Io_uring::Io_uring(unsigned)
+{
+    throw std::system_error{std::make_error_code(std::errc::function_not_supported),
+                            "io_uring is not supported on this platform."};
+}
+
+Io_uring::~Io_uring() = default;
+
+bool Io_uring::register_buffer(const ::iovec &) noexcept
+{
+    return false;
+}
+
+void Io_uring::queue_read(int, const ::iovec &, std::size_t, std::uint64_t)
+{}
+
+void Io_uring::submit()
+{}
+
+Io_uring::Completion Io_uring::wait_completion()
+{
+    return {};
+}
+
+bool io_uring_supported() noexcept
+{
+    return false;
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
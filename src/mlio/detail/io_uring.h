@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <sys/uio.h>
+
+#include "mlio/detail/file_descriptor.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// A minimal wrapper around a Linux io_uring instance that only supports
+// read requests. It talks to the kernel directly via system calls so
+// that we do not depend on liburing.
+class Io_uring {
+public:
+    struct Completion {
+        std::uint64_t user_data;
+        // The number of bytes read, or a negated errno value.
+        int result;
+    };
+
+    // Throws std::system_error if io_uring is not supported by the
+    // kernel or is blocked (e.g. by a seccomp profile).
+    explicit Io_uring(unsigned num_entries);
+
+    Io_uring(const Io_uring &) = delete;
+
+    Io_uring &operator=(const Io_uring &) = delete;
+
+    Io_uring(Io_uring &&) = delete;
+
+    Io_uring &operator=(Io_uring &&) = delete;
+
+    ~Io_uring();
+
+    // Registers the specified buffer with the kernel so that reads into
+    // it avoid mapping the pages on every request. Returns false if the
+    // kernel refuses it (e.g. because of RLIMIT_MEMLOCK).
+    bool register_buffer(const ::iovec &buffer) noexcept;
+
+    // Queues a read request without handing it to the kernel; see
+    // submit(). The iovec must stay valid until the read completes. If
+    // the buffer has been registered, the read is issued as a
+    // fixed-buffer read.
+    void queue_read(int fd, const ::iovec &destination, std::size_t offset, std::uint64_t user_data);
+
+    // Submits the queued read requests with a single system call. If
+    // the kernel refuses them, throws std::system_error and leaves the
+    // requests it has not accepted in the queue.
+    void submit();
+
+    // Drops the queued read requests.
+    void discard_queued() noexcept
+    {
+        num_queued_ = 0;
+    }
+
+    // Gets the number of read requests that are queued but not yet
+    // submitted.
+    unsigned num_queued() const noexcept
+    {
+        return num_queued_;
+    }
+
+    Completion wait_completion();
+
+private:
+    unsigned enter(unsigned num_submit, unsigned min_complete, unsigned flags);
+
+    void unmap() noexcept;
+
+    File_descriptor fd_{};
+    void *sq_ring_{};
+    std::size_t sq_ring_size_{};
+    void *cq_ring_{};
+    std::size_t cq_ring_size_{};
+    ::io_uring_sqe *sqes_{};
+    std::size_t sqes_size_{};
+    unsigned *sq_tail_{};
+    unsigned *sq_mask_{};
+    unsigned *sq_array_{};
+    unsigned *cq_head_{};
+    unsigned *cq_tail_{};
+    unsigned *cq_mask_{};
+    ::io_uring_cqe *cqes_{};
+    std::optional<::iovec> registered_buffer_{};
+    unsigned num_queued_{};
+};
+
+// Indicates whether io_uring can be used in this process.
+bool io_uring_supported() noexcept;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
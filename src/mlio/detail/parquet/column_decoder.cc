@@ -0,0 +1,676 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/parquet/column_decoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mlio/detail/parquet/snappy.h"
+#include "mlio/not_supported_error.h"
+#include "mlio/record_readers/record_error.h"
+#include "mlio/streams/detail/inflate_backend.h"
+#include "mlio/streams/detail/inflater.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+[[noreturn]] void throw_corrupt_page()
+{
+    throw Corrupt_record_error{"The Parquet file contains an invalid data page."};
+}
+
+// Returns an upper bound of the ratio between the uncompressed and the
+// compressed size of a page. A Snappy copy element expands 3 bytes to
+// at most 64; a Deflate block expands at most 1032-fold.
+inline std::size_t max_compression_ratio(Parquet_codec codec) noexcept
+{
+    if (codec == Parquet_codec::snappy) {
+        return 32;
+    }
+    return 1032;
+}
+
+inline int bit_width(std::uint32_t max_value) noexcept
+{
+    int width = 0;
+    for (; max_value != 0; max_value >>= 1) {
+        width++;
+    }
+    return width;
+}
+
+inline std::uint32_t read_le32(const std::uint8_t *pos) noexcept
+{
+    return static_cast<std::uint32_t>(pos[0]) | static_cast<std::uint32_t>(pos[1]) << 8 |
+           static_cast<std::uint32_t>(pos[2]) << 16 | static_cast<std::uint32_t>(pos[3]) << 24;
+}
+
+// Decodes values encoded with the hybrid RLE/bit-packing encoding that
+// Parquet uses for definition levels and dictionary indices.
+class Rle_decoder {
+public:
+    explicit Rle_decoder(Memory_span data, int bit_width) noexcept
+        : pos_{as_span<const std::uint8_t>(data).data()}
+        , end_{pos_ + data.size()}
+        , bit_width_{bit_width}
+    {}
+
+    void decode(std::uint32_t *out, std::size_t num_values);
+
+private:
+    void next_run();
+
+    const std::uint8_t *pos_;
+    const std::uint8_t *end_;
+    int bit_width_;
+    std::size_t num_repeated_{};
+    std::uint32_t repeated_value_{};
+    std::size_t num_packed_{};
+    const std::uint8_t *packed_{};
+    std::size_t packed_bit_offset_{};
+};
+
+void Rle_decoder::decode(std::uint32_t *out, std::size_t num_values)
+{
+    std::uint32_t mask = bit_width_ == 32 ? ~std::uint32_t{} : (std::uint32_t{1} << bit_width_) - 1;
+
+    auto width = static_cast<std::size_t>(bit_width_);
+
+    while (num_values > 0) {
+        if (num_repeated_ == 0 && num_packed_ == 0) {
+            next_run();
+        }
+
+        if (num_repeated_ > 0) {
+            std::size_t n = std::min(num_repeated_, num_values);
+
+            std::fill_n(out, n, repeated_value_);
+
+            out += n;
+
+            num_values -= n;
+            num_repeated_ -= n;
+
+            continue;
+        }
+
+        std::size_t n = std::min(num_packed_, num_values);
+        for (std::size_t i = 0; i < n; i++) {
+            std::size_t byte = packed_bit_offset_ >> 3;
+            std::size_t shift = packed_bit_offset_ & 7;
+
+            std::uint64_t bits = 0;
+            for (std::size_t j = 0; j < (shift + width + 7) / 8; j++) {
+                bits |= static_cast<std::uint64_t>(packed_[byte + j]) << (8 * j);
+            }
+
+            *out++ = static_cast<std::uint32_t>(bits >> shift) & mask;
+
+            packed_bit_offset_ += width;
+        }
+
+        num_values -= n;
+        num_packed_ -= n;
+    }
+}
+
+void Rle_decoder::next_run()
+{
+    std::uint32_t header = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos_ == end_ || shift > 28) {
+            throw_corrupt_page();
+        }
+
+        std::uint8_t byte = *pos_++;
+
+        header |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    auto count = static_cast<std::size_t>(header >> 1);
+    if (count == 0) {
+        throw_corrupt_page();
+    }
+
+    auto remaining = static_cast<std::size_t>(end_ - pos_);
+
+    auto width = static_cast<std::size_t>(bit_width_);
+
+    if ((header & 1) == 0) {
+        std::size_t num_bytes = (width + 7) / 8;
+        if (remaining < num_bytes) {
+            throw_corrupt_page();
+        }
+
+        repeated_value_ = 0;
+        for (std::size_t i = 0; i < num_bytes; i++) {
+            repeated_value_ |= static_cast<std::uint32_t>(pos_[i]) << (8 * i);
+        }
+
+        pos_ += num_bytes;
+
+        num_repeated_ = count;
+    }
+    else {
+        // The count is the number of groups of eight values. Writers can
+        // omit the padding of the last group at the end of the data.
+        std::size_t num_bytes = std::min(count * width, remaining);
+
+        packed_ = pos_;
+        packed_bit_offset_ = 0;
+
+        pos_ += num_bytes;
+
+        if (width == 0) {
+            num_packed_ = count * 8;
+        }
+        else {
+            num_packed_ = std::min(count * 8, num_bytes * 8 / width);
+        }
+
+        if (num_packed_ == 0) {
+            throw_corrupt_page();
+        }
+    }
+}
+
+template<typename T>
+inline T null_value() noexcept
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+    else {
+        return T{};
+    }
+}
+
+// Decodes the pages of a single column chunk; T is the C++ type of the
+// values of the column.
+template<typename T>
+class Column_chunk_decoder {
+public:
+    explicit Column_chunk_decoder(const Parquet_column &column,
+                                  const Parquet_column_chunk &chunk,
+                                  std::byte *first,
+                                  std::size_t stride,
+                                  std::size_t num_rows) noexcept
+        : column_{&column}, chunk_{&chunk}, first_{first}, stride_{stride}, num_rows_{num_rows}
+    {}
+
+    void decode(Memory_span data);
+
+private:
+    Memory_span uncompress(const Parquet_page_header &header, Memory_span body);
+
+    void decode_dictionary_page(const Parquet_page_header &header, Memory_span body);
+
+    void decode_data_page(const Parquet_page_header &header, Memory_span body);
+
+    Memory_span read_definition_levels(const Parquet_page_header &header,
+                                       Memory_span body,
+                                       std::size_t num_values);
+
+    template<typename Next_value>
+    void write_values(std::size_t num_values, Next_value &&next_value);
+
+    const Parquet_column *column_;
+    const Parquet_column_chunk *chunk_;
+    std::byte *first_;
+    std::size_t stride_;
+    std::size_t num_rows_;
+    std::size_t row_idx_{};
+    std::vector<T> dictionary_{};
+    bool has_dictionary_{};
+    std::vector<std::uint32_t> levels_{};
+    std::vector<std::uint32_t> indices_{};
+    std::vector<std::byte> buffer_{};
+    std::vector<std::byte> page_{};
+};
+
+template<typename T>
+void Column_chunk_decoder<T>::decode(Memory_span data)
+{
+    while (row_idx_ < num_rows_) {
+        if (data.empty()) {
+            throw Corrupt_record_error{"The Parquet file contains a truncated column chunk."};
+        }
+
+        std::size_t header_size{};
+
+        Parquet_page_header header = parse_parquet_page_header(data, header_size);
+
+        data = data.subspan(header_size);
+
+        auto page_size = static_cast<std::size_t>(header.compressed_size);
+        if (page_size > data.size()) {
+            throw Corrupt_record_error{"The Parquet file contains a truncated page."};
+        }
+
+        Memory_span body = data.first(page_size);
+
+        data = data.subspan(page_size);
+
+        switch (header.type) {
+        case Parquet_page_type::dictionary_page:
+            decode_dictionary_page(header, uncompress(header, body));
+            break;
+
+        case Parquet_page_type::data_page:
+            decode_data_page(header, uncompress(header, body));
+            break;
+
+        case Parquet_page_type::data_page_v2: {
+            // The levels of a version 2 page are never compressed.
+            auto levels_size = static_cast<std::size_t>(header.definition_levels_size) +
+                               static_cast<std::size_t>(header.repetition_levels_size);
+            if (levels_size > body.size()) {
+                throw_corrupt_page();
+            }
+
+            if (header.is_compressed && chunk_->codec != Parquet_codec::uncompressed) {
+                auto size = static_cast<std::size_t>(header.uncompressed_size);
+                if (size < levels_size) {
+                    throw_corrupt_page();
+                }
+
+                Parquet_page_header values_header = header;
+                values_header.uncompressed_size = static_cast<std::int32_t>(size - levels_size);
+
+                Memory_span values = uncompress(values_header, body.subspan(levels_size));
+
+                // Reassemble the page; the levels go in front of the
+                // uncompressed values.
+                page_.resize(levels_size + values.size());
+
+                auto levels_end = body.begin() + as_ssize(levels_size);
+
+                auto pos = std::copy(body.begin(), levels_end, page_.begin());
+
+                std::copy(values.begin(), values.end(), pos);
+
+                body = page_;
+            }
+
+            decode_data_page(header, body);
+            break;
+        }
+
+        case Parquet_page_type::index_page:
+            break;
+
+        default:
+            throw_corrupt_page();
+        }
+    }
+}
+
+template<typename T>
+Memory_span Column_chunk_decoder<T>::uncompress(const Parquet_page_header &header, Memory_span body)
+{
+    if (chunk_->codec == Parquet_codec::uncompressed) {
+        return body;
+    }
+
+    auto size = static_cast<std::size_t>(header.uncompressed_size);
+
+    // Make sure that a corrupt header does not make us allocate an
+    // arbitrarily large buffer.
+    if (size > body.size() * max_compression_ratio(chunk_->codec)) {
+        throw_corrupt_page();
+    }
+
+    buffer_.resize(size);
+
+    if (chunk_->codec == Parquet_codec::snappy) {
+        snappy_uncompress(body, buffer_);
+    }
+    else if (chunk_->codec == Parquet_codec::gzip) {
+        std::unique_ptr<Inflater> inflater = make_gzip_inflater(default_inflate_backend());
+
+        Mutable_memory_span out = buffer_;
+        while (!body.empty() && !out.empty()) {
+            inflater->inflate(body, out);
+            if (inflater->eof()) {
+                break;
+            }
+        }
+
+        if (!out.empty()) {
+            throw Corrupt_record_error{"The Parquet file contains an invalid GZIP page."};
+        }
+    }
+    else {
+        throw Not_supported_error{
+            "The Parquet file uses a compression codec that is not supported."};
+    }
+
+    return buffer_;
+}
+
+template<typename T>
+void Column_chunk_decoder<T>::decode_dictionary_page(const Parquet_page_header &header,
+                                                     Memory_span body)
+{
+    if (header.encoding != Parquet_encoding::plain &&
+        header.encoding != Parquet_encoding::plain_dictionary) {
+        throw Not_supported_error{
+            "The Parquet file contains a dictionary page with an unsupported encoding."};
+    }
+
+    auto num_values = static_cast<std::size_t>(header.num_values);
+
+    // Validate the number of values before sizing the dictionary.
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        if (num_values > body.size() * 8) {
+            throw_corrupt_page();
+        }
+    }
+    else {
+        if (num_values > body.size() / sizeof(T)) {
+            throw_corrupt_page();
+        }
+    }
+
+    dictionary_.resize(num_values);
+
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        auto bits = as_span<const std::uint8_t>(body);
+        for (std::size_t i = 0; i < num_values; i++) {
+            dictionary_[i] = static_cast<std::uint8_t>((bits[i >> 3] >> (i & 7)) & 1);
+        }
+    }
+    else {
+        std::memcpy(dictionary_.data(), body.data(), num_values * sizeof(T));
+    }
+
+    has_dictionary_ = true;
+}
+
+template<typename T>
+void Column_chunk_decoder<T>::decode_data_page(const Parquet_page_header &header, Memory_span body)
+{
+    auto num_values = static_cast<std::size_t>(header.num_values);
+    if (num_values > num_rows_ - row_idx_) {
+        throw Corrupt_record_error{
+            "The Parquet file contains a column chunk with more values than rows."};
+    }
+
+    Memory_span values = read_definition_levels(header, body, num_values);
+
+    // Count the number of non-null values in the page.
+    std::size_t num_defined = num_values;
+    if (column_->max_definition_level > 0) {
+        auto max_level = static_cast<std::uint32_t>(column_->max_definition_level);
+
+        num_defined = static_cast<std::size_t>(
+            std::count(levels_.begin(), levels_.begin() + as_ssize(num_values), max_level));
+    }
+
+    if (header.encoding == Parquet_encoding::plain) {
+        if constexpr (std::is_same_v<T, std::uint8_t>) {
+            if ((num_defined + 7) / 8 > values.size()) {
+                throw_corrupt_page();
+            }
+
+            auto bits = as_span<const std::uint8_t>(values).data();
+
+            std::size_t i = 0;
+            write_values(num_values, [bits, &i] {
+                auto value = static_cast<std::uint8_t>((bits[i >> 3] >> (i & 7)) & 1);
+                i++;
+                return value;
+            });
+        }
+        else {
+            if (num_defined > values.size() / sizeof(T)) {
+                throw_corrupt_page();
+            }
+
+            const std::byte *pos = values.data();
+            write_values(num_values, [&pos] {
+                T value;
+                std::memcpy(&value, pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            });
+        }
+    }
+    else if (header.encoding == Parquet_encoding::plain_dictionary ||
+             header.encoding == Parquet_encoding::rle_dictionary) {
+        if (!has_dictionary_) {
+            throw Corrupt_record_error{
+                "The Parquet file contains a dictionary-encoded page without a dictionary."};
+        }
+
+        if (num_defined > 0) {
+            if (values.empty()) {
+                throw_corrupt_page();
+            }
+
+            int width = static_cast<int>(values[0]);
+            if (width > 32) {
+                throw_corrupt_page();
+            }
+
+            indices_.resize(num_defined);
+
+            Rle_decoder decoder{values.subspan(1), width};
+            decoder.decode(indices_.data(), num_defined);
+
+            for (std::uint32_t idx : indices_) {
+                if (idx >= dictionary_.size()) {
+                    throw Corrupt_record_error{
+                        "The Parquet file contains an out-of-range dictionary index."};
+                }
+            }
+        }
+
+        const std::uint32_t *idx = indices_.data();
+        write_values(num_values, [this, &idx] {
+            return dictionary_[*idx++];
+        });
+    }
+    else if (header.encoding == Parquet_encoding::rle && std::is_same_v<T, std::uint8_t>) {
+        // Booleans can be run-length encoded with a bit width of one;
+        // like the levels of a version 1 page, they are prefixed with
+        // their 4-byte length.
+        if (values.size() < sizeof(std::uint32_t)) {
+            throw_corrupt_page();
+        }
+
+        std::size_t size = read_le32(as_span<const std::uint8_t>(values).data());
+        if (size > values.size() - sizeof(std::uint32_t)) {
+            throw_corrupt_page();
+        }
+
+        indices_.resize(num_defined);
+
+        Rle_decoder decoder{values.subspan(sizeof(std::uint32_t), size), 1};
+        decoder.decode(indices_.data(), num_defined);
+
+        const std::uint32_t *value = indices_.data();
+        write_values(num_values, [&value] {
+            return static_cast<T>(*value++);
+        });
+    }
+    else {
+        throw Not_supported_error{"The Parquet file contains a page with an unsupported encoding."};
+    }
+}
+
+template<typename T>
+Memory_span Column_chunk_decoder<T>::read_definition_levels(const Parquet_page_header &header,
+                                                             Memory_span body,
+                                                             std::size_t num_values)
+{
+    if (column_->max_definition_level == 0) {
+        if (header.type == Parquet_page_type::data_page_v2) {
+            return body.subspan(static_cast<std::size_t>(header.definition_levels_size));
+        }
+        return body;
+    }
+
+    Memory_span levels{};
+
+    if (header.type == Parquet_page_type::data_page_v2) {
+        auto size = static_cast<std::size_t>(header.definition_levels_size);
+
+        levels = body.first(size);
+
+        body = body.subspan(size);
+    }
+    else {
+        // Version 1 pages prefix the levels with their 4-byte length.
+        if (body.size() < sizeof(std::uint32_t)) {
+            throw_corrupt_page();
+        }
+
+        std::size_t size = read_le32(as_span<const std::uint8_t>(body).data());
+        if (size > body.size() - sizeof(std::uint32_t)) {
+            throw_corrupt_page();
+        }
+
+        levels = body.subspan(sizeof(std::uint32_t), size);
+
+        body = body.subspan(sizeof(std::uint32_t) + size);
+    }
+
+    levels_.resize(num_values);
+
+    auto max_level = static_cast<std::uint32_t>(column_->max_definition_level);
+
+    Rle_decoder decoder{levels, bit_width(max_level)};
+    decoder.decode(levels_.data(), num_values);
+
+    return body;
+}
+
+template<typename T>
+template<typename Next_value>
+void Column_chunk_decoder<T>::write_values(std::size_t num_values, Next_value &&next_value)
+{
+    std::byte *out = first_ + row_idx_ * stride_;
+
+    if (column_->max_definition_level == 0) {
+        for (std::size_t i = 0; i < num_values; i++, out += stride_) {
+            T value = next_value();
+            std::memcpy(out, &value, sizeof(T));
+        }
+    }
+    else {
+        auto max_level = static_cast<std::uint32_t>(column_->max_definition_level);
+
+        for (std::size_t i = 0; i < num_values; i++, out += stride_) {
+            T value = levels_[i] == max_level ? next_value() : null_value<T>();
+            std::memcpy(out, &value, sizeof(T));
+        }
+    }
+
+    row_idx_ += num_values;
+}
+
+template<typename T>
+void decode_column_chunk(const Parquet_column &column,
+                         const Parquet_column_chunk &chunk,
+                         Memory_span data,
+                         std::byte *first,
+                         std::size_t stride,
+                         std::size_t num_rows)
+{
+    Column_chunk_decoder<T> decoder{column, chunk, first, stride, num_rows};
+
+    decoder.decode(data);
+}
+
+}  // namespace
+
+std::optional<Data_type> parquet_column_data_type(const Parquet_column &column) noexcept
+{
+    // Nested and repeated columns cannot be represented as dense tensors.
+    if (column.max_repetition_level > 0 || column.max_definition_level > 1) {
+        return {};
+    }
+
+    switch (column.type) {
+    case Parquet_type::boolean:
+        return Data_type::uint8;
+    case Parquet_type::int32:
+        return Data_type::int32;
+    case Parquet_type::int64:
+        return Data_type::int64;
+    case Parquet_type::float_:
+        return Data_type::float32;
+    case Parquet_type::double_:
+        return Data_type::float64;
+    case Parquet_type::int96:
+    case Parquet_type::byte_array:
+    case Parquet_type::fixed_len_byte_array:
+        return {};
+    }
+
+    return {};
+}
+
+void decode_parquet_column_chunk(const Parquet_column &column,
+                                 const Parquet_column_chunk &chunk,
+                                 Memory_span data,
+                                 std::byte *first,
+                                 std::size_t stride,
+                                 std::size_t num_rows)
+{
+    if (parquet_column_data_type(column) == std::nullopt) {
+        throw Not_supported_error{"The Parquet column has a type that is not supported."};
+    }
+
+    switch (column.type) {
+    case Parquet_type::boolean:
+        decode_column_chunk<std::uint8_t>(column, chunk, data, first, stride, num_rows);
+        break;
+    case Parquet_type::int32:
+        decode_column_chunk<std::int32_t>(column, chunk, data, first, stride, num_rows);
+        break;
+    case Parquet_type::int64:
+        decode_column_chunk<std::int64_t>(column, chunk, data, first, stride, num_rows);
+        break;
+    case Parquet_type::float_:
+        decode_column_chunk<float>(column, chunk, data, first, stride, num_rows);
+        break;
+    case Parquet_type::double_:
+        decode_column_chunk<double>(column, chunk, data, first, stride, num_rows);
+        break;
+    case Parquet_type::int96:
+    case Parquet_type::byte_array:
+    case Parquet_type::fixed_len_byte_array:
+        break;
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
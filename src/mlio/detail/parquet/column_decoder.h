@@ -0,0 +1,50 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "mlio/data_type.h"
+#include "mlio/detail/parquet/metadata.h"
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Returns the data type of the tensor the specified column is decoded
+// into, or std::nullopt if the column type is not supported.
+std::optional<Data_type> parquet_column_data_type(const Parquet_column &column) noexcept;
+
+// Decodes the pages of a column chunk and writes its values straight to
+// the specified destination; the value of the i'th row is written to
+// first + i * stride. Null values are written as NaN for floating-point
+// columns and as zero for all others.
+//
+// Throws Not_supported_error if the chunk uses a codec, an encoding, or
+// a type that is not supported, and Corrupt_record_error if its data is
+// malformed.
+void decode_parquet_column_chunk(const Parquet_column &column,
+                                 const Parquet_column_chunk &chunk,
+                                 Memory_span data,
+                                 std::byte *first,
+                                 std::size_t stride,
+                                 std::size_t num_rows);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
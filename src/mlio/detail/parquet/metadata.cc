@@ -0,0 +1,485 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/parquet/metadata.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "mlio/detail/parquet/thrift.h"
+#include "mlio/not_supported_error.h"
+#include "mlio/record_readers/record_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// The maximum nesting depth of the schema tree; deeper schemas are
+// treated as corrupt instead of exhausting the stack.
+constexpr std::size_t max_schema_depth = 64;
+
+// Represents a node of the schema tree as stored in the metadata; the
+// tree is flattened in depth-first order.
+struct Schema_element {
+    std::optional<Parquet_type> type{};
+    Parquet_repetition repetition{};
+    std::string name{};
+    std::int32_t num_children{};
+};
+
+struct Column_metadata {
+    Parquet_codec codec{};
+    std::int64_t num_values{};
+    std::int64_t total_compressed_size{};
+    std::int64_t data_page_offset{};
+    std::optional<std::int64_t> dictionary_page_offset{};
+    std::optional<std::int64_t> bloom_filter_offset{};
+    std::int32_t bloom_filter_length{};
+};
+
+template<typename Fn>
+void read_struct(Thrift_compact_reader &reader, Fn &&read_field)
+{
+    reader.begin_struct();
+
+    while (true) {
+        Thrift_compact_reader::Field field = reader.read_field_header();
+        if (field.type == Thrift_type::stop) {
+            break;
+        }
+
+        if (!read_field(field)) {
+            reader.skip(field.type);
+        }
+    }
+
+    reader.end_struct();
+}
+
+template<typename Fn>
+void read_list(Thrift_compact_reader &reader, Fn &&read_element)
+{
+    Thrift_compact_reader::List list = reader.read_list_header();
+    for (std::size_t i = 0; i < list.size; i++) {
+        read_element();
+    }
+}
+
+Schema_element read_schema_element(Thrift_compact_reader &reader)
+{
+    Schema_element element{};
+
+    read_struct(reader, [&reader, &element](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 1:
+            element.type = static_cast<Parquet_type>(reader.read_i32());
+            return true;
+        case 3:
+            element.repetition = static_cast<Parquet_repetition>(reader.read_i32());
+            return true;
+        case 4:
+            element.name = reader.read_string();
+            return true;
+        case 5:
+            element.num_children = reader.read_i32();
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    return element;
+}
+
+Column_metadata read_column_metadata(Thrift_compact_reader &reader)
+{
+    Column_metadata metadata{};
+
+    read_struct(reader, [&reader, &metadata](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 4:
+            metadata.codec = static_cast<Parquet_codec>(reader.read_i32());
+            return true;
+        case 5:
+            metadata.num_values = reader.read_i64();
+            return true;
+        case 7:
+            metadata.total_compressed_size = reader.read_i64();
+            return true;
+        case 9:
+            metadata.data_page_offset = reader.read_i64();
+            return true;
+        case 11:
+            metadata.dictionary_page_offset = reader.read_i64();
+            return true;
+        case 14:
+            metadata.bloom_filter_offset = reader.read_i64();
+            return true;
+        case 15:
+            metadata.bloom_filter_length = reader.read_i32();
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    return metadata;
+}
+
+[[noreturn]] void throw_invalid_column_chunk()
+{
+    throw Corrupt_footer_error{"The Parquet metadata has an invalid column chunk."};
+}
+
+// Returns the end of the section of the file at the specified offset.
+// The offset and the length come from the metadata, so they are checked
+// for negative values and overflow.
+std::int64_t get_section_end(std::int64_t offset, std::int64_t length)
+{
+    if (offset < 0 || length < 0 || offset > std::numeric_limits<std::int64_t>::max() - length) {
+        throw_invalid_column_chunk();
+    }
+    return offset + length;
+}
+
+Parquet_column_chunk read_column_chunk(Thrift_compact_reader &reader)
+{
+    std::optional<Column_metadata> metadata{};
+
+    // The page indexes of the chunk, if any, are stored separately.
+    std::int64_t offset_index_offset{};
+    std::int32_t offset_index_length{};
+    std::int64_t column_index_offset{};
+    std::int32_t column_index_length{};
+
+    read_struct(reader, [&](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 1:
+            throw Not_supported_error{
+                "The Parquet file stores its column chunks in external files."};
+        case 3:
+            metadata = read_column_metadata(reader);
+            return true;
+        case 4:
+            offset_index_offset = reader.read_i64();
+            return true;
+        case 5:
+            offset_index_length = reader.read_i32();
+            return true;
+        case 6:
+            column_index_offset = reader.read_i64();
+            return true;
+        case 7:
+            column_index_length = reader.read_i32();
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    if (metadata == std::nullopt) {
+        throw Corrupt_footer_error{"The Parquet metadata has a column chunk without metadata."};
+    }
+
+    Parquet_column_chunk chunk{};
+    chunk.codec = metadata->codec;
+    chunk.num_values = metadata->num_values;
+    chunk.offset = metadata->data_page_offset;
+    chunk.size = metadata->total_compressed_size;
+
+    // Some writers set the dictionary page offset to zero when there is
+    // no dictionary; it is only meaningful if it precedes the data pages.
+    if (metadata->dictionary_page_offset && *metadata->dictionary_page_offset > 0 &&
+        *metadata->dictionary_page_offset < chunk.offset) {
+        chunk.offset = *metadata->dictionary_page_offset;
+    }
+
+    if (chunk.num_values < 0) {
+        throw_invalid_column_chunk();
+    }
+
+    chunk.end = get_section_end(chunk.offset, chunk.size);
+
+    if (offset_index_length != 0) {
+        chunk.end = std::max(chunk.end, get_section_end(offset_index_offset, offset_index_length));
+    }
+    if (column_index_length != 0) {
+        chunk.end = std::max(chunk.end, get_section_end(column_index_offset, column_index_length));
+    }
+    if (metadata->bloom_filter_offset) {
+        chunk.end = std::max(
+            chunk.end,
+            get_section_end(*metadata->bloom_filter_offset, metadata->bloom_filter_length));
+    }
+
+    return chunk;
+}
+
+Parquet_row_group read_row_group(Thrift_compact_reader &reader)
+{
+    Parquet_row_group row_group{};
+
+    read_struct(reader, [&reader, &row_group](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 1:
+            read_list(reader, [&reader, &row_group] {
+                row_group.columns.emplace_back(read_column_chunk(reader));
+            });
+            return true;
+        case 3:
+            row_group.num_rows = reader.read_i64();
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    if (row_group.num_rows < 0) {
+        throw Corrupt_footer_error{"The Parquet metadata has an invalid row group."};
+    }
+
+    return row_group;
+}
+
+// Walks the schema tree starting at the specified element and appends
+// its leaf columns to the specified list.
+void flatten_schema(const std::vector<Schema_element> &elements,
+                    std::size_t &idx,
+                    const Parquet_column &parent,
+                    std::vector<Parquet_column> &columns,
+                    std::size_t depth = 0)
+{
+    if (depth >= max_schema_depth) {
+        throw Corrupt_footer_error{"The Parquet metadata has a schema that is too deeply nested."};
+    }
+
+    if (idx >= elements.size()) {
+        throw Corrupt_footer_error{"The Parquet metadata has an invalid schema."};
+    }
+
+    const Schema_element &element = elements[idx++];
+
+    Parquet_column column{};
+
+    if (parent.name.empty()) {
+        column.name = element.name;
+    }
+    else {
+        column.name = parent.name + "." + element.name;
+    }
+
+    column.repetition = element.repetition;
+    column.max_definition_level = parent.max_definition_level;
+    column.max_repetition_level = parent.max_repetition_level;
+
+    if (element.repetition != Parquet_repetition::required) {
+        column.max_definition_level++;
+    }
+    if (element.repetition == Parquet_repetition::repeated) {
+        column.max_repetition_level++;
+    }
+
+    if (element.num_children == 0) {
+        if (element.type == std::nullopt) {
+            throw Corrupt_footer_error{"The Parquet metadata has a leaf column without a type."};
+        }
+
+        column.type = *element.type;
+
+        columns.emplace_back(std::move(column));
+
+        return;
+    }
+
+    for (std::int32_t i = 0; i < element.num_children; i++) {
+        flatten_schema(elements, idx, column, columns, depth + 1);
+    }
+}
+
+}  // namespace
+
+std::size_t parse_parquet_footer(Memory_span footer)
+{
+    if (footer.size() != parquet_footer_size) {
+        throw Corrupt_footer_error{"The Parquet file does not have a valid footer."};
+    }
+
+    if (std::memcmp(footer.data() + 4, "PAR1", 4) != 0) {
+        throw Corrupt_footer_error{"The Parquet file does not end with the Parquet magic number."};
+    }
+
+    auto b = as_span<const std::uint8_t>(footer);
+
+    // The metadata length is stored in little-endian.
+    return static_cast<std::size_t>(b[0]) | static_cast<std::size_t>(b[1]) << 8 |
+           static_cast<std::size_t>(b[2]) << 16 | static_cast<std::size_t>(b[3]) << 24;
+}
+
+Parquet_file_metadata parse_parquet_metadata(Memory_span data)
+{
+    Thrift_compact_reader reader{data};
+
+    Parquet_file_metadata metadata{};
+
+    std::vector<Schema_element> elements{};
+
+    read_struct(reader, [&reader, &metadata, &elements](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 2:
+            read_list(reader, [&reader, &elements] {
+                elements.emplace_back(read_schema_element(reader));
+            });
+            return true;
+        case 3:
+            metadata.num_rows = reader.read_i64();
+            return true;
+        case 4:
+            read_list(reader, [&reader, &metadata] {
+                metadata.row_groups.emplace_back(read_row_group(reader));
+            });
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    if (elements.empty()) {
+        throw Corrupt_footer_error{"The Parquet metadata does not have a schema."};
+    }
+
+    // The first element is the root of the schema; its name is not part
+    // of the column paths.
+    Parquet_column root{};
+
+    std::size_t idx = 1;
+    for (std::int32_t i = 0; i < elements[0].num_children; i++) {
+        flatten_schema(elements, idx, root, metadata.columns);
+    }
+
+    // The data starts right after the magic number at the beginning of
+    // the file.
+    metadata.data_end = 4;
+
+    if (metadata.num_rows < 0) {
+        throw Corrupt_footer_error{"The Parquet metadata has an invalid number of rows."};
+    }
+
+    for (const Parquet_row_group &row_group : metadata.row_groups) {
+        if (row_group.columns.size() != metadata.columns.size()) {
+            throw Corrupt_footer_error{
+                "The Parquet metadata has a row group that does not match the schema."};
+        }
+
+        // A row group cannot hold more rows than the file; this bounds
+        // the memory allocated for its decoded rows.
+        if (row_group.num_rows > metadata.num_rows) {
+            throw Corrupt_footer_error{"The Parquet metadata has an invalid row group."};
+        }
+
+        for (const Parquet_column_chunk &chunk : row_group.columns) {
+            metadata.data_end = std::max(metadata.data_end, chunk.end);
+        }
+    }
+
+    return metadata;
+}
+
+Parquet_page_header parse_parquet_page_header(Memory_span data, std::size_t &header_size)
+{
+    Thrift_compact_reader reader{data};
+
+    Parquet_page_header header{};
+
+    auto read_data_page_header = [&reader, &header] {
+        read_struct(reader, [&reader, &header](const Thrift_compact_reader::Field &field) {
+            switch (field.id) {
+            case 1:
+                header.num_values = reader.read_i32();
+                return true;
+            case 2:
+                header.encoding = static_cast<Parquet_encoding>(reader.read_i32());
+                return true;
+            default:
+                return false;
+            }
+        });
+    };
+
+    auto read_data_page_header_v2 = [&reader, &header] {
+        read_struct(reader, [&reader, &header](const Thrift_compact_reader::Field &field) {
+            switch (field.id) {
+            case 1:
+                header.num_values = reader.read_i32();
+                return true;
+            case 4:
+                header.encoding = static_cast<Parquet_encoding>(reader.read_i32());
+                return true;
+            case 5:
+                header.definition_levels_size = reader.read_i32();
+                return true;
+            case 6:
+                header.repetition_levels_size = reader.read_i32();
+                return true;
+            case 7:
+                header.is_compressed = reader.read_bool(field);
+                return true;
+            default:
+                return false;
+            }
+        });
+    };
+
+    read_struct(reader, [&](const Thrift_compact_reader::Field &field) {
+        switch (field.id) {
+        case 1:
+            header.type = static_cast<Parquet_page_type>(reader.read_i32());
+            return true;
+        case 2:
+            header.uncompressed_size = reader.read_i32();
+            return true;
+        case 3:
+            header.compressed_size = reader.read_i32();
+            return true;
+        case 5:
+        case 7:
+            // The dictionary page header has the same layout as the
+            // first two fields of the data page header.
+            read_data_page_header();
+            return true;
+        case 8:
+            read_data_page_header_v2();
+            return true;
+        default:
+            return false;
+        }
+    });
+
+    if (header.uncompressed_size < 0 || header.compressed_size < 0 || header.num_values < 0 ||
+        header.definition_levels_size < 0 || header.repetition_levels_size < 0) {
+        throw Corrupt_record_error{"The Parquet file has an invalid page header."};
+    }
+
+    header_size = reader.position();
+
+    return header;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
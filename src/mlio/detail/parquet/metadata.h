@@ -0,0 +1,141 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// The enumerations below mirror the ones defined in parquet.thrift; see
+// https://github.com/apache/parquet-format/blob/master/src/main/thrift/parquet.thrift.
+
+enum class Parquet_type : std::int32_t {
+    boolean = 0,
+    int32 = 1,
+    int64 = 2,
+    int96 = 3,
+    float_ = 4,
+    double_ = 5,
+    byte_array = 6,
+    fixed_len_byte_array = 7
+};
+
+enum class Parquet_repetition : std::int32_t { required = 0, optional = 1, repeated = 2 };
+
+enum class Parquet_codec : std::int32_t {
+    uncompressed = 0,
+    snappy = 1,
+    gzip = 2,
+    lzo = 3,
+    brotli = 4,
+    lz4 = 5,
+    zstd = 6,
+    lz4_raw = 7
+};
+
+enum class Parquet_encoding : std::int32_t {
+    plain = 0,
+    plain_dictionary = 2,
+    rle = 3,
+    bit_packed = 4,
+    delta_binary_packed = 5,
+    delta_length_byte_array = 6,
+    delta_byte_array = 7,
+    rle_dictionary = 8,
+    byte_stream_split = 9
+};
+
+enum class Parquet_page_type : std::int32_t {
+    data_page = 0,
+    index_page = 1,
+    dictionary_page = 2,
+    data_page_v2 = 3
+};
+
+// Describes a leaf column of a Parquet schema.
+struct Parquet_column {
+    // The dot-separated path of the column.
+    std::string name{};
+    Parquet_type type{};
+    Parquet_repetition repetition{};
+    std::int32_t max_definition_level{};
+    std::int32_t max_repetition_level{};
+};
+
+struct Parquet_column_chunk {
+    Parquet_codec codec{};
+    std::int64_t num_values{};
+    // The file offset of the first page of the chunk, which is the
+    // dictionary page if the chunk has one.
+    std::int64_t offset{};
+    std::int64_t size{};
+    // The file offset right past the last byte that belongs to the
+    // chunk, including its page indexes and bloom filter if any.
+    std::int64_t end{};
+};
+
+struct Parquet_row_group {
+    std::vector<Parquet_column_chunk> columns{};
+    std::int64_t num_rows{};
+};
+
+struct Parquet_file_metadata {
+    std::vector<Parquet_column> columns{};
+    std::vector<Parquet_row_group> row_groups{};
+    std::int64_t num_rows{};
+    // The file offset right past the last byte referenced by the
+    // metadata. Writers place the metadata right after it.
+    std::int64_t data_end{};
+};
+
+struct Parquet_page_header {
+    Parquet_page_type type{};
+    std::int32_t uncompressed_size{};
+    std::int32_t compressed_size{};
+    std::int32_t num_values{};
+    Parquet_encoding encoding{};
+    // Only set for version 2 data pages, which store their definition
+    // and repetition levels uncompressed in front of the values.
+    std::int32_t definition_levels_size{};
+    std::int32_t repetition_levels_size{};
+    bool is_compressed = true;
+};
+
+// The size of the footer that trails the metadata: a 4-byte metadata
+// length followed by the "PAR1" magic number.
+constexpr std::size_t parquet_footer_size = 8;
+
+// Parses the footer of a Parquet file and returns the size of the
+// metadata that precedes it. Throws Corrupt_footer_error if the footer
+// is malformed.
+std::size_t parse_parquet_footer(Memory_span footer);
+
+Parquet_file_metadata parse_parquet_metadata(Memory_span data);
+
+// Parses the page header at the beginning of the specified data and
+// stores its size in header_size.
+Parquet_page_header parse_parquet_page_header(Memory_span data, std::size_t &header_size);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
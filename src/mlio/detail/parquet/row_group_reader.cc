@@ -0,0 +1,311 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/parquet/row_group_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#include <tbb/tbb.h>
+
+#include "mlio/detail/parquet/column_decoder.h"
+#include "mlio/memory/memory_allocator.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/not_supported_error.h"
+#include "mlio/record_readers/record_error.h"
+#include "mlio/streams/memory_input_stream.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+Memory_slice read_range(Input_stream &stream, std::size_t offset, std::size_t size)
+{
+    stream.seek(offset);
+
+    if (stream.supports_zero_copy()) {
+        Memory_slice range = stream.read(size);
+        if (range.size() != size) {
+            throw Corrupt_record_error{"The Parquet file is truncated."};
+        }
+        return range;
+    }
+
+    auto block = memory_allocator().allocate(size);
+
+    Mutable_memory_span remaining = *block;
+    while (!remaining.empty()) {
+        std::size_t num_bytes_read = stream.read(remaining);
+        if (num_bytes_read == 0) {
+            throw Corrupt_record_error{"The Parquet file is truncated."};
+        }
+
+        remaining = remaining.subspan(num_bytes_read);
+    }
+
+    return Memory_slice{std::move(block)};
+}
+
+Memory_slice read_to_end(Input_stream &stream)
+{
+    constexpr std::size_t chunk_size = 0x10'0000;  // 1 MiB
+
+    std::vector<Memory_slice> chunks{};
+
+    std::size_t size = 0;
+    while (true) {
+        Memory_slice chunk = stream.read(chunk_size);
+        if (chunk.empty()) {
+            break;
+        }
+
+        size += chunk.size();
+
+        chunks.emplace_back(std::move(chunk));
+    }
+
+    auto block = memory_allocator().allocate(size);
+
+    auto pos = block->begin();
+    for (const Memory_slice &chunk : chunks) {
+        pos = std::copy(chunk.begin(), chunk.end(), pos);
+    }
+
+    return Memory_slice{std::move(block)};
+}
+
+}  // namespace
+
+Parquet_file_metadata read_parquet_metadata(Intrusive_ptr<Input_stream> &stream)
+{
+    // See https://github.com/apache/parquet-format for the layout of a
+    // Parquet file. The metadata precedes the footer at the end of the
+    // file; if we cannot seek, we have no choice but to read the whole
+    // file to get to it.
+    if (!stream->seekable()) {
+        stream = make_intrusive<Memory_input_stream>(read_to_end(*stream));
+    }
+
+    std::size_t file_size = stream->size();
+    if (file_size < 4 + parquet_footer_size) {
+        throw Corrupt_footer_error{"The Parquet file does not have a valid footer."};
+    }
+
+    Memory_slice footer = read_range(*stream, file_size - parquet_footer_size, parquet_footer_size);
+
+    std::size_t metadata_size = parse_parquet_footer(footer);
+    if (metadata_size > file_size - 4 - parquet_footer_size) {
+        throw Corrupt_footer_error{"The Parquet file has an invalid metadata length."};
+    }
+
+    Memory_slice metadata = read_range(
+        *stream, file_size - parquet_footer_size - metadata_size, metadata_size);
+
+    return parse_parquet_metadata(metadata);
+}
+
+std::optional<std::vector<std::size_t>> find_parquet_file_ends(Input_stream &stream)
+{
+    constexpr std::size_t min_file_size = 4 + parquet_footer_size;
+
+    std::size_t start = stream.position();
+
+    std::vector<std::size_t> file_ends{};
+
+    // Each footer tells us where the metadata of its file begins, and the
+    // metadata tells us how many bytes of data precede it; together they
+    // give us the beginning of the file, which is where the previous file
+    // ends.
+    std::size_t file_end = stream.size();
+    while (file_end > start) {
+        if (file_end - start < min_file_size) {
+            return {};
+        }
+
+        try {
+            Memory_slice footer =
+                read_range(stream, file_end - parquet_footer_size, parquet_footer_size);
+
+            std::size_t metadata_size = parse_parquet_footer(footer);
+            if (metadata_size > file_end - start - min_file_size) {
+                return {};
+            }
+
+            std::size_t metadata_offset = file_end - parquet_footer_size - metadata_size;
+
+            Memory_slice metadata = read_range(stream, metadata_offset, metadata_size);
+
+            auto data_end = as_size(parse_parquet_metadata(metadata).data_end);
+            if (data_end > metadata_offset - start) {
+                return {};
+            }
+
+            std::size_t file_begin = metadata_offset - data_end;
+
+            // If a writer left a gap between the data and the metadata, we
+            // end up at a wrong offset; the magic number guards us against
+            // that.
+            Memory_slice magic_number = read_range(stream, file_begin, 4);
+            if (std::memcmp(magic_number.data(), "PAR1", 4) != 0) {
+                return {};
+            }
+
+            file_ends.emplace_back(file_end);
+
+            file_end = file_begin;
+        }
+        catch (const Corrupt_record_error &) {
+            return {};
+        }
+        catch (const Not_supported_error &) {
+            return {};
+        }
+    }
+
+    std::reverse(file_ends.begin(), file_ends.end());
+
+    return file_ends;
+}
+
+Parquet_row_group_reader::Parquet_row_group_reader(Intrusive_ptr<Input_stream> stream,
+                                                   Parquet_file_metadata metadata,
+                                                   Parquet_row_layout layout,
+                                                   std::vector<std::size_t> row_groups)
+    : stream_{std::move(stream)}
+    , metadata_{std::move(metadata)}
+    , layout_{std::move(layout)}
+    , row_groups_{std::move(row_groups)}
+    , max_batch_length_{std::max(std::thread::hardware_concurrency(), 1U)}
+{}
+
+Parquet_row_group_reader::~Parquet_row_group_reader() = default;
+
+std::optional<Record> Parquet_row_group_reader::read_record_core()
+{
+    while (row_idx_ == num_rows_) {
+        if (!read_next_row_group()) {
+            return {};
+        }
+    }
+
+    Memory_slice payload =
+        Memory_slice{block_}.subslice(row_idx_ * layout_.stride, layout_.stride);
+
+    row_idx_++;
+
+    return Record{std::move(payload)};
+}
+
+bool Parquet_row_group_reader::read_next_row_group()
+{
+    if (decoded_.empty()) {
+        decode_next_row_groups();
+    }
+
+    if (decoded_.empty()) {
+        block_ = {};
+
+        num_rows_ = 0;
+        row_idx_ = 0;
+
+        return false;
+    }
+
+    block_ = std::move(decoded_.front().block);
+
+    num_rows_ = decoded_.front().num_rows;
+    row_idx_ = 0;
+
+    decoded_.pop_front();
+
+    return true;
+}
+
+void Parquet_row_group_reader::decode_next_row_groups()
+{
+    std::vector<const Parquet_row_group *> batch{};
+
+    std::size_t batch_size = 0;
+
+    // Read the column chunks of as many row groups as we can decode in
+    // parallel while staying within our memory budget. A row group is
+    // always read though, regardless of its size.
+    while (next_row_group_ < row_groups_.size() && batch.size() < max_batch_length_) {
+        if (!batch.empty() && batch_size >= max_batch_size_) {
+            break;
+        }
+
+        const Parquet_row_group &rg = metadata_.row_groups[row_groups_[next_row_group_++]];
+        if (rg.num_rows == 0) {
+            continue;
+        }
+
+        auto num_rows = static_cast<std::size_t>(rg.num_rows);
+        if (layout_.stride != 0 &&
+            num_rows > std::numeric_limits<std::size_t>::max() / layout_.stride) {
+            throw Corrupt_record_error{"The Parquet file has a row group that is too large."};
+        }
+
+        Row_group_block &decoded = decoded_.emplace_back();
+
+        decoded.num_rows = num_rows;
+
+        decoded.block = memory_allocator().allocate(num_rows * layout_.stride);
+
+        batch_size += decoded.block->size();
+
+        for (const Parquet_row_layout::Column &column : layout_.columns) {
+            const Parquet_column_chunk &chunk = rg.columns[column.index];
+
+            decoded.chunks.emplace_back(read_range(*stream_,
+                                                   static_cast<std::size_t>(chunk.offset),
+                                                   static_cast<std::size_t>(chunk.size)));
+
+            batch_size += decoded.chunks.back().size();
+        }
+
+        batch.emplace_back(&rg);
+    }
+
+    // The columns of a row group are decoded sequentially as their
+    // values are interleaved in the same cache lines; the parallelism
+    // comes from decoding several row groups at once.
+    tbb::parallel_for(std::size_t{}, batch.size(), [this, &batch](std::size_t i) {
+        Row_group_block &decoded = decoded_[i];
+
+        for (std::size_t j = 0; j < layout_.columns.size(); j++) {
+            const Parquet_row_layout::Column &column = layout_.columns[j];
+
+            decode_parquet_column_chunk(metadata_.columns[column.index],
+                                        batch[i]->columns[column.index],
+                                        decoded.chunks[j],
+                                        decoded.block->data() + column.offset,
+                                        layout_.stride,
+                                        decoded.num_rows);
+        }
+
+        // We no longer need the raw bytes.
+        decoded.chunks = {};
+    });
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "mlio/detail/parquet/metadata.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/record_readers/record.h"
+#include "mlio/record_readers/record_reader_base.h"
+#include "mlio/streams/input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Describes how the projected columns of a Parquet file are laid out in
+// the records returned by Parquet_row_group_reader.
+struct Parquet_row_layout {
+    struct Column {
+        // The index of the column in the schema of the file.
+        std::size_t index{};
+        // The offset of the value within a row.
+        std::size_t offset{};
+    };
+
+    std::vector<Column> columns{};
+    // The size of a row.
+    std::size_t stride{};
+};
+
+// Reads the metadata stored in the footer of a Parquet file. If the
+// stream is not seekable, it is read into memory and replaced with an
+// in-memory stream.
+Parquet_file_metadata read_parquet_metadata(Intrusive_ptr<Input_stream> &stream);
+
+// Walks backwards through the footers of the Parquet files stored
+// back-to-back in a seekable stream, starting at its current position,
+// and returns the offsets at which the files end in increasing order.
+// Returns std::nullopt if the files cannot be framed this way, e.g.
+// because a writer left a gap between the data and the metadata. The
+// position of the stream is left unspecified.
+std::optional<std::vector<std::size_t>> find_parquet_file_ends(Input_stream &stream);
+
+// Decodes the row groups of a Parquet file into row-major blocks and
+// returns each row as a separate record. Once the decoded row groups are
+// exhausted, the next batch of row groups is read and decoded in
+// parallel, one row group per task.
+class Parquet_row_group_reader final : public Record_reader_base {
+    struct Row_group_block {
+        Intrusive_ptr<Mutable_memory_block> block{};
+        std::size_t num_rows{};
+        // The raw bytes of the projected column chunks.
+        std::vector<Memory_slice> chunks{};
+    };
+
+public:
+    // The row_groups argument specifies the indices of the row groups
+    // to read.
+    explicit Parquet_row_group_reader(Intrusive_ptr<Input_stream> stream,
+                                      Parquet_file_metadata metadata,
+                                      Parquet_row_layout layout,
+                                      std::vector<std::size_t> row_groups);
+
+    Parquet_row_group_reader(const Parquet_row_group_reader &) = delete;
+
+    Parquet_row_group_reader &operator=(const Parquet_row_group_reader &) = delete;
+
+    Parquet_row_group_reader(Parquet_row_group_reader &&) = delete;
+
+    Parquet_row_group_reader &operator=(Parquet_row_group_reader &&) = delete;
+
+    ~Parquet_row_group_reader() final;
+
+    std::optional<Record> read_record_core() final;
+
+private:
+    bool read_next_row_group();
+
+    void decode_next_row_groups();
+
+    // The maximum number of bytes read and decoded in a single batch
+    // unless a single row group is larger.
+    static constexpr std::size_t max_batch_size_ = 0x1000'0000;  // 256 MiB
+
+    Intrusive_ptr<Input_stream> stream_;
+    Parquet_file_metadata metadata_;
+    Parquet_row_layout layout_;
+    std::vector<std::size_t> row_groups_;
+    std::size_t next_row_group_{};
+    std::size_t max_batch_length_{};
+    std::deque<Row_group_block> decoded_{};
+    Intrusive_ptr<Mutable_memory_block> block_{};
+    std::size_t num_rows_{};
+    std::size_t row_idx_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
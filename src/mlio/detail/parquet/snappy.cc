@@ -0,0 +1,164 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/parquet/snappy.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "mlio/record_readers/record_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+[[noreturn]] void throw_corrupt_block()
+{
+    throw Corrupt_record_error{"The Parquet file contains an invalid Snappy block."};
+}
+
+}  // namespace
+
+void snappy_uncompress(Memory_span source, Mutable_memory_span destination)
+{
+    auto src = as_span<const std::uint8_t>(source);
+    auto dst = as_span<std::uint8_t>(destination);
+
+    std::size_t s = 0;
+    std::size_t d = 0;
+
+    // The block starts with the uncompressed length as a varint.
+    std::uint64_t length = 0;
+    for (int shift = 0;; shift += 7) {
+        if (s == src.size() || shift > 28) {
+            throw_corrupt_block();
+        }
+
+        std::uint8_t byte = src[s++];
+
+        length |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    if (length != dst.size()) {
+        throw_corrupt_block();
+    }
+
+    while (s < src.size()) {
+        std::uint8_t tag = src[s++];
+
+        std::size_t size{};
+        std::size_t offset{};
+
+        switch (tag & 0x03) {
+        case 0: {
+            // Literal
+            size = static_cast<std::size_t>(tag >> 2);
+            if (size >= 60) {
+                std::size_t num_bytes = size - 59;
+                if (src.size() - s < num_bytes) {
+                    throw_corrupt_block();
+                }
+
+                size = 0;
+                for (std::size_t i = 0; i < num_bytes; i++) {
+                    size |= static_cast<std::size_t>(src[s++]) << (8 * i);
+                }
+            }
+            size++;
+
+            if (src.size() - s < size || dst.size() - d < size) {
+                throw_corrupt_block();
+            }
+
+            std::memcpy(dst.data() + d, src.data() + s, size);
+
+            s += size;
+            d += size;
+
+            continue;
+        }
+
+        case 1:
+            // Copy with a 1-byte offset
+            if (s == src.size()) {
+                throw_corrupt_block();
+            }
+
+            size = static_cast<std::size_t>((tag >> 2) & 0x07) + 4;
+            offset = static_cast<std::size_t>(tag >> 5) << 8 | src[s++];
+            break;
+
+        case 2:
+            // Copy with a 2-byte offset
+            if (src.size() - s < 2) {
+                throw_corrupt_block();
+            }
+
+            size = static_cast<std::size_t>(tag >> 2) + 1;
+            offset = static_cast<std::size_t>(src[s]) | static_cast<std::size_t>(src[s + 1]) << 8;
+
+            s += 2;
+            break;
+
+        default:
+            // Copy with a 4-byte offset
+            if (src.size() - s < 4) {
+                throw_corrupt_block();
+            }
+
+            size = static_cast<std::size_t>(tag >> 2) + 1;
+            offset = static_cast<std::size_t>(src[s]) | static_cast<std::size_t>(src[s + 1]) << 8 |
+                     static_cast<std::size_t>(src[s + 2]) << 16 |
+                     static_cast<std::size_t>(src[s + 3]) << 24;
+
+            s += 4;
+            break;
+        }
+
+        if (offset == 0 || offset > d || dst.size() - d < size) {
+            throw_corrupt_block();
+        }
+
+        std::uint8_t *out = dst.data() + d;
+
+        const std::uint8_t *from = out - offset;
+
+        // The source and the destination can overlap, in which case the
+        // copy repeats the last offset bytes; it must be done bytewise.
+        if (offset >= size) {
+            std::memcpy(out, from, size);
+        }
+        else {
+            for (std::size_t i = 0; i < size; i++) {
+                out[i] = from[i];
+            }
+        }
+
+        d += size;
+    }
+
+    if (d != dst.size()) {
+        throw_corrupt_block();
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
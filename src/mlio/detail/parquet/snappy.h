@@ -0,0 +1,33 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Decompresses a raw Snappy block (i.e. without the framing format) into
+// the specified destination, which must be exactly as large as the
+// uncompressed data. Throws Corrupt_record_error if the block is
+// malformed. See
+// https://github.com/google/snappy/blob/master/format_description.txt.
+void snappy_uncompress(Memory_span source, Mutable_memory_span destination);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
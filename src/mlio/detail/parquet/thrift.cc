@@ -0,0 +1,238 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/parquet/thrift.h"
+
+#include "mlio/record_readers/record_error.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+inline std::int64_t zigzag_decode(std::uint64_t value) noexcept
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+}  // namespace
+
+void Thrift_compact_reader::begin_struct() noexcept
+{
+    // Structs nested deeper than our stack are malformed in practice;
+    // we simply stop tracking the ids in such case.
+    if (depth_ < sizeof(field_id_stack_) / sizeof(std::int16_t)) {
+        field_id_stack_[depth_] = last_field_id_;
+    }
+
+    depth_++;
+
+    last_field_id_ = 0;
+}
+
+void Thrift_compact_reader::end_struct() noexcept
+{
+    depth_--;
+
+    if (depth_ < sizeof(field_id_stack_) / sizeof(std::int16_t)) {
+        last_field_id_ = field_id_stack_[depth_];
+    }
+}
+
+Thrift_compact_reader::Field Thrift_compact_reader::read_field_header()
+{
+    std::uint8_t header = read_byte();
+
+    auto type = static_cast<Thrift_type>(header & 0x0f);
+    if (type == Thrift_type::stop) {
+        return Field{type, 0};
+    }
+
+    auto delta = static_cast<std::int16_t>(header >> 4);
+    if (delta != 0) {
+        last_field_id_ = static_cast<std::int16_t>(last_field_id_ + delta);
+    }
+    else {
+        last_field_id_ = static_cast<std::int16_t>(zigzag_decode(read_varint()));
+    }
+
+    return Field{type, last_field_id_};
+}
+
+Thrift_compact_reader::List Thrift_compact_reader::read_list_header()
+{
+    std::uint8_t header = read_byte();
+
+    auto type = static_cast<Thrift_type>(header & 0x0f);
+
+    std::size_t size = header >> 4;
+    if (size == 0x0f) {
+        size = read_varint();
+    }
+
+    // Each element takes at least one byte; this check protects us from
+    // huge allocations caused by corrupt sizes.
+    if (size > data_.size() - pos_) {
+        throw Corrupt_record_error{"The Parquet metadata contains an invalid list size."};
+    }
+
+    return List{type, size};
+}
+
+bool Thrift_compact_reader::read_bool()
+{
+    return read_byte() == 1;
+}
+
+std::int32_t Thrift_compact_reader::read_i32()
+{
+    return static_cast<std::int32_t>(zigzag_decode(read_varint()));
+}
+
+std::int64_t Thrift_compact_reader::read_i64()
+{
+    return zigzag_decode(read_varint());
+}
+
+std::string Thrift_compact_reader::read_string()
+{
+    auto size = read_varint();
+    if (size > data_.size() - pos_) {
+        throw Corrupt_record_error{"The Parquet metadata is truncated."};
+    }
+
+    auto first = data_.begin() + as_ssize(pos_);
+
+    pos_ += size;
+
+    return std::string{reinterpret_cast<const char *>(&*first), size};
+}
+
+void Thrift_compact_reader::skip(Thrift_type type, std::size_t depth)
+{
+    if (depth > max_skip_depth_) {
+        throw Corrupt_record_error{"The Parquet metadata contains too deeply nested values."};
+    }
+
+    switch (type) {
+    case Thrift_type::boolean_true:
+    case Thrift_type::boolean_false:
+        return;
+
+    case Thrift_type::byte:
+        read_byte();
+        return;
+
+    case Thrift_type::i16:
+    case Thrift_type::i32:
+    case Thrift_type::i64:
+        read_varint();
+        return;
+
+    case Thrift_type::dbl:
+        for (int i = 0; i < 8; i++) {
+            read_byte();
+        }
+        return;
+
+    case Thrift_type::binary:
+        read_string();
+        return;
+
+    case Thrift_type::list:
+    case Thrift_type::set: {
+        List list = read_list_header();
+        for (std::size_t i = 0; i < list.size; i++) {
+            // Booleans in lists are encoded as a full byte.
+            if (list.element_type == Thrift_type::boolean_true ||
+                list.element_type == Thrift_type::boolean_false) {
+                read_byte();
+            }
+            else {
+                skip(list.element_type, depth + 1);
+            }
+        }
+        return;
+    }
+
+    case Thrift_type::map: {
+        auto size = read_varint();
+        if (size == 0) {
+            return;
+        }
+
+        std::uint8_t types = read_byte();
+
+        auto key_type = static_cast<Thrift_type>(types >> 4);
+        auto value_type = static_cast<Thrift_type>(types & 0x0f);
+
+        for (std::size_t i = 0; i < size; i++) {
+            skip(key_type, depth + 1);
+            skip(value_type, depth + 1);
+        }
+        return;
+    }
+
+    case Thrift_type::strct: {
+        begin_struct();
+
+        while (true) {
+            Field field = read_field_header();
+            if (field.type == Thrift_type::stop) {
+                break;
+            }
+            skip(field.type, depth + 1);
+        }
+
+        end_struct();
+        return;
+    }
+
+    case Thrift_type::stop:
+        break;
+    }
+
+    throw Corrupt_record_error{"The Parquet metadata contains an invalid Thrift type."};
+}
+
+std::uint64_t Thrift_compact_reader::read_varint()
+{
+    std::uint64_t value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        std::uint8_t byte = read_byte();
+
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    throw Corrupt_record_error{"The Parquet metadata contains an invalid variable-length integer."};
+}
+
+std::uint8_t Thrift_compact_reader::read_byte()
+{
+    if (pos_ == data_.size()) {
+        throw Corrupt_record_error{"The Parquet metadata is truncated."};
+    }
+
+    return static_cast<std::uint8_t>(data_[pos_++]);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Specifies the field types of the Thrift Compact protocol.
+enum class Thrift_type : std::uint8_t {
+    stop = 0,
+    boolean_true = 1,
+    boolean_false = 2,
+    byte = 3,
+    i16 = 4,
+    i32 = 5,
+    i64 = 6,
+    dbl = 7,
+    binary = 8,
+    list = 9,
+    set = 10,
+    map = 11,
+    strct = 12
+};
+
+// Reads values encoded with the Thrift Compact protocol, which is used
+// by Parquet to serialize its metadata. See
+// https://github.com/apache/thrift/blob/master/doc/specs/thrift-compact-protocol.md.
+//
+// The reader throws Corrupt_record_error if the data is truncated or
+// malformed.
+class Thrift_compact_reader {
+public:
+    struct Field {
+        Thrift_type type;
+        std::int16_t id;
+    };
+
+    struct List {
+        Thrift_type element_type;
+        std::size_t size;
+    };
+
+    explicit Thrift_compact_reader(Memory_span data) noexcept : data_{data}
+    {}
+
+    // Must be called before reading the fields of a struct.
+    void begin_struct() noexcept;
+
+    // Must be called after reading the stop field of a struct.
+    void end_struct() noexcept;
+
+    Field read_field_header();
+
+    List read_list_header();
+
+    bool read_bool(const Field &field) const noexcept
+    {
+        return field.type == Thrift_type::boolean_true;
+    }
+
+    // Reads a boolean element of a list.
+    bool read_bool();
+
+    std::int32_t read_i32();
+
+    std::int64_t read_i64();
+
+    std::string read_string();
+
+    void skip(Thrift_type type)
+    {
+        skip(type, 0);
+    }
+
+    // Gets the number of bytes consumed so far.
+    std::size_t position() const noexcept
+    {
+        return pos_;
+    }
+
+private:
+    void skip(Thrift_type type, std::size_t depth);
+
+    std::uint64_t read_varint();
+
+    std::uint8_t read_byte();
+
+    Memory_span data_;
+    std::size_t pos_{};
+    std::int16_t last_field_id_{};
+    // The ids of the last fields read in the enclosing structs.
+    std::int16_t field_id_stack_[32]{};
+    std::size_t depth_{};
+
+    // The maximum nesting depth of skipped containers; deeper values
+    // are treated as corrupt instead of exhausting the stack.
+    static constexpr std::size_t max_skip_depth_ = 64;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,626 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+
+#include "mlio/detail/protobuf/record_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "mlio/endian.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// See https://developers.google.com/protocol-buffers/docs/encoding for
+// the wire format of Protocol Buffers.
+enum class Wire_type : std::uint32_t {
+    varint = 0,
+    fixed64 = 1,
+    length_delimited = 2,
+    start_group = 3,
+    end_group = 4,
+    fixed32 = 5
+};
+
+// A varint is at most 10 bytes long.
+constexpr std::size_t max_varint_size = 10;
+
+// Reads the wire format either from a contiguous span or from a record
+// split into fragments. In the latter case a length-delimited field that
+// straddles the boundary of two fragments is the only thing copied.
+class Wire_reader {
+public:
+    explicit Wire_reader(Memory_span data) noexcept
+        : pos_{data.data()}, end_{data.data() + data.size()}
+    {}
+
+    explicit Wire_reader(stdx::span<const Memory_slice> fragments,
+                         std::vector<std::vector<std::byte>> &straddled) noexcept
+        : next_fragment_{fragments.data()}
+        , last_fragment_{fragments.data() + fragments.size()}
+        , straddled_{&straddled}
+    {}
+
+    bool read_tag(std::uint32_t &field_number, Wire_type &wire_type) noexcept
+    {
+        std::uint64_t tag{};
+        if (!read_varint(tag) || tag > 0xffff'ffff) {
+            return false;
+        }
+
+        field_number = static_cast<std::uint32_t>(tag >> 3);
+
+        wire_type = static_cast<Wire_type>(tag & 0x7);
+
+        return field_number != 0;
+    }
+
+    bool read_varint(std::uint64_t &value) noexcept
+    {
+        std::uint64_t result = 0;
+
+        for (std::size_t i = 0; i < max_varint_size; i++) {
+            if (pos_ == end_ && !next_fragment()) {
+                return false;
+            }
+
+            auto b = static_cast<std::uint64_t>(*pos_++);
+
+            result |= (b & 0x7f) << (7 * i);
+
+            if ((b & 0x80) == 0) {
+                value = result;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool read_length_delimited(Memory_span &value)
+    {
+        std::uint64_t size{};
+        if (!read_varint(size)) {
+            return false;
+        }
+
+        return read_fixed(size, value);
+    }
+
+    bool read_fixed(std::uint64_t size, Memory_span &value)
+    {
+        if (size <= static_cast<std::uint64_t>(end_ - pos_)) {
+            value = Memory_span{pos_, size};
+
+            pos_ += size;
+
+            return true;
+        }
+
+        if (straddled_ == nullptr) {
+            return false;
+        }
+
+        // The field continues in the next fragments; merge its parts.
+        if (num_straddled_ == straddled_->size()) {
+            straddled_->emplace_back();
+        }
+
+        std::vector<std::byte> &buffer = (*straddled_)[num_straddled_++];
+
+        buffer.clear();
+
+        while (size > 0) {
+            if (pos_ == end_ && !next_fragment()) {
+                return false;
+            }
+
+            auto chunk_size = static_cast<std::size_t>(
+                std::min(static_cast<std::uint64_t>(end_ - pos_), size));
+
+            buffer.insert(buffer.end(), pos_, pos_ + chunk_size);
+
+            pos_ += chunk_size;
+
+            size -= chunk_size;
+        }
+
+        value = buffer;
+
+        return true;
+    }
+
+    bool skip(Wire_type wire_type) noexcept
+    {
+        std::uint64_t value{};
+
+        switch (wire_type) {
+        case Wire_type::varint:
+            return read_varint(value);
+
+        case Wire_type::fixed64:
+            return skip_bytes(8);
+
+        case Wire_type::length_delimited:
+            return read_varint(value) && skip_bytes(value);
+
+        case Wire_type::fixed32:
+            return skip_bytes(4);
+
+        // Groups are deprecated and are not used by RecordIO-protobuf;
+        // we treat them as malformed data.
+        case Wire_type::start_group:
+        case Wire_type::end_group:
+            return false;
+        }
+
+        return false;
+    }
+
+    bool eof() noexcept
+    {
+        return pos_ == end_ && !next_fragment();
+    }
+
+private:
+    bool next_fragment() noexcept
+    {
+        while (next_fragment_ != last_fragment_) {
+            const Memory_slice &fragment = *next_fragment_++;
+
+            if (!fragment.empty()) {
+                pos_ = fragment.data();
+                end_ = fragment.data() + fragment.size();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool skip_bytes(std::uint64_t size) noexcept
+    {
+        while (size > static_cast<std::uint64_t>(end_ - pos_)) {
+            size -= static_cast<std::uint64_t>(end_ - pos_);
+
+            pos_ = end_;
+
+            if (!next_fragment()) {
+                return false;
+            }
+        }
+
+        pos_ += size;
+
+        return true;
+    }
+
+    const std::byte *pos_{};
+    const std::byte *end_{};
+    const Memory_slice *next_fragment_{};
+    const Memory_slice *last_fragment_{};
+    std::vector<std::vector<std::byte>> *straddled_{};
+    std::size_t num_straddled_{};
+};
+
+// Describes how the elements of a repeated field of type T are encoded.
+template<typename T>
+struct Wire_traits {
+    static constexpr Wire_type wire_type = Wire_type::varint;
+};
+
+template<>
+struct Wire_traits<float> {
+    static constexpr Wire_type wire_type = Wire_type::fixed32;
+};
+
+template<>
+struct Wire_traits<double> {
+    static constexpr Wire_type wire_type = Wire_type::fixed64;
+};
+
+template<typename T>
+T *decode_fixed_run(Memory_span run, T *destination) noexcept
+{
+    std::size_t num_elements = run.size() / sizeof(T);
+
+    // The elements are stored in little-endian; on such hosts decoding
+    // the run is a plain copy.
+    if constexpr (Byte_order::host == Byte_order::little) {
+        std::memcpy(destination, run.data(), run.size());
+    }
+    else {
+        using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+        for (std::size_t i = 0; i < num_elements; i++) {
+            U bits{};
+            std::memcpy(&bits, run.data() + (i * sizeof(T)), sizeof(T));
+
+            bits = little_to_host_order(bits);
+
+            std::memcpy(destination + i, &bits, sizeof(T));
+        }
+    }
+
+    return destination + num_elements;
+}
+
+// Decodes a run of varints that has already been validated.
+template<typename T>
+T *decode_varint_run(Memory_span run, T *destination) noexcept
+{
+    Wire_reader reader{run};
+
+    std::uint64_t value{};
+    while (reader.read_varint(value)) {
+        // An int32 is encoded as a sign-extended 64-bit value.
+        *destination++ = static_cast<T>(value);
+    }
+
+    return destination;
+}
+
+template<typename T>
+T *decode_run(Memory_span run, T *destination) noexcept
+{
+    if constexpr (Wire_traits<T>::wire_type == Wire_type::varint) {
+        return decode_varint_run(run, destination);
+    }
+    else {
+        return decode_fixed_run(run, destination);
+    }
+}
+
+// Returns the number of elements in a packed run, or false if the run
+// is malformed.
+bool count_elements(Wire_type wire_type, Memory_span run, std::size_t &num_elements) noexcept
+{
+    if (wire_type == Wire_type::fixed32 || wire_type == Wire_type::fixed64) {
+        std::size_t element_size = wire_type == Wire_type::fixed32 ? 4 : 8;
+        if (run.size() % element_size != 0) {
+            return false;
+        }
+
+        num_elements = run.size() / element_size;
+
+        return true;
+    }
+
+    // Every varint ends with a byte whose most significant bit is clear.
+    std::size_t num_varints = 0;
+
+    std::size_t varint_size = 0;
+    for (std::byte b : run) {
+        if (++varint_size > max_varint_size) {
+            return false;
+        }
+
+        if ((b & std::byte{0x80}) == std::byte{}) {
+            num_varints++;
+
+            varint_size = 0;
+        }
+    }
+
+    if (varint_size != 0) {
+        return false;
+    }
+
+    num_elements = num_varints;
+
+    return true;
+}
+
+bool parse_value(Memory_span data, Protobuf_feature_view &feature)
+{
+    Wire_reader reader{data};
+
+    while (!reader.eof()) {
+        std::uint32_t field_number{};
+
+        Wire_type wire_type{};
+        if (!reader.read_tag(field_number, wire_type)) {
+            return false;
+        }
+
+        // The value is a oneof; the last field wins.
+        if (wire_type == Wire_type::length_delimited) {
+            Memory_span message{};
+            if (!reader.read_length_delimited(message)) {
+                return false;
+            }
+
+            Data_type dt{};
+            switch (field_number) {
+            case 2:
+                dt = Data_type::float32;
+                break;
+            case 3:
+                dt = Data_type::float64;
+                break;
+            case 7:
+                dt = Data_type::int32;
+                break;
+            case 9:
+                feature.is_bytes = true;
+                feature.is_tensor = false;
+                continue;
+            default:
+                continue;
+            }
+
+            if (!Protobuf_tensor_view::parse(dt, message, feature.tensor)) {
+                return false;
+            }
+
+            feature.is_bytes = false;
+            feature.is_tensor = true;
+        }
+        else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool parse_map_entry(Memory_span data, Protobuf_feature_view &feature)
+{
+    Wire_reader reader{data};
+
+    while (!reader.eof()) {
+        std::uint32_t field_number{};
+
+        Wire_type wire_type{};
+        if (!reader.read_tag(field_number, wire_type)) {
+            return false;
+        }
+
+        if (wire_type == Wire_type::length_delimited && (field_number == 1 || field_number == 2)) {
+            Memory_span span{};
+            if (!reader.read_length_delimited(span)) {
+                return false;
+            }
+
+            if (field_number == 1) {
+                feature.name = std::string_view{reinterpret_cast<const char *>(span.data()),
+                                                span.size()};
+            }
+            else if (!parse_value(span, feature)) {
+                return false;
+            }
+        }
+        else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
+bool Protobuf_tensor_view::parse(Data_type dt, Memory_span message, Protobuf_tensor_view &tensor)
+{
+    tensor = {};
+
+    tensor.message_ = message;
+
+    tensor.data_type_ = dt;
+
+    Wire_type values_wire_type{};
+    if (dt == Data_type::float32) {
+        values_wire_type = Wire_type::fixed32;
+    }
+    else if (dt == Data_type::float64) {
+        values_wire_type = Wire_type::fixed64;
+    }
+    else {
+        values_wire_type = Wire_type::varint;
+    }
+
+    Wire_reader reader{message};
+
+    while (!reader.eof()) {
+        std::uint32_t field_number{};
+
+        Wire_type wire_type{};
+        if (!reader.read_tag(field_number, wire_type)) {
+            return false;
+        }
+
+        Field *field{};
+
+        // The values are followed by the keys and the shape, which are
+        // both stored as varints.
+        Wire_type element_wire_type = Wire_type::varint;
+        switch (field_number) {
+        case 1:
+            field = &tensor.values_;
+            element_wire_type = values_wire_type;
+            break;
+        case 2:
+            field = &tensor.keys_;
+            break;
+        case 3:
+            field = &tensor.shape_;
+            break;
+        default:
+            break;
+        }
+
+        // Like Protocol Buffers, we skip fields with an unexpected wire
+        // type as unknown fields.
+        if (field == nullptr ||
+            (wire_type != Wire_type::length_delimited && wire_type != element_wire_type)) {
+            if (!reader.skip(wire_type)) {
+                return false;
+            }
+
+            continue;
+        }
+
+        std::size_t num_elements = 1;
+
+        Memory_span run{};
+        if (wire_type == Wire_type::length_delimited) {
+            if (!reader.read_length_delimited(run) ||
+                !count_elements(element_wire_type, run, num_elements)) {
+                return false;
+            }
+        }
+        else if (!reader.skip(wire_type)) {
+            return false;
+        }
+
+        field->is_single_run = field->num_occurrences == 0 &&
+                               wire_type == Wire_type::length_delimited;
+
+        field->run = run;
+
+        field->size += num_elements;
+
+        field->num_occurrences++;
+    }
+
+    return true;
+}
+
+void Protobuf_tensor_view::read_values(stdx::span<float> destination) const
+{
+    read_field(1, values_, destination);
+}
+
+void Protobuf_tensor_view::read_values(stdx::span<double> destination) const
+{
+    read_field(1, values_, destination);
+}
+
+void Protobuf_tensor_view::read_values(stdx::span<std::int32_t> destination) const
+{
+    read_field(1, values_, destination);
+}
+
+void Protobuf_tensor_view::read_keys(stdx::span<std::uint64_t> destination) const
+{
+    read_field(2, keys_, destination);
+}
+
+void Protobuf_tensor_view::read_shape(stdx::span<std::uint64_t> destination) const
+{
+    read_field(3, shape_, destination);
+}
+
+template<typename T>
+void Protobuf_tensor_view::read_field(std::uint32_t field_number,
+                                      const Field &field,
+                                      stdx::span<T> destination) const
+{
+    if (field.is_single_run) {
+        decode_run(field.run, destination.data());
+
+        return;
+    }
+
+    // The field is either unpacked or split into several runs; walk the
+    // message and concatenate its occurrences. The message has already
+    // been validated.
+    T *pos = destination.data();
+
+    Wire_reader reader{message_};
+
+    std::uint32_t number{};
+
+    Wire_type wire_type{};
+    while (reader.read_tag(number, wire_type)) {
+        if (number != field_number) {
+            reader.skip(wire_type);
+
+            continue;
+        }
+
+        if (wire_type == Wire_type::length_delimited) {
+            Memory_span run{};
+            reader.read_length_delimited(run);
+
+            pos = decode_run(run, pos);
+        }
+        else if (wire_type == Wire_traits<T>::wire_type) {
+            if constexpr (Wire_traits<T>::wire_type == Wire_type::varint) {
+                std::uint64_t value{};
+                reader.read_varint(value);
+
+                *pos++ = static_cast<T>(value);
+            }
+            else {
+                Memory_span element{};
+                reader.read_fixed(sizeof(T), element);
+
+                pos = decode_fixed_run(element, pos);
+            }
+        }
+        else {
+            reader.skip(wire_type);
+        }
+    }
+}
+
+bool parse_protobuf_record(stdx::span<const Memory_slice> fragments,
+                           std::vector<Protobuf_feature_view> &features,
+                           std::vector<std::vector<std::byte>> &straddled)
+{
+    Wire_reader reader{fragments, straddled};
+
+    while (!reader.eof()) {
+        std::uint32_t field_number{};
+
+        Wire_type wire_type{};
+        if (!reader.read_tag(field_number, wire_type)) {
+            return false;
+        }
+
+        // The feature and label maps are stored as repeated messages of
+        // key-value pairs.
+        if (wire_type == Wire_type::length_delimited && (field_number == 1 || field_number == 2)) {
+            Memory_span entry{};
+            if (!reader.read_length_delimited(entry)) {
+                return false;
+            }
+
+            Protobuf_feature_view &feature = features.emplace_back();
+
+            feature.is_label = field_number == 2;
+
+            if (!parse_map_entry(entry, feature)) {
+                return false;
+            }
+        }
+        else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
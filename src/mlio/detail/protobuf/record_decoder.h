@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "mlio/data_type.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Refers to a Float32Tensor, Float64Tensor, or Int32Tensor message of a
+// RecordIO-protobuf record in its wire format; see recordio_protobuf.proto.
+// Its repeated fields are only validated and counted while parsing; they
+// are decoded on demand straight into the caller's memory.
+class Protobuf_tensor_view {
+    struct Field {
+        std::size_t size{};
+        std::size_t num_occurrences{};
+        // The packed run of the field if it is stored as a single one,
+        // which is what all writers we know of do; otherwise the whole
+        // message has to be walked to decode the field.
+        Memory_span run{};
+        bool is_single_run{};
+    };
+
+public:
+    // Parses the specified tensor message. Returns false if it is
+    // malformed.
+    static bool parse(Data_type dt, Memory_span message, Protobuf_tensor_view &tensor);
+
+    Data_type data_type() const noexcept
+    {
+        return data_type_;
+    }
+
+    std::size_t num_values() const noexcept
+    {
+        return values_.size;
+    }
+
+    std::size_t num_keys() const noexcept
+    {
+        return keys_.size;
+    }
+
+    std::size_t num_dims() const noexcept
+    {
+        return shape_.size;
+    }
+
+    // The destination must have the exact size of the corresponding
+    // field and match the data type of the tensor.
+    void read_values(stdx::span<float> destination) const;
+
+    void read_values(stdx::span<double> destination) const;
+
+    void read_values(stdx::span<std::int32_t> destination) const;
+
+    void read_keys(stdx::span<std::uint64_t> destination) const;
+
+    void read_shape(stdx::span<std::uint64_t> destination) const;
+
+private:
+    template<typename T>
+    void read_field(std::uint32_t field_number, const Field &field, stdx::span<T> destination) const;
+
+    Memory_span message_{};
+    Data_type data_type_{};
+    Field values_{};
+    Field keys_{};
+    Field shape_{};
+};
+
+// Represents an entry of the feature or label map of a RecordIO-protobuf
+// record. The name refers to the memory of the record.
+struct Protobuf_feature_view {
+    std::string_view name{};
+    bool is_label{};
+    // Indicates whether the value is a Bytes message.
+    bool is_bytes{};
+    // Indicates whether the value is one of the supported tensors.
+    bool is_tensor{};
+    Protobuf_tensor_view tensor{};
+};
+
+// Parses a RecordIO-protobuf record split into the specified fragments
+// and appends the entries of its label and feature maps to the specified
+// list in the order they appear in the record. An entry that straddles
+// the boundary of two fragments is copied into one of the straddled
+// buffers, which must outlive the features; the buffers are re-used
+// across calls. Returns false if the record is malformed.
+bool parse_protobuf_record(stdx::span<const Memory_slice> fragments,
+                           std::vector<Protobuf_feature_view> &features,
+                           std::vector<std::vector<std::byte>> &straddled);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <system_error>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Represents an error returned by Amazon S3 along with whether the AWS
+// SDK considers the failed request worth retrying (e.g. a throttled
+// request or a dropped connection).
+class S3_error : public std::system_error {
+public:
+    explicit S3_error(std::error_code ec, const char *what, bool retryable)
+        : std::system_error{ec, what}, retryable_{retryable}
+    {}
+
+    bool retryable() const noexcept
+    {
+        return retryable_;
+    }
+
+private:
+    bool retryable_;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
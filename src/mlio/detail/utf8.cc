@@ -0,0 +1,164 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/detail/utf8.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+using Byte = unsigned char;
+
+constexpr std::size_t block_size = 16;
+
+#ifdef __SSE2__
+
+// Returns the number of leading bytes that are known to be ASCII. The
+// text is checked in blocks of 32 bytes; the rest is left to the scalar
+// path.
+std::size_t skip_ascii(const Byte *text, std::size_t size) noexcept
+{
+    std::size_t i = 0;
+    for (; i + block_size * 2 <= size; i += block_size * 2) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + block_size));
+
+        // The sign bit of every byte of an ASCII block is zero.
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) {
+            break;
+        }
+    }
+    return i;
+}
+
+#else
+
+std::size_t skip_ascii(const Byte *, std::size_t) noexcept
+{
+    return 0;
+}
+
+#endif
+
+// Returns the size of the multi-byte sequence at the beginning of the
+// specified text; or zero if it is not a valid UTF-8 sequence. See
+// Table 3-7 of the Unicode Standard for the well-formed byte sequences.
+std::size_t sequence_size(const Byte *text, std::size_t size) noexcept
+{
+    Byte lead = text[0];
+
+    std::size_t n{};
+
+    // The valid range of the second byte.
+    Byte lower = 0x80;
+    Byte upper = 0xBF;
+
+    if (lead < 0xC2) {
+        // A stray continuation byte or an overlong two-byte sequence.
+        return 0;
+    }
+    if (lead < 0xE0) {
+        n = 2;
+    }
+    else if (lead < 0xF0) {
+        n = 3;
+
+        if (lead == 0xE0) {
+            lower = 0xA0;
+        }
+        else if (lead == 0xED) {
+            // Excludes the UTF-16 surrogates.
+            upper = 0x9F;
+        }
+    }
+    else if (lead < 0xF5) {
+        n = 4;
+
+        if (lead == 0xF0) {
+            lower = 0x90;
+        }
+        else if (lead == 0xF4) {
+            // Excludes the code points beyond U+10FFFF.
+            upper = 0x8F;
+        }
+    }
+    else {
+        return 0;
+    }
+
+    if (size < n) {
+        return 0;
+    }
+
+    if (text[1] < lower || text[1] > upper) {
+        return 0;
+    }
+
+    for (std::size_t i = 2; i < n; i++) {
+        if ((text[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+
+    return n;
+}
+
+}  // namespace
+
+std::optional<std::size_t> find_invalid_utf8(Memory_span text) noexcept
+{
+    auto chars = as_span<const Byte>(text);
+
+    const Byte *data = chars.data();
+
+    std::size_t size = chars.size();
+
+    std::size_t i = 0;
+    while (i < size) {
+        i += skip_ascii(data + i, size - i);
+
+        // Check at least one block using the scalar path before trying
+        // the vectorized one again; a sequence might cross the block
+        // boundary.
+        std::size_t block_end = std::min(i + block_size, size);
+        while (i < block_end) {
+            if (data[i] < 0x80) {
+                i++;
+
+                continue;
+            }
+
+            std::size_t n = sequence_size(data + i, size - i);
+            if (n == 0) {
+                return i;
+            }
+
+            i += n;
+        }
+    }
+
+    return {};
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
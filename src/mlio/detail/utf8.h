@@ -0,0 +1,35 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Returns the offset of the first byte of the first invalid UTF-8
+// sequence in the specified text; or std::nullopt if the text is valid
+// UTF-8. Overlong encodings, surrogates, and code points beyond U+10FFFF
+// are treated as invalid.
+std::optional<std::size_t> find_invalid_utf8(Memory_span text) noexcept;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -24,7 +24,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
-#include "mlio/cpu_array.h"
+#include "mlio/device_array.h"
 #include "mlio/data_reader_error.h"
 #include "mlio/data_stores/data_store.h"
 #include "mlio/data_type.h"
@@ -105,30 +105,15 @@ Intrusive_ptr<Example> Image_reader::decode(const Instance_batch &batch) const
         else {
             // If the user requested to skip the example in case of an
             // error, shortcut the loop and return immediately.
-            if (params().bad_example_handling == Bad_example_handling::skip) {
-                return {};
-            }
-            if (params().bad_example_handling == Bad_example_handling::skip_warn) {
-                logger::warn(
-                    "The example #{0:n} has been skipped as it had at least one bad instance.",
-                    batch.index());
+            if (skip_bad_example()) {
+                warn_bad_example(batch, {});
 
                 return {};
             }
-            if (params().bad_example_handling != Bad_example_handling::pad &&
-                params().bad_example_handling != Bad_example_handling::pad_warn) {
-                throw std::invalid_argument{"The specified bad example handling is invalid."};
-            }
         }
     }
 
-    if (batch.instances().size() != num_instances_read) {
-        if (params().bad_example_handling == Bad_example_handling::pad_warn) {
-            logger::warn("The example #{0:n} has been padded as it had {1:n} bad instance(s).",
-                         batch.index(),
-                         batch.instances().size() - num_instances_read);
-        }
-    }
+    warn_bad_example(batch, num_instances_read);
 
     std::vector<Intrusive_ptr<Tensor>> tensors{};
     tensors.emplace_back(std::move(tensor));
@@ -148,7 +133,7 @@ Image_reader::make_tensor(std::size_t batch_size, std::size_t batch_stride) cons
                       params_.image_dimensions[2],
                       params_.image_dimensions[0]};
 
-    auto arr = make_cpu_array(Data_type::uint8, batch_size * batch_stride);
+    auto arr = make_feature_array(Data_type::uint8, batch_size * batch_stride);
 
     return make_intrusive<Dense_tensor>(std::move(shape), std::move(arr));
 }
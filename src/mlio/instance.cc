@@ -15,6 +15,7 @@
 
 #include "mlio/instance.h"
 
+#include <algorithm>
 #include <exception>
 #include <system_error>
 
@@ -34,6 +35,31 @@
 namespace mlio {
 inline namespace abi_v1 {
 
+std::size_t Instance::size() const
+{
+    if (fragments_.empty()) {
+        return bits().size();
+    }
+
+    std::size_t size = 0;
+    for (const Memory_slice &fragment : fragments_) {
+        size += fragment.size();
+    }
+    return size;
+}
+
+Memory_slice Instance::merge_fragments() const
+{
+    auto block = memory_allocator().allocate(size());
+
+    auto pos = block->begin();
+    for (const Memory_slice &fragment : fragments_) {
+        pos = std::copy(fragment.begin(), fragment.end(), pos);
+    }
+
+    return Memory_slice{std::move(block)};
+}
+
 Memory_slice Instance::load_bits_from_store() const
 {
     Intrusive_ptr<Input_stream> stream{};
@@ -22,7 +22,7 @@ std::size_t Instance_batch::size_bytes() const
 {
     if (size_bytes_ == 0) {
         for (const Instance &instance : instances_) {
-            size_bytes_ += instance.bits().size();
+            size_bytes_ += instance.size();
         }
     }
 
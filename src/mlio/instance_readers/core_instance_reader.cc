@@ -16,6 +16,7 @@
 #include "mlio/instance_readers/core_instance_reader.h"
 
 #include <exception>
+#include <stdexcept>
 #include <system_error>
 #include <utility>
 
@@ -24,8 +25,7 @@
 #include "mlio/data_reader.h"
 #include "mlio/data_reader_error.h"
 #include "mlio/instance.h"
-#include "mlio/memory/memory_allocator.h"
-#include "mlio/memory/memory_block.h"
+#include "mlio/instance_readers/sharded_instance_reader.h"
 #include "mlio/memory/memory_slice.h"
 #include "mlio/not_supported_error.h"
 #include "mlio/record_readers/record.h"
@@ -40,20 +40,47 @@ Core_instance_reader::Core_instance_reader(const Data_reader_params &params,
                                            Record_reader_factory &&factory)
     : params_{&params}, record_reader_factory_{std::move(factory)}
 {
-    store_iter_ = params_->dataset.begin();
+    if (params_->use_record_index && params_->record_index_interval == 0) {
+        throw std::invalid_argument{"The record index interval must be greater than zero."};
+    }
+
+    if (params_->num_shards > 1 && params_->sharding_strategy == Sharding_strategy::data_store) {
+        stores_ = shard_data_stores(*params_);
+    }
+    else {
+        stores_ = params_->dataset;
+    }
+
+    store_iter_ = stores_.begin();
+
+    if (params_->num_prefetched_data_stores > 0) {
+        prefetcher_ = std::make_unique<Data_store_prefetcher>(params_->num_prefetched_data_stores);
+    }
+}
+
+Core_instance_reader::Core_instance_reader(const Data_reader_params &params,
+                                           Record_reader_factory &&factory,
+                                           std::vector<Intrusive_ptr<Data_store>> stores)
+    : params_{&params}, record_reader_factory_{std::move(factory)}, stores_{std::move(stores)}
+{
+    if (params_->use_record_index && params_->record_index_interval == 0) {
+        throw std::invalid_argument{"The record index interval must be greater than zero."};
+    }
+
+    store_iter_ = stores_.begin();
 }
 
 std::optional<Instance> Core_instance_reader::read_instance_core()
 {
-    std::optional<Memory_slice> payload;
+    std::optional<Instance> instance{};
     try {
-        payload = read_record_payload();
+        instance = read_record_instance();
     }
     catch (const std::exception &) {
         handle_errors();
     }
 
-    if (payload == std::nullopt) {
+    if (instance == std::nullopt) {
         // If we have not reached the end of the dataset, but we could
         // not read a record from the current data store, it means the
         // data store itself is an instance (e.g. an image file).
@@ -64,11 +91,122 @@ std::optional<Instance> Core_instance_reader::read_instance_core()
         return {};
     }
 
-    return Instance{*store_, instance_idx_++, std::move(*payload)};
+    return instance;
+}
+
+std::size_t Core_instance_reader::skip_instances_core(std::size_t count)
+{
+    if (!params_->use_record_index) {
+        return Instance_reader_base::skip_instances_core(count);
+    }
+
+    try {
+        return skip_instances_using_index(count);
+    }
+    catch (const std::exception &) {
+        handle_errors();
+    }
+}
+
+std::size_t Core_instance_reader::skip_instances_using_index(std::size_t count)
+{
+    std::size_t num_instances_skipped = 0;
+
+    while (num_instances_skipped < count) {
+        std::size_t num_instances_to_skip = count - num_instances_skipped;
+
+        if (record_reader_ == nullptr && store_iter_ != stores_.end()) {
+            // Skip the next data store as a whole, without opening it, if
+            // its index tells that it has no more instances than we have
+            // to skip.
+            std::optional<std::size_t> num_store_instances =
+                skip_next_store_using_index(num_instances_to_skip);
+            if (num_store_instances) {
+                num_instances_skipped += *num_store_instances;
+
+                continue;
+            }
+
+            // Otherwise open it so that its index, if any, gets loaded
+            // before we read from it.
+            if (init_next_record_reader()) {
+                continue;
+            }
+
+            // If we could not make a record reader, the data store itself
+            // is an instance (e.g. an image file).
+            num_instances_skipped++;
+
+            continue;
+        }
+
+        if (record_index_ && instance_idx_ <= record_index_->num_instances()) {
+            std::size_t num_instances_left = record_index_->num_instances() - instance_idx_;
+
+            // Drop the rest of the current data store; the next iteration
+            // will move to the next one.
+            if (num_instances_to_skip >= num_instances_left) {
+                num_instances_skipped += num_instances_left;
+
+                record_reader_ = nullptr;
+
+                stream_record_reader_ = nullptr;
+
+                record_index_ = {};
+
+                continue;
+            }
+
+            // Otherwise seek to the closest indexed instance and read the
+            // remaining ones.
+            Record_index_entry entry = record_index_->lookup(instance_idx_ + num_instances_to_skip);
+            if (entry.instance_idx > instance_idx_) {
+                stream_record_reader_->seek(entry.offset);
+
+                num_instances_skipped += entry.instance_idx - instance_idx_;
+
+                instance_idx_ = entry.instance_idx;
+
+                record_idx_ = entry.record_idx;
+
+                continue;
+            }
+        }
+
+        if (read_instance_core() == std::nullopt) {
+            break;
+        }
+
+        num_instances_skipped++;
+    }
+
+    return num_instances_skipped;
+}
+
+std::optional<std::size_t>
+Core_instance_reader::skip_next_store_using_index(std::size_t max_num_instances)
+{
+    // We can only tell whether an index is valid for the upcoming data
+    // store once we know how the records are framed.
+    if (framing_key_.empty()) {
+        return {};
+    }
+
+    std::optional<Record_index> index = load_record_index(**store_iter_, framing_key_);
+    if (index == std::nullopt || index->num_instances() > max_num_instances) {
+        return {};
+    }
+
+    ++store_iter_;
+
+    return index->num_instances();
 }
 
 void Core_instance_reader::handle_errors()
 {
+    // A data store that cannot be read in full cannot be indexed.
+    should_build_record_index_ = false;
+
     try {
         throw;
     }
@@ -101,7 +239,7 @@ void Core_instance_reader::handle_errors()
     }
 }
 
-std::optional<Memory_slice> Core_instance_reader::read_record_payload()
+std::optional<Instance> Core_instance_reader::read_record_instance()
 {
     if (has_corrupt_split_record_) {
         throw_corrupt_split_record_error();
@@ -112,25 +250,33 @@ std::optional<Memory_slice> Core_instance_reader::read_record_payload()
         return {};
     }
 
+    if (should_build_record_index_ && instance_idx_ % params_->record_index_interval == 0) {
+        record_index_offsets_.emplace_back(stream_record_reader_->record_offset());
+
+        // read_record() has already counted the record.
+        record_index_record_indices_.emplace_back(record_idx_ - 1);
+    }
+
     if (record->kind() == Record_kind::complete) {
-        return std::move(*record).payload();
+        return Instance{*store_, instance_idx_++, std::move(*record).payload()};
     }
 
-    return read_split_record_payload(std::move(record));
+    std::vector<Memory_slice> fragments = read_split_record_payload(std::move(record));
+
+    return Instance{*store_, instance_idx_++, std::move(fragments)};
 }
 
-std::optional<Memory_slice>
+std::vector<Memory_slice>
 Core_instance_reader::read_split_record_payload(std::optional<Record> record)
 {
-    std::vector<Record> records{};
-
-    std::size_t payload_size = 0;
+    // The payloads of the records are not merged; the instance keeps
+    // them as fragments and only decoders that need contiguous data pay
+    // for the copy.
+    std::vector<Memory_slice> fragments{};
 
     // A split record must start with a 'begin' record...
     if (record->kind() == Record_kind::begin) {
-        payload_size += record->payload().size();
-
-        records.emplace_back(std::move(*record));
+        fragments.emplace_back(std::move(*record).payload());
     }
     else {
         throw_corrupt_split_record_error();
@@ -138,31 +284,18 @@ Core_instance_reader::read_split_record_payload(std::optional<Record> record)
 
     // continue with zero or more 'middle' records...
     while ((record = read_record()) && record->kind() == Record_kind::middle) {
-        payload_size += record->payload().size();
-
-        records.emplace_back(std::move(*record));
+        fragments.emplace_back(std::move(*record).payload());
     }
 
     // and end with an 'end' record.
     if (record && record->kind() == Record_kind::end) {
-        payload_size += record->payload().size();
-
-        records.emplace_back(std::move(*record));
+        fragments.emplace_back(std::move(*record).payload());
     }
     else {
         throw_corrupt_split_record_error();
     }
 
-    // Once we have collected all records we merge their payloads in a
-    // single buffer.
-    auto payload = memory_allocator().allocate(payload_size);
-
-    auto pos = payload->begin();
-    for (const Record &r : records) {
-        pos = std::copy(r.payload().begin(), r.payload().end(), pos);
-    }
-
-    return std::move(payload);
+    return fragments;
 }
 
 void Core_instance_reader::throw_corrupt_split_record_error()
@@ -183,6 +316,8 @@ std::optional<Record> Core_instance_reader::read_record()
     std::optional<Record> record{};
 
     while ((record = record_reader_->read_record()) == std::nullopt) {
+        save_record_index();
+
         if (!init_next_record_reader()) {
             return {};
         }
@@ -199,18 +334,20 @@ bool Core_instance_reader::init_next_record_reader()
 
     record_idx_ = 0;
 
-    if (store_iter_ == params_->dataset.end()) {
+    if (store_iter_ == stores_.end()) {
         store_ = nullptr;
 
         record_reader_ = nullptr;
 
+        init_record_index();
+
         return false;
     }
 
     store_ = store_iter_->get();
 
     try {
-        record_reader_ = record_reader_factory_(*store_);
+        record_reader_ = make_record_reader();
     }
     catch (const std::system_error &e) {
         if (e.code() == std::errc::no_such_file_or_directory) {
@@ -231,12 +368,111 @@ bool Core_instance_reader::init_next_record_reader()
     // throws an exception.
     ++store_iter_;
 
+    auto *reader = dynamic_cast<Stream_record_reader *>(record_reader_.get());
+    if (reader != nullptr) {
+        reader->set_chunk_size_bounds(params_->min_chunk_size, params_->max_chunk_size);
+    }
+
+    init_record_index();
+
     return record_reader_ != nullptr;
 }
 
+Intrusive_ptr<Record_reader> Core_instance_reader::make_record_reader()
+{
+    if (prefetcher_ == nullptr) {
+        return record_reader_factory_(*store_);
+    }
+
+    Intrusive_ptr<Prefetched_data_store> store = prefetcher_->take(*store_);
+
+    prefetcher_->prefetch(store_iter_ + 1, stores_.cend());
+
+    if (store == nullptr) {
+        return record_reader_factory_(*store_);
+    }
+
+    Intrusive_ptr<Record_reader> reader = record_reader_factory_(*store);
+
+    // If the factory does not read the data store itself (e.g. a raw
+    // image reader), prefetching only wastes resources.
+    if (!store->stream_taken()) {
+        prefetcher_ = nullptr;
+    }
+
+    return reader;
+}
+
+void Core_instance_reader::init_record_index()
+{
+    stream_record_reader_ = nullptr;
+
+    record_index_ = {};
+
+    record_index_key_ = {};
+
+    record_index_offsets_.clear();
+
+    record_index_record_indices_.clear();
+
+    should_build_record_index_ = false;
+
+    if (!params_->use_record_index || record_reader_ == nullptr) {
+        return;
+    }
+
+    auto *reader = dynamic_cast<Stream_record_reader *>(record_reader_.get());
+    if (reader == nullptr) {
+        framing_key_.clear();
+
+        return;
+    }
+
+    // Remember the framing so that the indexes of the upcoming data
+    // stores can be checked without opening them.
+    framing_key_ = reader->framing_key();
+
+    // We can only make use of an index if we can seek to the offsets in
+    // it.
+    if (!reader->seekable()) {
+        return;
+    }
+
+    stream_record_reader_ = reader;
+
+    // The key of the index depends on the position of the reader, so it
+    // must be made before any record is read.
+    record_index_key_ = make_record_index_key(*store_, *reader);
+    if (record_index_key_ == std::nullopt) {
+        return;
+    }
+
+    record_index_ = load_record_index(*store_, *record_index_key_);
+    if (record_index_ == std::nullopt) {
+        should_build_record_index_ = true;
+    }
+}
+
+void Core_instance_reader::save_record_index() noexcept
+{
+    if (!should_build_record_index_) {
+        return;
+    }
+
+    should_build_record_index_ = false;
+
+    Record_index index{*record_index_key_,
+                       params_->record_index_interval,
+                       instance_idx_,
+                       std::move(record_index_offsets_),
+                       std::move(record_index_record_indices_)};
+
+    detail::save_record_index(*store_, index);
+}
+
 void Core_instance_reader::reset_core() noexcept
 {
-    store_iter_ = params_->dataset.begin();
+    store_iter_ = stores_.begin();
 
     store_ = nullptr;
 
@@ -247,6 +483,24 @@ void Core_instance_reader::reset_core() noexcept
     record_idx_ = 0;
 
     has_corrupt_split_record_ = false;
+
+    stream_record_reader_ = nullptr;
+
+    record_index_ = {};
+
+    record_index_key_ = {};
+
+    record_index_offsets_.clear();
+
+    record_index_record_indices_.clear();
+
+    should_build_record_index_ = false;
+
+    framing_key_.clear();
+
+    if (prefetcher_ != nullptr) {
+        prefetcher_->clear();
+    }
 }
 
 }  // namespace detail
@@ -16,15 +16,20 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "mlio/data_stores/data_store.h"
 #include "mlio/fwd.h"
+#include "mlio/instance_readers/data_store_prefetcher.h"
 #include "mlio/instance_readers/instance_reader.h"
 #include "mlio/instance_readers/instance_reader_base.h"
+#include "mlio/instance_readers/record_index.h"
 #include "mlio/intrusive_ptr.h"
 #include "mlio/record_readers/record_reader.h"
+#include "mlio/record_readers/stream_record_reader.h"
 
 namespace mlio {
 inline namespace abi_v1 {
@@ -35,14 +40,26 @@ public:
     explicit Core_instance_reader(const Data_reader_params &params,
                                   Record_reader_factory &&factory);
 
+    // Reads only the specified data stores instead of the dataset in
+    // params.
+    explicit Core_instance_reader(const Data_reader_params &params,
+                                  Record_reader_factory &&factory,
+                                  std::vector<Intrusive_ptr<Data_store>> stores);
+
 private:
     std::optional<Instance> read_instance_core() final;
 
+    std::size_t skip_instances_core(std::size_t count) final;
+
+    std::size_t skip_instances_using_index(std::size_t count);
+
+    std::optional<std::size_t> skip_next_store_using_index(std::size_t max_num_instances);
+
     [[noreturn]] void handle_errors();
 
-    std::optional<Memory_slice> read_record_payload();
+    std::optional<Instance> read_record_instance();
 
-    std::optional<Memory_slice> read_split_record_payload(std::optional<Record> record);
+    std::vector<Memory_slice> read_split_record_payload(std::optional<Record> record);
 
     [[noreturn]] void throw_corrupt_split_record_error();
 
@@ -50,16 +67,31 @@ private:
 
     bool init_next_record_reader();
 
+    Intrusive_ptr<Record_reader> make_record_reader();
+
+    void init_record_index();
+
+    void save_record_index() noexcept;
+
     void reset_core() noexcept final;
 
     const Data_reader_params *params_;
     Record_reader_factory record_reader_factory_;
+    std::vector<Intrusive_ptr<Data_store>> stores_{};
     std::vector<Intrusive_ptr<Data_store>>::const_iterator store_iter_{};
     Data_store *store_{};
     Intrusive_ptr<Record_reader> record_reader_{};
     std::size_t instance_idx_{};
     std::size_t record_idx_{};
     bool has_corrupt_split_record_{};
+    Stream_record_reader *stream_record_reader_{};
+    std::optional<Record_index> record_index_{};
+    std::optional<Record_index_key> record_index_key_{};
+    std::vector<std::size_t> record_index_offsets_{};
+    std::vector<std::size_t> record_index_record_indices_{};
+    std::string framing_key_{};
+    bool should_build_record_index_{};
+    std::unique_ptr<Data_store_prefetcher> prefetcher_{};
 };
 
 }  // namespace detail
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/instance_readers/data_store_prefetcher.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "mlio/detail/thread.h"
+#include "mlio/memory/memory_allocator.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/input_stream_base.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// Serves the bytes read ahead from an input stream before continuing
+// with the stream itself.
+class Prefixed_input_stream final : public Input_stream_base {
+public:
+    explicit Prefixed_input_stream(Intrusive_ptr<Input_stream> inner, Memory_slice prefix)
+        : inner_{std::move(inner)}, buffer_{std::move(prefix)}, prefix_{buffer_}
+    {
+        if (inner_->seekable()) {
+            buffer_offset_ = inner_->position() - buffer_.size();
+        }
+    }
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final
+    {
+        if (prefix_.empty()) {
+            // Once the inner stream moves past the buffer, seeks can no
+            // longer be served from it.
+            buffer_offset_ = std::nullopt;
+
+            buffer_ = {};
+
+            return inner_->read(destination);
+        }
+
+        std::size_t size = std::min(destination.size(), prefix_.size());
+
+        std::copy(prefix_.begin(), prefix_.begin() + as_ssize(size), destination.begin());
+
+        prefix_ = prefix_.subslice(size);
+
+        return size;
+    }
+
+    void seek(std::size_t position) final
+    {
+        // A seek within the buffer, such as the one to the beginning of
+        // the stream after sniffing its BOM, keeps the inner stream
+        // where it is instead of reading the same bytes again.
+        if (buffer_offset_ && position >= *buffer_offset_ &&
+            position - *buffer_offset_ <= buffer_.size()) {
+            prefix_ = buffer_.subslice(position - *buffer_offset_);
+
+            return;
+        }
+
+        inner_->seek(position);
+
+        buffer_offset_ = std::nullopt;
+
+        buffer_ = {};
+
+        prefix_ = {};
+    }
+
+    void close() noexcept final
+    {
+        inner_->close();
+
+        buffer_offset_ = std::nullopt;
+
+        buffer_ = {};
+
+        prefix_ = {};
+    }
+
+    std::size_t size() const final
+    {
+        return inner_->size();
+    }
+
+    std::size_t position() const final
+    {
+        return inner_->position() - prefix_.size();
+    }
+
+    bool closed() const noexcept final
+    {
+        return inner_->closed();
+    }
+
+    bool seekable() const noexcept final
+    {
+        return inner_->seekable();
+    }
+
+private:
+    Intrusive_ptr<Input_stream> inner_;
+    // The bytes read ahead and their offset in the inner stream; only
+    // kept while the inner stream is positioned right after them.
+    Memory_slice buffer_;
+    std::optional<std::size_t> buffer_offset_{};
+    // The part of the buffer that has not been read yet.
+    Memory_slice prefix_;
+};
+
+}  // namespace
+
+Intrusive_ptr<Input_stream> Prefetched_data_store::open_read() const
+{
+    if (stream_ != nullptr) {
+        return std::move(stream_);
+    }
+    return inner_->open_read();
+}
+
+Data_store_prefetcher::~Data_store_prefetcher()
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        stopping_ = true;
+    }
+
+    worker_condition_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Data_store_prefetcher::prefetch(Store_iterator first, Store_iterator last)
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        std::deque<std::shared_ptr<Entry>> entries{};
+
+        auto entry_pos = entries_.begin();
+
+        for (std::size_t i = 0; i < num_stores_ && first != last; i++, ++first) {
+            // Keep the entries that are already in the right order.
+            if (entry_pos != entries_.end() && (*entry_pos)->store == *first) {
+                entries.emplace_back(std::move(*entry_pos++));
+            }
+            else {
+                entry_pos = entries_.end();
+
+                auto entry = std::make_shared<Entry>();
+
+                entry->store = *first;
+
+                entries.emplace_back(std::move(entry));
+            }
+        }
+
+        entries_ = std::move(entries);
+
+        if (entries_.empty()) {
+            return;
+        }
+    }
+
+    if (!thread_.joinable()) {
+        thread_ = start_thread(&Data_store_prefetcher::run, this);
+    }
+    else {
+        worker_condition_.notify_one();
+    }
+}
+
+Intrusive_ptr<Prefetched_data_store> Data_store_prefetcher::take(const Data_store &store)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (!entries_.empty() && entries_.front()->store.get() != &store) {
+        entries_.pop_front();
+    }
+
+    if (entries_.empty()) {
+        return {};
+    }
+
+    std::shared_ptr<Entry> entry = std::move(entries_.front());
+
+    entries_.pop_front();
+
+    // If the worker has not picked up the data store yet, there is no
+    // point in waiting for it.
+    if (!entry->started) {
+        return {};
+    }
+
+    reader_condition_.wait(lock, [&entry] {
+        return entry->done;
+    });
+
+    if (entry->exception) {
+        std::rethrow_exception(entry->exception);
+    }
+
+    return make_intrusive<Prefetched_data_store>(store, std::move(entry->stream));
+}
+
+void Data_store_prefetcher::clear() noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    entries_.clear();
+}
+
+void Data_store_prefetcher::run()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (true) {
+        std::shared_ptr<Entry> entry{};
+
+        worker_condition_.wait(lock, [this, &entry] {
+            if (stopping_) {
+                return true;
+            }
+
+            auto pos = std::find_if(entries_.begin(), entries_.end(), [](const auto &e) {
+                return !e->started;
+            });
+            if (pos == entries_.end()) {
+                return false;
+            }
+
+            entry = *pos;
+
+            return true;
+        });
+
+        if (stopping_) {
+            return;
+        }
+
+        entry->started = true;
+
+        lock.unlock();
+
+        Intrusive_ptr<Input_stream> stream{};
+        std::exception_ptr exception{};
+        try {
+            stream = open_store(*entry->store);
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+
+        entry->stream = std::move(stream);
+        entry->exception = std::move(exception);
+        entry->done = true;
+
+        reader_condition_.notify_all();
+    }
+}
+
+Intrusive_ptr<Input_stream> Data_store_prefetcher::open_store(const Data_store &store)
+{
+    // Large enough to hide the time-to-first-byte of remote data stores
+    // without holding much memory for each prefetched data store.
+    constexpr std::size_t prefix_size = 0x10'0000;  // 1 MiB
+
+    Intrusive_ptr<Input_stream> stream = store.open_read();
+
+    // Zero-copy streams are backed by memory that is already accessible,
+    // so reading ahead would not save us anything.
+    if (stream->supports_zero_copy()) {
+        return stream;
+    }
+
+    auto block = memory_allocator().allocate(prefix_size);
+
+    std::size_t num_bytes_read = stream->read(*block);
+
+    return make_intrusive<Prefixed_input_stream>(std::move(stream),
+                                                 Memory_slice{std::move(block)}.first(num_bytes_read));
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
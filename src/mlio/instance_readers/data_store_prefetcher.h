@@ -0,0 +1,132 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mlio/data_stores/data_store.h"
+#include "mlio/fwd.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/streams/input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Wraps a data store whose input stream has already been opened by a
+// Data_store_prefetcher.
+class Prefetched_data_store final : public Data_store {
+public:
+    explicit Prefetched_data_store(const Data_store &inner, Intrusive_ptr<Input_stream> stream)
+        : inner_{&inner}, stream_{std::move(stream)}
+    {}
+
+    // Returns the prefetched stream on the first call; subsequent calls
+    // open the underlying data store again.
+    Intrusive_ptr<Input_stream> open_read() const final;
+
+    std::optional<std::size_t> size_hint() const final
+    {
+        return inner_->size_hint();
+    }
+
+    std::string repr() const final
+    {
+        return inner_->repr();
+    }
+
+    const std::string &id() const final
+    {
+        return inner_->id();
+    }
+
+    // Indicates whether the prefetched stream has been opened.
+    bool stream_taken() const noexcept
+    {
+        return stream_ == nullptr;
+    }
+
+private:
+    const Data_store *inner_;
+    mutable Intrusive_ptr<Input_stream> stream_;
+};
+
+// Opens the upcoming data stores of a dataset in background and reads
+// their first bytes so that moving from one data store to the next does
+// not stall on the latency of opening it (e.g. an S3 request).
+class Data_store_prefetcher {
+    struct Entry {
+        Intrusive_ptr<Data_store> store{};
+        Intrusive_ptr<Input_stream> stream{};
+        std::exception_ptr exception{};
+        bool started{};
+        bool done{};
+    };
+
+    using Store_iterator = std::vector<Intrusive_ptr<Data_store>>::const_iterator;
+
+public:
+    explicit Data_store_prefetcher(std::size_t num_stores) noexcept : num_stores_{num_stores}
+    {}
+
+    Data_store_prefetcher(const Data_store_prefetcher &) = delete;
+
+    Data_store_prefetcher &operator=(const Data_store_prefetcher &) = delete;
+
+    Data_store_prefetcher(Data_store_prefetcher &&) = delete;
+
+    Data_store_prefetcher &operator=(Data_store_prefetcher &&) = delete;
+
+    ~Data_store_prefetcher();
+
+    // Starts opening up to num_stores data stores from the specified
+    // range. Previously scheduled data stores that are not at the front
+    // of the range are dropped.
+    void prefetch(Store_iterator first, Store_iterator last);
+
+    // Returns the specified data store as a Prefetched_data_store if it
+    // is the next one scheduled; otherwise, returns a null pointer. Any
+    // error that occurred while opening the data store is rethrown.
+    Intrusive_ptr<Prefetched_data_store> take(const Data_store &store);
+
+    void clear() noexcept;
+
+private:
+    void run();
+
+    static Intrusive_ptr<Input_stream> open_store(const Data_store &store);
+
+    std::size_t num_stores_;
+    std::deque<std::shared_ptr<Entry>> entries_{};
+    std::thread thread_{};
+    bool stopping_{};
+    std::mutex mutex_{};
+    std::condition_variable worker_condition_{};
+    std::condition_variable reader_condition_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
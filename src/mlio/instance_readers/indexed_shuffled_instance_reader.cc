@@ -0,0 +1,634 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/instance_readers/indexed_shuffled_instance_reader.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "mlio/data_reader.h"
+#include "mlio/data_reader_error.h"
+#include "mlio/detail/thread.h"
+#include "mlio/instance_readers/core_instance_reader.h"
+#include "mlio/instance_readers/instance_reader_base.h"
+#include "mlio/instance_readers/record_index.h"
+#include "mlio/instance_readers/sharded_instance_reader.h"
+#include "mlio/instance_readers/shuffled_instance_reader.h"
+#include "mlio/logger.h"
+#include "mlio/record_readers/record.h"
+#include "mlio/record_readers/record_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// Returns an empty instance for each indexed instance of the dataset so
+// that the ranged, sharded, and sampled instance readers can select the
+// very same instances that they would select from the sequential
+// dataset.
+class Location_instance_reader final : public Instance_reader_base {
+public:
+    explicit Location_instance_reader(const std::vector<Intrusive_ptr<Data_store>> &stores,
+                                      std::vector<std::size_t> num_instances) noexcept
+        : stores_{&stores}, num_instances_{std::move(num_instances)}
+    {}
+
+private:
+    std::optional<Instance> read_instance_core() final
+    {
+        while (store_idx_ < stores_->size()) {
+            if (instance_idx_ < num_instances_[store_idx_]) {
+                return Instance{*(*stores_)[store_idx_], instance_idx_++, Memory_slice{}};
+            }
+
+            store_idx_++;
+
+            instance_idx_ = 0;
+        }
+        return {};
+    }
+
+    void reset_core() noexcept final
+    {
+        store_idx_ = 0;
+
+        instance_idx_ = 0;
+    }
+
+    const std::vector<Intrusive_ptr<Data_store>> *stores_;
+    std::vector<std::size_t> num_instances_;
+    std::size_t store_idx_{};
+    std::size_t instance_idx_{};
+};
+
+}  // namespace
+
+Indexed_shuffled_instance_reader::Indexed_shuffled_instance_reader(
+    const Data_reader_params &params, Record_reader_factory &&factory)
+    : params_{&params}, record_reader_factory_{std::move(factory)}
+{
+    if (params_->num_shards > 1 && params_->sharding_strategy == Sharding_strategy::data_store) {
+        stores_ = shard_data_stores(*params_);
+    }
+    else {
+        stores_ = params_->dataset;
+    }
+
+    record_readers_.resize(stores_.size());
+
+    if (params_->shuffle_seed != std::nullopt) {
+        seed_ = *params_->shuffle_seed;
+
+        mt_.seed(seed_);
+    }
+}
+
+Indexed_shuffled_instance_reader::~Indexed_shuffled_instance_reader()
+{
+    stop();
+}
+
+std::optional<Instance> Indexed_shuffled_instance_reader::read_instance_core()
+{
+    if (!has_locations_) {
+        init_locations();
+
+        has_locations_ = true;
+    }
+
+    if (fallback_) {
+        return fallback_->read_instance();
+    }
+
+    if (!started_) {
+        if (should_shuffle_) {
+            should_shuffle_ = false;
+
+            std::shuffle(locations_.begin(), locations_.end(), mt_);
+        }
+
+        start();
+    }
+
+    while (window_pos_ == window_.instances.size()) {
+        if (num_locations_read_ == locations_.size()) {
+            return {};
+        }
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            reader_condition_.wait(lock, [this] {
+                return !windows_.empty();
+            });
+
+            window_ = std::move(windows_.front());
+
+            windows_.pop_front();
+        }
+
+        worker_condition_.notify_one();
+
+        window_pos_ = 0;
+
+        num_locations_read_ += window_.instances.size();
+
+        if (window_.exception) {
+            window_pos_ = window_.instances.size();
+
+            std::rethrow_exception(window_.exception);
+        }
+    }
+
+    return std::move(window_.instances[window_pos_++]);
+}
+
+void Indexed_shuffled_instance_reader::init_locations()
+{
+    locations_.clear();
+
+    layouts_.resize(stores_.size());
+
+    for (std::size_t store_idx = 0; store_idx < stores_.size(); store_idx++) {
+        bool indexed{};
+        try {
+            indexed = index_store(store_idx);
+        }
+        catch (const Data_reader_error &) {
+            throw;
+        }
+        catch (const std::exception &) {
+            std::throw_with_nested(Data_reader_error{fmt::format(
+                "The data store '{0}' cannot be indexed. See nested exception for details.",
+                stores_[store_idx]->id())});
+        }
+
+        if (!indexed) {
+            logger::warn(
+                "The data store '{0}' does not support random access. The dataset will be shuffled in memory.",
+                stores_[store_idx]->id());
+
+            init_fallback();
+
+            return;
+        }
+    }
+
+    select_locations();
+}
+
+bool Indexed_shuffled_instance_reader::index_store(std::size_t store_idx)
+{
+    const Data_store &store = *stores_[store_idx];
+
+    Stream_record_reader *reader = get_record_reader(store_idx);
+    if (reader == nullptr) {
+        return false;
+    }
+
+    Store_layout &layout = layouts_[store_idx];
+
+    std::optional<Record_index_key> key = make_record_index_key(store, *reader);
+
+    // Use the existing index regardless of its interval. We read the
+    // instances block by block, so a sparse index only means that we
+    // read more than we need; we do not overwrite it with a denser one.
+    std::optional<Record_index> index{};
+    if (key) {
+        index = load_record_index(store, *key);
+    }
+    if (index && index->interval() > 0 &&
+        index->offsets().size() ==
+            (index->num_instances() + index->interval() - 1) / index->interval()) {
+        layout.interval = index->interval();
+        layout.num_instances = index->num_instances();
+        layout.offsets = index->offsets();
+
+        return true;
+    }
+
+    logger::info("The data store '{0}' is being indexed.", store.id());
+
+    std::vector<std::size_t> offsets{};
+    std::vector<std::size_t> record_indices{};
+
+    std::size_t record_idx = 0;
+
+    std::optional<Record> record{};
+    for (; (record = reader->read_record()) != std::nullopt; record_idx++) {
+        if (record->kind() == Record_kind::complete || record->kind() == Record_kind::begin) {
+            offsets.emplace_back(reader->record_offset());
+
+            record_indices.emplace_back(record_idx);
+        }
+    }
+
+    layout.interval = 1;
+    layout.num_instances = offsets.size();
+    layout.offsets = offsets;
+
+    // Do not replace an existing, valid index that was built with a
+    // different interval.
+    if (key && index == std::nullopt) {
+        std::size_t num_instances = offsets.size();
+
+        save_record_index(
+            store,
+            Record_index{
+                std::move(*key), 1, num_instances, std::move(offsets), std::move(record_indices)});
+    }
+
+    return true;
+}
+
+void Indexed_shuffled_instance_reader::select_locations()
+{
+    std::vector<std::size_t> num_instances{};
+    num_instances.reserve(layouts_.size());
+
+    std::unordered_map<const Data_store *, std::size_t> store_indices{};
+    for (std::size_t store_idx = 0; store_idx < stores_.size(); store_idx++) {
+        num_instances.emplace_back(layouts_[store_idx].num_instances);
+
+        store_indices.emplace(stores_[store_idx].get(), store_idx);
+    }
+
+    // Apply the very same selection that would be applied to the
+    // sequential dataset so that the shuffled dataset consists of
+    // exactly the same instances.
+    std::unique_ptr<Instance_reader> reader = make_selecting_instance_reader(
+        *params_, std::make_unique<Location_instance_reader>(stores_, std::move(num_instances)));
+
+    std::optional<Instance> instance{};
+    while ((instance = reader->read_instance()) != std::nullopt) {
+        std::size_t store_idx = store_indices[&instance->data_store()];
+
+        locations_.push_back(Instance_location{store_idx, instance->index()});
+    }
+
+    locations_.shrink_to_fit();
+}
+
+void Indexed_shuffled_instance_reader::init_fallback()
+{
+    locations_.clear();
+
+    layouts_.clear();
+
+    record_readers_.clear();
+
+    open_store_indices_.clear();
+
+    std::unique_ptr<Instance_reader> reader = std::make_unique<Core_instance_reader>(
+        *params_, Record_reader_factory{record_reader_factory_});
+
+    reader = make_selecting_instance_reader(*params_, std::move(reader));
+
+    fallback_ = std::make_unique<Shuffled_instance_reader>(*params_, std::move(reader));
+}
+
+void Indexed_shuffled_instance_reader::start()
+{
+    started_ = true;
+
+    stopping_ = false;
+
+    next_location_ = 0;
+
+    window_ = {};
+
+    window_pos_ = 0;
+
+    num_locations_read_ = 0;
+
+    thread_ = start_thread(&Indexed_shuffled_instance_reader::run, this);
+}
+
+void Indexed_shuffled_instance_reader::stop() noexcept
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        stopping_ = true;
+    }
+
+    worker_condition_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    windows_.clear();
+
+    window_ = {};
+
+    started_ = false;
+}
+
+void Indexed_shuffled_instance_reader::run()
+{
+    while (true) {
+        std::size_t first{};
+        std::size_t last{};
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            worker_condition_.wait(lock, [this] {
+                return stopping_ || windows_.size() < max_num_windows_;
+            });
+
+            if (stopping_ || next_location_ == locations_.size()) {
+                return;
+            }
+
+            first = next_location_;
+        }
+
+        // Determine the extent of the window based on the size of the
+        // blocks we have to read.
+        std::size_t window_size = 0;
+        for (last = first; last < locations_.size() && last - first < max_window_length_;) {
+            auto [block_beg, block_end] = block_range(locations_[last]);
+            if (block_end) {
+                window_size += *block_end - block_beg;
+            }
+
+            last++;
+
+            if (window_size >= max_window_size_) {
+                break;
+            }
+        }
+
+        Window window = read_window(first, last);
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            if (stopping_) {
+                return;
+            }
+
+            windows_.emplace_back(std::move(window));
+
+            next_location_ = last;
+        }
+
+        reader_condition_.notify_one();
+    }
+}
+
+Indexed_shuffled_instance_reader::Window
+Indexed_shuffled_instance_reader::read_window(std::size_t first, std::size_t last)
+{
+    Window window{};
+
+    window.instances.resize(last - first);
+
+    // Read the instances in the order in which they are stored so that
+    // neighbouring ones can be read at once.
+    std::vector<std::size_t> order(last - first);
+    std::iota(order.begin(), order.end(), first);
+
+    std::sort(order.begin(), order.end(), [this](std::size_t lhs, std::size_t rhs) {
+        const Instance_location &l = locations_[lhs];
+        const Instance_location &r = locations_[rhs];
+
+        return l.store_idx < r.store_idx ||
+               (l.store_idx == r.store_idx && l.instance_idx < r.instance_idx);
+    });
+
+    // Coalesce the blocks of the instances into ranges.
+    std::size_t range_beg = 0;
+    for (std::size_t i = 1; i <= order.size(); i++) {
+        if (i < order.size()) {
+            const Instance_location &prev = locations_[order[i - 1]];
+            const Instance_location &next = locations_[order[i]];
+
+            if (prev.store_idx == next.store_idx) {
+                auto [prev_beg, prev_end] = block_range(prev);
+                auto [next_beg, next_end] = block_range(next);
+
+                if (prev_end && next_beg <= *prev_end + max_read_gap_) {
+                    continue;
+                }
+            }
+        }
+
+        try {
+            read_range(window, order, range_beg, i, first);
+        }
+        catch (const std::exception &) {
+            window.exception = std::current_exception();
+
+            return window;
+        }
+
+        range_beg = i;
+    }
+
+    return window;
+}
+
+void Indexed_shuffled_instance_reader::read_range(Window &window,
+                                                  const std::vector<std::size_t> &order,
+                                                  std::size_t first,
+                                                  std::size_t last,
+                                                  std::size_t window_pos)
+{
+    const Instance_location &first_location = locations_[order[first]];
+    const Instance_location &last_location = locations_[order[last - 1]];
+
+    std::size_t store_idx = first_location.store_idx;
+
+    const Store_layout &layout = layouts_[store_idx];
+
+    try {
+        Stream_record_reader *reader = get_record_reader(store_idx);
+        if (reader == nullptr) {
+            throw Corrupt_record_error{"The data store does not support random access anymore."};
+        }
+
+        // Read the whole range at once...
+        std::size_t range_beg = block_range(first_location).first;
+
+        std::optional<std::size_t> range_end = block_range(last_location).second;
+        if (range_end) {
+            reader->seek(range_beg, *range_end - range_beg);
+        }
+        else {
+            reader->seek(range_beg, std::numeric_limits<std::size_t>::max());
+        }
+
+        // and jump to the blocks within it, so that we only decode the
+        // instances of the blocks we need.
+        std::optional<std::size_t> block_idx{};
+
+        std::size_t instance_idx{};
+
+        for (std::size_t i = first; i < last; i++) {
+            const Instance_location &location = locations_[order[i]];
+
+            if (block_idx != location.instance_idx / layout.interval) {
+                block_idx = location.instance_idx / layout.interval;
+
+                auto [block_beg, block_end] = block_range(location);
+                if (block_end) {
+                    reader->seek(block_beg, *block_end - block_beg);
+                }
+                else {
+                    reader->seek(block_beg, std::numeric_limits<std::size_t>::max());
+                }
+
+                instance_idx = *block_idx * layout.interval;
+            }
+
+            // Decode and discard the instances of the block that precede
+            // the one we need.
+            std::optional<Instance> instance{};
+            while (instance_idx <= location.instance_idx) {
+                instance = read_next_instance(*reader, store_idx, instance_idx++);
+                if (instance == std::nullopt) {
+                    throw Corrupt_record_error{"The record index does not match the data store."};
+                }
+            }
+
+            window.instances[order[i] - window_pos] = std::move(instance);
+        }
+    }
+    catch (const Data_reader_error &) {
+        throw;
+    }
+    catch (const std::exception &) {
+        handle_errors(first_location);
+    }
+}
+
+std::pair<std::size_t, std::optional<std::size_t>>
+Indexed_shuffled_instance_reader::block_range(const Instance_location &location) const noexcept
+{
+    const Store_layout &layout = layouts_[location.store_idx];
+
+    std::size_t block_idx = location.instance_idx / layout.interval;
+
+    std::optional<std::size_t> end{};
+    if (block_idx + 1 < layout.offsets.size()) {
+        end = layout.offsets[block_idx + 1];
+    }
+
+    return {layout.offsets[block_idx], end};
+}
+
+Stream_record_reader *Indexed_shuffled_instance_reader::get_record_reader(std::size_t store_idx)
+{
+    Intrusive_ptr<Record_reader> &reader = record_readers_[store_idx];
+    if (reader == nullptr) {
+        if (open_store_indices_.size() == max_num_open_stores_) {
+            record_readers_[open_store_indices_.front()] = nullptr;
+
+            open_store_indices_.pop_front();
+        }
+
+        Intrusive_ptr<Record_reader> new_reader = record_reader_factory_(*stores_[store_idx]);
+
+        auto *stream_reader = dynamic_cast<Stream_record_reader *>(new_reader.get());
+        if (stream_reader == nullptr || !stream_reader->seekable()) {
+            return nullptr;
+        }
+
+        stream_reader->set_chunk_size_bounds(params_->min_chunk_size, params_->max_chunk_size);
+
+        reader = std::move(new_reader);
+
+        open_store_indices_.push_back(store_idx);
+    }
+
+    return static_cast<Stream_record_reader *>(reader.get());
+}
+
+std::optional<Instance>
+Indexed_shuffled_instance_reader::read_next_instance(Stream_record_reader &reader,
+                                                     std::size_t store_idx,
+                                                     std::size_t instance_idx)
+{
+    const Data_store &store = *stores_[store_idx];
+
+    std::optional<Record> record = reader.read_record();
+    if (record == std::nullopt) {
+        return {};
+    }
+
+    if (record->kind() == Record_kind::complete) {
+        return Instance{store, instance_idx, std::move(*record).payload()};
+    }
+
+    if (record->kind() != Record_kind::begin) {
+        throw Corrupt_record_error{"Corrupt split Record encountered."};
+    }
+
+    std::vector<Memory_slice> fragments{};
+
+    fragments.emplace_back(std::move(*record).payload());
+
+    while ((record = reader.read_record()) && record->kind() == Record_kind::middle) {
+        fragments.emplace_back(std::move(*record).payload());
+    }
+
+    if (record == std::nullopt || record->kind() != Record_kind::end) {
+        throw Corrupt_record_error{"Corrupt split Record encountered."};
+    }
+
+    fragments.emplace_back(std::move(*record).payload());
+
+    return Instance{store, instance_idx, std::move(fragments)};
+}
+
+void Indexed_shuffled_instance_reader::handle_errors(const Instance_location &location)
+{
+    std::throw_with_nested(Data_reader_error{fmt::format(
+        "The instance #{1:n} in the data store '{0}' cannot be read. See nested exception for details.",
+        stores_[location.store_idx]->id(),
+        location.instance_idx)});
+}
+
+void Indexed_shuffled_instance_reader::reset_core() noexcept
+{
+    if (fallback_) {
+        fallback_->reset();
+
+        return;
+    }
+
+    stop();
+
+    // If reshuffling is not requested, we simply replay the permutation
+    // of the first epoch.
+    if (params_->reshuffle_each_epoch) {
+        should_shuffle_ = true;
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "mlio/data_stores/data_store.h"
+#include "mlio/fwd.h"
+#include "mlio/instance.h"
+#include "mlio/instance_readers/instance_reader.h"
+#include "mlio/instance_readers/instance_reader_base.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/record_readers/record_reader.h"
+#include "mlio/record_readers/stream_record_reader.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Perfectly shuffles the dataset by reading the instances in random
+// order at their indexed offsets. Unlike Shuffled_instance_reader, the
+// memory consumption is proportional to the number of instances, not to
+// the size of the dataset.
+//
+// The instances are read by a background thread in windows. The reads
+// of a window are sorted by their offsets, and neighbouring ones are
+// coalesced into a single read. If the dataset contains a data store
+// that does not support random access, the reader falls back to
+// shuffling in memory.
+class Indexed_shuffled_instance_reader final : public Instance_reader_base {
+    struct Instance_location {
+        std::size_t store_idx;
+        std::size_t instance_idx;
+    };
+
+    // Holds the offsets of every Nth instance of a data store.
+    struct Store_layout {
+        std::size_t interval{};
+        std::size_t num_instances{};
+        std::vector<std::size_t> offsets{};
+    };
+
+    struct Window {
+        std::vector<std::optional<Instance>> instances{};
+        std::exception_ptr exception{};
+    };
+
+public:
+    explicit Indexed_shuffled_instance_reader(const Data_reader_params &params,
+                                              Record_reader_factory &&factory);
+
+    Indexed_shuffled_instance_reader(const Indexed_shuffled_instance_reader &) = delete;
+
+    Indexed_shuffled_instance_reader &
+    operator=(const Indexed_shuffled_instance_reader &) = delete;
+
+    Indexed_shuffled_instance_reader(Indexed_shuffled_instance_reader &&) = delete;
+
+    Indexed_shuffled_instance_reader &operator=(Indexed_shuffled_instance_reader &&) = delete;
+
+    ~Indexed_shuffled_instance_reader() final;
+
+private:
+    std::optional<Instance> read_instance_core() final;
+
+    void init_locations();
+
+    bool index_store(std::size_t store_idx);
+
+    void select_locations();
+
+    void init_fallback();
+
+    void start();
+
+    void stop() noexcept;
+
+    void run();
+
+    Window read_window(std::size_t first, std::size_t last);
+
+    void read_range(Window &window,
+                    const std::vector<std::size_t> &order,
+                    std::size_t first,
+                    std::size_t last,
+                    std::size_t window_pos);
+
+    // Returns the byte range of the indexed block that contains the
+    // specified instance. An empty end means the end of the data store.
+    std::pair<std::size_t, std::optional<std::size_t>>
+    block_range(const Instance_location &location) const noexcept;
+
+    Stream_record_reader *get_record_reader(std::size_t store_idx);
+
+    std::optional<Instance> read_next_instance(Stream_record_reader &reader,
+                                               std::size_t store_idx,
+                                               std::size_t instance_idx);
+
+    [[noreturn]] void handle_errors(const Instance_location &location);
+
+    void reset_core() noexcept final;
+
+    // The maximum number of data stores we keep open at any time.
+    static constexpr std::size_t max_num_open_stores_ = 64;
+    // The maximum number of instances and bytes read in a window.
+    static constexpr std::size_t max_window_length_ = 0x1000;   // 4096
+    static constexpr std::size_t max_window_size_ = 0x1000000;  // 16 MiB
+    // The maximum number of windows read ahead of the one that is being
+    // consumed.
+    static constexpr std::size_t max_num_windows_ = 1;
+    // The maximum gap in bytes between two blocks that are coalesced
+    // into a single read.
+    static constexpr std::size_t max_read_gap_ = 0x10000;  // 64 KiB
+
+    const Data_reader_params *params_;
+    Record_reader_factory record_reader_factory_;
+    std::vector<Intrusive_ptr<Data_store>> stores_{};
+    std::vector<Store_layout> layouts_{};
+    std::vector<Intrusive_ptr<Record_reader>> record_readers_{};
+    std::deque<std::size_t> open_store_indices_{};
+    std::vector<Instance_location> locations_{};
+    bool has_locations_{};
+    bool should_shuffle_ = true;
+    std::unique_ptr<Instance_reader> fallback_{};
+    std::random_device rd_{};
+    std::uint_fast64_t seed_{rd_()};
+    std::mt19937_64 mt_{seed_};
+
+    // The window that is being consumed.
+    Window window_{};
+    std::size_t window_pos_{};
+    std::size_t num_locations_read_{};
+
+    // The state shared with the background thread.
+    std::thread thread_{};
+    bool started_{};
+    bool stopping_{};
+    std::deque<Window> windows_{};
+    std::size_t next_location_{};
+    std::mutex mutex_{};
+    std::condition_variable worker_condition_{};
+    std::condition_variable reader_condition_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
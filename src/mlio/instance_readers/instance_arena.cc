@@ -0,0 +1,202 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/instance_readers/instance_arena.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mlio/memory/file_backed_memory_block.h"
+#include "mlio/memory/heap_memory_block.h"
+#include "mlio/memory/memory_slice.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Instance Instance_arena::pack(const Instance &instance)
+{
+    // Instances that represent a whole data store are loaded lazily;
+    // there is nothing to pack.
+    if (!instance.has_bits()) {
+        return instance;
+    }
+
+    std::size_t size = instance.size();
+    if (size == 0) {
+        return instance;
+    }
+
+    Page &page = find_page(size);
+
+    // Fragmented instances are merged while being packed.
+    auto pos = page.block->data() + page.num_bytes_used;
+    for (const Memory_slice &fragment : instance.fragments()) {
+        pos = std::copy(fragment.begin(), fragment.end(), pos);
+    }
+
+    Memory_slice slice = Memory_slice{page.block}.subslice(page.num_bytes_used, size);
+
+    page.num_bytes_used += size;
+    page.num_live_bytes += size;
+
+    num_used_bytes_ += size;
+    num_live_bytes_ += size;
+
+    return Instance{instance.data_store(), instance.index(), std::move(slice)};
+}
+
+Instance_arena::Page &Instance_arena::find_page(std::size_t size)
+{
+    if (current_page_ != nullptr &&
+        current_page_->block->size() - current_page_->num_bytes_used >= size) {
+        return *current_page_;
+    }
+
+    std::size_t block_size = std::max(size, page_size_);
+
+    // The current page is about to be replaced; if all of its instances
+    // have been released in the meantime, drop it before allocating the
+    // new page so that its heap budget becomes available again.
+    if (block_size == page_size_ && current_page_ != nullptr &&
+        current_page_->num_live_bytes == 0) {
+        drop_page(*std::exchange(current_page_, nullptr));
+    }
+
+    Page page{};
+
+    // Stay on the heap as long as we are below the threshold; beyond it
+    // let the kernel page the data out to a temporary file as needed.
+    if (num_heap_bytes_ + block_size <= memory_threshold_) {
+        page.block = make_intrusive<Heap_memory_block>(block_size);
+
+        num_heap_bytes_ += block_size;
+    }
+    else {
+        page.block = make_intrusive<File_backed_memory_block>(block_size);
+
+        page.file_backed = true;
+    }
+
+    auto [pos, inserted] = pages_.emplace(page.block->data(), std::move(page));
+
+    // An oversized page holds a single instance; we keep bump-allocating
+    // from the current page.
+    if (block_size == page_size_) {
+        current_page_ = &pos->second;
+    }
+
+    return pos->second;
+}
+
+void Instance_arena::release(const Instance &instance) noexcept
+{
+    Page *page = find_page_of(instance);
+    if (page == nullptr) {
+        return;
+    }
+
+    std::size_t size = instance.bits().size();
+
+    page->num_live_bytes -= size;
+
+    num_live_bytes_ -= size;
+
+    // The current page is kept even if empty as we still allocate from
+    // it. Any other page can be dropped; its memory will be freed once
+    // the last popped instance referencing it is destructed.
+    if (page->num_live_bytes == 0 && page != current_page_) {
+        drop_page(*page);
+    }
+}
+
+void Instance_arena::compact(std::vector<Instance> &instances)
+{
+    // Only compact once the dead bytes dominate the arena so that the
+    // amortized cost of moving instances stays constant.
+    std::size_t num_dead_bytes = num_used_bytes_ - num_live_bytes_;
+    if (num_dead_bytes < page_size_ || num_dead_bytes < num_live_bytes_) {
+        return;
+    }
+
+    for (Instance &instance : instances) {
+        Page *page = find_page_of(instance);
+        if (page == nullptr || page == current_page_) {
+            continue;
+        }
+
+        // Skip pages that are still at least half full.
+        if (page->num_live_bytes * 2 > page->num_bytes_used) {
+            continue;
+        }
+
+        Instance packed = pack(instance);
+
+        release(instance);
+
+        instance = std::move(packed);
+    }
+}
+
+void Instance_arena::clear() noexcept
+{
+    pages_.clear();
+
+    current_page_ = nullptr;
+
+    num_heap_bytes_ = 0;
+    num_used_bytes_ = 0;
+    num_live_bytes_ = 0;
+}
+
+Instance_arena::Page *Instance_arena::find_page_of(const Instance &instance) noexcept
+{
+    // Packed instances are never fragmented.
+    if (!instance.has_bits() || instance.has_fragments() || instance.bits().empty()) {
+        return nullptr;
+    }
+
+    const std::byte *data = instance.bits().data();
+
+    auto pos = pages_.upper_bound(data);
+    if (pos == pages_.begin()) {
+        return nullptr;
+    }
+
+    --pos;
+
+    if (data >= pos->first + pos->second.block->size()) {
+        return nullptr;
+    }
+
+    return &pos->second;
+}
+
+void Instance_arena::drop_page(const Page &page) noexcept
+{
+    if (!page.file_backed) {
+        num_heap_bytes_ -= page.block->size();
+    }
+
+    num_used_bytes_ -= page.num_bytes_used;
+
+    num_live_bytes_ -= page.num_live_bytes;
+
+    pages_.erase(page.block->data());
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "mlio/instance.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Packs the payloads of buffered instances contiguously into large
+// bump-allocated pages. Once the pages exceed a memory threshold, new
+// pages are backed by temporary files instead of the process heap.
+//
+// A page is freed once no instance references it anymore. To avoid
+// keeping mostly empty pages alive, the instances residing in sparse
+// pages are periodically moved to the current page.
+class Instance_arena {
+    struct Page {
+        Intrusive_ptr<Mutable_memory_block> block;
+        std::size_t num_bytes_used;
+        std::size_t num_live_bytes;
+        bool file_backed;
+    };
+
+public:
+    explicit Instance_arena(std::size_t memory_threshold) noexcept
+        : memory_threshold_{memory_threshold}
+    {}
+
+    // Returns a copy of the specified instance whose payload resides in
+    // the arena.
+    Instance pack(const Instance &instance);
+
+    // Marks the payload of an instance returned by pack() as no longer
+    // buffered.
+    void release(const Instance &instance) noexcept;
+
+    // Moves the instances that reside in sparse pages to the current
+    // page if the arena holds more dead bytes than live ones.
+    void compact(std::vector<Instance> &instances);
+
+    void clear() noexcept;
+
+    // Gets the number of bytes allocated from the pages of the arena,
+    // including the ones of released instances.
+    std::size_t num_used_bytes() const noexcept
+    {
+        return num_used_bytes_;
+    }
+
+    // Gets the number of bytes of the instances still buffered in the
+    // arena.
+    std::size_t num_live_bytes() const noexcept
+    {
+        return num_live_bytes_;
+    }
+
+private:
+    Page &find_page(std::size_t size);
+
+    Page *find_page_of(const Instance &instance) noexcept;
+
+    void drop_page(const Page &page) noexcept;
+
+    static constexpr std::size_t page_size_ = 0x4000000;  // 64 MiB
+
+    std::size_t memory_threshold_;
+    std::map<const std::byte *, Page> pages_{};
+    Page *current_page_{};
+    std::size_t num_heap_bytes_{};
+    std::size_t num_used_bytes_{};
+    std::size_t num_live_bytes_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
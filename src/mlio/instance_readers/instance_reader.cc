@@ -17,6 +17,8 @@
 
 #include "mlio/data_reader.h"
 #include "mlio/instance_readers/core_instance_reader.h"
+#include "mlio/instance_readers/indexed_shuffled_instance_reader.h"
+#include "mlio/instance_readers/interleaved_instance_reader.h"
 #include "mlio/instance_readers/ranged_instance_reader.h"
 #include "mlio/instance_readers/sampled_instance_reader.h"
 #include "mlio/instance_readers/sharded_instance_reader.h"
@@ -33,13 +35,37 @@ make_instance_reader(const Data_reader_params &params, Record_reader_factory &&f
 {
     std::unique_ptr<Instance_reader> reader{};
 
-    reader = std::make_unique<Core_instance_reader>(params, std::move(factory));
+    // A perfect shuffle over seekable data stores can be done by random
+    // access instead of buffering the whole dataset in memory.
+    if (params.shuffle_instances && params.shuffle_window == 0 && params.use_record_index) {
+        return std::make_unique<Indexed_shuffled_instance_reader>(params, std::move(factory));
+    }
+
+    if (params.interleave_cycle_length > 1) {
+        reader = std::make_unique<Interleaved_instance_reader>(params, std::move(factory));
+    }
+    else {
+        reader = std::make_unique<Core_instance_reader>(params, std::move(factory));
+    }
+
+    reader = make_selecting_instance_reader(params, std::move(reader));
 
+    if (params.shuffle_instances) {
+        reader = std::make_unique<Shuffled_instance_reader>(params, std::move(reader));
+    }
+
+    return reader;
+}
+
+std::unique_ptr<Instance_reader>
+make_selecting_instance_reader(const Data_reader_params &params,
+                               std::unique_ptr<Instance_reader> &&reader)
+{
     if (params.num_instances_to_skip > 0 || params.num_instances_to_read) {
         reader = std::make_unique<Ranged_instance_reader>(params, std::move(reader));
     }
 
-    if (params.num_shards > 1) {
+    if (params.num_shards > 1 && params.sharding_strategy == Sharding_strategy::instance) {
         reader = std::make_unique<Sharded_instance_reader>(params, std::move(reader));
     }
 
@@ -47,11 +73,7 @@ make_instance_reader(const Data_reader_params &params, Record_reader_factory &&f
         reader = std::make_unique<Sampled_instance_reader>(params, std::move(reader));
     }
 
-    if (params.shuffle_instances) {
-        reader = std::make_unique<Shuffled_instance_reader>(params, std::move(reader));
-    }
-
-    return reader;
+    return std::move(reader);
 }
 
 }  // namespace detail
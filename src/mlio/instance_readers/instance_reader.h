@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -45,6 +46,11 @@ public:
 
     virtual std::optional<Instance> peek_instance() = 0;
 
+    // Skips the specified number of instances and returns the number of
+    // instances actually skipped which is less than count only if the
+    // end of the dataset is reached.
+    virtual std::size_t skip_instances(std::size_t count) = 0;
+
     virtual void reset() noexcept = 0;
 };
 
@@ -53,6 +59,13 @@ using Record_reader_factory = std::function<Intrusive_ptr<Record_reader>(const D
 std::unique_ptr<Instance_reader>
 make_instance_reader(const Data_reader_params &params, Record_reader_factory &&factory);
 
+// Wraps the specified reader with the instance readers that select the
+// range, the shard, and the sample of the dataset as specified in the
+// parameters.
+std::unique_ptr<Instance_reader>
+make_selecting_instance_reader(const Data_reader_params &params,
+                               std::unique_ptr<Instance_reader> &&reader);
+
 }  // namespace detail
 }  // namespace abi_v1
 }  // namespace mlio
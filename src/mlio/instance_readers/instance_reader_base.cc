@@ -36,6 +36,30 @@ std::optional<Instance> Instance_reader_base::peek_instance()
     return peeked_instance_;
 }
 
+std::size_t Instance_reader_base::skip_instances(std::size_t count)
+{
+    std::size_t num_instances_skipped = 0;
+
+    if (count > 0 && peeked_instance_) {
+        peeked_instance_ = {};
+
+        num_instances_skipped++;
+    }
+
+    return num_instances_skipped + skip_instances_core(count - num_instances_skipped);
+}
+
+std::size_t Instance_reader_base::skip_instances_core(std::size_t count)
+{
+    std::size_t num_instances_skipped = 0;
+    for (; num_instances_skipped < count; num_instances_skipped++) {
+        if (read_instance_core() == std::nullopt) {
+            break;
+        }
+    }
+    return num_instances_skipped;
+}
+
 void Instance_reader_base::reset() noexcept
 {
     reset_core();
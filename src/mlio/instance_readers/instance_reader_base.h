@@ -31,8 +31,15 @@ public:
 
     std::optional<Instance> peek_instance() final;
 
+    std::size_t skip_instances(std::size_t count) final;
+
     void reset() noexcept final;
 
+protected:
+    // Reads and discards the instances by default; derived classes can
+    // override it if they have a faster way to skip.
+    virtual std::size_t skip_instances_core(std::size_t count);
+
 private:
     virtual std::optional<Instance> read_instance_core() = 0;
 
@@ -0,0 +1,377 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/instance_readers/interleaved_instance_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "mlio/data_reader.h"
+#include "mlio/detail/thread.h"
+#include "mlio/instance_readers/core_instance_reader.h"
+#include "mlio/instance_readers/sharded_instance_reader.h"
+#include "mlio/record_readers/record_reader.h"
+#include "mlio/streams/input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// Record reader factories are not required to be thread-safe, so we
+// call them under a lock. Since opening a data store is the expensive
+// part (e.g. an HTTP request for an S3 object), this proxy releases the
+// lock while the underlying data store is being opened.
+//
+// Note that slots call the factory in no particular order; a reader
+// must not infer anything from the order of the calls (e.g. the CSV
+// reader decides whether a data store has a header by its identity).
+class Unlocking_data_store final : public Data_store {
+public:
+    explicit Unlocking_data_store(const Data_store &inner, std::unique_lock<std::mutex> &lock)
+        : inner_{&inner}, lock_{&lock}
+    {}
+
+    Intrusive_ptr<Input_stream> open_read() const final
+    {
+        lock_->unlock();
+
+        Intrusive_ptr<Input_stream> stream{};
+        try {
+            stream = inner_->open_read();
+        }
+        catch (...) {
+            lock_->lock();
+
+            throw;
+        }
+
+        lock_->lock();
+
+        return stream;
+    }
+
+    std::optional<std::size_t> size_hint() const final
+    {
+        return inner_->size_hint();
+    }
+
+    std::string repr() const final
+    {
+        return inner_->repr();
+    }
+
+    const std::string &id() const final
+    {
+        return inner_->id();
+    }
+
+private:
+    const Data_store *inner_;
+    std::unique_lock<std::mutex> *lock_;
+};
+
+}  // namespace
+
+Interleaved_instance_reader::Interleaved_instance_reader(const Data_reader_params &params,
+                                                         Record_reader_factory &&factory)
+    : params_{&params}
+    , record_reader_factory_{std::move(factory)}
+    , block_length_{std::max(params.interleave_block_length, std::size_t{1})}
+    , slot_capacity_{std::max(block_length_ * 2, std::size_t{64})}
+{
+    if (params_->num_shards > 1 && params_->sharding_strategy == Sharding_strategy::data_store) {
+        stores_ = shard_data_stores(*params_);
+    }
+    else {
+        stores_ = params_->dataset;
+    }
+}
+
+Interleaved_instance_reader::~Interleaved_instance_reader()
+{
+    stop();
+}
+
+std::optional<Instance> Interleaved_instance_reader::read_instance_core()
+{
+    if (!started_) {
+        start();
+    }
+
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    Slot *slot{};
+    while ((slot = next_ready_slot(lock)) != nullptr) {
+        Slot_item item = std::move(slot->items.front());
+
+        slot->items.pop_front();
+
+        slot->condition.notify_one();
+
+        if (item.exception) {
+            slot->active = false;
+
+            num_active_slots_--;
+
+            lock.unlock();
+
+            std::rethrow_exception(item.exception);
+        }
+
+        if (item.instance) {
+            if (++num_instances_read_from_slot_ == block_length_) {
+                move_to_next_slot();
+            }
+
+            return std::move(item.instance);
+        }
+
+        // We have reached the end of the data store in this slot. In the
+        // deterministic mode the reader decides which data store comes
+        // next; otherwise the worker has already picked one.
+        if (params_->deterministic_interleave) {
+            if (next_store_idx_ < stores_.size()) {
+                slot->store_idx = next_store_idx_++;
+
+                slot->condition.notify_one();
+            }
+            else {
+                slot->active = false;
+
+                num_active_slots_--;
+            }
+        }
+        else if (!item.has_next_store) {
+            slot->active = false;
+
+            num_active_slots_--;
+        }
+
+        move_to_next_slot();
+    }
+
+    return {};
+}
+
+Interleaved_instance_reader::Slot *
+Interleaved_instance_reader::next_ready_slot(std::unique_lock<std::mutex> &lock)
+{
+    while (num_active_slots_ > 0) {
+        if (params_->deterministic_interleave) {
+            // Round-robin over the active slots and wait for the current
+            // one even if others have data.
+            while (!slots_[slot_idx_].active) {
+                move_to_next_slot();
+            }
+
+            Slot &slot = slots_[slot_idx_];
+
+            reader_condition_.wait(lock, [&slot] {
+                return !slot.items.empty();
+            });
+
+            return &slot;
+        }
+
+        // Otherwise return the first active slot that has data, starting
+        // from the current one.
+        for (std::size_t i = 0; i < slots_.size(); i++) {
+            std::size_t idx = (slot_idx_ + i) % slots_.size();
+
+            Slot &slot = slots_[idx];
+            if (slot.active && !slot.items.empty()) {
+                if (idx != slot_idx_) {
+                    slot_idx_ = idx;
+
+                    num_instances_read_from_slot_ = 0;
+                }
+                return &slot;
+            }
+        }
+
+        reader_condition_.wait(lock);
+    }
+
+    return nullptr;
+}
+
+void Interleaved_instance_reader::move_to_next_slot() noexcept
+{
+    slot_idx_ = (slot_idx_ + 1) % slots_.size();
+
+    num_instances_read_from_slot_ = 0;
+}
+
+void Interleaved_instance_reader::start()
+{
+    started_ = true;
+
+    stopping_ = false;
+
+    std::size_t num_slots = std::min(params_->interleave_cycle_length, stores_.size());
+
+    slots_ = std::vector<Slot>(num_slots);
+
+    for (Slot &slot : slots_) {
+        slot.store_idx = next_store_idx_++;
+
+        slot.active = true;
+    }
+
+    num_active_slots_ = num_slots;
+
+    for (std::size_t i = 0; i < num_slots; i++) {
+        slots_[i].thread = start_thread(&Interleaved_instance_reader::run_slot, this, i);
+    }
+}
+
+void Interleaved_instance_reader::stop() noexcept
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        stopping_ = true;
+    }
+
+    for (Slot &slot : slots_) {
+        slot.condition.notify_one();
+    }
+
+    for (Slot &slot : slots_) {
+        if (slot.thread.joinable()) {
+            slot.thread.join();
+        }
+    }
+
+    slots_.clear();
+
+    started_ = false;
+
+    next_store_idx_ = 0;
+
+    slot_idx_ = 0;
+
+    num_instances_read_from_slot_ = 0;
+
+    num_active_slots_ = 0;
+}
+
+void Interleaved_instance_reader::run_slot(std::size_t slot_idx)
+{
+    Slot &slot = slots_[slot_idx];
+
+    while (true) {
+        std::size_t store_idx{};
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            slot.condition.wait(lock, [this, &slot] {
+                return stopping_ || slot.store_idx != std::nullopt;
+            });
+
+            if (stopping_) {
+                return;
+            }
+
+            store_idx = *slot.store_idx;
+
+            slot.store_idx = std::nullopt;
+        }
+
+        try {
+            read_store(slot, store_idx);
+        }
+        catch (...) {
+            push_item(slot, Slot_item{{}, std::current_exception()});
+
+            return;
+        }
+
+        Slot_item end_item{};
+
+        if (!params_->deterministic_interleave) {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            if (next_store_idx_ < stores_.size()) {
+                slot.store_idx = next_store_idx_++;
+
+                end_item.has_next_store = true;
+            }
+        }
+
+        if (!push_item(slot, std::move(end_item))) {
+            return;
+        }
+    }
+}
+
+void Interleaved_instance_reader::read_store(Slot &slot, std::size_t store_idx)
+{
+    Core_instance_reader reader{
+        *params_,
+        [this](const Data_store &store) {
+            return make_record_reader(store);
+        },
+        {stores_[store_idx]}};
+
+    std::optional<Instance> instance{};
+    while ((instance = reader.read_instance()) != std::nullopt) {
+        if (!push_item(slot, Slot_item{std::move(instance)})) {
+            return;
+        }
+    }
+}
+
+bool Interleaved_instance_reader::push_item(Slot &slot, Slot_item &&item)
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        slot.condition.wait(lock, [this, &slot] {
+            return stopping_ || slot.items.size() < slot_capacity_;
+        });
+
+        if (stopping_) {
+            return false;
+        }
+
+        slot.items.emplace_back(std::move(item));
+    }
+
+    reader_condition_.notify_one();
+
+    return true;
+}
+
+Intrusive_ptr<Record_reader> Interleaved_instance_reader::make_record_reader(const Data_store &store)
+{
+    std::unique_lock<std::mutex> lock{factory_mutex_};
+
+    auto proxy = make_intrusive<Unlocking_data_store>(store, lock);
+
+    return record_reader_factory_(*proxy);
+}
+
+void Interleaved_instance_reader::reset_core() noexcept
+{
+    stop();
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
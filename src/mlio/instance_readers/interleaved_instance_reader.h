@@ -0,0 +1,114 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "mlio/data_stores/data_store.h"
+#include "mlio/fwd.h"
+#include "mlio/instance.h"
+#include "mlio/instance_readers/instance_reader.h"
+#include "mlio/instance_readers/instance_reader_base.h"
+#include "mlio/intrusive_ptr.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Reads multiple data stores concurrently and interleaves their
+// instances. Each slot of the cycle is read by its own background
+// thread; once a data store is exhausted, the next data store of the
+// dataset takes over its slot.
+class Interleaved_instance_reader final : public Instance_reader_base {
+    // Represents an instance, an error, or the end of a data store.
+    struct Slot_item {
+        std::optional<Instance> instance{};
+        std::exception_ptr exception{};
+        bool has_next_store{};
+    };
+
+    struct Slot {
+        std::deque<Slot_item> items{};
+        std::optional<std::size_t> store_idx{};
+        bool active{};
+        std::thread thread{};
+        // Wakes up the worker of the slot when there is room for more
+        // items, a data store to read, or when the reader is stopping.
+        std::condition_variable condition{};
+    };
+
+public:
+    explicit Interleaved_instance_reader(const Data_reader_params &params,
+                                         Record_reader_factory &&factory);
+
+    Interleaved_instance_reader(const Interleaved_instance_reader &) = delete;
+
+    Interleaved_instance_reader &operator=(const Interleaved_instance_reader &) = delete;
+
+    Interleaved_instance_reader(Interleaved_instance_reader &&) = delete;
+
+    Interleaved_instance_reader &operator=(Interleaved_instance_reader &&) = delete;
+
+    ~Interleaved_instance_reader() final;
+
+private:
+    std::optional<Instance> read_instance_core() final;
+
+    Slot *next_ready_slot(std::unique_lock<std::mutex> &lock);
+
+    void move_to_next_slot() noexcept;
+
+    void start();
+
+    void stop() noexcept;
+
+    void run_slot(std::size_t slot_idx);
+
+    void read_store(Slot &slot, std::size_t store_idx);
+
+    bool push_item(Slot &slot, Slot_item &&item);
+
+    Intrusive_ptr<Record_reader> make_record_reader(const Data_store &store);
+
+    void reset_core() noexcept final;
+
+    const Data_reader_params *params_;
+    Record_reader_factory record_reader_factory_;
+    std::vector<Intrusive_ptr<Data_store>> stores_{};
+    std::size_t block_length_;
+    std::size_t slot_capacity_;
+    std::vector<Slot> slots_{};
+    std::size_t next_store_idx_{};
+    std::size_t slot_idx_{};
+    std::size_t num_instances_read_from_slot_{};
+    std::size_t num_active_slots_{};
+    bool started_{};
+    bool stopping_{};
+    std::mutex mutex_{};
+    std::mutex factory_mutex_{};
+    std::condition_variable reader_condition_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -34,11 +34,9 @@ std::optional<Instance> Ranged_instance_reader::read_instance_core()
     if (first_read_) {
         first_read_ = false;
 
-        for (std::size_t i = 0; i < params_->num_instances_to_skip; i++) {
-            std::optional<Instance> instance = inner_->read_instance();
-            if (instance == std::nullopt) {
-                return {};
-            }
+        std::size_t num_instances_skipped = inner_->skip_instances(params_->num_instances_to_skip);
+        if (num_instances_skipped < params_->num_instances_to_skip) {
+            return {};
         }
     }
 
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/instance_readers/record_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "mlio/config.h"
+#include "mlio/data_stores/data_store.h"
+#include "mlio/data_stores/file.h"
+#include "mlio/logger.h"
+#include "mlio/record_readers/stream_record_reader.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::array<char, 8> index_magic{'M', 'L', 'I', 'O', 'I', 'D', 'X', '3'};
+
+// The index is a local cache of the data store, so we simply use the
+// native representation of the offsets.
+bool read_size(std::istream &s, std::size_t &value)
+{
+    return static_cast<bool>(s.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+void write_size(std::ostream &s, std::size_t value)
+{
+    s.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool read_key(std::istream &s, Record_index_key &key)
+{
+    std::size_t mtime{};
+    std::size_t framing_size{};
+    if (!read_size(s, key.store_size) || !read_size(s, mtime) ||
+        !read_size(s, key.start_offset) || !read_size(s, framing_size)) {
+        return false;
+    }
+
+    key.store_mtime = static_cast<std::int64_t>(mtime);
+
+    // Guard against allocating a huge string for a corrupt index.
+    constexpr std::size_t max_framing_size = 0x10000;
+    if (framing_size > max_framing_size) {
+        return false;
+    }
+
+    key.framing.resize(framing_size);
+
+    return static_cast<bool>(s.read(key.framing.data(), static_cast<std::streamsize>(framing_size)));
+}
+
+void write_key(std::ostream &s, const Record_index_key &key)
+{
+    write_size(s, key.store_size);
+    write_size(s, static_cast<std::size_t>(key.store_mtime));
+    write_size(s, key.start_offset);
+    write_size(s, key.framing.size());
+
+    s.write(key.framing.data(), static_cast<std::streamsize>(key.framing.size()));
+}
+
+// Makes a key that only identifies the version of the data store; the
+// framing parts are left empty.
+std::optional<Record_index_key> make_store_version_key(const Data_store &store)
+{
+    if (record_index_path(store) == std::nullopt) {
+        return {};
+    }
+
+    struct ::stat buf = {};
+    if (::stat(store.id().c_str(), &buf) == -1) {
+        return {};
+    }
+
+#ifdef MLIO_PLATFORM_LINUX
+    const ::timespec &mtime = buf.st_mtim;
+#else
+    const ::timespec &mtime = buf.st_mtimespec;
+#endif
+
+    std::int64_t mtime_sec = mtime.tv_sec;
+    std::int64_t mtime_nsec = mtime.tv_nsec;
+
+    Record_index_key key{};
+    key.store_size = static_cast<std::size_t>(buf.st_size);
+    key.store_mtime = mtime_sec * 1'000'000'000 + mtime_nsec;
+
+    return key;
+}
+
+std::optional<Record_index> read_record_index(const std::string &path)
+{
+    std::ifstream s{path, std::ios::binary};
+    if (!s) {
+        return {};
+    }
+
+    std::array<char, 8> magic{};
+    if (!s.read(magic.data(), magic.size()) || magic != index_magic) {
+        logger::warn("The record index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    Record_index_key key{};
+    std::size_t interval{};
+    std::size_t num_instances{};
+    std::size_t num_offsets{};
+    if (!read_key(s, key) || !read_size(s, interval) || !read_size(s, num_instances) ||
+        !read_size(s, num_offsets)) {
+        logger::warn("The record index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    // There cannot be more offsets than instances; this also guards
+    // against allocating a huge vector for a corrupt index.
+    if (num_offsets > num_instances || num_offsets > key.store_size) {
+        logger::warn("The record index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    std::vector<std::size_t> offsets(num_offsets);
+    for (std::size_t &offset : offsets) {
+        if (!read_size(s, offset)) {
+            logger::warn("The record index '{0}' is invalid and will be ignored.", path);
+
+            return {};
+        }
+    }
+
+    std::vector<std::size_t> record_indices(num_offsets);
+    for (std::size_t &record_idx : record_indices) {
+        if (!read_size(s, record_idx)) {
+            logger::warn("The record index '{0}' is invalid and will be ignored.", path);
+
+            return {};
+        }
+    }
+
+    return Record_index{
+        std::move(key), interval, num_instances, std::move(offsets), std::move(record_indices)};
+}
+
+}  // namespace
+
+bool operator==(const Record_index_key &lhs, const Record_index_key &rhs) noexcept
+{
+    return lhs.store_size == rhs.store_size && lhs.store_mtime == rhs.store_mtime &&
+           lhs.start_offset == rhs.start_offset && lhs.framing == rhs.framing;
+}
+
+Record_index_entry Record_index::lookup(std::size_t instance_idx) const noexcept
+{
+    if (offsets_.empty() || interval_ == 0) {
+        return {};
+    }
+
+    std::size_t entry = std::min(instance_idx / interval_, offsets_.size() - 1);
+
+    return {entry * interval_, record_indices_[entry], offsets_[entry]};
+}
+
+std::optional<std::string> record_index_path(const Data_store &store)
+{
+    // Only local files have a natural place for a sidecar index.
+    if (dynamic_cast<const File *>(&store) == nullptr) {
+        return {};
+    }
+    return store.id() + ".mlioidx";
+}
+
+std::optional<Record_index_key>
+make_record_index_key(const Data_store &store, const Stream_record_reader &reader)
+{
+    std::optional<Record_index_key> key = make_store_version_key(store);
+    if (key == std::nullopt) {
+        return {};
+    }
+
+    key->framing = reader.framing_key();
+    if (key->framing.empty()) {
+        return {};
+    }
+
+    key->start_offset = reader.position();
+
+    return key;
+}
+
+std::optional<Record_index> load_record_index(const Data_store &store, const Record_index_key &key)
+{
+    std::optional<std::string> path = record_index_path(store);
+    if (path == std::nullopt) {
+        return {};
+    }
+
+    std::optional<Record_index> index = read_record_index(*path);
+    if (index == std::nullopt) {
+        return {};
+    }
+
+    // An index that was built for an earlier version of the data store,
+    // or by a reader that frames its records differently, is of no use.
+    if (index->key() != key) {
+        logger::info("The record index '{0}' is stale and will be ignored.", *path);
+
+        return {};
+    }
+
+    return index;
+}
+
+std::optional<Record_index> load_record_index(const Data_store &store, std::string_view framing)
+{
+    std::optional<std::string> path = record_index_path(store);
+    if (path == std::nullopt || framing.empty()) {
+        return {};
+    }
+
+    std::optional<Record_index_key> key = make_store_version_key(store);
+    if (key == std::nullopt) {
+        return {};
+    }
+
+    std::optional<Record_index> index = read_record_index(*path);
+    if (index == std::nullopt) {
+        return {};
+    }
+
+    const Record_index_key &index_key = index->key();
+    if (index_key.store_size != key->store_size || index_key.store_mtime != key->store_mtime ||
+        index_key.framing != framing) {
+        logger::info("The record index '{0}' is stale and will be ignored.", *path);
+
+        return {};
+    }
+
+    return index;
+}
+
+void save_record_index(const Data_store &store, const Record_index &index) noexcept
+{
+    std::optional<std::string> path = record_index_path(store);
+    if (path == std::nullopt) {
+        return;
+    }
+
+    try {
+        // Write to a temporary file first so that concurrent readers
+        // never observe a partially written index.
+        std::string tmp_path = fmt::format("{0}.{1}", *path, ::getpid());
+
+        {
+            std::ofstream s{tmp_path, std::ios::binary | std::ios::trunc};
+
+            s.write(index_magic.data(), index_magic.size());
+
+            write_key(s, index.key());
+            write_size(s, index.interval());
+            write_size(s, index.num_instances());
+            write_size(s, index.offsets().size());
+
+            for (std::size_t offset : index.offsets()) {
+                write_size(s, offset);
+            }
+
+            for (std::size_t record_idx : index.record_indices()) {
+                write_size(s, record_idx);
+            }
+
+            if (!s.flush()) {
+                std::remove(tmp_path.c_str());
+
+                logger::warn("The record index '{0}' cannot be written.", *path);
+
+                return;
+            }
+        }
+
+        if (std::rename(tmp_path.c_str(), path->c_str()) != 0) {
+            std::remove(tmp_path.c_str());
+
+            logger::warn("The record index '{0}' cannot be written.", *path);
+
+            return;
+        }
+
+        logger::info("The record index '{0}' has been written.", *path);
+    }
+    catch (const std::exception &) {
+        logger::warn("The record index '{0}' cannot be written.", *path);
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
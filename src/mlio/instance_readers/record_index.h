@@ -0,0 +1,141 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mlio/fwd.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Identifies the version of a data store along with the way its records
+// are framed. An index is only valid for the key it was built with.
+struct Record_index_key {
+    std::size_t store_size{};
+    std::int64_t store_mtime{};
+    // The position of the record reader right after it got created;
+    // differs if e.g. a different number of header rows is skipped.
+    std::size_t start_offset{};
+    std::string framing{};
+};
+
+bool operator==(const Record_index_key &lhs, const Record_index_key &rhs) noexcept;
+
+inline bool operator!=(const Record_index_key &lhs, const Record_index_key &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+// Describes where an indexed instance starts in a data store.
+struct Record_index_entry {
+    std::size_t instance_idx{};
+    // The number of records that precede the instance; differs from the
+    // instance index if records are split.
+    std::size_t record_idx{};
+    std::size_t offset{};
+};
+
+// Holds the byte offsets and the record numbers of every Nth instance of
+// a data store along with the total number of instances in it.
+class Record_index {
+public:
+    explicit Record_index(Record_index_key key,
+                          std::size_t interval,
+                          std::size_t num_instances,
+                          std::vector<std::size_t> offsets,
+                          std::vector<std::size_t> record_indices) noexcept
+        : key_{std::move(key)}
+        , interval_{interval}
+        , num_instances_{num_instances}
+        , offsets_{std::move(offsets)}
+        , record_indices_{std::move(record_indices)}
+    {}
+
+    // Returns the closest indexed instance that precedes or equals the
+    // specified instance.
+    Record_index_entry lookup(std::size_t instance_idx) const noexcept;
+
+    const Record_index_key &key() const noexcept
+    {
+        return key_;
+    }
+
+    std::size_t interval() const noexcept
+    {
+        return interval_;
+    }
+
+    std::size_t num_instances() const noexcept
+    {
+        return num_instances_;
+    }
+
+    const std::vector<std::size_t> &offsets() const noexcept
+    {
+        return offsets_;
+    }
+
+    const std::vector<std::size_t> &record_indices() const noexcept
+    {
+        return record_indices_;
+    }
+
+private:
+    Record_index_key key_;
+    std::size_t interval_;
+    std::size_t num_instances_;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> record_indices_;
+};
+
+// Returns the path of the sidecar index file of the specified data
+// store, or an empty value if the data store cannot have one.
+std::optional<std::string> record_index_path(const Data_store &store);
+
+// Makes the key of the index of the specified data store that is read
+// by the specified record reader. Must be called before any record is
+// read. Returns an empty value if the version of the data store cannot
+// be determined or if the reader does not have a framing key.
+std::optional<Record_index_key>
+make_record_index_key(const Data_store &store, const Stream_record_reader &reader);
+
+// Loads the index of the specified data store. Returns an empty value
+// if the data store has no index or if the index was built with a
+// different key.
+std::optional<Record_index> load_record_index(const Data_store &store, const Record_index_key &key);
+
+// Loads the index of the specified data store without opening it. The
+// index is only returned if it was built for the current version of the
+// data store by a reader with the specified framing; since the start
+// offset cannot be checked, the framing must determine it.
+std::optional<Record_index> load_record_index(const Data_store &store, std::string_view framing);
+
+// Saves the index of the specified data store to its sidecar file.
+// Failures are logged and otherwise ignored since the index is only an
+// optimization.
+void save_record_index(const Data_store &store, const Record_index &index) noexcept;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
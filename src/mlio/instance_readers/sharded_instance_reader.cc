@@ -15,6 +15,9 @@
 
 #include "mlio/instance_readers/sharded_instance_reader.h"
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 #include <utility>
 
 #include "mlio/data_reader.h"
@@ -23,14 +26,22 @@
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
+namespace {
+
+void validate_shard_index(const Data_reader_params &params)
+{
+    if (params.shard_index >= params.num_shards) {
+        throw std::invalid_argument{"The shard index must be less than the number of shards."};
+    }
+}
+
+}  // namespace
 
 Sharded_instance_reader::Sharded_instance_reader(const Data_reader_params &params,
                                                  std::unique_ptr<Instance_reader> &&inner)
     : params_{&params}, inner_{std::move(inner)}
 {
-    if (params_->shard_index >= params_->num_shards) {
-        throw std::invalid_argument{"The shard index must be less than the number of shards."};
-    }
+    validate_shard_index(*params_);
 }
 
 std::optional<Instance> Sharded_instance_reader::read_instance_core()
@@ -63,6 +74,65 @@ void Sharded_instance_reader::reset_core() noexcept
     first_read_ = true;
 }
 
+std::vector<Intrusive_ptr<Data_store>> shard_data_stores(const Data_reader_params &params)
+{
+    validate_shard_index(params);
+
+    const std::vector<Intrusive_ptr<Data_store>> &dataset = params.dataset;
+
+    std::vector<std::size_t> sizes(dataset.size());
+
+    bool has_sizes = true;
+    for (std::size_t i = 0; i < dataset.size(); i++) {
+        std::optional<std::size_t> size = dataset[i]->size_hint();
+        if (size == std::nullopt) {
+            has_sizes = false;
+
+            break;
+        }
+        sizes[i] = *size;
+    }
+
+    std::vector<std::size_t> shard_indices(dataset.size());
+
+    if (has_sizes) {
+        // Greedily assign the largest remaining data store to the shard
+        // with the least number of bytes so far.
+        std::vector<std::size_t> order(dataset.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::stable_sort(order.begin(), order.end(), [&sizes](std::size_t a, std::size_t b) {
+            return sizes[a] > sizes[b];
+        });
+
+        std::vector<std::size_t> shard_sizes(params.num_shards);
+        for (std::size_t i : order) {
+            auto pos = std::min_element(shard_sizes.begin(), shard_sizes.end());
+
+            *pos += sizes[i];
+
+            shard_indices[i] = static_cast<std::size_t>(pos - shard_sizes.begin());
+        }
+    }
+    else {
+        // If we cannot tell the size of a data store, fall back to a
+        // plain round-robin assignment.
+        for (std::size_t i = 0; i < dataset.size(); i++) {
+            shard_indices[i] = i % params.num_shards;
+        }
+    }
+
+    // Preserve the original order of the data stores within the shard.
+    std::vector<Intrusive_ptr<Data_store>> stores{};
+    for (std::size_t i = 0; i < dataset.size(); i++) {
+        if (shard_indices[i] == params.shard_index) {
+            stores.emplace_back(dataset[i]);
+        }
+    }
+
+    return stores;
+}
+
 }  // namespace detail
 }  // namespace abi_v1
 }  // namespace mlio
@@ -18,10 +18,13 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <vector>
 
+#include "mlio/data_stores/data_store.h"
 #include "mlio/fwd.h"
 #include "mlio/instance_readers/instance_reader.h"
 #include "mlio/instance_readers/instance_reader_base.h"
+#include "mlio/intrusive_ptr.h"
 
 namespace mlio {
 inline namespace abi_v1 {
@@ -42,6 +45,11 @@ private:
     bool first_read_ = true;
 };
 
+// Returns the data stores of the dataset that are assigned to the shard
+// specified in params. The assignment is deterministic so that all
+// shards agree on it.
+std::vector<Intrusive_ptr<Data_store>> shard_data_stores(const Data_reader_params &params);
+
 }  // namespace detail
 }  // namespace abi_v1
 }  // namespace mlio
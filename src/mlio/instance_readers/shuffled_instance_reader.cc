@@ -42,6 +42,10 @@ Shuffled_instance_reader::Shuffled_instance_reader(const Data_reader_params &par
         buffer_.reserve(shuffle_window_);
     }
 
+    if (params_->shuffle_buffer_memory_threshold != std::nullopt) {
+        arena_ = std::make_unique<Instance_arena>(*params_->shuffle_buffer_memory_threshold);
+    }
+
     if (params_->shuffle_seed != std::nullopt) {
         seed_ = *params_->shuffle_seed;
 
@@ -65,11 +69,7 @@ std::optional<Instance> Shuffled_instance_reader::read_instance_core()
         return pop_random_instance_from_buffer();
     }
 
-    Instance instance = std::move(buffer_.back());
-
-    buffer_.pop_back();
-
-    return std::move(instance);
+    return pop_instance_from_buffer(buffer_.size() - 1);
 }
 
 void Shuffled_instance_reader::fill_buffer_from_inner()
@@ -84,23 +84,37 @@ void Shuffled_instance_reader::fill_buffer_from_inner()
             break;
         }
 
-        buffer_.emplace_back(std::move(*instance));
+        if (arena_ != nullptr) {
+            buffer_.emplace_back(arena_->pack(*instance));
+        }
+        else {
+            buffer_.emplace_back(std::move(*instance));
+        }
     }
 }
 
 std::optional<Instance> Shuffled_instance_reader::pop_random_instance_from_buffer()
 {
-    std::size_t random_idx = dist_(mt_);
+    return pop_instance_from_buffer(dist_(mt_));
+}
 
-    Instance instance = std::move(buffer_[random_idx]);
+Instance Shuffled_instance_reader::pop_instance_from_buffer(std::size_t idx)
+{
+    Instance instance = std::move(buffer_[idx]);
 
-    if (random_idx != buffer_.size() - 1) {
-        buffer_[random_idx] = std::move(buffer_.back());
+    if (idx != buffer_.size() - 1) {
+        buffer_[idx] = std::move(buffer_.back());
     }
 
     buffer_.pop_back();
 
-    return std::move(instance);
+    if (arena_ != nullptr) {
+        arena_->release(instance);
+
+        arena_->compact(buffer_);
+    }
+
+    return instance;
 }
 
 void Shuffled_instance_reader::reset_core() noexcept
@@ -109,6 +123,10 @@ void Shuffled_instance_reader::reset_core() noexcept
 
     buffer_.clear();
 
+    if (arena_ != nullptr) {
+        arena_->clear();
+    }
+
     inner_has_instance_ = true;
 
     // Make sure that we reset the random number generator engine to
@@ -24,6 +24,7 @@
 #include "mlio/fwd.h"
 #include "mlio/instance.h"
 #include "mlio/instance_readers/instance_reader.h"
+#include "mlio/instance_readers/instance_arena.h"
 #include "mlio/instance_readers/instance_reader_base.h"
 
 namespace mlio {
@@ -42,12 +43,15 @@ private:
 
     std::optional<Instance> pop_random_instance_from_buffer();
 
+    Instance pop_instance_from_buffer(std::size_t idx);
+
     void reset_core() noexcept final;
 
     const Data_reader_params *params_;
     std::unique_ptr<Instance_reader> inner_;
     std::size_t shuffle_window_;
     std::vector<Instance> buffer_{};
+    std::unique_ptr<Instance_arena> arena_{};
     bool inner_has_instance_ = true;
     std::random_device rd_{};
     std::uint_fast64_t seed_{rd_()};
@@ -16,6 +16,7 @@
 #include "mlio/memory/file_mapped_memory_block.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <system_error>
 #include <utility>
 
@@ -34,7 +35,9 @@ using mlio::detail::File_descriptor;
 namespace mlio {
 inline namespace abi_v1 {
 
-File_mapped_memory_block::File_mapped_memory_block(std::string path) : path_{std::move(path)}
+File_mapped_memory_block::File_mapped_memory_block(std::string path,
+                                                   const Memory_map_options &opts)
+    : path_{std::move(path)}, populate_{opts.populate}, huge_pages_{opts.huge_pages}
 {
     detail::validate_file_path(path_);
 
@@ -65,13 +68,71 @@ void File_mapped_memory_block::init_memory_map()
         return;
     }
 
-    void *address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate_) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+
+    // In order to align the mapping to a huge page boundary we reserve
+    // an address range large enough to contain an aligned one, map the
+    // file over it, and return the excess.
+    void *reservation = nullptr;
+    std::size_t reservation_size = 0;
+    void *hint = nullptr;
+    if (huge_pages_) {
+        reservation_size = size_ + huge_page_size_;
+
+        reservation = ::mmap(
+            nullptr, reservation_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+        if (reservation == MAP_FAILED) {
+            throw std::system_error{current_error_code(), "The file cannot be memory mapped."};
+        }
+
+        auto addr = reinterpret_cast<std::uintptr_t>(reservation);
+
+        hint = reinterpret_cast<void *>((addr + huge_page_size_ - 1) & ~(huge_page_size_ - 1));
+
+        flags |= MAP_FIXED;
+    }
+
+    void *address = ::mmap(hint, size_, PROT_READ, flags, fd.get(), 0);
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
     if (address == MAP_FAILED) {
-        throw std::system_error{current_error_code(), "The file cannot be memory mapped."};
+        std::error_code err = current_error_code();
+
+        if (reservation != nullptr) {
+            ::munmap(reservation, reservation_size);
+        }
+
+        throw std::system_error{err, "The file cannot be memory mapped."};
     }
 
     data_ = static_cast<std::byte *>(address);
+
+    if (reservation != nullptr) {
+        auto *first = static_cast<std::byte *>(reservation);
+        auto *last = first + reservation_size;
+
+        auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+        auto *map_end = data_ + ((size_ + page_size - 1) & ~(page_size - 1));
+
+        if (data_ > first) {
+            ::munmap(first, static_cast<std::size_t>(data_ - first));
+        }
+        if (last > map_end) {
+            ::munmap(map_end, static_cast<std::size_t>(last - map_end));
+        }
+
+#ifdef MADV_HUGEPAGE
+        // This is best effort; most file systems do not support huge
+        // pages for file-backed mappings.
+        ::madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+    }
 }
 
 }  // namespace abi_v1
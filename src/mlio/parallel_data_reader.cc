@@ -16,12 +16,15 @@
 #include "mlio/parallel_data_reader.h"
 
 #include <cstddef>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include <tbb/tbb.h>
 
+#include "mlio/cpu_array.h"
+#include "mlio/cpu_array_pool.h"
 #include "mlio/data_reader.h"
 #include "mlio/detail/thread.h"
 #include "mlio/example.h"
@@ -61,14 +64,29 @@ std::size_t Parallel_data_reader::num_bytes_read() const noexcept
     return num_bytes_read_;
 }
 
-Parallel_data_reader::Parallel_data_reader(Data_reader_params &&params)
+Parallel_data_reader::Parallel_data_reader(Data_reader_params &&params, bool shards_row_groups)
     : Data_reader_base{std::move(params)}, graph_{std::make_unique<Graph_data>()}
 {
+    if (this->params().num_shards > 1 &&
+        this->params().sharding_strategy == Sharding_strategy::row_group && !shards_row_groups) {
+        throw std::invalid_argument{"The data reader does not support row group sharding."};
+    }
+
+    if (this->params().min_chunk_size != 0 && this->params().max_chunk_size != 0 &&
+        this->params().min_chunk_size > this->params().max_chunk_size) {
+        throw std::invalid_argument{
+            "The minimum chunk size must be less than or equal to the maximum chunk size."};
+    }
+
     reader_ = detail::make_instance_reader(this->params(), [this](const Data_store &store) {
         return make_record_reader(store);
     });
 
     batch_reader_ = std::make_unique<Instance_batch_reader>(this->params(), *reader_);
+
+    if (this->params().tensor_pool_size > 0) {
+        array_pool_ = make_intrusive<Cpu_array_pool>(this->params().tensor_pool_size);
+    }
 }
 
 void Parallel_data_reader::stop()
@@ -290,6 +308,15 @@ void Parallel_data_reader::ensure_schema_inferred()
     schema_ = infer_schema(reader_->peek_instance());
 }
 
+std::unique_ptr<Device_array>
+Parallel_data_reader::make_feature_array(Data_type dt, std::size_t size, bool zero_init) const
+{
+    if (array_pool_ == nullptr) {
+        return make_cpu_array(dt, size);
+    }
+    return array_pool_->allocate(dt, size, zero_init);
+}
+
 Intrusive_ptr<const Schema> Parallel_data_reader::read_schema()
 {
     ensure_schema_inferred();
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/parquet_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "mlio/data_reader.h"
+#include "mlio/data_reader_error.h"
+#include "mlio/data_stores/data_store.h"
+#include "mlio/detail/parquet/column_decoder.h"
+#include "mlio/detail/parquet/metadata.h"
+#include "mlio/detail/parquet/row_group_reader.h"
+#include "mlio/device_array.h"
+#include "mlio/example.h"
+#include "mlio/instance.h"
+#include "mlio/instance_batch.h"
+#include "mlio/logger.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/not_supported_error.h"
+#include "mlio/record_readers/record_error.h"
+#include "mlio/schema.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/tensor.h"
+
+using mlio::detail::Parquet_column;
+using mlio::detail::Parquet_file_metadata;
+using mlio::detail::Parquet_row_group_reader;
+using mlio::detail::Parquet_row_layout;
+using mlio::detail::parquet_column_data_type;
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace {
+
+template<Data_type dt>
+struct get_data_type_size_op {
+    std::size_t operator()() const noexcept
+    {
+        return sizeof(data_type_t<dt>);
+    }
+};
+
+template<std::size_t size>
+void gather(const Instance_batch &batch, std::size_t offset, std::byte *out)
+{
+    for (const Instance &instance : batch.instances()) {
+        std::memcpy(out, instance.bits().data() + offset, size);
+
+        out += size;
+    }
+}
+
+}  // namespace
+
+Parquet_reader::Parquet_reader(Data_reader_params params, Parquet_params pq_params)
+    : Parallel_data_reader{std::move(params), true}, params_{std::move(pq_params)}
+{
+    const Data_reader_params &prm = this->params();
+
+    if (prm.num_shards > 1 && prm.sharding_strategy == Sharding_strategy::row_group &&
+        prm.shard_index >= prm.num_shards) {
+        throw std::invalid_argument{"The shard index must be less than the number of shards."};
+    }
+
+    for (std::size_t i = 0; i < prm.dataset.size(); i++) {
+        store_indices_.emplace(prm.dataset[i]->id(), i);
+    }
+}
+
+Parquet_reader::~Parquet_reader()
+{
+    stop();
+}
+
+Intrusive_ptr<Record_reader> Parquet_reader::make_record_reader(const Data_store &store)
+{
+    auto stream = store.open_read();
+
+    Parquet_file_metadata metadata{};
+    try {
+        metadata = detail::read_parquet_metadata(stream);
+    }
+    catch (const Corrupt_record_error &) {
+        std::throw_with_nested(Schema_error{fmt::format(
+            "The metadata of the Parquet data store '{0}' cannot be read. See nested exception for details.",
+            store.id())});
+    }
+
+    Parquet_row_layout layout{};
+
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        // This function can be called from multiple threads, e.g. when
+        // data stores are interleaved; the first data store opened
+        // determines the columns.
+        if (!has_columns_) {
+            std::vector<Column> columns{};
+
+            if (params_.column_names.empty()) {
+                for (const Parquet_column &column : metadata.columns) {
+                    std::optional<Data_type> dt = parquet_column_data_type(column);
+                    if (dt == std::nullopt) {
+                        logger::warn(
+                            "The column '{0}' of the Parquet data store '{1}' has a type that is not supported and will be skipped.",
+                            column.name,
+                            store.id());
+
+                        continue;
+                    }
+
+                    std::size_t size = dispatch<get_data_type_size_op>(*dt);
+
+                    columns.emplace_back(Column{column.name, *dt, size});
+                }
+            }
+            else {
+                // The tensors are returned in the order of the requested
+                // column names.
+                for (const std::string &name : params_.column_names) {
+                    auto pos = std::find_if(metadata.columns.begin(),
+                                            metadata.columns.end(),
+                                            [&name](const Parquet_column &c) {
+                                                return c.name == name;
+                                            });
+
+                    if (pos == metadata.columns.end()) {
+                        throw Schema_error{fmt::format(
+                            "The Parquet data store '{0}' does not have a column named '{1}'.",
+                            store.id(),
+                            name)};
+                    }
+
+                    std::optional<Data_type> dt = parquet_column_data_type(*pos);
+                    if (dt == std::nullopt) {
+                        throw Not_supported_error{fmt::format(
+                            "The column '{0}' of the Parquet data store '{1}' has a type that is not supported.",
+                            name,
+                            store.id())};
+                    }
+
+                    std::size_t size = dispatch<get_data_type_size_op>(*dt);
+
+                    columns.emplace_back(Column{name, *dt, size});
+                }
+            }
+
+            if (columns.empty()) {
+                throw Schema_error{fmt::format(
+                    "The Parquet data store '{0}' does not have any column that can be read.",
+                    store.id())};
+            }
+
+            // Lay out the values of a row by decreasing size so that
+            // each of them is naturally aligned.
+            std::vector<Column *> sorted(columns.size());
+            std::transform(columns.begin(), columns.end(), sorted.begin(), [](Column &c) {
+                return &c;
+            });
+
+            std::stable_sort(sorted.begin(), sorted.end(), [](const Column *a, const Column *b) {
+                return a->size > b->size;
+            });
+
+            std::size_t stride = 0;
+            for (Column *column : sorted) {
+                column->offset = stride;
+
+                stride += column->size;
+            }
+
+            stride = (stride + 7) & ~std::size_t{7};
+
+            columns_ = std::move(columns);
+
+            stride_ = stride;
+
+            has_columns_ = true;
+        }
+
+        layout.stride = stride_;
+
+        for (const Column &column : columns_) {
+            auto pos = std::find_if(metadata.columns.begin(),
+                                    metadata.columns.end(),
+                                    [&column](const Parquet_column &c) {
+                                        return c.name == column.name;
+                                    });
+
+            if (pos == metadata.columns.end() ||
+                parquet_column_data_type(*pos) != column.data_type) {
+                throw Schema_error{fmt::format(
+                    "The column '{0}' of the Parquet data store '{1}' is missing or has a different type than in the first data store.",
+                    column.name,
+                    store.id())};
+            }
+
+            auto idx = static_cast<std::size_t>(pos - metadata.columns.begin());
+
+            layout.columns.emplace_back(Parquet_row_layout::Column{idx, column.offset});
+        }
+    }
+
+    const Data_reader_params &prm = params();
+
+    std::vector<std::size_t> row_groups{};
+
+    std::size_t num_row_groups = metadata.row_groups.size();
+
+    if (prm.num_shards > 1 && prm.sharding_strategy == Sharding_strategy::row_group) {
+        // Rotate the assignment by the index of the data store so that
+        // datasets made of small single-row-group files are balanced
+        // as well.
+        std::size_t store_idx{};
+
+        auto pos = store_indices_.find(store.id());
+        if (pos != store_indices_.end()) {
+            store_idx = pos->second;
+        }
+
+        for (std::size_t i = 0; i < num_row_groups; i++) {
+            if ((store_idx + i) % prm.num_shards == prm.shard_index) {
+                row_groups.emplace_back(i);
+            }
+        }
+    }
+    else {
+        row_groups.resize(num_row_groups);
+
+        std::iota(row_groups.begin(), row_groups.end(), 0);
+    }
+
+    return make_intrusive<Parquet_row_group_reader>(
+        std::move(stream), std::move(metadata), std::move(layout), std::move(row_groups));
+}
+
+Intrusive_ptr<const Schema> Parquet_reader::infer_schema(const std::optional<Instance> &)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    std::vector<Attribute> attrs{};
+    for (const Column &column : columns_) {
+        attrs.emplace_back(column.name, column.data_type, Size_vector{params().batch_size, 1});
+    }
+
+    return make_intrusive<Schema>(std::move(attrs));
+}
+
+Intrusive_ptr<Example> Parquet_reader::decode(const Instance_batch &batch) const
+{
+    bool zero_init = batch.instances().size() != batch.size();
+
+    std::vector<Intrusive_ptr<Tensor>> tensors{};
+    tensors.reserve(columns_.size());
+
+    // The record of an instance holds a row of the row-major block the
+    // row group was decoded into; gather the values of each column.
+    for (const Column &column : columns_) {
+        std::unique_ptr<Device_array> arr =
+            make_feature_array(column.data_type, batch.size(), zero_init);
+
+        auto *out = static_cast<std::byte *>(arr->data());
+
+        switch (column.size) {
+        case 1:
+            gather<1>(batch, column.offset, out);
+            break;
+        case 4:
+            gather<4>(batch, column.offset, out);
+            break;
+        default:
+            gather<8>(batch, column.offset, out);
+            break;
+        }
+
+        Size_vector shape{batch.size(), 1};
+
+        tensors.emplace_back(make_intrusive<Dense_tensor>(std::move(shape), std::move(arr)));
+    }
+
+    auto example = make_intrusive<Example>(schema(), std::move(tensors));
+
+    example->padding = batch.size() - batch.instances().size();
+
+    return example;
+}
+
+}  // namespace abi_v1
+}  // namespace mlio
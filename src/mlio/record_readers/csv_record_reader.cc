@@ -16,6 +16,7 @@
 #include "mlio/record_readers/csv_record_reader.h"
 
 #include <cstddef>
+#include <string>
 
 #include <fmt/format.h>
 
@@ -31,6 +32,31 @@ namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
+std::string Csv_record_reader::framing_key() const
+{
+    std::string encoding{};
+    if (params_->encoding) {
+        encoding = params_->encoding->name();
+    }
+
+    // The number of skipped rows determines where the first record
+    // starts.
+    std::size_t num_skipped_rows = 0;
+    if (has_header_ && params_->header_row_index) {
+        num_skipped_rows = *params_->header_row_index + 1;
+    }
+
+    return fmt::format("csv:{0:d}:{1:d}:{2:d}:{3:d}:{4:d}:{5:d}:{6}:{7:d}",
+                       static_cast<int>(params_->delimiter),
+                       static_cast<int>(params_->quote_char),
+                       params_->comment_char ? static_cast<int>(*params_->comment_char) : -1,
+                       params_->allow_quoted_new_lines,
+                       params_->skip_blank_lines,
+                       params_->max_line_length.value_or(0),
+                       encoding,
+                       num_skipped_rows);
+}
+
 std::optional<Record>
 Csv_record_reader::decode_text_record(Memory_slice &chunk, bool ignore_leftover)
 {
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "mlio/fwd.h"
@@ -29,10 +30,16 @@ namespace detail {
 
 class Csv_record_reader final : public Text_record_reader {
 public:
-    explicit Csv_record_reader(Intrusive_ptr<Input_stream> stream, const Csv_params &params)
-        : Text_record_reader{std::move(stream)}, params_{&params}
+    // The has_header flag only contributes to the framing key; skipping
+    // the header rows is up to the caller.
+    explicit Csv_record_reader(Intrusive_ptr<Input_stream> stream,
+                               const Csv_params &params,
+                               bool has_header = false)
+        : Text_record_reader{std::move(stream)}, params_{&params}, has_header_{has_header}
     {}
 
+    std::string framing_key() const final;
+
 private:
     enum class Parser_state {
         new_field,
@@ -57,6 +64,7 @@ private:
                                   std::size_t max_line_length);
 
     const Csv_params *params_;
+    bool has_header_;
 };
 
 }  // namespace detail
@@ -19,6 +19,9 @@
 
 #include "mlio/record_readers/detail/default_chunk_reader.h"
 #include "mlio/record_readers/detail/in_memory_chunk_reader.h"
+#include "mlio/record_readers/detail/mapped_chunk_reader.h"
+#include "mlio/streams/detail/direct_file_input_stream.h"
+#include "mlio/streams/detail/mapped_file_input_stream.h"
 #include "mlio/streams/input_stream.h"
 
 namespace mlio {
@@ -29,21 +32,37 @@ Chunk_reader::~Chunk_reader() = default;
 
 std::unique_ptr<Chunk_reader> make_chunk_reader(Intrusive_ptr<Input_stream> stream)
 {
+    auto *mapped_stream = dynamic_cast<Mapped_file_input_stream *>(stream.get());
+    if (mapped_stream != nullptr && mapped_stream->window_size() != 0) {
+        return std::make_unique<Mapped_chunk_reader>(
+            mapped_stream->block(), mapped_stream->position(), mapped_stream->window_size());
+    }
+
     // See if we can zero-copy read the whole stream (e.g. a
     // memory-mapped file). In such case we can simply return a single
     // memory block right away instead of reading the stream chunk by
     // chunk.
     if (stream->supports_zero_copy()) {
-        Memory_slice chunk = stream->read(stream->size());
+        std::size_t position = stream->position();
+
+        Memory_slice chunk = stream->read(stream->size() - position);
         // Although this shouldn't happen, make sure we have read all
         // the data.
-        if (chunk.size() == stream->size()) {
+        if (chunk.size() == stream->size() - position) {
             return std::make_unique<In_memory_chunk_reader>(std::move(chunk));
         }
 
-        stream->seek(0);
+        stream->seek(position);
     }
-    return std::make_unique<Default_chunk_reader>(std::move(stream));
+
+    // Direct I/O can read straight into the chunks only if they are
+    // suitably aligned.
+    std::size_t alignment = 1;
+    if (dynamic_cast<Direct_file_input_stream *>(stream.get()) != nullptr) {
+        alignment = Direct_file_input_stream::alignment();
+    }
+
+    return std::make_unique<Default_chunk_reader>(std::move(stream), alignment);
 }
 
 }  // namespace detail
@@ -48,6 +48,10 @@ public:
     virtual std::size_t chunk_size_hint() const noexcept = 0;
 
     virtual void set_chunk_size_hint(std::size_t value) noexcept = 0;
+
+    // Sets the range within which the chunk size can be tuned. A zero
+    // value leaves the corresponding bound unchanged.
+    virtual void set_chunk_size_bounds(std::size_t min_size, std::size_t max_size) noexcept = 0;
 };
 
 std::unique_ptr<Chunk_reader> make_chunk_reader(Intrusive_ptr<Input_stream> stream);
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/record_readers/detail/chunk_size_tuner.h"
+
+#include <algorithm>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+inline std::size_t ceil_pow2(std::size_t value) noexcept
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+inline std::size_t floor_pow2(std::size_t value) noexcept
+{
+    std::size_t result = 1;
+    while (result <= value >> 1) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+void Chunk_size_tuner::set_bounds(std::size_t min_size, std::size_t max_size) noexcept
+{
+    if (min_size != 0) {
+        min_size_ = ceil_pow2(min_size);
+    }
+    if (max_size != 0) {
+        max_size_ = floor_pow2(max_size);
+
+        // If only the upper bound is specified, it takes precedence over
+        // the default lower bound; otherwise, rounding the bounds to
+        // powers of two must not invert them.
+        if (min_size == 0) {
+            min_size_ = std::min(min_size_, max_size_);
+        }
+        else {
+            max_size_ = std::max(max_size_, min_size_);
+        }
+    }
+
+    resize(size_);
+}
+
+void Chunk_size_tuner::set_size_hint(std::size_t value) noexcept
+{
+    // Leave room for the leftover of the previous chunk.
+    floor_ = std::max(floor_, ceil_pow2(value + value / 4));
+
+    resize(size_);
+}
+
+void Chunk_size_tuner::observe(const Observation &observation) noexcept
+{
+    // If the whole chunk is leftover, it means it does not contain any
+    // records; in such case we have to increase the size of the chunks
+    // to make sure that we fit at least one record into them, even if
+    // that means going beyond the upper bound.
+    if (observation.leftover_size != 0 && observation.leftover_size == observation.chunk_size) {
+        floor_ = std::max(floor_, size_ << 1);
+
+        votes_ = 0;
+
+        resize(size_);
+
+        return;
+    }
+
+    // Keep the leftovers small relative to the chunks; anything that
+    // does not fit into the reserved space in front of a block has to
+    // be merged by copying the whole chunk.
+    leftover_peak_ = std::max(observation.leftover_size, leftover_peak_ - leftover_peak_ / 8);
+
+    using namespace std::chrono_literals;
+
+    // If the consumer keeps waiting on the stream (e.g. S3), larger
+    // reads amortize the per-request latency. If the stream keeps up,
+    // but the blocks cannot be recycled because records still
+    // reference them, smaller chunks reduce the memory held by the
+    // decoding stage and increase the chance of reuse.
+    if (observation.wait_time > 1ms && observation.wait_time * 4 > observation.consume_time) {
+        votes_ = std::max(votes_, 0) + 1;
+    }
+    else if (!observation.block_reused && observation.wait_time * 16 < observation.consume_time) {
+        votes_ = std::min(votes_, 0) - 1;
+    }
+    else {
+        votes_ = 0;
+    }
+
+    std::size_t size = size_;
+    if (votes_ >= num_votes_to_resize_) {
+        size <<= 1;
+
+        votes_ = 0;
+    }
+    else if (votes_ <= -num_votes_to_resize_) {
+        size >>= 1;
+
+        votes_ = 0;
+    }
+
+    resize(size);
+}
+
+void Chunk_size_tuner::resize(std::size_t value) noexcept
+{
+    std::size_t lower = std::max(min_size_, std::min(ceil_pow2(leftover_peak_ * 8), max_size_));
+
+    // The floor might exceed the upper bound if the records are large.
+    lower = std::max(lower, floor_);
+
+    size_ = std::max(std::min(value, max_size_), lower);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
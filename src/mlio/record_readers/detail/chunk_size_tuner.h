@@ -0,0 +1,86 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Tunes the size of the chunks read from a stream based on what has
+// been observed while reading the previous chunks. Chunk sizes are
+// always powers of two so that recycled blocks can be matched by size
+// and so that the allocations stay friendly to the memory allocator.
+class Chunk_size_tuner {
+public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct Observation {
+        // The size of the chunk that has been consumed.
+        std::size_t chunk_size{};
+        // The size of the trailing partial record of the chunk.
+        std::size_t leftover_size{};
+        // How long the consumer waited for the next chunk.
+        Duration wait_time{};
+        // How long the consumer spent decoding the previous chunk.
+        Duration consume_time{};
+        // Indicates whether the block for the next read could be
+        // recycled, meaning that no records held a reference to it.
+        bool block_reused{};
+    };
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    // The size of the space reserved in front of a block for the
+    // leftover of the previous chunk.
+    static std::size_t leftover_capacity(std::size_t block_size) noexcept
+    {
+        return block_size / 8;
+    }
+
+    void set_bounds(std::size_t min_size, std::size_t max_size) noexcept;
+
+    // Ensures that a record of the specified size fits into a chunk.
+    void set_size_hint(std::size_t value) noexcept;
+
+    void observe(const Observation &observation) noexcept;
+
+private:
+    void resize(std::size_t value) noexcept;
+
+    // The number of consecutive observations pointing in the same
+    // direction before we change the size; this avoids oscillating
+    // between two sizes and throwing away recycled blocks.
+    static constexpr int num_votes_to_resize_ = 3;
+
+    std::size_t size_ = 0x200'0000;       // 32 MiB
+    std::size_t min_size_ = 0x10'0000;    // 1 MiB
+    std::size_t max_size_ = 0x1000'0000;  // 256 MiB
+    // The smallest size that fits the records we know of.
+    std::size_t floor_{};
+    // A decaying maximum of the leftover sizes.
+    std::size_t leftover_peak_{};
+    int votes_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -16,15 +16,48 @@
 #include "mlio/record_readers/detail/default_chunk_reader.h"
 
 #include <algorithm>
+#include <cstdint>
 
+#include "mlio/detail/thread.h"
 #include "mlio/memory/memory_allocator.h"
-#include "mlio/memory/util.h"
 #include "mlio/span.h"
 #include "mlio/util/cast.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
+namespace {
+
+// Returns the number of bytes between the specified address and the
+// next one with the specified alignment.
+inline std::size_t align_offset(const std::byte *ptr, std::size_t alignment) noexcept
+{
+    auto address = reinterpret_cast<std::uintptr_t>(ptr);
+
+    return (alignment - address % alignment) % alignment;
+}
+
+inline std::size_t align_up(std::size_t value, std::size_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+Default_chunk_reader::~Default_chunk_reader()
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        stopping_ = true;
+    }
+
+    condition_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
 
 Memory_slice Default_chunk_reader::read_chunk(Memory_span leftover)
 {
@@ -32,50 +65,217 @@ Memory_slice Default_chunk_reader::read_chunk(Memory_span leftover)
         return {};
     }
 
-    bool reuse_buffer = false;
+    // A single chunk is read synchronously since the caller might only
+    // need a few records (e.g. after seeking to an indexed record).
+    if (!has_read_first_chunk_) {
+        has_read_first_chunk_ = true;
 
-    if (chunk_ != nullptr) {
-        // If the whole chunk is leftover, it means it does not contain
-        // any records; in such case we should increase the size of the
-        // chunk to make sure that we fit at least one record into it.
-        if (chunk_->size() == leftover.size()) {
-            if (chunk_->size() == next_chunk_size_) {
-                next_chunk_size_ <<= 1;
-            }
+        return read_first_chunk(leftover);
+    }
 
-            reuse_buffer = true;
+    return read_next_chunk(leftover);
+}
 
-            // If the chunk is owned only by this Chunk_reader and its
-            // associated Stream_record_reader, we can safely re-use it
-            // for the next fill operation.
-        }
-        else if (chunk_->use_count() <= 2) {
-            if (!leftover.empty()) {
-                std::copy(leftover.begin(), leftover.end(), chunk_->begin());
-            }
+Memory_slice Default_chunk_reader::read_first_chunk(Memory_span leftover)
+{
+    std::size_t size = tuner_.size();
 
-            reuse_buffer = true;
-        }
+    // Over-allocate so that the data can start at an aligned address.
+    chunk_ = memory_allocator().allocate(size + alignment_ - 1);
+
+    std::size_t offset{};
+    if (leftover.empty()) {
+        offset = align_offset(chunk_->data(), alignment_);
+    }
+    else {
+        std::copy(leftover.begin(), leftover.end(), chunk_->begin());
     }
 
-    if (reuse_buffer) {
-        if (chunk_->size() != next_chunk_size_) {
-            chunk_ = resize_memory_block(chunk_, next_chunk_size_);
+    std::size_t num_bytes_to_read = size - leftover.size();
+
+    // Let the chunk end at an aligned stream position so that the chunks
+    // read ahead start at one.
+    if (alignment_ > 1) {
+        std::size_t excess = (stream_->position() + num_bytes_to_read) % alignment_;
+        if (excess < num_bytes_to_read) {
+            num_bytes_to_read -= excess;
         }
     }
+
+    auto destination = make_span(*chunk_).subspan(offset + leftover.size(), num_bytes_to_read);
+
+    std::size_t num_bytes_read = fill(destination, eof_);
+
+    chunk_size_ = leftover.size() + num_bytes_read;
+
+    chunk_time_ = std::chrono::steady_clock::now();
+
+    return Memory_slice{chunk_}.subslice(offset, chunk_size_);
+}
+
+Memory_slice Default_chunk_reader::read_next_chunk(Memory_span leftover)
+{
+    auto wait_start = std::chrono::steady_clock::now();
+
+    if (!read_ahead_.requested) {
+        request_read_ahead();
+    }
+
+    Read_ahead read_ahead = wait_read_ahead();
+
+    auto wait_end = std::chrono::steady_clock::now();
+
+    tuner_.observe({chunk_size_,
+                    leftover.size(),
+                    wait_end - wait_start,
+                    wait_start - chunk_time_,
+                    block_reused_});
+
+    if (read_ahead.eof) {
+        eof_ = true;
+    }
+    else {
+        request_read_ahead();
+    }
+
+    // The previous chunk might still be referenced by the records read
+    // from it; we reuse it once they are gone.
+    retire_block(std::move(chunk_));
+
+    Memory_slice chunk{};
+
+    if (leftover.size() <= read_ahead.offset) {
+        std::size_t offset = read_ahead.offset - leftover.size();
+
+        std::copy(leftover.begin(), leftover.end(), read_ahead.block->begin() + as_ssize(offset));
+
+        chunk_ = std::move(read_ahead.block);
+
+        chunk = Memory_slice{chunk_}.subslice(offset, leftover.size() + read_ahead.num_bytes_read);
+    }
+    else {
+        chunk_ = memory_allocator().allocate(leftover.size() + read_ahead.num_bytes_read);
+
+        auto pos = std::copy(leftover.begin(), leftover.end(), chunk_->begin());
+
+        auto data = make_span(*read_ahead.block).subspan(read_ahead.offset);
+
+        std::copy(data.begin(), data.begin() + as_ssize(read_ahead.num_bytes_read), pos);
+
+        retire_block(std::move(read_ahead.block));
+
+        chunk = Memory_slice{chunk_};
+    }
+
+    chunk_size_ = chunk.size();
+
+    chunk_time_ = std::chrono::steady_clock::now();
+
+    return chunk;
+}
+
+void Default_chunk_reader::request_read_ahead()
+{
+    std::size_t block_size = tuner_.size();
+
+    auto block = get_block(block_size + alignment_ - 1);
+
+    // The space in front of the data is reserved for the leftover of the
+    // current chunk; the data itself starts at an aligned address.
+    std::size_t reserve = align_up(Chunk_size_tuner::leftover_capacity(block_size), alignment_);
+
+    std::size_t offset = reserve + align_offset(block->data() + reserve, alignment_);
+
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        read_ahead_ = {};
+
+        read_ahead_.block = std::move(block);
+
+        read_ahead_.offset = offset;
+
+        read_ahead_.num_bytes_requested = block_size - reserve;
+
+        read_ahead_.requested = true;
+    }
+
+    if (thread_.joinable()) {
+        condition_.notify_all();
+    }
     else {
-        chunk_ = memory_allocator().allocate(next_chunk_size_);
+        thread_ = start_thread(&Default_chunk_reader::run_read_ahead, this);
+    }
+}
+
+Default_chunk_reader::Read_ahead Default_chunk_reader::wait_read_ahead()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    condition_.wait(lock, [this] {
+        return read_ahead_.done;
+    });
+
+    Read_ahead read_ahead = std::move(read_ahead_);
+
+    read_ahead_ = {};
+
+    lock.unlock();
+
+    if (read_ahead.exception) {
+        std::rethrow_exception(read_ahead.exception);
+    }
 
-        if (!leftover.empty()) {
-            std::copy(leftover.begin(), leftover.end(), chunk_->begin());
+    return read_ahead;
+}
+
+void Default_chunk_reader::run_read_ahead()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (true) {
+        condition_.wait(lock, [this] {
+            return stopping_ || (read_ahead_.requested && !read_ahead_.done);
+        });
+
+        if (stopping_) {
+            return;
+        }
+
+        auto destination = make_span(*read_ahead_.block)
+                               .subspan(read_ahead_.offset, read_ahead_.num_bytes_requested);
+
+        lock.unlock();
+
+        std::size_t num_bytes_read{};
+        bool eof{};
+        std::exception_ptr exception{};
+        try {
+            num_bytes_read = fill(destination, eof);
         }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+
+        read_ahead_.num_bytes_read = num_bytes_read;
+        read_ahead_.eof = eof;
+        read_ahead_.exception = std::move(exception);
+        read_ahead_.done = true;
+
+        condition_.notify_all();
     }
+}
 
-    auto remaining = make_span(*chunk_).subspan(leftover.size());
-    while (!remaining.empty()) {
-        std::size_t num_bytes_read = stream_->read(remaining);
+std::size_t Default_chunk_reader::fill(Mutable_memory_span destination, bool &eof)
+{
+    auto remaining = destination;
+    while (!remaining.empty() && !stopping_) {
+        std::size_t num_bytes_read =
+            stream_->read(remaining.first(std::min(remaining.size(), max_read_size_)));
         if (num_bytes_read == 0) {
-            eof_ = true;
+            eof = true;
 
             break;
         }
@@ -83,22 +283,41 @@ Memory_slice Default_chunk_reader::read_chunk(Memory_span leftover)
         remaining = remaining.subspan(num_bytes_read);
     }
 
-    Intrusive_ptr<Mutable_memory_block> chunk;
-    if (eof_) {
-        chunk = std::move(chunk_);
-    }
-    else {
-        chunk = chunk_;
+    return destination.size() - remaining.size();
+}
+
+Intrusive_ptr<Mutable_memory_block> Default_chunk_reader::get_block(std::size_t size)
+{
+    // A block can be reused only if neither we nor any record reference
+    // it anymore.
+    auto pos = std::find_if(spare_blocks_.begin(), spare_blocks_.end(), [size](const auto &block) {
+        return block->size() == size && block->use_count() == 1;
+    });
+
+    block_reused_ = pos != spare_blocks_.end();
+
+    if (!block_reused_) {
+        return memory_allocator().allocate(size);
     }
 
-    return Memory_slice{chunk}.first(chunk->end() - stdx::ssize(remaining));
+    Intrusive_ptr<Mutable_memory_block> block = std::move(*pos);
+
+    spare_blocks_.erase(pos);
+
+    return block;
 }
 
-void Default_chunk_reader::set_chunk_size_hint(std::size_t value) noexcept
+void Default_chunk_reader::retire_block(Intrusive_ptr<Mutable_memory_block> &&block)
 {
-    while (value > next_chunk_size_) {
-        next_chunk_size_ <<= 1;
+    if (block == nullptr) {
+        return;
     }
+
+    if (spare_blocks_.size() == max_num_spare_blocks_) {
+        spare_blocks_.erase(spare_blocks_.begin());
+    }
+
+    spare_blocks_.emplace_back(std::move(block));
 }
 
 }  // namespace detail
@@ -15,13 +15,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "mlio/intrusive_ptr.h"
 #include "mlio/memory/memory_block.h"
 #include "mlio/memory/memory_slice.h"
 #include "mlio/record_readers/detail/chunk_reader.h"
+#include "mlio/record_readers/detail/chunk_size_tuner.h"
 #include "mlio/span.h"
 #include "mlio/streams/input_stream.h"
 
@@ -29,12 +37,47 @@ namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
+// Reads a stream chunk by chunk. The first chunk is read synchronously;
+// once the caller asks for a second one, meaning the stream is read
+// sequentially, the following chunks are read ahead on a background
+// thread while the current one is being consumed. The size of the
+// chunks is tuned as we go; see Chunk_size_tuner.
+//
+// If the stream requires an alignment for zero-copy reads (e.g. direct
+// I/O), the data of the chunks is read at aligned addresses and stream
+// positions.
 class Default_chunk_reader : public Chunk_reader {
+    // Represents a chunk that is read ahead in background. The data is
+    // read at an offset within the block so that the leftover of the
+    // previous chunk can be prepended without copying the new data.
+    struct Read_ahead {
+        Intrusive_ptr<Mutable_memory_block> block{};
+        // The offset within the block at which the data is read.
+        std::size_t offset{};
+        std::size_t num_bytes_requested{};
+        std::size_t num_bytes_read{};
+        bool eof{};
+        std::exception_ptr exception{};
+        bool requested{};
+        bool done{};
+    };
+
 public:
-    explicit Default_chunk_reader(Intrusive_ptr<Input_stream> stream) noexcept
-        : stream_{std::move(stream)}
+    explicit Default_chunk_reader(Intrusive_ptr<Input_stream> stream,
+                                  std::size_t alignment = 1) noexcept
+        : stream_{std::move(stream)}, alignment_{alignment}
     {}
 
+    Default_chunk_reader(const Default_chunk_reader &) = delete;
+
+    Default_chunk_reader &operator=(const Default_chunk_reader &) = delete;
+
+    Default_chunk_reader(Default_chunk_reader &&) = delete;
+
+    Default_chunk_reader &operator=(Default_chunk_reader &&) = delete;
+
+    ~Default_chunk_reader() override;
+
     Memory_slice read_chunk(Memory_span leftover) final;
 
     bool eof() const noexcept final
@@ -44,16 +87,60 @@ public:
 
     std::size_t chunk_size_hint() const noexcept final
     {
-        return next_chunk_size_;
+        return tuner_.size();
     }
 
-    void set_chunk_size_hint(std::size_t value) noexcept final;
+    void set_chunk_size_hint(std::size_t value) noexcept final
+    {
+        tuner_.set_size_hint(value);
+    }
+
+    void set_chunk_size_bounds(std::size_t min_size, std::size_t max_size) noexcept final
+    {
+        tuner_.set_bounds(min_size, max_size);
+    }
 
 private:
+    Memory_slice read_first_chunk(Memory_span leftover);
+
+    Memory_slice read_next_chunk(Memory_span leftover);
+
+    void request_read_ahead();
+
+    Read_ahead wait_read_ahead();
+
+    void run_read_ahead();
+
+    std::size_t fill(Mutable_memory_span destination, bool &eof);
+
+    Intrusive_ptr<Mutable_memory_block> get_block(std::size_t size);
+
+    void retire_block(Intrusive_ptr<Mutable_memory_block> &&block);
+
+    static constexpr std::size_t max_num_spare_blocks_ = 2;
+
+    // The maximum number of bytes requested from the stream at once. A
+    // stop request is honored between two reads; this bounds the time
+    // the destructor waits for an in-flight read-ahead.
+    static constexpr std::size_t max_read_size_ = 0x10'0000;  // 1 MiB
+
     Intrusive_ptr<Input_stream> stream_;
-    std::size_t next_chunk_size_ = 0x200'0000;  // 32 MiB
+    std::size_t alignment_;
+    Chunk_size_tuner tuner_{};
     Intrusive_ptr<Mutable_memory_block> chunk_{};
+    std::size_t chunk_size_{};
+    bool has_read_first_chunk_{};
     bool eof_{};
+    // Indicates whether the block of the last read-ahead was recycled.
+    bool block_reused_{};
+    // The time at which we handed out the last chunk.
+    std::chrono::steady_clock::time_point chunk_time_{};
+    std::vector<Intrusive_ptr<Mutable_memory_block>> spare_blocks_{};
+    Read_ahead read_ahead_{};
+    std::thread thread_{};
+    std::atomic_bool stopping_{};
+    std::mutex mutex_{};
+    std::condition_variable condition_{};
 };
 
 }  // namespace detail
@@ -46,6 +46,9 @@ public:
     void set_chunk_size_hint(std::size_t) noexcept final
     {}
 
+    void set_chunk_size_bounds(std::size_t, std::size_t) noexcept final
+    {}
+
 private:
     Memory_slice chunk_;
 };
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/record_readers/detail/mapped_chunk_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+inline std::size_t page_size() noexcept
+{
+    static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    return size;
+}
+
+inline void advise(const std::byte *first, std::size_t size, int advice) noexcept
+{
+    // The address passed to madvise() must be page aligned.
+    auto addr = reinterpret_cast<std::uintptr_t>(first);
+
+    std::uintptr_t aligned_addr = addr & ~(page_size() - 1);
+
+    // Advices are hints; we ignore any errors.
+    ::madvise(reinterpret_cast<void *>(aligned_addr), size + (addr - aligned_addr), advice);
+}
+
+}  // namespace
+
+Mapped_chunk_reader::Mapped_chunk_reader(Intrusive_ptr<File_mapped_memory_block> mapping,
+                                         std::size_t offset,
+                                         std::size_t window_size)
+    : mapping_{std::move(mapping)}
+    , offset_{std::min(offset, mapping_->size())}
+    , tracker_{std::make_shared<Window_tracker>(mapping_, offset_)}
+    , window_size_{window_size}
+{
+    if (mapping_->size() == 0) {
+        return;
+    }
+
+    advise(mapping_->data() + offset_, mapping_->size() - offset_, MADV_SEQUENTIAL);
+}
+
+Memory_slice Mapped_chunk_reader::read_chunk(Memory_span leftover)
+{
+    if (eof()) {
+        return {};
+    }
+
+    // The leftover lives in the previous window; since the windows are
+    // contiguous in the mapping, the new one simply starts at the
+    // leftover instead of copying it.
+    std::size_t first = offset_;
+    if (!leftover.empty()) {
+        first = static_cast<std::size_t>(leftover.data() - mapping_->data());
+    }
+
+    std::size_t last = std::min(offset_ + window_size_, mapping_->size());
+
+    std::size_t id = tracker_->add_window(first, last);
+
+    Memory_span data{mapping_->data() + first, last - first};
+
+    auto block = make_intrusive<Window_block>(tracker_, id, data);
+
+    offset_ = last;
+
+    // Let the kernel read the next window while this one is decoded.
+    if (offset_ < mapping_->size()) {
+        std::size_t size = std::min(window_size_, mapping_->size() - offset_);
+
+        advise(mapping_->data() + offset_, size, MADV_WILLNEED);
+    }
+
+    return Memory_slice{std::move(block)};
+}
+
+void Mapped_chunk_reader::set_chunk_size_hint(std::size_t value) noexcept
+{
+    // A window must be large enough to hold at least one record.
+    while (value > window_size_) {
+        window_size_ <<= 1;
+    }
+}
+
+Mapped_chunk_reader::Window_block::~Window_block()
+{
+    tracker_->release_window(id_);
+}
+
+Mapped_chunk_reader::Window_tracker::Window_tracker(
+    Intrusive_ptr<File_mapped_memory_block> mapping, std::size_t offset) noexcept
+    : mapping_{std::move(mapping)}, released_offset_{(offset + page_size() - 1) & ~(page_size() - 1)}
+{}
+
+std::size_t
+Mapped_chunk_reader::Window_tracker::add_window(std::size_t offset, std::size_t end)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    windows_.push_back(Window{offset, end, false});
+
+    return first_id_ + windows_.size() - 1;
+}
+
+void Mapped_chunk_reader::Window_tracker::release_window(std::size_t id) noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    windows_[id - first_id_].released = true;
+
+    std::size_t end = 0;
+    while (!windows_.empty() && windows_.front().released) {
+        end = windows_.front().end;
+
+        windows_.pop_front();
+
+        first_id_++;
+    }
+
+    if (end == 0) {
+        return;
+    }
+
+    // The remaining windows are still referenced; everything before the
+    // oldest of them can go. If there are none left, as is the case when
+    // the windows are consumed one after another, everything up to the
+    // end of the last released window can go.
+    if (windows_.empty()) {
+        release_pages(end);
+    }
+    else {
+        release_pages(windows_.front().offset);
+    }
+}
+
+std::size_t Mapped_chunk_reader::Window_tracker::released_offset() const noexcept
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    return released_offset_;
+}
+
+void Mapped_chunk_reader::Window_tracker::release_pages(std::size_t offset) noexcept
+{
+    std::size_t last = offset & ~(page_size() - 1);
+    if (last <= released_offset_) {
+        return;
+    }
+
+    const std::byte *first = mapping_->data() + released_offset_;
+
+    std::size_t size = last - released_offset_;
+
+#ifdef MADV_COLD
+    // Let the kernel reclaim the page cache pages before anything else.
+    advise(first, size, MADV_COLD);
+#endif
+    // The mapping is private and read-only, so the pages are simply
+    // reloaded from the file should they be accessed again.
+    advise(first, size, MADV_DONTNEED);
+
+    released_offset_ = last;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/file_mapped_memory_block.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/record_readers/detail/chunk_reader.h"
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Hands out a memory-mapped file window by window. Each window is a
+// separate memory block over the mapping, so we know when the records
+// of a window are gone. The kernel is advised to read ahead of the
+// current window, and the pages behind the oldest window that is still
+// referenced are released to keep the resident memory bounded.
+class Mapped_chunk_reader final : public Chunk_reader {
+    // Keeps track of the windows that are still referenced.
+    class Window_tracker {
+        struct Window {
+            std::size_t offset;
+            std::size_t end;
+            bool released;
+        };
+
+    public:
+        // Pages before the specified offset are never released since
+        // they might be read by someone else (e.g. after a seek).
+        explicit Window_tracker(Intrusive_ptr<File_mapped_memory_block> mapping,
+                                std::size_t offset) noexcept;
+
+        std::size_t add_window(std::size_t offset, std::size_t end);
+
+        void release_window(std::size_t id) noexcept;
+
+        std::size_t released_offset() const noexcept;
+
+    private:
+        void release_pages(std::size_t offset) noexcept;
+
+        Intrusive_ptr<File_mapped_memory_block> mapping_;
+        mutable std::mutex mutex_{};
+        std::deque<Window> windows_{};
+        // The id of the first window in the queue.
+        std::size_t first_id_{};
+        // The offset up to which the pages have been released.
+        std::size_t released_offset_{};
+    };
+
+    class Window_block final : public Memory_block {
+    public:
+        Window_block(std::shared_ptr<Window_tracker> tracker,
+                     std::size_t id,
+                     Memory_span data) noexcept
+            : tracker_{std::move(tracker)}, id_{id}, data_{data}
+        {}
+
+        Window_block(const Window_block &) = delete;
+
+        Window_block &operator=(const Window_block &) = delete;
+
+        Window_block(Window_block &&) = delete;
+
+        Window_block &operator=(Window_block &&) = delete;
+
+        ~Window_block() final;
+
+        const_pointer data() const noexcept final
+        {
+            return data_.data();
+        }
+
+        size_type size() const noexcept final
+        {
+            return data_.size();
+        }
+
+    private:
+        std::shared_ptr<Window_tracker> tracker_;
+        std::size_t id_;
+        Memory_span data_;
+    };
+
+public:
+    explicit Mapped_chunk_reader(Intrusive_ptr<File_mapped_memory_block> mapping,
+                                 std::size_t offset,
+                                 std::size_t window_size);
+
+    Memory_slice read_chunk(Memory_span leftover) final;
+
+    bool eof() const noexcept final
+    {
+        return offset_ == mapping_->size();
+    }
+
+    std::size_t chunk_size_hint() const noexcept final
+    {
+        return window_size_;
+    }
+
+    void set_chunk_size_hint(std::size_t value) noexcept final;
+
+    void set_chunk_size_bounds(std::size_t, std::size_t) noexcept final
+    {}
+
+    // Returns the offset in the mapping up to which the pages have been
+    // released.
+    std::size_t released_offset() const noexcept
+    {
+        return tracker_->released_offset();
+    }
+
+private:
+    Intrusive_ptr<File_mapped_memory_block> mapping_;
+    // The offset in the mapping up to which we have handed out windows.
+    std::size_t offset_;
+    std::shared_ptr<Window_tracker> tracker_;
+    std::size_t window_size_;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -15,6 +15,12 @@
 
 #include "mlio/record_readers/parquet_record_reader.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "mlio/detail/parquet/row_group_reader.h"
+#include "mlio/logger.h"
 #include "mlio/memory/memory_slice.h"
 #include "mlio/record_readers/record.h"
 #include "mlio/record_readers/record_error.h"
@@ -24,6 +30,112 @@ namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
+Parquet_record_reader::Parquet_record_reader(Intrusive_ptr<Input_stream> stream)
+    : Parquet_record_reader{stream, find_file_ends(*stream)}
+{}
+
+Parquet_record_reader::Parquet_record_reader(Intrusive_ptr<Input_stream> stream,
+                                             std::vector<std::size_t> file_ends)
+    : Stream_record_reader{std::move(stream)}
+{
+    std::size_t file_begin = position();
+    for (std::size_t file_end : file_ends) {
+        if (file_end < file_begin || file_end - file_begin < (2 * magic_number_size_) + 4) {
+            throw std::invalid_argument{
+                "The file ends must be in increasing order and must leave enough room for a "
+                "Parquet file."};
+        }
+
+        file_begin = file_end;
+    }
+
+    set_file_ends(std::move(file_ends));
+}
+
+std::string Parquet_record_reader::framing_key() const
+{
+    return "parquet";
+}
+
+std::vector<std::size_t> Parquet_record_reader::find_file_ends(Input_stream &stream)
+{
+    if (!stream.seekable()) {
+        return {};
+    }
+
+    std::size_t position = stream.position();
+
+    std::optional<std::vector<std::size_t>> file_ends = find_parquet_file_ends(stream);
+
+    stream.seek(position);
+
+    if (file_ends == std::nullopt) {
+        logger::warn("The boundaries of the Parquet files in the stream cannot be determined "
+                     "from their footers; the stream will be scanned for them instead.");
+
+        return {};
+    }
+
+    return std::move(*file_ends);
+}
+
+void Parquet_record_reader::set_file_ends(std::vector<std::size_t> &&file_ends)
+{
+    file_ends_ = std::move(file_ends);
+
+    if (file_ends_.empty()) {
+        return;
+    }
+
+    // If we can seek, we read each file with a single request of its
+    // exact size. This way we hold no more memory than the file itself;
+    // sizing the chunks for the largest file would, due to rounding and
+    // read-ahead, pin several times that amount.
+    if (seekable()) {
+        read_files_directly_ = true;
+
+        return;
+    }
+
+    // Otherwise have the chunk reader read each file in one go instead of
+    // growing its chunks until the largest file fits.
+    std::size_t max_file_size = 0;
+
+    std::size_t file_begin = position();
+    for (std::size_t file_end : file_ends_) {
+        max_file_size = std::max(max_file_size, file_end - file_begin);
+
+        file_begin = file_end;
+    }
+
+    if (max_file_size > 0) {
+        set_record_size_hint(max_file_size);
+    }
+}
+
+std::optional<Record> Parquet_record_reader::read_record_core()
+{
+    if (read_files_directly_) {
+        std::size_t offset = position();
+
+        auto pos = std::upper_bound(file_ends_.begin(), file_ends_.end(), offset);
+        if (pos != file_ends_.end()) {
+            seek(offset, *pos - offset);
+
+            past_last_file_ = false;
+        }
+        else if (!past_last_file_) {
+            // Let the regular chunk reader handle any data past the last
+            // file; decode_framed_record() reports it as corrupt.
+            seek(offset);
+
+            past_last_file_ = true;
+        }
+    }
+
+    return Stream_record_reader::read_record_core();
+}
+
 std::optional<Record>
 Parquet_record_reader::decode_record(Memory_slice &chunk, bool ignore_leftover)
 {
@@ -34,6 +146,51 @@ Parquet_record_reader::decode_record(Memory_slice &chunk, bool ignore_leftover)
     // See https://github.com/apache/parquet-format for the spec of the
     // Parquet file format.
 
+    if (file_ends_.empty()) {
+        return scan_record(chunk, ignore_leftover);
+    }
+    return decode_framed_record(chunk, ignore_leftover);
+}
+
+std::optional<Record>
+Parquet_record_reader::decode_framed_record(Memory_slice &chunk, bool ignore_leftover)
+{
+    // The chunk starts at the current position of the reader.
+    std::size_t offset = position();
+
+    auto pos = std::upper_bound(file_ends_.begin(), file_ends_.end(), offset);
+    if (pos == file_ends_.end()) {
+        throw Corrupt_record_error{"The stream has data past the end of the last Parquet file."};
+    }
+
+    std::size_t size = *pos - offset;
+
+    if (chunk.size() < size) {
+        if (ignore_leftover) {
+            return {};
+        }
+
+        throw Corrupt_footer_error{"The record does not have a valid Parquet footer."};
+    }
+
+    if (!is_magic_number(chunk.begin())) {
+        throw Corrupt_header_error{"The record does not start with the Parquet magic number."};
+    }
+
+    if (!is_magic_number(chunk.begin() + as_ssize(size - magic_number_size_))) {
+        throw Corrupt_footer_error{"The record does not have a valid Parquet footer."};
+    }
+
+    auto payload = chunk.first(size);
+
+    chunk = chunk.subslice(size);
+
+    return Record{std::move(payload)};
+}
+
+std::optional<Record>
+Parquet_record_reader::scan_record(Memory_slice &chunk, bool ignore_leftover)
+{
     if (chunk.size() < magic_number_size_) {
         if (ignore_leftover) {
             return {};
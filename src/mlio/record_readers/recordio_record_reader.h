@@ -16,6 +16,7 @@
 #pragma once
 
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "mlio/fwd.h"
@@ -33,6 +34,11 @@ public:
         : Stream_record_reader{std::move(stream)}
     {}
 
+    std::string framing_key() const final
+    {
+        return "recordio";
+    }
+
 private:
     std::optional<Record> decode_record(Memory_slice &chunk, bool ignore_leftover) final;
 };
@@ -15,10 +15,14 @@
 
 #include "mlio/record_readers/stream_record_reader.h"
 
+#include <algorithm>
 #include <optional>
 #include <utility>
 
+#include "mlio/memory/memory_allocator.h"
+#include "mlio/memory/memory_block.h"
 #include "mlio/record_readers/detail/chunk_reader.h"
+#include "mlio/record_readers/detail/in_memory_chunk_reader.h"
 #include "mlio/record_readers/record.h"
 #include "mlio/streams/input_stream.h"
 
@@ -34,12 +38,120 @@ std::size_t Stream_record_reader::record_size_hint() const noexcept
 
 void Stream_record_reader::set_record_size_hint(std::size_t value) noexcept
 {
+    record_size_hint_ = std::max(record_size_hint_, value);
+
     chunk_reader_->set_chunk_size_hint(value);
 }
 
+void Stream_record_reader::set_chunk_size_bounds(std::size_t min_size,
+                                                 std::size_t max_size) noexcept
+{
+    min_chunk_size_ = min_size;
+    max_chunk_size_ = max_size;
+
+    chunk_reader_->set_chunk_size_bounds(min_size, max_size);
+}
+
+std::string Stream_record_reader::framing_key() const
+{
+    return {};
+}
+
+bool Stream_record_reader::seekable() const noexcept
+{
+    return stream_->seekable();
+}
+
+void Stream_record_reader::seek(std::size_t offset)
+{
+    // The chunk reader might be reading ahead from the stream; make sure
+    // it is stopped before we reposition it.
+    chunk_reader_ = nullptr;
+
+    range_ = {};
+
+    stream_->seek(offset);
+
+    chunk_reader_ = detail::make_chunk_reader(stream_);
+
+    chunk_reader_->set_chunk_size_bounds(min_chunk_size_, max_chunk_size_);
+
+    if (record_size_hint_ != 0) {
+        chunk_reader_->set_chunk_size_hint(record_size_hint_);
+    }
+
+    chunk_ = {};
+
+    chunk_offset_ = offset;
+
+    record_offset_ = offset;
+
+    discard_peeked_record();
+}
+
+void Stream_record_reader::seek(std::size_t offset, std::size_t size)
+{
+    chunk_reader_ = nullptr;
+
+    size = std::min(size, stream_->size() - std::min(offset, stream_->size()));
+
+    Memory_slice chunk{};
+
+    // If the range was part of the previous one, there is no need to
+    // read it again.
+    if (offset >= range_offset_ && offset + size <= range_offset_ + range_.size()) {
+        chunk = range_.subslice(offset - range_offset_, size);
+    }
+    else {
+        // Release the previous range before reading the next one.
+        range_ = {};
+
+        stream_->seek(offset);
+
+        if (stream_->supports_zero_copy()) {
+            chunk = stream_->read(size);
+        }
+        else {
+            Intrusive_ptr<Mutable_memory_block> block = memory_allocator().allocate(size);
+
+            // Unlike the chunk reader we need the whole range; so keep
+            // reading until we have it or hit the end of the stream.
+            Mutable_memory_span remaining{*block};
+            while (!remaining.empty()) {
+                std::size_t num_bytes_read = stream_->read(remaining);
+                if (num_bytes_read == 0) {
+                    break;
+                }
+                remaining = remaining.subspan(num_bytes_read);
+            }
+
+            chunk = Memory_slice{std::move(block)}.first(size - remaining.size());
+        }
+
+        range_ = chunk;
+
+        range_offset_ = offset;
+    }
+
+    chunk_reader_ = std::make_unique<detail::In_memory_chunk_reader>(std::move(chunk));
+
+    chunk_ = {};
+
+    chunk_offset_ = offset;
+
+    record_offset_ = offset;
+
+    discard_peeked_record();
+}
+
 Stream_record_reader::Stream_record_reader(Intrusive_ptr<Input_stream> stream)
+    : stream_{std::move(stream)}
 {
-    chunk_reader_ = detail::make_chunk_reader(std::move(stream));
+    if (stream_->seekable()) {
+        chunk_offset_ = stream_->position();
+    }
+
+    chunk_reader_ = detail::make_chunk_reader(stream_);
 }
 
 std::optional<Record> Stream_record_reader::read_record_core()
@@ -47,8 +159,19 @@ std::optional<Record> Stream_record_reader::read_record_core()
     std::optional<Record> record{};
 
     while (true) {
+        std::size_t chunk_size = chunk_.size();
+
         record = decode_record(chunk_, !chunk_reader_->eof());
+
+        std::size_t record_offset = chunk_offset_;
+
+        // Keep track of where the chunk starts in the stream so that we
+        // can tell the offset of the next record.
+        chunk_offset_ += chunk_size - chunk_.size();
+
         if (record) {
+            record_offset_ = record_offset;
+
             break;
         }
 
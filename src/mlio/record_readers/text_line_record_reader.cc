@@ -16,6 +16,7 @@
 #include "mlio/record_readers/text_line_record_reader.h"
 
 #include <optional>
+#include <string>
 
 #include "mlio/memory/memory_slice.h"
 #include "mlio/record_readers/detail/text_line.h"
@@ -27,6 +28,11 @@ namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
+std::string Text_line_record_reader::framing_key() const
+{
+    return skip_blank_ ? "text_line:1" : "text_line:0";
+}
+
 std::optional<Record>
 Text_line_record_reader::decode_text_record(Memory_slice &chunk, bool ignore_leftover)
 {
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "mlio/fwd.h"
@@ -33,6 +34,8 @@ public:
         : Text_record_reader{std::move(stream)}, skip_blank_{skip_blank}
     {}
 
+    std::string framing_key() const final;
+
 private:
     std::optional<Record> decode_text_record(Memory_slice &chunk, bool ignore_leftover) final;
 
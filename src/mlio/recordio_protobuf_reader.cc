@@ -16,9 +16,10 @@
 #include "mlio/recordio_protobuf_reader.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <limits>
-#include <stdexcept>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -26,9 +27,10 @@
 #include <tbb/tbb.h>
 
 #include "mlio/coo_tensor_builder.h"
-#include "mlio/cpu_array.h"
+#include "mlio/csr_tensor_builder.h"
 #include "mlio/data_reader_error.h"
-#include "mlio/detail/protobuf/recordio_protobuf.pb.h"
+#include "mlio/detail/protobuf/record_decoder.h"
+#include "mlio/device_array.h"
 #include "mlio/instance.h"
 #include "mlio/instance_batch.h"
 #include "mlio/logger.h"
@@ -37,76 +39,118 @@
 #include "mlio/tensor.h"
 #include "mlio/util/cast.h"
 
-using mlio::detail::Coo_tensor_builder;
 using mlio::detail::Coo_tensor_builder_impl;
+using mlio::detail::Csr_tensor_builder_impl;
 using mlio::detail::make_coo_tensor_builder;
+using mlio::detail::make_csr_tensor_builder;
+using mlio::detail::Sparse_tensor_builder;
+using mlio::detail::Protobuf_feature_view;
+using mlio::detail::Protobuf_tensor_view;
 
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 namespace {
 
-// Constructing protobuf message objects is an expensive operation;
-// therefore we re-use a single instance per thread.
-thread_local aialgs::data::Record proto_msg_{};  // NOLINT(cert-err58-cpp)
+// The buffers used while decoding an instance. They are re-used across
+// instances on each thread so that decoding does not allocate memory
+// once they have grown to their working size.
+struct Decode_buffers {
+    // Holds the entries of a split record that straddle the boundary of
+    // two fragments.
+    std::vector<std::vector<std::byte>> straddled{};
+    std::vector<Protobuf_feature_view> features{};
+    // Maps each attribute to its feature in the instance.
+    std::vector<const Protobuf_feature_view *> attr_features{};
+    std::vector<std::uint64_t> shape{};
+    std::vector<std::uint64_t> keys{};
+};
+
+thread_local Decode_buffers buffers_{};  // NOLINT(cert-err58-cpp)
+
+template<typename T>
+std::vector<T> &sparse_values_buffer() noexcept
+{
+    thread_local std::vector<T> values{};  // NOLINT(cert-err58-cpp)
+
+    return values;
+}
 
 }  // namespace
 }  // namespace detail
 
 class Recordio_protobuf_reader::Decoder_state {
 public:
-    explicit Decoder_state(const Recordio_protobuf_reader &r, std::size_t batch_size);
+    using Builder_list = std::vector<std::unique_ptr<Sparse_tensor_builder>>;
+
+    explicit Decoder_state(const Recordio_protobuf_reader &r,
+                           std::size_t batch_size,
+                           bool zero_init);
+
+    // Makes a set of sparse tensor builders for a range of rows starting
+    // at the specified row index. Used when decoding in parallel.
+    Builder_list make_sparse_tensor_builders(std::size_t batch_size, std::size_t row_idx) const;
+
+    // Reserves capacity in the specified builders for the estimated
+    // number of values of the specified number of instances.
+    void reserve_sparse_values(Builder_list &builders, std::size_t num_instances) const;
 
     const Recordio_protobuf_reader *reader;
     bool warn_bad_instance;
     bool error_bad_example;
     std::vector<Intrusive_ptr<Tensor>> tensors{};
-    std::vector<std::unique_ptr<Coo_tensor_builder>> coo_tensor_builders{};
+    Builder_list sparse_tensor_builders{};
 
 private:
-    void init_state(const Schema &schema, std::size_t batch_size);
+    void init_state(const Schema &schema, std::size_t batch_size, bool zero_init);
 
-    void init_tensor(const Attribute &attr, std::size_t batch_size);
+    void init_tensor(const Attribute &attr, std::size_t batch_size, bool zero_init);
 
-    void init_coo_tensor_builder(const Attribute &attr, std::size_t batch_size);
+    void init_sparse_tensor_builder(const Attribute &attr, std::size_t batch_size);
 };
 
 class Recordio_protobuf_reader::Decoder {
 public:
-    explicit Decoder(Decoder_state &state) : state_{&state}
+    explicit Decoder(Decoder_state &state) : Decoder{state, state.sparse_tensor_builders}
+    {}
+
+    explicit Decoder(Decoder_state &state, Decoder_state::Builder_list &builders)
+        : state_{&state}, builders_{&builders}
     {}
 
     bool decode(std::size_t row_idx, const Instance &instance);
 
 private:
-    const aialgs::data::Record *parse_proto(const Instance &instance) const;
+    bool parse_record() const;
+
+    bool map_features();
 
-    bool decode_feature(const std::string &name, const aialgs::data::Value &value);
+    bool decode_feature(const Protobuf_feature_view &feature);
 
-    template<Data_type dt, typename Protobuf_tensor>
-    bool decode_feature(const Protobuf_tensor &tensor);
+    template<Data_type dt>
+    bool decode_feature(const Protobuf_tensor_view &tensor);
 
-    template<typename Protobuf_tensor>
-    bool is_sparse(const Protobuf_tensor &tensor) const;
+    bool is_sparse(const Protobuf_tensor_view &tensor) const;
 
-    template<typename Protobuf_tensor>
-    bool shape_equals(const Protobuf_tensor &tensor) const;
+    bool shape_equals(const Protobuf_tensor_view &tensor) const;
 
-    template<Data_type dt, typename Protobuf_tensor>
-    bool copy_to_tensor(const Protobuf_tensor &tensor) const;
+    template<Data_type dt>
+    bool copy_to_tensor(const Protobuf_tensor_view &tensor) const;
 
-    template<Data_type dt, typename Protobuf_tensor>
-    bool append_to_builder(const Protobuf_tensor &tensor) const;
+    template<Data_type dt>
+    bool append_to_builder(const Protobuf_tensor_view &tensor) const;
 
     Decoder_state *state_;
+    Decoder_state::Builder_list *builders_;
     const Instance *instance_{};
     std::size_t row_idx_{};
     std::size_t attr_idx_{};
     const Attribute *attr_{};
 };
 
-Recordio_protobuf_reader::Recordio_protobuf_reader(Data_reader_params params)
-    : Parallel_data_reader{std::move(params)}
+Recordio_protobuf_reader::Recordio_protobuf_reader(Data_reader_params params,
+                                                   Recordio_protobuf_params rp_params)
+    : Parallel_data_reader{std::move(params)}, params_{rp_params}
 {}
 
 Recordio_protobuf_reader::~Recordio_protobuf_reader()
@@ -129,32 +173,79 @@ Recordio_protobuf_reader::infer_schema(const std::optional<Instance> &instance)
         return {};
     }
 
-    const aialgs::data::Record *proto_msg = parse_proto(*instance);
-    if (proto_msg == nullptr) {
+    std::vector<Protobuf_feature_view> &features = detail::buffers_.features;
+
+    if (!parse_record(*instance, features)) {
         throw Schema_error{fmt::format(
             "The instance #{1:n} in the data store '{0}' contains a corrupt RecordIO-protobuf message.",
             instance->data_store().id(),
             instance->index())};
     }
 
-    std::vector<Attribute> attrs{};
+    // Like a protobuf map, the last entry wins if a name is repeated.
+    // The labels come before the features in the schema.
+    std::vector<const Protobuf_feature_view *> entries{};
+    for (bool is_label : {true, false}) {
+        for (const Protobuf_feature_view &feature : features) {
+            if (feature.is_label != is_label) {
+                continue;
+            }
 
-    for (auto &[label, value] : proto_msg->label()) {
-        // The label and feature maps of a RecordIO-protobuf message can
-        // contain same-named features. In order to avoid name clashes
-        // we use the "label_" prefix for the labels.
-        attrs.emplace_back(make_attribute(*instance, "label_" + label, value));
+            auto pos = std::find_if(entries.begin(), entries.end(), [&feature](const auto *e) {
+                return e->is_label == feature.is_label && e->name == feature.name;
+            });
+
+            if (pos == entries.end()) {
+                entries.emplace_back(&feature);
+            }
+            else {
+                *pos = &feature;
+            }
+        }
     }
-    for (auto &[label, value] : proto_msg->features()) {
-        attrs.emplace_back(make_attribute(*instance, label, value));
+
+    std::vector<Attribute> attrs{};
+
+    for (const Protobuf_feature_view *feature : entries) {
+        attrs.emplace_back(make_attribute(*instance, *feature));
     }
 
     auto schema = make_intrusive<Schema>(std::move(attrs));
 
+    // We resolve the feature names of the instances via these indices
+    // instead of looking them up in the schema; that way we avoid
+    // constructing a string for every feature. The keys refer to the
+    // attribute names of the schema which we keep alive.
+    feature_indices_.clear();
+    label_indices_.clear();
+
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        std::string_view name = schema->attributes()[i].name();
+
+        if (entries[i]->is_label) {
+            label_indices_.emplace(name.substr(label_prefix_.size()), i);
+        }
+        else {
+            feature_indices_.emplace(name, i);
+        }
+    }
+
+    num_sparse_values_ = std::vector<std::atomic_size_t>(entries.size());
+
     // We use this value in the decode function to decide whether the
     // amount of data we need to process is worth to parallelize.
-    for (const Attribute &attr : schema->attributes()) {
-        if (!attr.sparse()) {
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        const Attribute &attr = schema->attributes()[i];
+        if (attr.sparse()) {
+            // The number of values of a sparse feature varies from one
+            // instance to another; use the first one as an estimate.
+            std::size_t num_values = entries[i]->tensor.num_values();
+
+            num_values_per_instance_ += num_values;
+
+            num_sparse_values_[i] = num_values;
+        }
+        else {
             // Add the stride of the batch dimension.
             num_values_per_instance_ += as_size(attr.strides()[0]);
         }
@@ -164,24 +255,44 @@ Recordio_protobuf_reader::infer_schema(const std::optional<Instance> &instance)
 }
 
 Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
-                                                   const std::string &name,
-                                                   const aialgs::data::Value &value)
+                                                   const Protobuf_feature_view &feature)
 {
-    switch (value.value_case()) {
-    case aialgs::data::Value::ValueCase::kFloat32Tensor:
-        return make_attribute<Data_type::float32>(instance, name, value.float32_tensor());
-
-    case aialgs::data::Value::ValueCase::kFloat64Tensor:
-        return make_attribute<Data_type::float64>(instance, name, value.float64_tensor());
+    std::string name{feature.name};
 
-    case aialgs::data::Value::ValueCase::kInt32Tensor:
-        return make_attribute<Data_type::int32>(instance, name, value.int32_tensor());
+    // The label and feature maps of a RecordIO-protobuf message can
+    // contain same-named features. In order to avoid name clashes we
+    // use the "label_" prefix for the labels.
+    if (feature.is_label) {
+        name.insert(0, label_prefix_);
+    }
 
-    case aialgs::data::Value::ValueCase::kBytes:
+    if (feature.is_bytes) {
         throw Not_supported_error{"The RecordIO-protobuf binary data format is not supported."};
+    }
 
-    case aialgs::data::Value::ValueCase::VALUE_NOT_SET:
-        break;
+    if (feature.is_tensor) {
+        switch (feature.tensor.data_type()) {
+        case Data_type::float32:
+            return make_attribute<Data_type::float32>(instance, name, feature.tensor);
+
+        case Data_type::float64:
+            return make_attribute<Data_type::float64>(instance, name, feature.tensor);
+
+        case Data_type::int32:
+            return make_attribute<Data_type::int32>(instance, name, feature.tensor);
+
+        case Data_type::size:
+        case Data_type::float16:
+        case Data_type::int8:
+        case Data_type::int16:
+        case Data_type::int64:
+        case Data_type::uint8:
+        case Data_type::uint16:
+        case Data_type::uint32:
+        case Data_type::uint64:
+        case Data_type::string:
+            break;
+        }
     }
 
     throw Schema_error{fmt::format(
@@ -191,20 +302,20 @@ Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
         name)};
 }
 
-template<Data_type dt, typename Protobuf_tensor>
+template<Data_type dt>
 Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
                                                    const std::string &name,
-                                                   const Protobuf_tensor &tensor)
+                                                   const Protobuf_tensor_view &tensor)
 {
     bool sparse{};
 
     Size_vector shape{params().batch_size};
 
-    if (tensor.keys().empty()) {
-        if (tensor.shape().empty()) {
+    if (tensor.num_keys() == 0) {
+        if (tensor.num_dims() == 0) {
             // If both the shape and the key array are empty, we treat
             // the feature as a dense vector.
-            shape.emplace_back(static_cast<std::size_t>(tensor.values_size()));
+            shape.emplace_back(tensor.num_values());
         }
         else {
             copy_shape(instance, name, shape, tensor);
@@ -213,7 +324,7 @@ Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
             // way to determine if it is dense or sparse. The common
             // practice is to check whether it has a shape and treat it
             // as sparse in such case.
-            if (tensor.values().empty()) {
+            if (tensor.num_values() == 0) {
                 sparse = true;
             }
         }
@@ -221,7 +332,7 @@ Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
     else {
         sparse = true;
 
-        if (tensor.shape().empty()) {
+        if (tensor.num_dims() == 0) {
             throw Schema_error{fmt::format(
                 "The sparse feature '{2}' of the instance #{1:n} in the data store '{0}' has no shape specified.",
                 instance.data_store().id(),
@@ -239,13 +350,18 @@ Attribute Recordio_protobuf_reader::make_attribute(const Instance &instance,
     return Attribute{name, dt, std::move(shape), {}, sparse};
 }
 
-template<typename Protobuf_tensor>
 void Recordio_protobuf_reader::copy_shape(const Instance &instance,
                                           const std::string &name,
                                           Size_vector &shape,
-                                          const Protobuf_tensor &tensor)
+                                          const Protobuf_tensor_view &tensor)
 {
-    for (std::uint64_t dim : tensor.shape()) {
+    std::vector<std::uint64_t> &dims = detail::buffers_.shape;
+
+    dims.resize(tensor.num_dims());
+
+    tensor.read_shape(dims);
+
+    for (std::uint64_t dim : dims) {
         std::size_t d{};
         if (!try_narrow(dim, d)) {
             std::size_t s = std::numeric_limits<std::byte>::digits * sizeof(std::size_t);
@@ -262,24 +378,42 @@ void Recordio_protobuf_reader::copy_shape(const Instance &instance,
     }
 }
 
+bool Recordio_protobuf_reader::builds_csr_tensor(const Attribute &attr) const noexcept
+{
+    // A CSR tensor has two dimensions; the batch dimension and the
+    // dimension of the feature.
+    return params_.sparse_tensor_format == Sparse_tensor_format::csr && attr.shape().size() == 2;
+}
+
+std::unique_ptr<Sparse_tensor_builder> Recordio_protobuf_reader::make_sparse_tensor_builder(
+    const Attribute &attr, std::size_t batch_size, std::size_t row_idx) const
+{
+    // The CSR tensor builder does not need to know its starting row as
+    // it only stores the row offsets.
+    if (builds_csr_tensor(attr)) {
+        return make_csr_tensor_builder(attr, batch_size);
+    }
+    return make_coo_tensor_builder(attr, batch_size, row_idx);
+}
+
 Intrusive_ptr<Example> Recordio_protobuf_reader::decode(const Instance_batch &batch) const
 {
-    Decoder_state state{*this, batch.size()};
+    // Unless the example can be padded, every good instance overwrites
+    // its rows in the dense tensors; so there is no need to zero-
+    // initialize them.
+    bool zero_init = batch.instances().size() != batch.size() || pad_bad_examples();
+
+    Decoder_state state{*this, batch.size(), zero_init};
 
     std::size_t num_instances = batch.instances().size();
 
     constexpr std::size_t cut_off = 10'000'000;
 
     bool should_run_serial =
-        // If we have any sparse features, we cannot decode the example
-        // in parallel as we need to append each instance sequentially
-        // to the COO tensor.
-        has_sparse_feature_ ||
         // If bad example handling mode is pad, we cannot parallelize
         // decoding as good records must be stacked together without
         // any gap in between.
-        params().bad_example_handling == Bad_example_handling::pad ||
-        params().bad_example_handling == Bad_example_handling::pad_warn ||
+        pad_bad_examples() ||
         // If the number of values (e.g. integers, floating-points) we
         // need to decode is below the cut-off threshold, avoid parallel
         // execution; otherwise the threading overhead will potentially
@@ -294,30 +428,19 @@ Intrusive_ptr<Example> Recordio_protobuf_reader::decode(const Instance_batch &ba
         num_instances_read = decode_parallel(state, batch);
     }
 
+    warn_bad_example(batch, num_instances_read);
+
     // Check if we failed to decode the example and return a null pointer
     // if that is the case.
     if (num_instances_read == std::nullopt) {
-        if (params().bad_example_handling == Bad_example_handling::skip_warn) {
-            logger::warn("The example #{0:n} has been skipped as it had at least one bad instance.",
-                         batch.index());
-        }
-
         return nullptr;
     }
 
-    if (num_instances != *num_instances_read) {
-        if (params().bad_example_handling == Bad_example_handling::pad_warn) {
-            logger::warn("The example #{0:n} has been padded as it had {1:n} bad instance(s).",
-                         batch.index(),
-                         num_instances - *num_instances_read);
-        }
-    }
-
     auto tsr_beg = state.tensors.begin();
     auto tsr_end = state.tensors.end();
 
-    auto bld_beg = state.coo_tensor_builders.begin();
-    auto bld_end = state.coo_tensor_builders.end();
+    auto bld_beg = state.sparse_tensor_builders.begin();
+    auto bld_end = state.sparse_tensor_builders.end();
 
     auto ftr_beg = tbb::make_zip_iterator(tsr_beg, bld_beg);
     auto ftr_end = tbb::make_zip_iterator(tsr_end, bld_end);
@@ -327,9 +450,22 @@ Intrusive_ptr<Example> Recordio_protobuf_reader::decode(const Instance_batch &ba
 
         // If no tensor exists at the specified index, it means the
         // corresponding feature is sparse and we should build its
-        // COO tensor.
+        // sparse tensor.
         if (tensor == nullptr) {
-            tensor = std::get<1>(*ftr_pos)->build();
+            Sparse_tensor_builder &builder = *std::get<1>(*ftr_pos);
+
+            // Keep a running estimate of the number of values per
+            // instance so that the builders of the next examples can
+            // reserve their capacity upfront.
+            if (*num_instances_read > 0) {
+                std::size_t num_values =
+                    (builder.num_values() + *num_instances_read - 1) / *num_instances_read;
+
+                num_sparse_values_[as_size(ftr_pos - ftr_beg)].store(num_values,
+                                                                     std::memory_order_relaxed);
+            }
+
+            tensor = builder.build();
         }
     }
 
@@ -343,6 +479,8 @@ Intrusive_ptr<Example> Recordio_protobuf_reader::decode(const Instance_batch &ba
 std::optional<std::size_t>
 Recordio_protobuf_reader::decode_serial(Decoder_state &state, const Instance_batch &batch) const
 {
+    state.reserve_sparse_values(state.sparse_tensor_builders, batch.instances().size());
+
     std::size_t row_idx = 0;
 
     for (const Instance &instance : batch.instances()) {
@@ -353,14 +491,9 @@ Recordio_protobuf_reader::decode_serial(Decoder_state &state, const Instance_bat
         else {
             // If the user requested to skip the example in case of an
             // error, shortcut the loop and return immediately.
-            if (params().bad_example_handling == Bad_example_handling::skip ||
-                params().bad_example_handling == Bad_example_handling::skip_warn) {
+            if (skip_bad_example()) {
                 return {};
             }
-            if (params().bad_example_handling != Bad_example_handling::pad &&
-                params().bad_example_handling != Bad_example_handling::pad_warn) {
-                throw std::invalid_argument{"The specified bad example handling is invalid."};
-            }
         }
     }
 
@@ -385,20 +518,35 @@ Recordio_protobuf_reader::decode_parallel(Decoder_state &state, const Instance_b
 
     tbb::blocked_range<decltype(range_beg)> range{range_beg, range_end};
 
-    auto worker = [this, &state, &skip_example](auto &sub_range) {
+    // The instances append their sparse features to the COO tensor
+    // builders row by row; therefore each sub-range gets its own set of
+    // builders starting at its first row. Once all sub-ranges are
+    // decoded, we merge their builders in row order.
+    tbb::concurrent_vector<std::pair<std::size_t, Decoder_state::Builder_list>> range_builders{};
+
+    auto worker = [this, &state, &batch, &range_builders, &skip_example](auto &sub_range) {
+        Decoder_state::Builder_list *builders = &state.sparse_tensor_builders;
+        if (has_sparse_feature_) {
+            std::size_t row_idx = std::get<0>(*sub_range.begin());
+
+            auto pos = range_builders.emplace_back(
+                row_idx, state.make_sparse_tensor_builders(batch.size(), row_idx));
+
+            builders = &pos->second;
+
+            state.reserve_sparse_values(*builders, sub_range.size());
+        }
+
         for (auto instance_zip : sub_range) {
-            Decoder decoder{state};
+            Decoder decoder{state, *builders};
             if (!decoder.decode(std::get<0>(instance_zip), std::get<1>(instance_zip))) {
                 // If we failed to decode the instance, we can terminate
                 // the task right away and skip this example.
-                if (params().bad_example_handling == Bad_example_handling::skip ||
-                    params().bad_example_handling == Bad_example_handling::skip_warn) {
+                if (skip_bad_example()) {
                     skip_example = true;
 
                     return;
                 }
-
-                throw std::invalid_argument{"The specified bad example handling is invalid."};
             }
         }
     };
@@ -409,49 +557,114 @@ Recordio_protobuf_reader::decode_parallel(Decoder_state &state, const Instance_b
         return {};
     }
 
+    if (!has_sparse_feature_) {
+        return num_instances;
+    }
+
+    std::sort(range_builders.begin(), range_builders.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+    });
+
+    std::vector<Sparse_tensor_builder *> builders(range_builders.size());
+
+    for (std::size_t i = 0; i < state.sparse_tensor_builders.size(); i++) {
+        std::unique_ptr<Sparse_tensor_builder> &builder = state.sparse_tensor_builders[i];
+        if (builder == nullptr) {
+            continue;
+        }
+
+        std::transform(range_builders.begin(),
+                       range_builders.end(),
+                       builders.begin(),
+                       [i](const auto &range_builder) {
+                           return range_builder.second[i].get();
+                       });
+
+        builder->merge(builders);
+    }
+
     return num_instances;
 }
 
-const aialgs::data::Record *Recordio_protobuf_reader::parse_proto(const Instance &instance)
+bool Recordio_protobuf_reader::parse_record(const Instance &instance,
+                                            std::vector<Protobuf_feature_view> &features)
 {
-    bool parsed = detail::proto_msg_.ParseFromArray(instance.bits().data(),
-                                                    static_cast<int>(instance.bits().size()));
+    features.clear();
 
-    return parsed ? &detail::proto_msg_ : nullptr;
+    // A split record is parsed in place; only the entries that straddle
+    // the boundary of two fragments are copied.
+    return detail::parse_protobuf_record(
+        instance.fragments(), features, detail::buffers_.straddled);
 }
 
 Recordio_protobuf_reader::Decoder_state::Decoder_state(const Recordio_protobuf_reader &r,
-                                                       std::size_t batch_size)
+                                                       std::size_t batch_size,
+                                                       bool zero_init)
     : reader{&r}
     , warn_bad_instance{r.warn_bad_instances()}
     , error_bad_example{r.params().bad_example_handling == Bad_example_handling::error}
 {
-    init_state(*r.schema(), batch_size);
+    init_state(*r.schema(), batch_size, zero_init);
+}
+
+Recordio_protobuf_reader::Decoder_state::Builder_list
+Recordio_protobuf_reader::Decoder_state::make_sparse_tensor_builders(std::size_t batch_size,
+                                                                     std::size_t row_idx) const
+{
+    Builder_list builders{};
+
+    builders.reserve(sparse_tensor_builders.size());
+
+    for (const Attribute &attr : reader->schema()->attributes()) {
+        if (attr.sparse()) {
+            builders.emplace_back(reader->make_sparse_tensor_builder(attr, batch_size, row_idx));
+        }
+        else {
+            builders.emplace_back(nullptr);
+        }
+    }
+
+    return builders;
+}
+
+void Recordio_protobuf_reader::Decoder_state::reserve_sparse_values(Builder_list &builders,
+                                                                    std::size_t num_instances) const
+{
+    for (std::size_t i = 0; i < builders.size(); i++) {
+        if (builders[i] != nullptr) {
+            std::size_t num_values = reader->num_sparse_values_[i].load(std::memory_order_relaxed);
+
+            builders[i]->reserve(num_values * num_instances);
+        }
+    }
 }
 
 void Recordio_protobuf_reader::Decoder_state::init_state(const Schema &schema,
-                                                         std::size_t batch_size)
+                                                         std::size_t batch_size,
+                                                         bool zero_init)
 {
     tensors.reserve(schema.attributes().size());
 
-    coo_tensor_builders.reserve(schema.attributes().size());
+    sparse_tensor_builders.reserve(schema.attributes().size());
 
     for (const Attribute &attr : schema.attributes()) {
         if (attr.sparse()) {
-            init_coo_tensor_builder(attr, batch_size);
+            init_sparse_tensor_builder(attr, batch_size);
         }
         else {
-            init_tensor(attr, batch_size);
+            init_tensor(attr, batch_size, zero_init);
         }
     }
 }
 
 void Recordio_protobuf_reader::Decoder_state::init_tensor(const Attribute &attr,
-                                                          std::size_t batch_size)
+                                                          std::size_t batch_size,
+                                                          bool zero_init)
 {
     std::size_t data_size = batch_size * as_size(attr.strides()[0]);
 
-    std::unique_ptr<Device_array> arr = make_cpu_array(attr.data_type(), data_size);
+    std::unique_ptr<Device_array> arr =
+        reader->make_feature_array(attr.data_type(), data_size, zero_init);
 
     Size_vector shape = attr.shape();
 
@@ -463,15 +676,15 @@ void Recordio_protobuf_reader::Decoder_state::init_tensor(const Attribute &attr,
 
     tensors.emplace_back(std::move(tensor));
 
-    coo_tensor_builders.emplace_back(nullptr);
+    sparse_tensor_builders.emplace_back(nullptr);
 }
 
-void Recordio_protobuf_reader::Decoder_state::init_coo_tensor_builder(const Attribute &attr,
-                                                                      std::size_t batch_size)
+void Recordio_protobuf_reader::Decoder_state::init_sparse_tensor_builder(const Attribute &attr,
+                                                                         std::size_t batch_size)
 {
-    auto builder = make_coo_tensor_builder(attr, batch_size);
+    auto builder = reader->make_sparse_tensor_builder(attr, batch_size, 0);
 
-    coo_tensor_builders.emplace_back(std::move(builder));
+    sparse_tensor_builders.emplace_back(std::move(builder));
 
     tensors.emplace_back(nullptr);
 }
@@ -482,43 +695,37 @@ bool Recordio_protobuf_reader::Decoder::decode(std::size_t row_idx, const Instan
 
     instance_ = &instance;
 
-    const aialgs::data::Record *proto_msg = parse_proto(instance);
-    if (proto_msg == nullptr) {
+    if (!parse_record()) {
         return false;
     }
 
-    std::size_t num_features_read = 0;
+    if (!map_features()) {
+        return false;
+    }
 
-    for (auto &[label, value] : proto_msg->label()) {
-        if (!decode_feature("label_" + label, value)) {
-            return false;
-        }
+    const std::vector<const Protobuf_feature_view *> &attr_features =
+        detail::buffers_.attr_features;
 
-        num_features_read++;
-    }
-    for (auto &[label, value] : proto_msg->features()) {
-        if (!decode_feature(label, value)) {
+    for (attr_idx_ = 0; attr_idx_ < attr_features.size(); attr_idx_++) {
+        if (!decode_feature(*attr_features[attr_idx_])) {
             return false;
         }
-
-        num_features_read++;
     }
 
-    const auto &schema = state_->reader->schema();
+    return true;
+}
 
-    // Make sure that we read all features for which we have an
-    // attribute in the schema.
-    if (num_features_read == schema->attributes().size()) {
+bool Recordio_protobuf_reader::Decoder::parse_record() const
+{
+    if (Recordio_protobuf_reader::parse_record(*instance_, detail::buffers_.features)) {
         return true;
     }
 
     if (state_->warn_bad_instance || state_->error_bad_example) {
         auto msg = fmt::format(
-            "The instance #{1:n} in the data store '{0}' has {2:n} feature(s) while it is expected to have {3:n} features.",
+            "The instance #{1:n} in the data store '{0}' contains a corrupt RecordIO-protobuf message.",
             instance_->data_store().id(),
-            instance_->index(),
-            num_features_read,
-            schema->attributes().size());
+            instance_->index());
 
         if (state_->warn_bad_instance) {
             logger::warn(msg);
@@ -532,19 +739,69 @@ bool Recordio_protobuf_reader::Decoder::decode(std::size_t row_idx, const Instan
     return false;
 }
 
-const aialgs::data::Record *
-Recordio_protobuf_reader::Decoder::parse_proto(const Instance &instance) const
+bool Recordio_protobuf_reader::Decoder::map_features()
 {
-    const aialgs::data::Record *proto_msg = Recordio_protobuf_reader::parse_proto(instance);
-    if (proto_msg != nullptr) {
-        return proto_msg;
+    const Recordio_protobuf_reader &reader = *state_->reader;
+
+    std::size_t num_attrs = reader.schema()->attributes().size();
+
+    std::vector<const Protobuf_feature_view *> &attr_features = detail::buffers_.attr_features;
+
+    attr_features.assign(num_attrs, nullptr);
+
+    std::size_t num_features_read = 0;
+
+    for (const Protobuf_feature_view &feature : detail::buffers_.features) {
+        const auto &indices = feature.is_label ? reader.label_indices_ : reader.feature_indices_;
+
+        auto pos = indices.find(feature.name);
+        if (pos == indices.end()) {
+            if (state_->warn_bad_instance || state_->error_bad_example) {
+                std::string name{feature.name};
+                if (feature.is_label) {
+                    name.insert(0, label_prefix_);
+                }
+
+                auto msg = fmt::format(
+                    "The instance #{1:n} in the data store '{0}' has an unknown feature named '{2}'.",
+                    instance_->data_store().id(),
+                    instance_->index(),
+                    name);
+
+                if (state_->warn_bad_instance) {
+                    logger::warn(msg);
+                }
+
+                if (state_->error_bad_example) {
+                    throw Invalid_instance_error{msg};
+                }
+            }
+
+            return false;
+        }
+
+        // Like a protobuf map, the last entry wins if a name is repeated.
+        const Protobuf_feature_view *&attr_feature = attr_features[pos->second];
+        if (attr_feature == nullptr) {
+            num_features_read++;
+        }
+
+        attr_feature = &feature;
+    }
+
+    // Make sure that we read all features for which we have an
+    // attribute in the schema.
+    if (num_features_read == num_attrs) {
+        return true;
     }
 
     if (state_->warn_bad_instance || state_->error_bad_example) {
         auto msg = fmt::format(
-            "The instance #{1:n} in the data store '{0}' contains a corrupt RecordIO-protobuf message.",
+            "The instance #{1:n} in the data store '{0}' has {2:n} feature(s) while it is expected to have {3:n} features.",
             instance_->data_store().id(),
-            instance_->index());
+            instance_->index(),
+            num_features_read,
+            num_attrs);
 
         if (state_->warn_bad_instance) {
             logger::warn(msg);
@@ -555,52 +812,36 @@ Recordio_protobuf_reader::Decoder::parse_proto(const Instance &instance) const
         }
     }
 
-    return nullptr;
+    return false;
 }
 
-bool Recordio_protobuf_reader::Decoder::decode_feature(const std::string &name,
-                                                       const aialgs::data::Value &value)
+bool Recordio_protobuf_reader::Decoder::decode_feature(const Protobuf_feature_view &feature)
 {
-    const auto &schema = state_->reader->schema();
-
-    std::optional<std::size_t> attr_idx = schema->get_index(name);
-    if (attr_idx == std::nullopt) {
-        if (state_->warn_bad_instance || state_->error_bad_example) {
-            auto msg = fmt::format(
-                "The instance #{1:n} in the data store '{0}' has an unknown feature named '{2}'.",
-                instance_->data_store().id(),
-                instance_->index(),
-                name);
-
-            if (state_->warn_bad_instance) {
-                logger::warn(msg);
-            }
-
-            if (state_->error_bad_example) {
-                throw Invalid_instance_error{msg};
-            }
+    attr_ = &state_->reader->schema()->attributes()[attr_idx_];
+
+    if (feature.is_tensor) {
+        switch (feature.tensor.data_type()) {
+        case Data_type::float32:
+            return decode_feature<Data_type::float32>(feature.tensor);
+
+        case Data_type::float64:
+            return decode_feature<Data_type::float64>(feature.tensor);
+
+        case Data_type::int32:
+            return decode_feature<Data_type::int32>(feature.tensor);
+
+        case Data_type::size:
+        case Data_type::float16:
+        case Data_type::int8:
+        case Data_type::int16:
+        case Data_type::int64:
+        case Data_type::uint8:
+        case Data_type::uint16:
+        case Data_type::uint32:
+        case Data_type::uint64:
+        case Data_type::string:
+            break;
         }
-
-        return false;
-    }
-
-    attr_idx_ = *attr_idx;
-
-    attr_ = &schema->attributes()[attr_idx_];
-
-    switch (value.value_case()) {
-    case aialgs::data::Value::ValueCase::kFloat32Tensor:
-        return decode_feature<Data_type::float32>(value.float32_tensor());
-
-    case aialgs::data::Value::ValueCase::kFloat64Tensor:
-        return decode_feature<Data_type::float64>(value.float64_tensor());
-
-    case aialgs::data::Value::ValueCase::kInt32Tensor:
-        return decode_feature<Data_type::int32>(value.int32_tensor());
-
-    case aialgs::data::Value::ValueCase::kBytes:
-    case aialgs::data::Value::ValueCase::VALUE_NOT_SET:
-        break;
     }
 
     if (state_->warn_bad_instance || state_->error_bad_example) {
@@ -622,8 +863,8 @@ bool Recordio_protobuf_reader::Decoder::decode_feature(const std::string &name,
     return false;
 }
 
-template<Data_type dt, typename Protobuf_tensor>
-bool Recordio_protobuf_reader::Decoder::decode_feature(const Protobuf_tensor &tensor)
+template<Data_type dt>
+bool Recordio_protobuf_reader::Decoder::decode_feature(const Protobuf_tensor_view &tensor)
 {
     if (attr_->data_type() != dt) {
         if (state_->warn_bad_instance || state_->error_bad_example) {
@@ -676,11 +917,15 @@ bool Recordio_protobuf_reader::Decoder::decode_feature(const Protobuf_tensor &te
     if (!shape_equals(tensor)) {
         if (state_->warn_bad_instance || state_->error_bad_example) {
             std::string shape_str;
-            if (tensor.shape().empty()) {
-                shape_str = fmt::to_string(tensor.values_size());
+            if (tensor.num_dims() == 0) {
+                shape_str = fmt::to_string(tensor.num_values());
             }
             else {
-                shape_str = fmt::format("{0}", fmt::join(tensor.shape(), ", "));
+                std::vector<std::uint64_t> dims(tensor.num_dims());
+
+                tensor.read_shape(dims);
+
+                shape_str = fmt::format("{0}", fmt::join(dims, ", "));
             }
 
             const Size_vector &shape = attr_->shape();
@@ -712,40 +957,42 @@ bool Recordio_protobuf_reader::Decoder::decode_feature(const Protobuf_tensor &te
     return copy_to_tensor<dt>(tensor);
 }
 
-template<typename Protobuf_tensor>
-bool Recordio_protobuf_reader::Decoder::is_sparse(const Protobuf_tensor &tensor) const
+bool Recordio_protobuf_reader::Decoder::is_sparse(const Protobuf_tensor_view &tensor) const
 {
-    if (tensor.keys().empty()) {
-        return tensor.values().empty() && !tensor.shape().empty();
+    if (tensor.num_keys() == 0) {
+        return tensor.num_values() == 0 && tensor.num_dims() != 0;
     }
     return true;
 }
 
-template<typename Protobuf_tensor>
-bool Recordio_protobuf_reader::Decoder::shape_equals(const Protobuf_tensor &tensor) const
+bool Recordio_protobuf_reader::Decoder::shape_equals(const Protobuf_tensor_view &tensor) const
 {
     const Size_vector &shape = attr_->shape();
 
     // A dense feature might have no shape specified.
-    if (tensor.shape().empty()) {
+    if (tensor.num_dims() == 0) {
         if (shape.size() == 2) {
-            auto val_size = static_cast<std::size_t>(tensor.values_size());
             // In such case we consider the size of the value array as
             // its one-dimensional shape.
-            return shape[1] == val_size;
+            return shape[1] == tensor.num_values();
         }
         return false;
     }
 
-    auto shape_size = static_cast<std::size_t>(tensor.shape().size());
     // We should skip the batch dimension while comparing the shapes.
-    if (shape.size() - 1 != shape_size) {
+    if (shape.size() - 1 != tensor.num_dims()) {
         return false;
     }
 
+    std::vector<std::uint64_t> &dims = detail::buffers_.shape;
+
+    dims.resize(tensor.num_dims());
+
+    tensor.read_shape(dims);
+
     auto pos = shape.begin() + 1;
 
-    for (std::uint64_t dim : tensor.shape()) {
+    for (std::uint64_t dim : dims) {
         std::size_t d{};
         if (!try_narrow(dim, d) || *pos != d) {
             return false;
@@ -757,13 +1004,13 @@ bool Recordio_protobuf_reader::Decoder::shape_equals(const Protobuf_tensor &tens
     return true;
 }
 
-template<Data_type dt, typename Protobuf_tensor>
-bool Recordio_protobuf_reader::Decoder::copy_to_tensor(const Protobuf_tensor &tensor) const
+template<Data_type dt>
+bool Recordio_protobuf_reader::Decoder::copy_to_tensor(const Protobuf_tensor_view &tensor) const
 {
     // The stride of the batch dimension.
     std::ptrdiff_t num_values = attr_->strides()[0];
 
-    if (num_values != tensor.values_size()) {
+    if (as_size(num_values) != tensor.num_values()) {
         if (state_->warn_bad_instance || state_->error_bad_example) {
             const Size_vector &shape = attr_->shape();
 
@@ -772,7 +1019,7 @@ bool Recordio_protobuf_reader::Decoder::copy_to_tensor(const Protobuf_tensor &te
                 instance_->data_store().id(),
                 instance_->index(),
                 attr_->name(),
-                tensor.values_size(),
+                tensor.num_values(),
                 fmt::join(shape.begin() + 1, shape.end(), ", "));
 
             if (state_->warn_bad_instance) {
@@ -793,23 +1040,24 @@ bool Recordio_protobuf_reader::Decoder::copy_to_tensor(const Protobuf_tensor &te
 
     std::ptrdiff_t offset = as_ssize(row_idx_) * num_values;
 
-    std::copy_n(tensor.values().begin(), num_values, destination.begin() + offset);
+    // The values are decoded straight from the wire into the tensor.
+    tensor.read_values(destination.subspan(as_size(offset), as_size(num_values)));
 
     return true;
 }
 
-template<Data_type dt, typename Protobuf_tensor>
-bool Recordio_protobuf_reader::Decoder::append_to_builder(const Protobuf_tensor &tensor) const
+template<Data_type dt>
+bool Recordio_protobuf_reader::Decoder::append_to_builder(const Protobuf_tensor_view &tensor) const
 {
-    if (tensor.keys_size() != tensor.values_size()) {
+    if (tensor.num_keys() != tensor.num_values()) {
         if (state_->warn_bad_instance || state_->error_bad_example) {
             auto msg = fmt::format(
                 "The sparse feature '{2}' of the instance #{1:n} in the data store '{0}' has {3:n} key(s) but {4:n} value(s).",
                 instance_->data_store().id(),
                 instance_->index(),
                 attr_->name(),
-                tensor.keys_size(),
-                tensor.values_size());
+                tensor.num_keys(),
+                tensor.num_values());
 
             if (state_->warn_bad_instance) {
                 logger::warn(msg);
@@ -823,10 +1071,29 @@ bool Recordio_protobuf_reader::Decoder::append_to_builder(const Protobuf_tensor
         return false;
     }
 
-    auto &builder =
-        static_cast<Coo_tensor_builder_impl<dt> &>(*state_->coo_tensor_builders[attr_idx_]);
+    std::vector<data_type_t<dt>> &values = detail::sparse_values_buffer<data_type_t<dt>>();
+
+    values.resize(tensor.num_values());
+
+    tensor.read_values(make_span(values));
+
+    std::vector<std::uint64_t> &keys = detail::buffers_.keys;
+
+    keys.resize(tensor.num_keys());
+
+    tensor.read_keys(keys);
+
+    Sparse_tensor_builder &builder = *(*builders_)[attr_idx_];
+
+    bool appended{};
+    if (state_->reader->builds_csr_tensor(*attr_)) {
+        appended = static_cast<Csr_tensor_builder_impl<dt> &>(builder).append(values, keys);
+    }
+    else {
+        appended = static_cast<Coo_tensor_builder_impl<dt> &>(builder).append(values, keys);
+    }
 
-    if (builder.append(tensor.values(), tensor.keys())) {
+    if (appended) {
         return true;
     }
 
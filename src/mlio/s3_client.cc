@@ -15,6 +15,19 @@
 
 #include "mlio/s3_client.h"
 
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::size_t default_read_ahead_part_size = 0x80'0000;  // 8 MiB
+constexpr std::size_t default_num_read_ahead_parts = 8;
+
+}  // namespace
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
 #ifdef MLIO_BUILD_S3
 
 #include <mutex>
@@ -31,6 +44,7 @@
 #include <aws/s3/model/ListObjectsV2Request.h>
 #include <fmt/format.h>
 
+#include "mlio/detail/s3_error.h"
 #include "mlio/util/cast.h"
 
 namespace mlio {
@@ -82,7 +96,7 @@ Aws::Auth::AWSCredentials get_default_aws_credentials()
         break;
     }
 
-    throw std::system_error{ec, "The S3 object cannot be accessed."};
+    throw S3_error{ec, "The S3 object cannot be accessed.", err.ShouldRetry()};
 }
 
 #pragma GCC diagnostic pop
@@ -98,8 +112,14 @@ inline void check_s3_error(const Outcome &outcome)
 }  // namespace
 }  // namespace detail
 
-S3_client::S3_client(std::unique_ptr<Aws::S3::S3Client> native_client) noexcept
+S3_client::S3_client(std::unique_ptr<Aws::S3::S3Client> native_client,
+                     std::size_t read_ahead_part_size,
+                     std::size_t num_read_ahead_parts) noexcept
     : native_client_{std::move(native_client)}
+    , read_ahead_part_size_{read_ahead_part_size == 0 ? detail::default_read_ahead_part_size
+                                                      : read_ahead_part_size}
+    , num_read_ahead_parts_{num_read_ahead_parts == 0 ? detail::default_num_read_ahead_parts
+                                                      : num_read_ahead_parts}
 {}
 
 S3_client::~S3_client() = default;
@@ -206,7 +226,8 @@ Intrusive_ptr<S3_client> make_s3_client(const S3_client_options &opts)
 
     auto native_client = std::make_unique<Aws::S3::S3Client>(credentials, config);
 
-    return make_intrusive<S3_client>(std::move(native_client));
+    return make_intrusive<S3_client>(
+        std::move(native_client), opts.read_ahead_part_size, opts.num_read_ahead_parts);
 }
 
 }  // namespace abi_v1
@@ -228,7 +249,14 @@ inline namespace abi_v1 {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmissing-noreturn"
 
-S3_client::S3_client(std::unique_ptr<Aws::S3::S3Client>) noexcept : native_client_{}
+S3_client::S3_client(std::unique_ptr<Aws::S3::S3Client>,
+                     std::size_t read_ahead_part_size,
+                     std::size_t num_read_ahead_parts) noexcept
+    : native_client_{}
+    , read_ahead_part_size_{read_ahead_part_size == 0 ? detail::default_read_ahead_part_size
+                                                      : read_ahead_part_size}
+    , num_read_ahead_parts_{num_read_ahead_parts == 0 ? detail::default_num_read_ahead_parts
+                                                      : num_read_ahead_parts}
 {}
 
 S3_client::~S3_client() = default;
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/sparse_tensor_builder.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Sparse_tensor_builder::~Sparse_tensor_builder() = default;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
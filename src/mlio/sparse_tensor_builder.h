@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/span.h"
+#include "mlio/tensor.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Represents an interface for building the sparse tensor of a feature
+// by appending the instances of a batch one row at a time.
+class Sparse_tensor_builder {
+public:
+    Sparse_tensor_builder() noexcept = default;
+
+    Sparse_tensor_builder(const Sparse_tensor_builder &) = delete;
+
+    Sparse_tensor_builder &operator=(const Sparse_tensor_builder &) = delete;
+
+    Sparse_tensor_builder(Sparse_tensor_builder &&) = delete;
+
+    Sparse_tensor_builder &operator=(Sparse_tensor_builder &&) = delete;
+
+    virtual ~Sparse_tensor_builder();
+
+    virtual Intrusive_ptr<Tensor> build() = 0;
+
+    // Appends the contents of the specified builders, which must be of
+    // the same type as this builder and must have been used for
+    // consecutive row ranges following the rows of this builder, in
+    // order of their ranges. The contents are copied in parallel to
+    // their offsets computed via a prefix sum over the number of values
+    // of each builder.
+    virtual void merge(stdx::span<Sparse_tensor_builder *const> builders) = 0;
+
+    // Reserves capacity for the specified number of values.
+    virtual void reserve(std::size_t num_values) = 0;
+
+    // Gets the number of values appended so far.
+    virtual std::size_t num_values() const noexcept = 0;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
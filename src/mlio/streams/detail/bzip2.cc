@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/bzip2.h"
+
+#ifdef MLIO_BUILD_BZIP2
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <new>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Bzip2_inflater::Bzip2_inflater()
+{
+    init();
+}
+
+Bzip2_inflater::~Bzip2_inflater()
+{
+    ::BZ2_bzDecompressEnd(&stream_);
+}
+
+void Bzip2_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
+{
+    if (inp.empty() && eof_) {
+        return;
+    }
+
+    // bzip2 counts in 32-bit integers; larger buffers are processed over
+    // several calls.
+    constexpr std::size_t max_size = std::numeric_limits<unsigned>::max();
+
+    auto i_buf = as_span<const char>(inp).first(std::min(inp.size(), max_size));
+    auto o_buf = as_span<char>(out).first(std::min(out.size(), max_size));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    stream_.next_in = const_cast<char *>(i_buf.data());
+    stream_.next_out = o_buf.data();
+
+    stream_.avail_in = static_cast<unsigned>(i_buf.size());
+    stream_.avail_out = static_cast<unsigned>(o_buf.size());
+
+    int r = ::BZ2_bzDecompress(&stream_);
+
+    inp = inp.subspan(i_buf.size() - stream_.avail_in);
+    out = out.subspan(o_buf.size() - stream_.avail_out);
+
+    switch (r) {
+    case BZ_OK:
+        eof_ = false;
+
+        return;
+
+    case BZ_STREAM_END:
+        // Tools like pbzip2 write several concatenated bzip2 streams; we
+        // have to start over to inflate the next one.
+        ::BZ2_bzDecompressEnd(&stream_);
+
+        init();
+
+        eof_ = true;
+
+        return;
+
+    case BZ_MEM_ERROR:
+        throw std::bad_alloc{};
+
+    default:
+        throw Inflate_error{"The bzip2 stream contains invalid or incomplete data."};
+    }
+}
+
+void Bzip2_inflater::check_eof() const
+{
+    if (!eof_) {
+        throw Inflate_error{"The bzip2 stream contains invalid or incomplete data."};
+    }
+}
+
+void Bzip2_inflater::init()
+{
+    stream_ = {};
+
+    int r = ::BZ2_bzDecompressInit(&stream_, 0, 0);
+    if (r == BZ_OK) {
+        return;
+    }
+
+    if (r == BZ_MEM_ERROR) {
+        throw std::bad_alloc{};
+    }
+    assert(false);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#ifdef MLIO_BUILD_BZIP2
+
+#include <bzlib.h>
+
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+class Bzip2_inflater final : public Inflater {
+public:
+    explicit Bzip2_inflater();
+
+    Bzip2_inflater(const Bzip2_inflater &) = delete;
+
+    Bzip2_inflater &operator=(const Bzip2_inflater &) = delete;
+
+    Bzip2_inflater(Bzip2_inflater &&) = delete;
+
+    Bzip2_inflater &operator=(Bzip2_inflater &&) = delete;
+
+    ~Bzip2_inflater() final;
+
+    void inflate(Memory_span &inp, Mutable_memory_span &out) final;
+
+    bool eof() const noexcept final
+    {
+        return eof_;
+    }
+
+    void check_eof() const final;
+
+private:
+    void init();
+
+    ::bz_stream stream_{};
+    bool eof_ = true;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
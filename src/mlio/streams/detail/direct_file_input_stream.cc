@@ -0,0 +1,246 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/direct_file_input_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mlio/detail/error.h"
+#include "mlio/detail/path.h"
+#include "mlio/logger.h"
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+inline bool is_aligned(std::size_t value, std::size_t alignment) noexcept
+{
+    return (value & (alignment - 1)) == 0;
+}
+
+inline std::size_t align_down(std::size_t value, std::size_t alignment) noexcept
+{
+    return value & ~(alignment - 1);
+}
+
+}  // namespace
+
+Direct_file_input_stream::Direct_file_input_stream(std::string path) : path_{std::move(path)}
+{
+    validate_file_path(path_);
+
+#ifdef O_DIRECT
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+    if (fd_ == -1 && errno == EINVAL) {
+        // The file system (e.g. tmpfs) does not support direct I/O.
+        logger::warn("The file '{0}' cannot be opened for direct I/O; it will be read through the "
+                     "page cache.",
+                     path_);
+
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    else {
+        direct_ = true;
+    }
+#else
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd_ == -1) {
+        throw std::system_error{current_error_code(), "The file cannot be opened."};
+    }
+
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    // macOS has no O_DIRECT, but offers the same behavior via fcntl().
+    direct_ = ::fcntl(fd_.get(), F_NOCACHE, 1) != -1;
+#endif
+
+    struct ::stat buf = {};
+    if (::fstat(fd_.get(), &buf) == -1) {
+        throw std::system_error{current_error_code(), "The size of the file cannot be retrieved."};
+    }
+
+    size_ = static_cast<std::size_t>(buf.st_size);
+
+    void *ptr{};
+    if (::posix_memalign(&ptr, alignment_, buffer_size_) != 0) {
+        throw std::bad_alloc{};
+    }
+
+    buffer_.reset(static_cast<std::byte *>(ptr));
+}
+
+std::size_t Direct_file_input_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty() || position_ >= size_) {
+        return 0;
+    }
+
+    // Serve the request from the staging buffer if it holds the current
+    // position.
+    if (position_ >= buffer_offset_ && position_ < buffer_offset_ + buffer_length_) {
+        std::size_t offset = position_ - buffer_offset_;
+
+        std::size_t size = std::min(buffer_length_ - offset, destination.size());
+
+        std::copy_n(buffer_.get() + offset, size, destination.data());
+
+        position_ += size;
+
+        return size;
+    }
+
+    // If both the position and the destination are suitably aligned, we
+    // can bypass the staging buffer for the aligned part of the request.
+    auto address = reinterpret_cast<std::uintptr_t>(destination.data());
+    if (is_aligned(position_, alignment_) && is_aligned(address, alignment_) &&
+        destination.size() >= min_direct_read_size_) {
+        std::size_t size = align_down(destination.size(), alignment_);
+
+        std::size_t num_bytes_read = read_aligned(destination.first(size), position_);
+
+        position_ += num_bytes_read;
+
+        return num_bytes_read;
+    }
+
+    // Otherwise refill the staging buffer starting at the aligned offset
+    // preceding the current position; this also takes care of the tail
+    // of the file whose length is not a multiple of the block size.
+    buffer_offset_ = align_down(position_, alignment_);
+
+    buffer_length_ = read_aligned(Mutable_memory_span{buffer_.get(), buffer_size_}, buffer_offset_);
+
+    if (buffer_offset_ + buffer_length_ <= position_) {
+        // The file has been truncated since we opened it.
+        return 0;
+    }
+
+    return read(destination);
+}
+
+std::size_t Direct_file_input_stream::read_aligned(Mutable_memory_span destination,
+                                                   std::size_t offset)
+{
+    std::size_t num_bytes_read = 0;
+
+    // Keep reading until the destination is full or we hit the end of
+    // the file; a short read at an unaligned length must not happen
+    // anywhere but at the tail.
+    while (num_bytes_read < destination.size()) {
+        auto buffer = destination.subspan(num_bytes_read);
+
+        ssize_t r = ::pread(fd_.get(),
+                            buffer.data(),
+                            buffer.size(),
+                            static_cast<::off_t>(offset + num_bytes_read));
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Some file systems accept O_DIRECT on open, but reject the
+            // reads themselves.
+            if (errno == EINVAL && direct_) {
+                disable_direct_io();
+
+                continue;
+            }
+
+            throw std::system_error{current_error_code(), "The file cannot be read."};
+        }
+
+        if (r == 0) {
+            break;
+        }
+
+        num_bytes_read += static_cast<std::size_t>(r);
+
+        if (!is_aligned(num_bytes_read, alignment_)) {
+            break;
+        }
+    }
+
+    return num_bytes_read;
+}
+
+void Direct_file_input_stream::disable_direct_io()
+{
+    logger::warn("The file '{0}' cannot be read using direct I/O; it will be read through the "
+                 "page cache.",
+                 path_);
+
+#ifdef O_DIRECT
+    int flags = ::fcntl(fd_.get(), F_GETFL);
+    if (flags == -1 || ::fcntl(fd_.get(), F_SETFL, flags & ~O_DIRECT) == -1) {
+        throw std::system_error{current_error_code(), "The file cannot be read."};
+    }
+#endif
+
+    direct_ = false;
+}
+
+void Direct_file_input_stream::seek(std::size_t position)
+{
+    check_if_closed();
+
+    position_ = std::min(position, size_);
+}
+
+void Direct_file_input_stream::close() noexcept
+{
+    fd_ = {};
+
+    buffer_ = nullptr;
+}
+
+std::size_t Direct_file_input_stream::size() const
+{
+    check_if_closed();
+
+    return size_;
+}
+
+std::size_t Direct_file_input_stream::position() const
+{
+    check_if_closed();
+
+    return position_;
+}
+
+void Direct_file_input_stream::check_if_closed() const
+{
+    if (fd_.is_open()) {
+        return;
+    }
+
+    throw Stream_error{"The input stream is closed."};
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
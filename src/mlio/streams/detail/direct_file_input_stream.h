@@ -0,0 +1,105 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "mlio/detail/file_descriptor.h"
+#include "mlio/span.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Reads a file bypassing the page cache (O_DIRECT). Since direct I/O
+// requires the file offset, the length, and the address of a read to be
+// aligned to the logical block size of the underlying device, the file
+// is read into an aligned staging buffer from which the caller is
+// served. Large, aligned reads go straight into the caller's buffer.
+class Direct_file_input_stream final : public Input_stream_base {
+    struct Free_deleter {
+        void operator()(std::byte *ptr) const noexcept
+        {
+            std::free(ptr);  // NOLINT
+        }
+    };
+
+public:
+    explicit Direct_file_input_stream(std::string path);
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void seek(std::size_t position) final;
+
+    void close() noexcept final;
+
+    std::size_t size() const final;
+
+    std::size_t position() const final;
+
+    bool closed() const noexcept final
+    {
+        return !fd_.is_open();
+    }
+
+    bool seekable() const noexcept final
+    {
+        return true;
+    }
+
+    // Gets the alignment that the address of a destination buffer and
+    // the stream position must have for a read to bypass the staging
+    // buffer.
+    static constexpr std::size_t alignment() noexcept
+    {
+        return alignment_;
+    }
+
+private:
+    std::size_t read_aligned(Mutable_memory_span destination, std::size_t offset);
+
+    void disable_direct_io();
+
+    void check_if_closed() const;
+
+    // Covers the logical block size of virtually all storage devices.
+    static constexpr std::size_t alignment_ = 0x1000;       // 4 KiB
+    static constexpr std::size_t buffer_size_ = 0x40'0000;  // 4 MiB
+    // The smallest aligned read that bypasses the staging buffer; it
+    // matches the size of the reads issued by the chunk reader.
+    static constexpr std::size_t min_direct_read_size_ = 0x10'0000;  // 1 MiB
+
+    std::string path_;
+    File_descriptor fd_{};
+    bool direct_{};
+    std::size_t size_{};
+    std::unique_ptr<std::byte, Free_deleter> buffer_{};
+    // The file offset of the first byte of the staging buffer.
+    std::size_t buffer_offset_{};
+    // The number of valid bytes in the staging buffer.
+    std::size_t buffer_length_{};
+    std::size_t position_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
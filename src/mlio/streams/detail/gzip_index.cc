@@ -0,0 +1,235 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/gzip_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "mlio/config.h"
+#include "mlio/logger.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::array<char, 8> index_magic{'M', 'L', 'I', 'O', 'G', 'Z', 'X', '2'};
+
+// Like the record index, the gzip index is a local cache of the file, so
+// we simply use the native representation of the sizes.
+bool read_size(std::istream &s, std::size_t &value)
+{
+    return static_cast<bool>(s.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+void write_size(std::ostream &s, std::size_t value)
+{
+    s.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool read_mtime(std::istream &s, std::int64_t &value)
+{
+    return static_cast<bool>(s.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+void write_mtime(std::ostream &s, std::int64_t value)
+{
+    s.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool read_access_point(std::istream &s, Gzip_access_point &point)
+{
+    std::size_t num_bits{};
+    std::size_t window_size{};
+    if (!read_size(s, point.compressed_offset) || !read_size(s, num_bits) ||
+        !read_size(s, point.offset) || !read_size(s, window_size)) {
+        return false;
+    }
+
+    if (num_bits > 7 || window_size > 0x8000) {
+        return false;
+    }
+
+    point.num_bits = static_cast<int>(num_bits);
+
+    point.window.resize(window_size);
+
+    return static_cast<bool>(
+        s.read(reinterpret_cast<char *>(point.window.data()), static_cast<std::streamsize>(window_size)));
+}
+
+void write_access_point(std::ostream &s, const Gzip_access_point &point)
+{
+    write_size(s, point.compressed_offset);
+    write_size(s, static_cast<std::size_t>(point.num_bits));
+    write_size(s, point.offset);
+    write_size(s, point.window.size());
+
+    s.write(reinterpret_cast<const char *>(point.window.data()),
+            static_cast<std::streamsize>(point.window.size()));
+}
+
+}  // namespace
+
+const Gzip_access_point &Gzip_index::lookup(std::size_t offset) const noexcept
+{
+    auto pos = std::upper_bound(
+        points_.begin(), points_.end(), offset, [](std::size_t o, const Gzip_access_point &point) {
+            return o < point.offset;
+        });
+
+    if (pos == points_.begin()) {
+        return *pos;
+    }
+    return *(pos - 1);
+}
+
+std::string gzip_index_path(const std::string &path)
+{
+    return path + ".mliogzidx";
+}
+
+std::optional<Gzip_index_key> make_gzip_index_key(const std::string &path)
+{
+    struct ::stat buf = {};
+    if (::stat(path.c_str(), &buf) == -1) {
+        return {};
+    }
+
+#ifdef MLIO_PLATFORM_LINUX
+    const ::timespec &mtime = buf.st_mtim;
+#else
+    const ::timespec &mtime = buf.st_mtimespec;
+#endif
+
+    std::int64_t mtime_sec = mtime.tv_sec;
+    std::int64_t mtime_nsec = mtime.tv_nsec;
+
+    Gzip_index_key key{};
+    key.compressed_size = static_cast<std::size_t>(buf.st_size);
+    key.mtime = mtime_sec * 1'000'000'000 + mtime_nsec;
+
+    return key;
+}
+
+std::optional<Gzip_index> load_gzip_index(const std::string &path, const Gzip_index_key &key)
+{
+    std::ifstream s{path, std::ios::binary};
+    if (!s) {
+        return {};
+    }
+
+    std::array<char, 8> magic{};
+    if (!s.read(magic.data(), magic.size()) || magic != index_magic) {
+        logger::warn("The gzip index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    Gzip_index_key stored_key{};
+    std::size_t size{};
+    std::size_t gzip{};
+    std::size_t num_points{};
+    if (!read_size(s, stored_key.compressed_size) || !read_mtime(s, stored_key.mtime) ||
+        !read_size(s, size) || !read_size(s, gzip) || !read_size(s, num_points)) {
+        logger::warn("The gzip index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    // An index that was built for an earlier version of the file is of
+    // no use.
+    if (stored_key.compressed_size != key.compressed_size || stored_key.mtime != key.mtime) {
+        logger::info("The gzip index '{0}' is stale and will be ignored.", path);
+
+        return {};
+    }
+
+    std::vector<Gzip_access_point> points(num_points);
+    for (Gzip_access_point &point : points) {
+        if (!read_access_point(s, point)) {
+            logger::warn("The gzip index '{0}' is invalid and will be ignored.", path);
+
+            return {};
+        }
+    }
+
+    if (points.empty() || points.front().compressed_offset != 0) {
+        logger::warn("The gzip index '{0}' is invalid and will be ignored.", path);
+
+        return {};
+    }
+
+    return Gzip_index{key, size, gzip != 0, std::move(points)};
+}
+
+void save_gzip_index(const std::string &path, const Gzip_index &index) noexcept
+{
+    try {
+        // Write to a temporary file first so that concurrent readers
+        // never observe a partially written index.
+        std::string tmp_path = fmt::format("{0}.{1}", path, ::getpid());
+
+        {
+            std::ofstream s{tmp_path, std::ios::binary | std::ios::trunc};
+
+            s.write(index_magic.data(), index_magic.size());
+
+            write_size(s, index.key().compressed_size);
+            write_mtime(s, index.key().mtime);
+            write_size(s, index.size());
+            write_size(s, index.gzip() ? 1 : 0);
+            write_size(s, index.points().size());
+
+            for (const Gzip_access_point &point : index.points()) {
+                write_access_point(s, point);
+            }
+
+            if (!s.flush()) {
+                std::remove(tmp_path.c_str());
+
+                logger::warn("The gzip index '{0}' cannot be written.", path);
+
+                return;
+            }
+        }
+
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            std::remove(tmp_path.c_str());
+
+            logger::warn("The gzip index '{0}' cannot be written.", path);
+
+            return;
+        }
+
+        logger::info("The gzip index '{0}' has been written.", path);
+    }
+    catch (const std::exception &) {
+        logger::warn("The gzip index '{0}' cannot be written.", path);
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
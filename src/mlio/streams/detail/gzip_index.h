@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Represents a position within a gzip stream from which inflation can
+// resume without inflating the data that precedes it.
+struct Gzip_access_point {
+    // The offset of the first compressed byte that was not fully
+    // consumed.
+    std::size_t compressed_offset{};
+    // The number of bits of the byte preceding compressed_offset that
+    // belong to the next deflate block.
+    int num_bits{};
+    // The corresponding offset within the inflated data.
+    std::size_t offset{};
+    // The last 32 KiB of inflated data preceding the access point; the
+    // next deflate block might refer to it.
+    std::vector<std::byte> window{};
+};
+
+// Identifies the version of a gzip file that an index was built for.
+struct Gzip_index_key {
+    std::size_t compressed_size{};
+    // The modification time of the file in nanoseconds.
+    std::int64_t mtime{};
+};
+
+// Holds the access points of a gzip stream, spaced a fixed number of
+// inflated bytes apart, along with the sizes of the stream. The first
+// access point always refers to the beginning of the stream.
+class Gzip_index {
+public:
+    explicit Gzip_index(const Gzip_index_key &key,
+                        std::size_t size,
+                        bool gzip,
+                        std::vector<Gzip_access_point> points) noexcept
+        : key_{key}, size_{size}, gzip_{gzip}, points_{std::move(points)}
+    {}
+
+    // Returns the closest access point that precedes or equals the
+    // specified inflated offset.
+    const Gzip_access_point &lookup(std::size_t offset) const noexcept;
+
+    const Gzip_index_key &key() const noexcept
+    {
+        return key_;
+    }
+
+    std::size_t compressed_size() const noexcept
+    {
+        return key_.compressed_size;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    // Indicates whether the stream consists of gzip members as opposed
+    // to zlib streams.
+    bool gzip() const noexcept
+    {
+        return gzip_;
+    }
+
+    const std::vector<Gzip_access_point> &points() const noexcept
+    {
+        return points_;
+    }
+
+private:
+    Gzip_index_key key_;
+    std::size_t size_;
+    bool gzip_;
+    std::vector<Gzip_access_point> points_;
+};
+
+// Returns the path of the sidecar index file of the specified gzip
+// file.
+std::string gzip_index_path(const std::string &path);
+
+// Returns the key of the specified gzip file, or an empty value if the
+// file cannot be accessed.
+std::optional<Gzip_index_key> make_gzip_index_key(const std::string &path);
+
+// Loads the index saved at the specified path. Returns an empty value
+// if there is no index or if it was built for a different version of
+// the gzip file.
+std::optional<Gzip_index> load_gzip_index(const std::string &path, const Gzip_index_key &key);
+
+// Saves the index to the specified path. Failures are logged and
+// otherwise ignored since the index is only an optimization.
+void save_gzip_index(const std::string &path, const Gzip_index &index) noexcept;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
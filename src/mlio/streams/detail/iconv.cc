@@ -55,7 +55,7 @@ Iconv_desc::~Iconv_desc()
     ::iconv_close(desc_);
 }
 
-Iconv_status Iconv_desc::convert(Memory_span &inp, Mutable_memory_span &out)
+Conversion_status Iconv_desc::convert(Memory_span &inp, Mutable_memory_span &out)
 {
     auto i_chars = as_span<const char>(inp);
     auto o_chars = as_span<char>(out);
@@ -73,14 +73,14 @@ Iconv_status Iconv_desc::convert(Memory_span &inp, Mutable_memory_span &out)
     out = out.last(o_left);
 
     if (static_cast<std::ptrdiff_t>(r) != -1) {
-        return Iconv_status::ok;
+        return Conversion_status::ok;
     }
 
     if (errno == EINVAL) {
-        return Iconv_status::incomplete_char;
+        return Conversion_status::incomplete_char;
     }
     if (errno == E2BIG) {
-        return Iconv_status::leftover;
+        return Conversion_status::leftover;
     }
     if (errno == EILSEQ) {
         throw Stream_error{
@@ -18,15 +18,15 @@
 #include <iconv.h>
 
 #include "mlio/span.h"
+#include "mlio/streams/detail/text_converter.h"
 #include "mlio/text_encoding.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
-enum class Iconv_status { ok, incomplete_char, leftover };
-
-class Iconv_desc {
+// Converts text to UTF-8 using iconv.
+class Iconv_desc final : public Text_converter {
 public:
     explicit Iconv_desc(Text_encoding &&encoding);
 
@@ -38,11 +38,11 @@ public:
 
     Iconv_desc &operator=(Iconv_desc &&) = delete;
 
-    ~Iconv_desc();
+    ~Iconv_desc() final;
 
-    Iconv_status convert(Memory_span &inp, Mutable_memory_span &out);
+    Conversion_status convert(Memory_span &inp, Mutable_memory_span &out) final;
 
-    const Text_encoding &encoding() const noexcept
+    const Text_encoding &encoding() const noexcept final
     {
         return encoding_;
     }
@@ -0,0 +1,751 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/indexed_gzip_inflate_stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <limits>
+#include <new>
+#include <utility>
+
+#include <tbb/tbb.h>
+
+#include "mlio/not_supported_error.h"
+#include "mlio/streams/stream_error.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+// Lets zlib detect whether a member has a gzip or a zlib header.
+constexpr int auto_window_bits = MAX_WBITS + 32;
+
+constexpr std::size_t max_window_size = 0x8000;  // 32 KiB
+
+constexpr std::size_t max_num_concurrent_segments = 16;
+
+void init_zlib(::z_stream &stream)
+{
+    int r = ::inflateInit2(&stream, auto_window_bits);
+    if (r == Z_OK) {
+        return;
+    }
+
+    if (r == Z_MEM_ERROR) {
+        throw std::bad_alloc{};
+    }
+    if (r == Z_VERSION_ERROR) {
+        throw Not_supported_error{"The zlib library has an unsupported version."};
+    }
+    assert(false);
+}
+
+class Zlib_stream {
+public:
+    explicit Zlib_stream()
+    {
+        init_zlib(stream_);
+    }
+
+    Zlib_stream(const Zlib_stream &) = delete;
+
+    Zlib_stream &operator=(const Zlib_stream &) = delete;
+
+    Zlib_stream(Zlib_stream &&) = delete;
+
+    Zlib_stream &operator=(Zlib_stream &&) = delete;
+
+    ~Zlib_stream()
+    {
+        ::inflateEnd(&stream_);
+    }
+
+    ::z_stream &get() noexcept
+    {
+        return stream_;
+    }
+
+private:
+    ::z_stream stream_{};
+};
+
+// Inflates the range of the stream that starts at the specified access
+// point into output, which must be exactly as large as the range. The
+// data starts at the compressed offset of the access point, or at the
+// byte before it if the access point is in the middle of a byte. If the
+// range is the last one, the data must end with the stream.
+void inflate_range(Memory_span data,
+                   const Gzip_access_point &point,
+                   bool gzip,
+                   bool last,
+                   Mutable_memory_span output)
+{
+    // zlib counts in 32-bit integers.
+    constexpr std::size_t max_size = std::numeric_limits<::uInt>::max();
+
+    Zlib_stream zlib_stream{};
+
+    ::z_stream &stream = zlib_stream.get();
+
+    auto i_buf = as_span<const ::Bytef>(data);
+    auto o_buf = as_span<::Bytef>(output);
+
+    auto consume_input = [&stream, &i_buf](std::size_t size) {
+        i_buf = i_buf.subspan(size);
+
+        stream.next_in += size;
+        stream.avail_in -= static_cast<::uInt>(size);
+    };
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    stream.next_in = const_cast<::Bytef *>(i_buf.data());
+    stream.avail_in = static_cast<::uInt>(std::min(i_buf.size(), max_size));
+
+    bool member_end = point.compressed_offset == 0;
+
+    if (!member_end) {
+        ::inflateReset2(&stream, -MAX_WBITS);
+
+        if (point.num_bits > 0) {
+            if (i_buf.empty()) {
+                throw Inflate_error{"The gzip index does not match the stream."};
+            }
+
+            int value = i_buf[0] >> (8 - point.num_bits);
+
+            consume_input(1);
+
+            ::inflatePrime(&stream, point.num_bits, value);
+        }
+
+        if (!point.window.empty()) {
+            auto window = as_span<const ::Bytef>(make_span(point.window));
+
+            ::inflateSetDictionary(&stream, window.data(), static_cast<::uInt>(window.size()));
+        }
+    }
+
+    // See Indexed_gzip_inflate_stream::read() for the handling of the
+    // member boundaries.
+    bool raw = !member_end;
+
+    std::size_t num_trailer_bytes = 0;
+
+    while (!o_buf.empty() || last) {
+        if (stream.avail_in == 0) {
+            if (i_buf.empty()) {
+                if (!o_buf.empty() || !member_end || num_trailer_bytes > 0) {
+                    throw Inflate_error{
+                        "The zlib stream contains invalid or incomplete deflate data."};
+                }
+                return;
+            }
+
+            stream.avail_in = static_cast<::uInt>(std::min(i_buf.size(), max_size));
+        }
+
+        if (num_trailer_bytes > 0) {
+            std::size_t size = std::min(num_trailer_bytes, std::size_t{stream.avail_in});
+
+            consume_input(size);
+
+            num_trailer_bytes -= size;
+
+            continue;
+        }
+
+        if (member_end) {
+            ::inflateReset2(&stream, auto_window_bits);
+
+            raw = false;
+
+            member_end = false;
+        }
+
+        stream.next_out = o_buf.data();
+        stream.avail_out = static_cast<::uInt>(std::min(o_buf.size(), max_size));
+
+        ::uInt avail_in = stream.avail_in;
+        ::uInt avail_out = stream.avail_out;
+
+        int r = ::inflate(&stream, Z_NO_FLUSH);
+
+        i_buf = i_buf.subspan(avail_in - stream.avail_in);
+        o_buf = o_buf.subspan(avail_out - stream.avail_out);
+
+        switch (r) {
+        case Z_OK:
+            break;
+
+        case Z_BUF_ERROR:
+            // Without room for output, no progress means that the range
+            // inflates to more data than the index says.
+            if (avail_out == 0 && avail_in == stream.avail_in) {
+                throw Inflate_error{"The gzip index does not match the stream."};
+            }
+            break;
+
+        case Z_STREAM_END:
+            member_end = true;
+
+            if (raw) {
+                num_trailer_bytes = gzip ? 8 : 4;
+            }
+            break;
+
+        case Z_MEM_ERROR:
+            throw std::bad_alloc{};
+
+        default:
+            throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+        }
+    }
+}
+
+}  // namespace
+
+Indexed_gzip_inflate_stream::Indexed_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                                         std::shared_ptr<const Gzip_index> index)
+    : inner_{std::move(inner)}, index_{std::move(index)}, gzip_{index_->gzip()}
+{
+    init_zlib(stream_);
+}
+
+Indexed_gzip_inflate_stream::Indexed_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                                         std::size_t interval,
+                                                         std::string index_path,
+                                                         const Gzip_index_key &key)
+    : inner_{std::move(inner)}
+    , interval_{interval}
+    , index_path_{std::move(index_path)}
+    , key_{key}
+    , parallel_{false}
+{
+    // The beginning of the stream is always an access point.
+    points_.emplace_back();
+
+    init_zlib(stream_);
+}
+
+Indexed_gzip_inflate_stream::~Indexed_gzip_inflate_stream()
+{
+    ::inflateEnd(&stream_);
+}
+
+std::size_t Indexed_gzip_inflate_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty()) {
+        return 0;
+    }
+
+    if (index_ == nullptr) {
+        return inflate_serial(destination);
+    }
+
+    if (parallel_) {
+        while (outputs_.empty() && position_ < index_->size()) {
+            inflate_segments();
+        }
+
+        if (outputs_.empty()) {
+            return 0;
+        }
+        return read_output(destination);
+    }
+
+    const std::vector<Gzip_access_point> &points = index_->points();
+
+    auto next = std::upper_bound(
+        points.begin(), points.end(), position_, [](std::size_t o, const Gzip_access_point &point) {
+            return o < point.offset;
+        });
+
+    if (next == points.end()) {
+        return inflate_serial(destination);
+    }
+
+    // Stop at the next access point from where we can go on in parallel.
+    std::size_t size = std::min(destination.size(), next->offset - position_);
+
+    std::size_t num_bytes_read = inflate_serial(destination.first(size));
+
+    if (position_ == next->offset) {
+        parallel_ = true;
+    }
+
+    return num_bytes_read;
+}
+
+std::size_t Indexed_gzip_inflate_stream::read_output(Mutable_memory_span destination)
+{
+    const std::vector<std::byte> &output = outputs_.front();
+
+    std::size_t size = std::min(output.size() - output_pos_, destination.size());
+
+    auto first = output.begin() + as_ssize(output_pos_);
+
+    std::copy(first, first + as_ssize(size), destination.begin());
+
+    position_ += size;
+
+    output_pos_ += size;
+    if (output_pos_ == output.size()) {
+        outputs_.pop_front();
+
+        output_pos_ = 0;
+    }
+
+    return size;
+}
+
+void Indexed_gzip_inflate_stream::inflate_segments()
+{
+    const std::vector<Gzip_access_point> &points = index_->points();
+
+    auto first = std::lower_bound(
+        points.begin(), points.end(), position_, [](const Gzip_access_point &point, std::size_t o) {
+            return point.offset < o;
+        });
+
+    assert(first != points.end() && first->offset == position_);
+
+    auto num_segments = std::min({as_size(tbb::this_task_arena::max_concurrency()),
+                                  max_num_concurrent_segments,
+                                  as_size(points.end() - first)});
+
+    auto last = first + as_ssize(num_segments);
+
+    std::size_t compressed_begin = first->compressed_offset;
+    if (first->num_bits > 0) {
+        compressed_begin--;
+    }
+
+    std::size_t compressed_end{};
+    if (last == points.end()) {
+        compressed_end = index_->compressed_size();
+    }
+    else {
+        compressed_end = last->compressed_offset;
+    }
+
+    std::size_t compressed_size = compressed_end - compressed_begin;
+
+    // Read the compressed data of all ranges; without copying if the
+    // inner stream holds it in memory.
+    inner_->seek(compressed_begin);
+
+    Memory_slice mapped_input{};
+
+    Memory_span inp{};
+    if (inner_->supports_zero_copy()) {
+        mapped_input = inner_->read(compressed_size);
+
+        inp = mapped_input;
+    }
+    else {
+        input_.resize(compressed_size);
+
+        std::size_t size = 0;
+        while (size < compressed_size) {
+            std::size_t num_bytes_read = inner_->read(make_span(input_).subspan(size));
+            if (num_bytes_read == 0) {
+                break;
+            }
+            size += num_bytes_read;
+        }
+
+        inp = make_span(input_).first(size);
+    }
+
+    if (inp.size() != compressed_size) {
+        throw Inflate_error{"The gzip index does not match the stream."};
+    }
+
+    std::vector<std::vector<std::byte>> outputs(num_segments);
+
+    std::vector<std::exception_ptr> errors(num_segments);
+
+    tbb::parallel_for(std::size_t{}, num_segments, [&](std::size_t i) {
+        auto pos = first + as_ssize(i);
+
+        const Gzip_access_point &point = *pos;
+
+        std::size_t begin = point.compressed_offset - compressed_begin;
+        if (point.num_bits > 0) {
+            begin--;
+        }
+
+        bool last_range = pos + 1 == points.end();
+
+        std::size_t end{};
+        std::size_t end_offset{};
+        if (last_range) {
+            end = compressed_size;
+
+            end_offset = index_->size();
+        }
+        else {
+            end = (pos + 1)->compressed_offset - compressed_begin;
+
+            end_offset = (pos + 1)->offset;
+        }
+
+        try {
+            outputs[i].resize(end_offset - point.offset);
+
+            inflate_range(inp.subspan(begin, end - begin), point, gzip_, last_range, outputs[i]);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    for (std::exception_ptr &error : errors) {
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (std::vector<std::byte> &output : outputs) {
+        if (!output.empty()) {
+            outputs_.emplace_back(std::move(output));
+        }
+    }
+
+    // Only an empty stream has an empty range.
+    if (outputs_.empty()) {
+        position_ = index_->size();
+    }
+}
+
+std::size_t Indexed_gzip_inflate_stream::inflate_serial(Mutable_memory_span destination)
+{
+    // zlib counts in 32-bit integers.
+    constexpr std::size_t max_size = std::numeric_limits<::uInt>::max();
+
+    auto o_buf = as_span<::Bytef>(destination).first(std::min(destination.size(), max_size));
+
+    while (!eof_) {
+        if (stream_.avail_in == 0 && !fill_input()) {
+            if (!member_end_ || num_trailer_bytes_ > 0) {
+                throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+            }
+
+            eof_ = true;
+
+            save_index();
+
+            break;
+        }
+
+        if (num_trailer_bytes_ > 0) {
+            std::size_t size = std::min(num_trailer_bytes_, std::size_t{stream_.avail_in});
+
+            consume_input(size);
+
+            num_trailer_bytes_ -= size;
+
+            continue;
+        }
+
+        if (member_end_) {
+            if (compressed_offset_ == 0 && index_ == nullptr) {
+                gzip_ = *stream_.next_in == 0x1f;
+            }
+
+            ::inflateReset2(&stream_, auto_window_bits);
+
+            raw_ = false;
+
+            member_end_ = false;
+        }
+
+        stream_.next_out = o_buf.data();
+        stream_.avail_out = static_cast<::uInt>(o_buf.size());
+
+        ::uInt avail_in = stream_.avail_in;
+
+        // While building the index we stop at every block boundary to
+        // check whether it should become an access point.
+        int r = ::inflate(&stream_, index_ == nullptr ? Z_BLOCK : Z_NO_FLUSH);
+
+        compressed_offset_ += avail_in - stream_.avail_in;
+
+        std::size_t num_bytes_inflated = o_buf.size() - stream_.avail_out;
+
+        position_ += num_bytes_inflated;
+
+        switch (r) {
+        case Z_OK:
+        case Z_BUF_ERROR:
+            break;
+
+        case Z_STREAM_END:
+            member_end_ = true;
+
+            if (raw_) {
+                num_trailer_bytes_ = gzip_ ? 8 : 4;
+            }
+            break;
+
+        case Z_MEM_ERROR:
+            throw std::bad_alloc{};
+
+        default:
+            throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+        }
+
+        if (index_ == nullptr && !member_end_) {
+            add_access_point();
+        }
+
+        if (num_bytes_inflated > 0) {
+            return num_bytes_inflated;
+        }
+    }
+
+    return 0;
+}
+
+void Indexed_gzip_inflate_stream::seek(std::size_t position)
+{
+    check_if_closed();
+
+    if (index_ == nullptr) {
+        throw Not_supported_error{"The input stream is not seekable."};
+    }
+
+    position = std::min(position, index_->size());
+
+    const Gzip_access_point &point = index_->lookup(position);
+
+    // Unless we are inflating serially and are already between the
+    // access point and the target position, we have to restart from the
+    // access point.
+    if (parallel_ || position < position_ || point.offset > position_) {
+        restore(point);
+    }
+
+    outputs_.clear();
+
+    output_pos_ = 0;
+
+    parallel_ = false;
+
+    skip(position - position_);
+}
+
+void Indexed_gzip_inflate_stream::restore(const Gzip_access_point &point)
+{
+    buffer_ = {};
+
+    stream_.next_in = nullptr;
+    stream_.avail_in = 0;
+
+    num_trailer_bytes_ = 0;
+
+    eof_ = false;
+
+    if (point.compressed_offset == 0) {
+        inner_->seek(0);
+
+        compressed_offset_ = 0;
+
+        position_ = 0;
+
+        member_end_ = true;
+
+        return;
+    }
+
+    // If the access point is in the middle of a byte, we have to feed
+    // its remaining bits to zlib before the rest of the block.
+    std::size_t offset = point.compressed_offset;
+    if (point.num_bits > 0) {
+        offset--;
+    }
+
+    inner_->seek(offset);
+
+    compressed_offset_ = offset;
+
+    ::inflateReset2(&stream_, -MAX_WBITS);
+
+    raw_ = true;
+
+    member_end_ = false;
+
+    if (point.num_bits > 0) {
+        if (!fill_input()) {
+            throw Inflate_error{"The gzip index does not match the stream."};
+        }
+
+        int value = *stream_.next_in >> (8 - point.num_bits);
+
+        consume_input(1);
+
+        ::inflatePrime(&stream_, point.num_bits, value);
+    }
+
+    if (!point.window.empty()) {
+        auto window = as_span<const ::Bytef>(make_span(point.window));
+
+        ::inflateSetDictionary(&stream_, window.data(), static_cast<::uInt>(window.size()));
+    }
+
+    position_ = point.offset;
+}
+
+void Indexed_gzip_inflate_stream::skip(std::size_t size)
+{
+    std::vector<std::byte> buffer(std::min(size, std::size_t{0x10'0000}));  // 1 MiB
+
+    while (size > 0) {
+        std::size_t num_bytes_read = read(make_span(buffer).first(std::min(size, buffer.size())));
+        if (num_bytes_read == 0) {
+            break;
+        }
+
+        size -= num_bytes_read;
+    }
+}
+
+bool Indexed_gzip_inflate_stream::fill_input()
+{
+    buffer_ = inner_->read(0x8'0000);  // 512 KiB
+    if (buffer_.empty()) {
+        return false;
+    }
+
+    auto i_buf = as_span<const ::Bytef>(buffer_);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    stream_.next_in = const_cast<::Bytef *>(i_buf.data());
+    stream_.avail_in = static_cast<::uInt>(i_buf.size());
+
+    return true;
+}
+
+void Indexed_gzip_inflate_stream::consume_input(std::size_t size) noexcept
+{
+    stream_.next_in += size;
+    stream_.avail_in -= static_cast<::uInt>(size);
+
+    compressed_offset_ += size;
+}
+
+void Indexed_gzip_inflate_stream::add_access_point()
+{
+    // zlib sets the 7th bit of data_type at the end of a deflate block,
+    // and the 6th one while in the last block of a member; the start of
+    // a block is a valid access point if there is a next block.
+    if ((stream_.data_type & 128) == 0 || (stream_.data_type & 64) != 0) {
+        return;
+    }
+
+    if (position_ - points_.back().offset < interval_) {
+        return;
+    }
+
+    Gzip_access_point point{};
+
+    point.compressed_offset = compressed_offset_;
+    point.num_bits = stream_.data_type & 7;
+    point.offset = position_;
+
+    point.window.resize(max_window_size);
+
+    auto window = as_span<::Bytef>(make_span(point.window));
+
+    auto window_size = static_cast<::uInt>(window.size());
+
+    ::inflateGetDictionary(&stream_, window.data(), &window_size);
+
+    point.window.resize(window_size);
+
+    points_.emplace_back(std::move(point));
+}
+
+void Indexed_gzip_inflate_stream::save_index() noexcept
+{
+    if (index_ != nullptr || index_path_.empty()) {
+        return;
+    }
+
+    // Make sure that we save the index only once.
+    std::string index_path = std::move(index_path_);
+
+    index_path_.clear();
+
+    // The file has changed since we started reading it.
+    if (compressed_offset_ != key_.compressed_size) {
+        return;
+    }
+
+    Gzip_index index{key_, position_, gzip_, std::move(points_)};
+
+    save_gzip_index(index_path, index);
+}
+
+void Indexed_gzip_inflate_stream::close() noexcept
+{
+    inner_->close();
+
+    buffer_ = {};
+
+    stream_.next_in = nullptr;
+    stream_.avail_in = 0;
+
+    input_ = {};
+
+    outputs_.clear();
+}
+
+std::size_t Indexed_gzip_inflate_stream::size() const
+{
+    check_if_closed();
+
+    if (index_ == nullptr) {
+        return Input_stream_base::size();
+    }
+    return index_->size();
+}
+
+std::size_t Indexed_gzip_inflate_stream::position() const
+{
+    check_if_closed();
+
+    if (index_ == nullptr) {
+        return Input_stream_base::position();
+    }
+    return position_;
+}
+
+void Indexed_gzip_inflate_stream::check_if_closed() const
+{
+    if (inner_->closed()) {
+        throw Stream_error{"The input stream is closed."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
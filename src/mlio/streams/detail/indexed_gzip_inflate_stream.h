@@ -0,0 +1,149 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/gzip_index.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates a gzip or zlib stream through zlib and, given a Gzip_index,
+// supports seeking within it by resuming inflation at the closest
+// access point. Without an index the stream is not seekable; instead it
+// builds one while being read and saves it once the end of the stream
+// is reached.
+//
+// With an index, the ranges between consecutive access points are
+// inflated concurrently and returned in order as long as the stream is
+// read sequentially. After a seek we inflate serially up to the next
+// access point, so that reading a few records does not inflate several
+// intervals worth of data.
+class Indexed_gzip_inflate_stream final : public Input_stream_base {
+public:
+    // Constructs a seekable stream. The inner stream must be seekable.
+    explicit Indexed_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                         std::shared_ptr<const Gzip_index> index);
+
+    // Constructs a stream that builds an index with an access point
+    // every interval bytes of inflated data and saves it to index_path.
+    // The index is not saved if the inner stream turns out not to be
+    // the version of the file identified by key.
+    explicit Indexed_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                         std::size_t interval,
+                                         std::string index_path,
+                                         const Gzip_index_key &key);
+
+    Indexed_gzip_inflate_stream(const Indexed_gzip_inflate_stream &) = delete;
+
+    Indexed_gzip_inflate_stream &operator=(const Indexed_gzip_inflate_stream &) = delete;
+
+    Indexed_gzip_inflate_stream(Indexed_gzip_inflate_stream &&) = delete;
+
+    Indexed_gzip_inflate_stream &operator=(Indexed_gzip_inflate_stream &&) = delete;
+
+    ~Indexed_gzip_inflate_stream() final;
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void seek(std::size_t position) final;
+
+    void close() noexcept final;
+
+    std::size_t size() const final;
+
+    std::size_t position() const final;
+
+    bool closed() const noexcept final
+    {
+        return inner_->closed();
+    }
+
+    bool seekable() const noexcept final
+    {
+        return index_ != nullptr;
+    }
+
+private:
+    std::size_t read_output(Mutable_memory_span destination);
+
+    std::size_t inflate_serial(Mutable_memory_span destination);
+
+    void inflate_segments();
+
+    void restore(const Gzip_access_point &point);
+
+    void skip(std::size_t size);
+
+    bool fill_input();
+
+    void consume_input(std::size_t size) noexcept;
+
+    void add_access_point();
+
+    void save_index() noexcept;
+
+    void check_if_closed() const;
+
+    Intrusive_ptr<Input_stream> inner_;
+    std::shared_ptr<const Gzip_index> index_{};
+    std::size_t interval_{};
+    std::string index_path_{};
+    Gzip_index_key key_{};
+    std::vector<Gzip_access_point> points_{};
+    bool gzip_{};
+    ::z_stream stream_{};
+    Memory_slice buffer_{};
+    // The offset of the first unconsumed byte within the inner stream.
+    std::size_t compressed_offset_{};
+    std::size_t position_{};
+    // Indicates whether we are inflating raw deflate data after
+    // resuming at an access point; in that case the trailer of the
+    // member has to be skipped by us rather than by zlib.
+    bool raw_{};
+    std::size_t num_trailer_bytes_{};
+    bool member_end_ = true;
+    bool eof_{};
+    // Indicates whether the stream is read sequentially from an access
+    // point; in that case position_ is at an access point once the
+    // outputs are consumed and the state of stream_ is not used.
+    bool parallel_ = true;
+    // The compressed data of the ranges being inflated concurrently if
+    // the inner stream does not support zero-copy reading.
+    std::vector<std::byte> input_{};
+    // The inflated ranges that have not been read yet.
+    std::deque<std::vector<std::byte>> outputs_{};
+    std::size_t output_pos_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
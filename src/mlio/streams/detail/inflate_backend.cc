@@ -0,0 +1,81 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/inflate_backend.h"
+
+#include "mlio/streams/detail/isal.h"
+#include "mlio/streams/detail/libdeflate.h"
+#include "mlio/streams/detail/zlib.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+std::unique_ptr<Inflater> make_gzip_inflater(Inflate_backend backend)
+{
+    // libdeflate cannot inflate streams; we fall back to ISA-L if
+    // available.
+    switch (backend) {
+    case Inflate_backend::isal:
+    case Inflate_backend::libdeflate:
+#ifdef MLIO_BUILD_ISAL
+        return std::make_unique<Isal_inflater>();
+#endif
+
+    case Inflate_backend::zlib:
+        return std::make_unique<Zlib_inflater>();
+    }
+
+    return std::make_unique<Zlib_inflater>();
+}
+
+bool has_whole_buffer_inflater(Inflate_backend backend) noexcept
+{
+    return backend == Inflate_backend::libdeflate;
+}
+
+std::optional<std::size_t> inflate_gzip_frame([[maybe_unused]] Inflate_backend backend,
+                                              [[maybe_unused]] Memory_span data,
+                                              [[maybe_unused]] std::vector<std::byte> &output,
+                                              [[maybe_unused]] std::size_t max_output_size)
+{
+#ifdef MLIO_BUILD_LIBDEFLATE
+    if (has_whole_buffer_inflater(backend)) {
+        return libdeflate_inflate_frame(data, output, max_output_size);
+    }
+#endif
+
+    return {};
+}
+
+bool inflate_gzip_buffer(Inflate_backend backend,
+                         Memory_span data,
+                         std::vector<std::byte> &output,
+                         std::size_t max_output_size)
+{
+#ifdef MLIO_BUILD_LIBDEFLATE
+    if (has_whole_buffer_inflater(backend)) {
+        return libdeflate_inflate(data, output, max_output_size);
+    }
+#endif
+
+    std::unique_ptr<Inflater> inflater = make_gzip_inflater(backend);
+
+    return inflate_buffer(*inflater, data, output, max_output_size);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "mlio/data_stores/compression.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Constructs an inflater for gzip and zlib data using the specified
+// inflate backend.
+std::unique_ptr<Inflater> make_gzip_inflater(Inflate_backend backend);
+
+// Indicates whether the specified inflate backend has a dedicated
+// decompressor for whole buffers.
+bool has_whole_buffer_inflater(Inflate_backend backend) noexcept;
+
+// Inflates the gzip member or zlib stream at the beginning of the
+// specified data in one piece and appends it to output. Returns the
+// number of bytes consumed, or nullopt if the inflate backend has no
+// dedicated decompressor for whole buffers or if the inflated data
+// would be larger than max_output_size.
+std::optional<std::size_t> inflate_gzip_frame(Inflate_backend backend,
+                                              Memory_span data,
+                                              std::vector<std::byte> &output,
+                                              std::size_t max_output_size);
+
+// Inflates the specified data that consists of one or more complete
+// gzip members or zlib streams into output using the fastest method of
+// the inflate backend. Returns false, leaving output empty, if the
+// inflated data would be larger than max_output_size.
+bool inflate_gzip_buffer(Inflate_backend backend,
+                         Memory_span data,
+                         std::vector<std::byte> &output,
+                         std::size_t max_output_size);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
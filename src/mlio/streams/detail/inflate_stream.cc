@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/inflate_stream.h"
+
+#include <utility>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Inflate_stream::Inflate_stream(Intrusive_ptr<Input_stream> inner,
+                               std::unique_ptr<Inflater> inflater)
+    : inner_{std::move(inner)}, inflater_{std::move(inflater)}
+{}
+
+Inflate_stream::~Inflate_stream() = default;
+
+std::size_t Inflate_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty()) {
+        return 0;
+    }
+
+    while (true) {
+        if (buffer_pos_ == buffer_.end() && !inner_eof_) {
+            buffer_ = inner_->read(0x8'0000);  // 512 KiB
+
+            buffer_pos_ = buffer_.begin();
+
+            inner_eof_ = buffer_.empty();
+        }
+
+        Memory_span inp{buffer_pos_, buffer_.end()};
+
+        auto out = destination;
+
+        // Even if we have consumed all input, the inflater might still
+        // have pending output.
+        inflater_->inflate(inp, out);
+
+        buffer_pos_ = buffer_.end() - stdx::ssize(inp);
+
+        std::size_t num_bytes_read = destination.size() - out.size();
+        if (num_bytes_read > 0) {
+            return num_bytes_read;
+        }
+
+        if (inner_eof_) {
+            inflater_->check_eof();
+
+            return 0;
+        }
+    }
+}
+
+void Inflate_stream::close() noexcept
+{
+    inner_->close();
+
+    inflater_ = nullptr;
+
+    buffer_ = {};
+}
+
+bool Inflate_stream::closed() const noexcept
+{
+    return inner_->closed();
+}
+
+void Inflate_stream::check_if_closed() const
+{
+    if (inner_->closed()) {
+        throw Stream_error{"The input stream is closed."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates an underlying stream serially using the specified inflater.
+class Inflate_stream final : public Input_stream_base {
+public:
+    explicit Inflate_stream(Intrusive_ptr<Input_stream> inner, std::unique_ptr<Inflater> inflater);
+
+    Inflate_stream(const Inflate_stream &) = delete;
+
+    Inflate_stream &operator=(const Inflate_stream &) = delete;
+
+    Inflate_stream(Inflate_stream &&) = delete;
+
+    Inflate_stream &operator=(Inflate_stream &&) = delete;
+
+    ~Inflate_stream() final;
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void close() noexcept final;
+
+    bool closed() const noexcept final;
+
+private:
+    void check_if_closed() const;
+
+    Intrusive_ptr<Input_stream> inner_;
+    std::unique_ptr<Inflater> inflater_;
+    Memory_slice buffer_{};
+    Memory_block::iterator buffer_pos_ = buffer_.begin();
+    bool inner_eof_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/inflater.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Inflater::~Inflater() = default;
+
+bool inflate_buffer(Inflater &inflater,
+                    Memory_span data,
+                    std::vector<std::byte> &output,
+                    std::size_t max_output_size)
+{
+    constexpr std::size_t min_output_size = 0x1'0000;  // 64 KiB
+
+    // We need room for one more byte to tell whether the inflated data
+    // exceeds max_output_size.
+    std::size_t max_capacity = max_output_size;
+    if (max_capacity != std::numeric_limits<std::size_t>::max()) {
+        max_capacity++;
+    }
+
+    // Start with a guess of the compression ratio.
+    output.resize(std::min(std::max(data.size() * 4, min_output_size), max_capacity));
+
+    std::size_t size = 0;
+
+    // Keep going while there is input left or the inflater might still
+    // have pending output.
+    while (!data.empty() || size == output.size()) {
+        if (size == output.size()) {
+            if (size == max_capacity) {
+                output.clear();
+
+                return false;
+            }
+
+            output.resize(max_capacity / 2 < size ? max_capacity : size * 2);
+        }
+
+        auto out = make_span(output).subspan(size);
+
+        std::size_t out_size = out.size();
+
+        inflater.inflate(data, out);
+
+        size += out_size - out.size();
+    }
+
+    output.resize(size);
+
+    // The data must end at a frame boundary.
+    inflater.check_eof();
+
+    return true;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
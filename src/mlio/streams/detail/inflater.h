@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Represents a streaming decompressor. An inflater consumes input and
+// produces output incrementally; the input can consist of several
+// concatenated frames (e.g. gzip members).
+class Inflater {
+public:
+    Inflater() noexcept = default;
+
+    Inflater(const Inflater &) = delete;
+
+    Inflater &operator=(const Inflater &) = delete;
+
+    Inflater(Inflater &&) = delete;
+
+    Inflater &operator=(Inflater &&) = delete;
+
+    virtual ~Inflater();
+
+    // Inflates as much of inp as possible into out. On return both spans
+    // are advanced past the consumed and produced bytes. The function
+    // can be called with an empty inp to flush pending output.
+    //
+    // Throws Inflate_error if inp contains invalid data.
+    virtual void inflate(Memory_span &inp, Mutable_memory_span &out) = 0;
+
+    // Indicates whether the inflater is at a frame boundary; initially
+    // true.
+    virtual bool eof() const noexcept = 0;
+
+    // Throws Inflate_error if the input ended in the middle of a frame.
+    virtual void check_eof() const = 0;
+};
+
+// Inflates the specified data that consists of one or more complete
+// frames into output, which is resized to the inflated size. Returns
+// false, leaving output empty, if the inflated data would be larger than
+// max_output_size.
+bool inflate_buffer(Inflater &inflater,
+                    Memory_span data,
+                    std::vector<std::byte> &output,
+                    std::size_t max_output_size = std::numeric_limits<std::size_t>::max());
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/io_uring_file_input_stream.h"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "mlio/detail/error.h"
+#include "mlio/detail/path.h"
+#include "mlio/memory/memory_allocator.h"
+#include "mlio/streams/stream_error.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Io_uring_file_input_stream::Io_uring_file_input_stream(std::string path) : path_{std::move(path)}
+{
+    validate_file_path(path_);
+
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1) {
+        throw std::system_error{current_error_code(), "The file cannot be opened."};
+    }
+
+    struct ::stat buf = {};
+    if (::fstat(fd_.get(), &buf) == -1) {
+        throw std::system_error{current_error_code(), "The size of the file cannot be retrieved."};
+    }
+
+    size_ = static_cast<std::size_t>(buf.st_size);
+
+    // There is no point in having buffers larger than the file.
+    buffer_size_ = std::min(max_buffer_size_, size_);
+}
+
+Io_uring_file_input_stream::~Io_uring_file_input_stream()
+{
+    drain();
+}
+
+std::size_t Io_uring_file_input_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty()) {
+        return 0;
+    }
+
+    if (ring_ == nullptr) {
+        if (position_ == size_) {
+            return 0;
+        }
+
+        init_queue();
+    }
+
+    bool is_large = destination.size() >= min_direct_read_size_;
+
+    while (true) {
+        // A large read does not refill the queue; once the data read
+        // ahead so far is consumed, we switch to direct reads.
+        if (!is_large) {
+            fill_queue();
+        }
+        else if (num_queued_ == 0) {
+            return read_direct(destination);
+        }
+
+        if (num_queued_ == 0) {
+            return 0;
+        }
+
+        Buffer &buffer = buffers_[head_];
+
+        wait(buffer);
+
+        if (buffer.error != 0) {
+            throw std::system_error{buffer.error, std::generic_category(), "The file cannot be read."};
+        }
+
+        std::size_t num_bytes_available = buffer.num_bytes_read - num_bytes_consumed_;
+        if (num_bytes_available > 0) {
+            std::size_t size = std::min(num_bytes_available, destination.size());
+
+            auto first = buffer.data.begin() + as_ssize(num_bytes_consumed_);
+
+            std::copy(first, first + as_ssize(size), destination.begin());
+
+            num_bytes_consumed_ += size;
+
+            position_ += size;
+
+            return size;
+        }
+
+        // The head buffer is exhausted; move on to the next one.
+        head_ = (head_ + 1) % num_buffers_;
+
+        num_queued_--;
+
+        num_bytes_consumed_ = 0;
+    }
+}
+
+void Io_uring_file_input_stream::init_queue()
+{
+    ring_ = std::make_unique<Io_uring>(static_cast<unsigned>(num_buffers_));
+
+    memory_ = memory_allocator().allocate(num_buffers_ * buffer_size_);
+
+    // Pinning the buffers is an optimization; if the kernel refuses to
+    // do so, the reads are still done into the same buffers.
+    if (size_ >= min_registered_size_) {
+        ring_->register_buffer(::iovec{memory_->data(), memory_->size()});
+    }
+
+    buffers_.assign(num_buffers_ * 2, Buffer{});
+    for (std::size_t i = 0; i < num_buffers_; i++) {
+        buffers_[i].data = make_span(*memory_).subspan(i * buffer_size_, buffer_size_);
+    }
+
+    queued_.reserve(buffers_.size());
+}
+
+std::size_t Io_uring_file_input_stream::read_direct(Mutable_memory_span destination)
+{
+    std::size_t size = std::min(destination.size(), size_ - position_);
+    if (size == 0) {
+        return 0;
+    }
+
+    // Split the read into page-aligned parts that the kernel can serve
+    // concurrently.
+    std::size_t part_size = (size + num_buffers_ - 1) / num_buffers_;
+
+    part_size = (part_size + 0xfff) & ~std::size_t{0xfff};
+
+    std::size_t num_parts = 0;
+    for (std::size_t offset = 0; offset < size; offset += part_size) {
+        Buffer &part = buffers_[num_buffers_ + num_parts++];
+
+        part.data = destination.subspan(offset, std::min(part_size, size - offset));
+        part.offset = position_ + offset;
+        part.num_bytes_requested = part.data.size();
+        part.num_bytes_read = 0;
+        part.error = 0;
+
+        queue(part);
+    }
+
+    submit_queued();
+
+    // The kernel writes into the caller's buffer; we have to wait for
+    // all parts even if one of them fails.
+    for (std::size_t i = 0; i < num_parts; i++) {
+        wait(buffers_[num_buffers_ + i]);
+    }
+
+    std::size_t num_bytes_read = 0;
+    for (std::size_t i = 0; i < num_parts; i++) {
+        const Buffer &part = buffers_[num_buffers_ + i];
+
+        if (part.error != 0) {
+            throw std::system_error{part.error, std::generic_category(), "The file cannot be read."};
+        }
+
+        num_bytes_read += part.num_bytes_read;
+
+        // A short part means that the file has been truncated; the
+        // bytes of any later part are not contiguous.
+        if (part.num_bytes_read < part.num_bytes_requested) {
+            break;
+        }
+    }
+
+    position_ += num_bytes_read;
+
+    next_offset_ = position_;
+
+    return num_bytes_read;
+}
+
+void Io_uring_file_input_stream::seek(std::size_t position)
+{
+    check_if_closed();
+
+    drain();
+
+    head_ = 0;
+
+    num_queued_ = 0;
+
+    num_bytes_consumed_ = 0;
+
+    next_offset_ = std::min(position, size_);
+
+    position_ = next_offset_;
+}
+
+void Io_uring_file_input_stream::close() noexcept
+{
+    drain();
+
+    ring_ = nullptr;
+
+    memory_ = nullptr;
+
+    buffers_.clear();
+
+    fd_ = {};
+}
+
+std::size_t Io_uring_file_input_stream::size() const
+{
+    check_if_closed();
+
+    return size_;
+}
+
+std::size_t Io_uring_file_input_stream::position() const
+{
+    check_if_closed();
+
+    return position_;
+}
+
+void Io_uring_file_input_stream::fill_queue()
+{
+    while (num_queued_ < num_buffers_ && next_offset_ < size_) {
+        Buffer &buffer = buffers_[(head_ + num_queued_) % num_buffers_];
+
+        buffer.offset = next_offset_;
+        buffer.num_bytes_requested = std::min(buffer_size_, size_ - next_offset_);
+        buffer.num_bytes_read = 0;
+        buffer.error = 0;
+
+        queue(buffer);
+
+        next_offset_ += buffer.num_bytes_requested;
+
+        num_queued_++;
+    }
+
+    submit_queued();
+}
+
+void Io_uring_file_input_stream::queue(Buffer &buffer)
+{
+    std::size_t num_bytes_read = buffer.num_bytes_read;
+
+    buffer.pending = ::iovec{buffer.data.data() + num_bytes_read,
+                             buffer.num_bytes_requested - num_bytes_read};
+
+    // Mark the buffer before the kernel can see the read so that we never
+    // lose track of memory the kernel might write to.
+    buffer.in_flight = true;
+
+    ring_->queue_read(fd_.get(),
+                      buffer.pending,
+                      buffer.offset + num_bytes_read,
+                      static_cast<std::uint64_t>(&buffer - buffers_.data()));
+
+    queued_.emplace_back(&buffer);
+}
+
+void Io_uring_file_input_stream::submit_queued() noexcept
+{
+    try {
+        ring_->submit();
+    }
+    catch (const std::system_error &e) {
+        // The reads that the kernel has not accepted are the last ones we
+        // queued; they fail as if the kernel had rejected them so that
+        // the error surfaces when their buffers are read.
+        auto num_dropped = static_cast<std::ptrdiff_t>(ring_->num_queued());
+
+        ring_->discard_queued();
+
+        for (auto pos = queued_.end() - num_dropped; pos < queued_.end(); ++pos) {
+            (*pos)->error = e.code().value();
+
+            (*pos)->in_flight = false;
+        }
+    }
+
+    queued_.clear();
+}
+
+void Io_uring_file_input_stream::wait(const Buffer &buffer)
+{
+    // Completions might arrive out of order; we process all of them
+    // until the requested buffer is ready.
+    while (buffer.in_flight) {
+        Io_uring::Completion completion = ring_->wait_completion();
+
+        Buffer &b = buffers_[completion.user_data];
+
+        if (completion.result < 0) {
+            b.error = -completion.result;
+        }
+        else if (completion.result > 0) {
+            b.num_bytes_read += static_cast<std::size_t>(completion.result);
+
+            // Resubmit the rest of a short read.
+            if (b.num_bytes_read < b.num_bytes_requested) {
+                queue(b);
+
+                submit_queued();
+
+                continue;
+            }
+        }
+        // A zero-length read means that the file has been truncated
+        // since we opened it.
+
+        b.in_flight = false;
+    }
+}
+
+void Io_uring_file_input_stream::drain() noexcept
+{
+    if (ring_ == nullptr) {
+        return;
+    }
+
+    for (Buffer &buffer : buffers_) {
+        while (buffer.in_flight) {
+            try {
+                Io_uring::Completion completion = ring_->wait_completion();
+
+                buffers_[completion.user_data].in_flight = false;
+            }
+            catch (const std::system_error &) {
+                // The kernel still owns the buffers; it is safer to leak
+                // them than to free memory that might be written to.
+                ring_.release();
+
+                memory_.release();
+
+                return;
+            }
+        }
+    }
+}
+
+void Io_uring_file_input_stream::check_if_closed() const
+{
+    if (fd_.is_open()) {
+        return;
+    }
+
+    throw Stream_error{"The input stream is closed."};
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
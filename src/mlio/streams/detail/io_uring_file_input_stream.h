@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include "mlio/detail/file_descriptor.h"
+#include "mlio/detail/io_uring.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/span.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Reads a file through io_uring, keeping a queue of large reads in
+// flight ahead of the current position. Large reads bypass the queue
+// and are done directly into the caller's buffer.
+class Io_uring_file_input_stream final : public Input_stream_base {
+    struct Buffer {
+        Mutable_memory_span data{};
+        // The file offset of the first byte of the buffer.
+        std::size_t offset{};
+        // The number of bytes requested from the file.
+        std::size_t num_bytes_requested{};
+        // The number of bytes read so far.
+        std::size_t num_bytes_read{};
+        // The remaining part of the request if the kernel returned a
+        // short read.
+        ::iovec pending{};
+        int error{};
+        bool in_flight{};
+    };
+
+public:
+    explicit Io_uring_file_input_stream(std::string path);
+
+    Io_uring_file_input_stream(const Io_uring_file_input_stream &) = delete;
+
+    Io_uring_file_input_stream &operator=(const Io_uring_file_input_stream &) = delete;
+
+    Io_uring_file_input_stream(Io_uring_file_input_stream &&) = delete;
+
+    Io_uring_file_input_stream &operator=(Io_uring_file_input_stream &&) = delete;
+
+    ~Io_uring_file_input_stream() final;
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void seek(std::size_t position) final;
+
+    void close() noexcept final;
+
+    std::size_t size() const final;
+
+    std::size_t position() const final;
+
+    bool closed() const noexcept final
+    {
+        return !fd_.is_open();
+    }
+
+    bool seekable() const noexcept final
+    {
+        return true;
+    }
+
+private:
+    void init_queue();
+
+    std::size_t read_direct(Mutable_memory_span destination);
+
+    void fill_queue();
+
+    void queue(Buffer &buffer);
+
+    void submit_queued() noexcept;
+
+    void wait(const Buffer &buffer);
+
+    void drain() noexcept;
+
+    void check_if_closed() const;
+
+    static constexpr std::size_t num_buffers_ = 4;
+    static constexpr std::size_t max_buffer_size_ = 0x40'0000;  // 4 MiB
+    // Reads of at least this size are done directly into the caller's
+    // buffer once the queue is drained; this saves a copy per byte.
+    static constexpr std::size_t min_direct_read_size_ = 0x10'0000;  // 1 MiB
+    // The buffers of smaller files are not registered with the kernel;
+    // pinning them costs more than it saves.
+    static constexpr std::size_t min_registered_size_ = 0x10'0000;  // 1 MiB
+
+    std::string path_;
+    File_descriptor fd_{};
+    std::size_t size_{};
+    // The ring and the buffers are set up by the first read.
+    std::size_t buffer_size_{};
+    Intrusive_ptr<Mutable_memory_block> memory_{};
+    std::unique_ptr<Io_uring> ring_{};
+    // The first num_buffers_ buffers form the read-ahead queue; the rest
+    // describe the parts of a direct read.
+    std::vector<Buffer> buffers_{};
+    // The buffers whose reads are queued in the ring but not submitted
+    // yet, in the order they were queued.
+    std::vector<Buffer *> queued_{};
+    // The index of the buffer we are currently reading from.
+    std::size_t head_{};
+    // The number of buffers that are in flight or hold unread data.
+    std::size_t num_queued_{};
+    // The number of bytes already read from the head buffer.
+    std::size_t num_bytes_consumed_{};
+    // The file offset of the next read to submit.
+    std::size_t next_offset_{};
+    std::size_t position_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
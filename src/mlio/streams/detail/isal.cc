@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/isal.h"
+
+#ifdef MLIO_BUILD_ISAL
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Isal_inflater::Isal_inflater()
+{
+    ::isal_inflate_init(&state_);
+}
+
+Isal_inflater::~Isal_inflater() = default;
+
+void Isal_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
+{
+    if (inp.empty() && eof_) {
+        return;
+    }
+
+    if (eof_) {
+        ::isal_inflate_reset(&state_);
+
+        // Unlike zlib, ISA-L does not detect the wrapper by itself. A
+        // gzip member starts with 0x1f which can never be the first byte
+        // of a zlib stream.
+        if (inp[0] == std::byte{0x1f}) {
+            state_.crc_flag = ISAL_GZIP;
+        }
+        else {
+            state_.crc_flag = ISAL_ZLIB;
+        }
+    }
+
+    // ISA-L counts in 32-bit integers; larger buffers are processed over
+    // several calls.
+    constexpr std::size_t max_size = std::numeric_limits<std::uint32_t>::max();
+
+    auto i_buf = as_span<const std::uint8_t>(inp).first(std::min(inp.size(), max_size));
+    auto o_buf = as_span<std::uint8_t>(out).first(std::min(out.size(), max_size));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    state_.next_in = const_cast<std::uint8_t *>(i_buf.data());
+    state_.next_out = o_buf.data();
+
+    state_.avail_in = static_cast<std::uint32_t>(i_buf.size());
+    state_.avail_out = static_cast<std::uint32_t>(o_buf.size());
+
+    int r = ::isal_inflate(&state_);
+    if (r < 0 || r == ISAL_NEED_DICT) {
+        throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+    }
+
+    eof_ = state_.block_state == ISAL_BLOCK_FINISH;
+
+    inp = inp.subspan(i_buf.size() - state_.avail_in);
+    out = out.subspan(o_buf.size() - state_.avail_out);
+}
+
+void Isal_inflater::check_eof() const
+{
+    if (!eof_) {
+        throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/libdeflate.h"
+
+#ifdef MLIO_BUILD_LIBDEFLATE
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+
+#include <libdeflate.h>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+struct Decompressor_deleter {
+    void operator()(::libdeflate_decompressor *decompressor) const noexcept
+    {
+        ::libdeflate_free_decompressor(decompressor);
+    }
+};
+
+using Decompressor_ptr = std::unique_ptr<::libdeflate_decompressor, Decompressor_deleter>;
+
+// Returns the inflated size, modulo 2^32, stored in the trailer of the
+// last gzip member of the specified data.
+std::size_t gzip_trailer_size(Memory_span data) noexcept
+{
+    if (data.size() < 4) {
+        return 0;
+    }
+
+    Memory_span trailer = data.last(4);
+
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < 4; i++) {
+        size |= std::size_t{static_cast<std::uint8_t>(trailer[i])} << (8 * i);
+    }
+    return size;
+}
+
+}  // namespace
+
+std::optional<std::size_t> libdeflate_inflate_frame(Memory_span data,
+                                                    std::vector<std::byte> &output,
+                                                    std::size_t max_output_size)
+{
+    constexpr std::size_t min_output_size = 0x1'0000;  // 64 KiB
+
+    // The maximum compression ratio of deflate.
+    constexpr std::size_t max_deflate_ratio = 1032;
+
+    thread_local Decompressor_ptr decompressor{};
+    if (decompressor == nullptr) {
+        decompressor.reset(::libdeflate_alloc_decompressor());
+        if (decompressor == nullptr) {
+            throw std::bad_alloc{};
+        }
+    }
+
+    bool is_gzip = data[0] == std::byte{0x1f};
+
+    // Start with a guess of the compression ratio. If the data holds a
+    // single gzip member, its trailer tells the exact inflated size.
+    std::size_t capacity = std::max(data.size() * 4, min_output_size);
+    if (is_gzip) {
+        std::size_t trailer_size = gzip_trailer_size(data);
+
+        // If the data holds more than one member, the trailer belongs
+        // to the last one; in the worst case we fall back to streaming
+        // a member that would have fit.
+        if (trailer_size > max_output_size) {
+            return {};
+        }
+
+        // Make sure that the guess is not absurd.
+        capacity = std::min(trailer_size, data.size() * max_deflate_ratio);
+
+        capacity = std::max(capacity, min_output_size);
+    }
+
+    capacity = std::min(capacity, max_output_size);
+
+    std::size_t size = output.size();
+
+    while (true) {
+        output.resize(size + capacity);
+
+        std::size_t num_bytes_consumed{};
+        std::size_t num_bytes_inflated{};
+
+        ::libdeflate_result r{};
+        if (is_gzip) {
+            r = ::libdeflate_gzip_decompress_ex(decompressor.get(),
+                                                data.data(),
+                                                data.size(),
+                                                output.data() + size,
+                                                capacity,
+                                                &num_bytes_consumed,
+                                                &num_bytes_inflated);
+        }
+        else {
+            r = ::libdeflate_zlib_decompress_ex(decompressor.get(),
+                                                data.data(),
+                                                data.size(),
+                                                output.data() + size,
+                                                capacity,
+                                                &num_bytes_consumed,
+                                                &num_bytes_inflated);
+        }
+
+        // Unlike zlib, libdeflate cannot resume; we have to start the
+        // frame over with a larger buffer.
+        if (r == LIBDEFLATE_INSUFFICIENT_SPACE) {
+            if (capacity == max_output_size) {
+                output.resize(size);
+
+                return {};
+            }
+
+            capacity = max_output_size / 2 < capacity ? max_output_size : capacity * 2;
+
+            continue;
+        }
+
+        if (r != LIBDEFLATE_SUCCESS) {
+            output.resize(size);
+
+            throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+        }
+
+        output.resize(size + num_bytes_inflated);
+
+        return num_bytes_consumed;
+    }
+}
+
+bool libdeflate_inflate(Memory_span data,
+                        std::vector<std::byte> &output,
+                        std::size_t max_output_size)
+{
+    output.clear();
+
+    // libdeflate inflates one gzip member or zlib stream per call.
+    while (!data.empty()) {
+        std::optional<std::size_t> num_bytes_consumed =
+            libdeflate_inflate_frame(data, output, max_output_size - output.size());
+
+        if (num_bytes_consumed == std::nullopt) {
+            output.clear();
+
+            return false;
+        }
+
+        data = data.subspan(*num_bytes_consumed);
+    }
+
+    return true;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
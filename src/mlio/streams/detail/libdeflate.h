@@ -0,0 +1,51 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#ifdef MLIO_BUILD_LIBDEFLATE
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates the gzip member or zlib stream at the beginning of the
+// specified data and appends it to output. Returns the number of bytes
+// consumed, or nullopt if the inflated data would be larger than
+// max_output_size; in that case output is left unchanged.
+std::optional<std::size_t> libdeflate_inflate_frame(Memory_span data,
+                                                    std::vector<std::byte> &output,
+                                                    std::size_t max_output_size);
+
+// Inflates the specified data that consists of one or more complete
+// gzip members or zlib streams into output, which is resized to the
+// inflated size. Returns false, leaving output empty, if the inflated
+// data would be larger than max_output_size.
+bool libdeflate_inflate(Memory_span data,
+                        std::vector<std::byte> &output,
+                        std::size_t max_output_size = std::numeric_limits<std::size_t>::max());
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
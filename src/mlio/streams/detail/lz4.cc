@@ -0,0 +1,75 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/lz4.h"
+
+#ifdef MLIO_BUILD_LZ4
+
+#include <new>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Lz4_inflater::Lz4_inflater()
+{
+    if (::LZ4F_isError(::LZ4F_createDecompressionContext(&ctx_, LZ4F_VERSION)) != 0) {
+        throw std::bad_alloc{};
+    }
+}
+
+Lz4_inflater::~Lz4_inflater()
+{
+    ::LZ4F_freeDecompressionContext(ctx_);
+}
+
+void Lz4_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
+{
+    // At a frame boundary an empty input would make LZ4 expect a new
+    // frame header.
+    if (inp.empty() && eof_) {
+        return;
+    }
+
+    std::size_t i_size = inp.size();
+    std::size_t o_size = out.size();
+
+    std::size_t r = ::LZ4F_decompress(ctx_, out.data(), &o_size, inp.data(), &i_size, nullptr);
+    if (::LZ4F_isError(r) != 0) {
+        throw Inflate_error{"The LZ4 stream contains invalid or incomplete data."};
+    }
+
+    // A return value of zero means that a frame has been fully decoded
+    // and flushed.
+    eof_ = r == 0;
+
+    inp = inp.subspan(i_size);
+    out = out.subspan(o_size);
+}
+
+void Lz4_inflater::check_eof() const
+{
+    if (!eof_) {
+        throw Inflate_error{"The LZ4 stream contains invalid or incomplete data."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
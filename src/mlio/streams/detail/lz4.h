@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#ifdef MLIO_BUILD_LZ4
+
+#include <lz4frame.h>
+
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates data in the LZ4 frame format.
+class Lz4_inflater final : public Inflater {
+public:
+    explicit Lz4_inflater();
+
+    Lz4_inflater(const Lz4_inflater &) = delete;
+
+    Lz4_inflater &operator=(const Lz4_inflater &) = delete;
+
+    Lz4_inflater(Lz4_inflater &&) = delete;
+
+    Lz4_inflater &operator=(Lz4_inflater &&) = delete;
+
+    ~Lz4_inflater() final;
+
+    void inflate(Memory_span &inp, Mutable_memory_span &out) final;
+
+    bool eof() const noexcept final
+    {
+        return eof_;
+    }
+
+    void check_eof() const final;
+
+private:
+    ::LZ4F_dctx *ctx_{};
+    bool eof_ = true;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
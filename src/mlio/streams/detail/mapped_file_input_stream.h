@@ -0,0 +1,106 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/file_mapped_memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/memory_input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Wraps a memory-mapped file that should be read window by window; see
+// Mapped_chunk_reader. Otherwise it behaves like a Memory_input_stream.
+class Mapped_file_input_stream final : public Input_stream {
+public:
+    explicit Mapped_file_input_stream(Intrusive_ptr<File_mapped_memory_block> block,
+                                      std::size_t window_size) noexcept
+        : block_{std::move(block)}, window_size_{window_size}, inner_{Memory_slice{block_}}
+    {}
+
+    std::size_t read(Mutable_memory_span destination) final
+    {
+        return inner_.read(destination);
+    }
+
+    Memory_slice read(std::size_t size) final
+    {
+        return inner_.read(size);
+    }
+
+    void seek(std::size_t position) final
+    {
+        inner_.seek(position);
+    }
+
+    void close() noexcept final
+    {
+        inner_.close();
+
+        block_ = nullptr;
+    }
+
+    std::size_t size() const final
+    {
+        return inner_.size();
+    }
+
+    std::size_t position() const final
+    {
+        return inner_.position();
+    }
+
+    bool closed() const noexcept final
+    {
+        return inner_.closed();
+    }
+
+    bool seekable() const noexcept final
+    {
+        return true;
+    }
+
+    bool supports_zero_copy() const noexcept final
+    {
+        return true;
+    }
+
+    const Intrusive_ptr<File_mapped_memory_block> &block() const noexcept
+    {
+        return block_;
+    }
+
+    std::size_t window_size() const noexcept
+    {
+        return window_size_;
+    }
+
+private:
+    Intrusive_ptr<File_mapped_memory_block> block_;
+    std::size_t window_size_;
+    Memory_input_stream inner_;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/parallel_gzip_inflate_stream.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "mlio/streams/detail/inflate_backend.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::size_t gzip_header_size = 10;
+
+inline std::uint8_t byte_at(Memory_span data, std::size_t pos) noexcept
+{
+    return static_cast<std::uint8_t>(data[pos]);
+}
+
+inline bool has_gzip_magic(Memory_span data) noexcept
+{
+    return data.size() >= 3 && byte_at(data, 0) == 0x1f && byte_at(data, 1) == 0x8b &&
+           byte_at(data, 2) == 0x08;
+}
+
+// Checks whether the specified data starts with a gzip member header.
+// Besides the magic number we check the reserved flags and the values
+// of the XFL and OS fields to reduce false positives.
+bool is_plausible_header(Memory_span data) noexcept
+{
+    if (data.size() < gzip_header_size || !has_gzip_magic(data)) {
+        return false;
+    }
+
+    std::uint8_t flags = byte_at(data, 3);
+    if ((flags & 0xe0) != 0) {
+        return false;
+    }
+
+    std::uint8_t xfl = byte_at(data, 8);
+    if (xfl != 0 && xfl != 2 && xfl != 4) {
+        return false;
+    }
+
+    std::uint8_t os = byte_at(data, 9);
+
+    return os <= 13 || os == 255;
+}
+
+// Returns the size of the BGZF block starting at the specified data,
+// or nullopt if the data does not start with a complete BGZF header.
+std::optional<std::size_t> bgzf_block_size(Memory_span data) noexcept
+{
+    constexpr std::uint8_t fextra = 0x04;
+
+    if (data.size() < gzip_header_size + 2 || !has_gzip_magic(data)) {
+        return {};
+    }
+
+    if ((byte_at(data, 3) & fextra) == 0) {
+        return {};
+    }
+
+    std::size_t xlen = byte_at(data, 10) | (std::size_t{byte_at(data, 11)} << 8);
+    if (data.size() < gzip_header_size + 2 + xlen) {
+        return {};
+    }
+
+    Memory_span extra = data.subspan(gzip_header_size + 2, xlen);
+
+    // Look for the 'BC' subfield that holds the block size minus one.
+    while (extra.size() >= 4) {
+        std::size_t slen = byte_at(extra, 2) | (std::size_t{byte_at(extra, 3)} << 8);
+        if (extra.size() < 4 + slen) {
+            break;
+        }
+
+        if (byte_at(extra, 0) == 'B' && byte_at(extra, 1) == 'C' && slen == 2) {
+            return (byte_at(extra, 4) | (std::size_t{byte_at(extra, 5)} << 8)) + 1;
+        }
+
+        extra = extra.subspan(4 + slen);
+    }
+
+    return {};
+}
+
+std::optional<std::size_t> find_member_header(Memory_span data, std::size_t from) noexcept
+{
+    for (std::size_t pos = from; pos + gzip_header_size <= data.size(); pos++) {
+        const void *magic =
+            std::memchr(data.data() + pos, 0x1f, data.size() - pos - gzip_header_size + 1);
+        if (magic == nullptr) {
+            break;
+        }
+
+        pos = as_size(static_cast<const std::byte *>(magic) - data.data());
+
+        if (is_plausible_header(data.subspan(pos))) {
+            return pos;
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+Parallel_gzip_inflate_stream::Parallel_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                                           Inflate_backend backend)
+    : Parallel_inflate_stream{std::move(inner)}, backend_{backend}
+{}
+
+Parallel_gzip_inflate_stream::~Parallel_gzip_inflate_stream() = default;
+
+std::unique_ptr<Inflater> Parallel_gzip_inflate_stream::make_inflater() const
+{
+    return make_gzip_inflater(backend_);
+}
+
+bool Parallel_gzip_inflate_stream::inflate_frames(Memory_span data,
+                                                  std::vector<std::byte> &output,
+                                                  std::size_t max_output_size) const
+{
+    return inflate_gzip_buffer(backend_, data, output, max_output_size);
+}
+
+std::optional<std::size_t> Parallel_gzip_inflate_stream::inflate_frame(
+    Memory_span data, std::vector<std::byte> &output, std::size_t max_output_size) const
+{
+    return inflate_gzip_frame(backend_, data, output, max_output_size);
+}
+
+std::optional<std::size_t> Parallel_gzip_inflate_stream::frame_size(Memory_span data) const
+{
+    return bgzf_block_size(data);
+}
+
+std::optional<std::size_t>
+Parallel_gzip_inflate_stream::inflated_frame_size(Memory_span frame) const
+{
+    constexpr std::size_t gzip_trailer_size = 8;
+
+    if (frame.size() < gzip_header_size + gzip_trailer_size) {
+        return {};
+    }
+
+    // The ISIZE field of the trailer holds the inflated size modulo 2^32,
+    // which is exact for a BGZF block.
+    std::size_t pos = frame.size() - 4;
+
+    return byte_at(frame, pos) | (std::size_t{byte_at(frame, pos + 1)} << 8) |
+           (std::size_t{byte_at(frame, pos + 2)} << 16) |
+           (std::size_t{byte_at(frame, pos + 3)} << 24);
+}
+
+std::optional<std::size_t>
+Parallel_gzip_inflate_stream::guess_next_frame(Memory_span data, std::size_t from) const
+{
+    // A zlib stream consists of a single frame.
+    if (!has_gzip_magic(data)) {
+        return {};
+    }
+    return find_member_header(data, from);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "mlio/data_stores/compression.h"
+#include "mlio/intrusive_ptr.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+#include "mlio/streams/detail/parallel_inflate_stream.h"
+#include "mlio/streams/input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates a gzip stream in parallel; see Parallel_inflate_stream.
+//
+// The members of a BGZF file store their size in their header, so the
+// segments are exact. For other multi-member files we speculate that a
+// member starts wherever we find a valid-looking member header.
+//
+// A single-member gzip or a zlib stream is a single deflate stream
+// whose blocks refer back to the previous 32 KiB of output; it cannot be
+// split without knowing that window. Therefore it is inflated serially
+// unless the inflate backend can decompress it faster in one piece. If
+// the file has a gzip index, its access points hold such windows and
+// the stream can be inflated in parallel; see Indexed_gzip_inflate_stream.
+class Parallel_gzip_inflate_stream final : public Parallel_inflate_stream {
+public:
+    explicit Parallel_gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                          Inflate_backend backend);
+
+    Parallel_gzip_inflate_stream(const Parallel_gzip_inflate_stream &) = delete;
+
+    Parallel_gzip_inflate_stream &operator=(const Parallel_gzip_inflate_stream &) = delete;
+
+    Parallel_gzip_inflate_stream(Parallel_gzip_inflate_stream &&) = delete;
+
+    Parallel_gzip_inflate_stream &operator=(Parallel_gzip_inflate_stream &&) = delete;
+
+    ~Parallel_gzip_inflate_stream() final;
+
+private:
+    std::unique_ptr<Inflater> make_inflater() const final;
+
+    std::optional<std::size_t> frame_size(Memory_span data) const final;
+
+    std::optional<std::size_t> inflated_frame_size(Memory_span frame) const final;
+
+    std::optional<std::size_t> guess_next_frame(Memory_span data, std::size_t from) const final;
+
+    bool inflate_frames(Memory_span data,
+                        std::vector<std::byte> &output,
+                        std::size_t max_output_size) const final;
+
+    std::optional<std::size_t> inflate_frame(Memory_span data,
+                                             std::vector<std::byte> &output,
+                                             std::size_t max_output_size) const final;
+
+    Inflate_backend backend_;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
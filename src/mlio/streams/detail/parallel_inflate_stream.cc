@@ -0,0 +1,474 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/parallel_inflate_stream.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include <tbb/tbb.h>
+
+#include "mlio/streams/stream_error.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::size_t max_num_concurrent_segments = 16;
+
+// The maximum total inflated size of the segments of a window.
+constexpr std::size_t max_window_output_size = 0x400'0000;  // 64 MiB
+
+// The size below which we stop splitting segments that inflate to more
+// than their share of max_window_output_size.
+constexpr std::size_t min_segment_size = 0x1'0000;  // 64 KiB
+
+// The maximum inflated size of a frame of unknown size that we inflate
+// in one piece; larger frames are inflated serially.
+constexpr std::size_t max_whole_frame_size = 0x400'0000;  // 64 MiB
+
+}  // namespace
+
+Parallel_inflate_stream::Parallel_inflate_stream(Intrusive_ptr<Input_stream> inner)
+    : inner_{std::move(inner)}, segment_size_{0x40'0000}  // 4 MiB
+{
+    max_num_segments_ = std::min(as_size(tbb::this_task_arena::max_concurrency()),
+                                 max_num_concurrent_segments);
+
+    max_segment_output_size_ = max_window_output_size / max_num_segments_;
+
+    // Leave room for the speculated end of the last segment.
+    window_size_ = segment_size_ * (max_num_segments_ + 1);
+}
+
+Parallel_inflate_stream::~Parallel_inflate_stream() = default;
+
+std::size_t Parallel_inflate_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty()) {
+        return 0;
+    }
+
+    while (true) {
+        if (!outputs_.empty()) {
+            return read_output(destination);
+        }
+
+        if (inflater_ != nullptr) {
+            std::size_t num_bytes_read = inflate_serial(destination);
+            if (num_bytes_read > 0 || inflater_ != nullptr) {
+                return num_bytes_read;
+            }
+
+            // The frame has ended without any output; go on with the
+            // next one.
+            continue;
+        }
+
+        fill_input();
+
+        if (input().empty()) {
+            return 0;
+        }
+
+        inflate_segments();
+    }
+}
+
+std::optional<std::size_t> Parallel_inflate_stream::inflated_frame_size(Memory_span) const
+{
+    return {};
+}
+
+std::optional<std::size_t>
+Parallel_inflate_stream::guess_next_frame(Memory_span, std::size_t) const
+{
+    return {};
+}
+
+std::size_t Parallel_inflate_stream::read_output(Mutable_memory_span destination)
+{
+    const std::vector<std::byte> &output = outputs_.front();
+
+    std::size_t size = std::min(output.size() - output_pos_, destination.size());
+
+    auto first = output.begin() + as_ssize(output_pos_);
+
+    std::copy(first, first + as_ssize(size), destination.begin());
+
+    output_pos_ += size;
+    if (output_pos_ == output.size()) {
+        outputs_.pop_front();
+
+        output_pos_ = 0;
+    }
+
+    return size;
+}
+
+std::size_t Parallel_inflate_stream::inflate_serial(Mutable_memory_span destination)
+{
+    auto out = destination;
+
+    // Inflating the header of a frame does not produce any output; keep
+    // going until we have some.
+    while (out.size() == destination.size()) {
+        bool input_eof = false;
+        if (input().empty()) {
+            fill_input();
+
+            input_eof = input().empty();
+        }
+
+        // Feed the inflater at most one window at a time.
+        Memory_span inp = input();
+        if (inp.size() > window_size_) {
+            inp = inp.first(window_size_);
+        }
+
+        std::size_t inp_size = inp.size();
+
+        // Even if we have consumed all input, the inflater might still
+        // have pending output.
+        inflater_->inflate(inp, out);
+
+        input_pos_ += inp_size - inp.size();
+
+        // Once the frame ends, we are back at a frame boundary and can
+        // try to inflate the rest of the stream in parallel.
+        if (inflater_->eof()) {
+            inflater_ = nullptr;
+
+            break;
+        }
+
+        if (input_eof && out.size() == destination.size()) {
+            inflater_->check_eof();
+        }
+    }
+
+    return destination.size() - out.size();
+}
+
+void Parallel_inflate_stream::inflate_segments()
+{
+    std::vector<Segment> segments = split_input();
+    if (segments.empty()) {
+        // The input starts with a frame of unknown size. If the rest of
+        // the input is in memory, it might be faster to inflate the frame
+        // in one piece.
+        if (mapped_) {
+            std::vector<std::byte> output{};
+
+            std::optional<std::size_t> num_bytes_consumed =
+                inflate_frame(input(), output, max_whole_frame_size);
+
+            if (num_bytes_consumed) {
+                if (!output.empty()) {
+                    outputs_.emplace_back(std::move(output));
+                }
+
+                input_pos_ += *num_bytes_consumed;
+
+                return;
+            }
+        }
+
+        inflater_ = make_inflater();
+
+        return;
+    }
+
+    Memory_span inp = input();
+
+    std::vector<std::vector<std::byte>> outputs(segments.size());
+
+    std::vector<std::exception_ptr> errors(segments.size());
+
+    // Indicates whether a segment inflated to more than its share of the
+    // output bound.
+    std::vector<char> overflows(segments.size());
+
+    tbb::parallel_for(std::size_t{}, segments.size(), [&](std::size_t i) {
+        const Segment &segment = segments[i];
+
+        Memory_span data = inp.subspan(segment.begin, segment.end - segment.begin);
+
+        try {
+            overflows[i] = !inflate_frames(data, outputs[i], max_segment_output_size_);
+        }
+        catch (const Inflate_error &) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    std::size_t input_begin = input_pos_;
+
+    for (std::size_t i = 0; i < segments.size(); i++) {
+        if (errors[i] != nullptr) {
+            if (!segments[i].speculative) {
+                std::rethrow_exception(errors[i]);
+            }
+
+            // Our guess was wrong; inflate the frame serially. Most
+            // likely the stream consists of frames that are too large
+            // for speculation, so we stop trying.
+            speculate_ = false;
+
+            input_pos_ = input_begin + segments[i].begin;
+
+            inflater_ = make_inflater();
+
+            return;
+        }
+
+        if (overflows[i] != 0) {
+            input_pos_ = input_begin + segments[i].begin;
+
+            // The data compresses better than the segment size accounts
+            // for; retry with smaller segments, and once they are small
+            // enough, inflate serially with bounded output.
+            if (segment_size_ > min_segment_size) {
+                segment_size_ = std::max(segment_size_ / 2, min_segment_size);
+            }
+            else {
+                inflater_ = make_inflater();
+            }
+
+            return;
+        }
+
+        if (!outputs[i].empty()) {
+            outputs_.emplace_back(std::move(outputs[i]));
+        }
+
+        input_pos_ = input_begin + segments[i].end;
+    }
+}
+
+bool Parallel_inflate_stream::inflate_frames(Memory_span data,
+                                             std::vector<std::byte> &output,
+                                             std::size_t max_output_size) const
+{
+    std::unique_ptr<Inflater> inflater = make_inflater();
+
+    return inflate_buffer(*inflater, data, output, max_output_size);
+}
+
+std::optional<std::size_t>
+Parallel_inflate_stream::inflate_frame(Memory_span, std::vector<std::byte> &, std::size_t) const
+{
+    return {};
+}
+
+std::vector<Parallel_inflate_stream::Segment> Parallel_inflate_stream::split_input() const
+{
+    Memory_span inp = input();
+
+    // Unless we inflate a whole buffer, we split at most one window.
+    bool input_eof = input_eof_;
+    if (inp.size() > window_size_) {
+        inp = inp.first(window_size_);
+
+        input_eof = false;
+    }
+
+    std::vector<Segment> segments{};
+
+    // Indicates whether we stopped at a frame whose end is unknown, or
+    // that is too large to be inflated as part of a segment.
+    bool has_unknown_frame = false;
+
+    std::size_t segment_begin = 0;
+
+    // The known inflated size of the current segment.
+    std::size_t segment_output_size = 0;
+
+    std::size_t pos = 0;
+    while (pos < inp.size() && segments.size() < max_num_segments_) {
+        Memory_span frame = inp.subspan(pos);
+
+        std::optional<std::size_t> size = frame_size(frame);
+        if (size) {
+            if (*size == 0 || *size > frame.size()) {
+                break;
+            }
+
+            std::size_t output_size = inflated_frame_size(frame.first(*size)).value_or(0);
+
+            // A frame whose inflated size alone exceeds the bound of a
+            // segment is left to inflate_segments(), which inflates it on
+            // its own.
+            if (output_size > max_segment_output_size_) {
+                has_unknown_frame = true;
+
+                break;
+            }
+
+            if (segment_output_size + output_size > max_segment_output_size_) {
+                segments.emplace_back(Segment{segment_begin, pos, false});
+
+                segment_begin = pos;
+
+                segment_output_size = 0;
+
+                continue;
+            }
+
+            segment_output_size += output_size;
+
+            pos += *size;
+
+            if (pos - segment_begin >= segment_size_) {
+                segments.emplace_back(Segment{segment_begin, pos, false});
+
+                segment_begin = pos;
+
+                segment_output_size = 0;
+            }
+
+            continue;
+        }
+
+        // The size of the frame is unknown.
+        if (pos != segment_begin) {
+            segments.emplace_back(Segment{segment_begin, pos, false});
+
+            segment_begin = pos;
+
+            segment_output_size = 0;
+        }
+
+        std::optional<std::size_t> next{};
+        if (speculate_) {
+            next = guess_next_frame(frame, segment_size_);
+        }
+
+        if (!next) {
+            has_unknown_frame = true;
+
+            break;
+        }
+
+        pos += *next;
+
+        segments.emplace_back(Segment{segment_begin, pos, true});
+
+        segment_begin = pos;
+    }
+
+    if (pos != segment_begin) {
+        segments.emplace_back(Segment{segment_begin, pos, false});
+    }
+
+    // At the end of the stream the rest of the input must consist of
+    // complete frames. A frame of unknown size is left to
+    // inflate_segments() though, which bounds its output; and if we have
+    // enough segments, the rest is split in the next window.
+    if (input_eof && pos < inp.size() && !has_unknown_frame &&
+        segments.size() < max_num_segments_) {
+        segments.emplace_back(Segment{pos, inp.size(), false});
+    }
+
+    return segments;
+}
+
+void Parallel_inflate_stream::fill_input()
+{
+    if (mapped_ || input_eof_) {
+        return;
+    }
+
+    // If the inner stream holds its data in memory, we read all of it at
+    // once without copying.
+    if (input_.empty() && inner_->supports_zero_copy() && inner_->seekable()) {
+        std::size_t size = inner_->size() - inner_->position();
+
+        Memory_slice data = inner_->read(size);
+        if (data.size() == size) {
+            mapped_input_ = std::move(data);
+
+            mapped_ = true;
+
+            input_eof_ = true;
+
+            return;
+        }
+
+        input_.assign(data.begin(), data.end());
+    }
+
+    // Move the data that has not been inflated yet to the beginning of
+    // the buffer.
+    input_.erase(input_.begin(), input_.begin() + as_ssize(input_pos_));
+
+    input_pos_ = 0;
+
+    while (!input_eof_ && input_.size() < window_size_) {
+        std::size_t size = input_.size();
+
+        input_.resize(window_size_);
+
+        std::size_t num_bytes_read = inner_->read(make_span(input_).subspan(size));
+
+        input_.resize(size + num_bytes_read);
+
+        if (num_bytes_read == 0) {
+            input_eof_ = true;
+        }
+    }
+}
+
+Memory_span Parallel_inflate_stream::input() const noexcept
+{
+    if (mapped_) {
+        return Memory_span{mapped_input_}.subspan(input_pos_);
+    }
+    return Memory_span{input_}.subspan(input_pos_);
+}
+
+void Parallel_inflate_stream::close() noexcept
+{
+    inner_->close();
+
+    inflater_ = nullptr;
+
+    input_ = {};
+
+    mapped_input_ = {};
+
+    outputs_.clear();
+}
+
+bool Parallel_inflate_stream::closed() const noexcept
+{
+    return inner_->closed();
+}
+
+void Parallel_inflate_stream::check_if_closed() const
+{
+    if (inner_->closed()) {
+        throw Stream_error{"The input stream is closed."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates a stream of concatenated frames (e.g. gzip members or zstd
+// frames) by splitting it into segments of one or more frames and
+// inflating the segments concurrently; the output is returned in order.
+//
+// If the size of a frame can be determined from its header, the
+// segments are exact. Otherwise a derived class can speculate where the
+// next frame starts, in which case a segment is only accepted if its
+// last frame ends exactly where the next segment starts. If the
+// speculation fails, or the frame boundaries cannot be determined at
+// all, the current frame is inflated serially; or in one piece, if the
+// derived class supports it and its inflated size is within a bound.
+//
+// The inflated output of a window is bounded. Segments are cut early if
+// the inflated sizes of their frames are known; otherwise a segment that
+// inflates to more than its share of the bound is discarded and the
+// input is split into smaller segments, or inflated serially.
+//
+// If the inner stream holds its data in memory (e.g. a memory-mapped
+// file), the data is inflated in place instead of being copied into
+// the read window.
+class Parallel_inflate_stream : public Input_stream_base {
+    struct Segment {
+        std::size_t begin{};
+        std::size_t end{};
+        // Indicates whether the end of the segment is a guess.
+        bool speculative{};
+    };
+
+public:
+    Parallel_inflate_stream(const Parallel_inflate_stream &) = delete;
+
+    Parallel_inflate_stream &operator=(const Parallel_inflate_stream &) = delete;
+
+    Parallel_inflate_stream(Parallel_inflate_stream &&) = delete;
+
+    Parallel_inflate_stream &operator=(Parallel_inflate_stream &&) = delete;
+
+    ~Parallel_inflate_stream() override;
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void close() noexcept final;
+
+    bool closed() const noexcept final;
+
+protected:
+    explicit Parallel_inflate_stream(Intrusive_ptr<Input_stream> inner);
+
+private:
+    virtual std::unique_ptr<Inflater> make_inflater() const = 0;
+
+    // Returns the size of the frame at the beginning of the specified
+    // data if it can be determined from its header; otherwise nullopt.
+    virtual std::optional<std::size_t> frame_size(Memory_span data) const = 0;
+
+    // Returns the inflated size of the specified frame, whose size was
+    // determined by frame_size(), if it is known; otherwise nullopt.
+    virtual std::optional<std::size_t> inflated_frame_size(Memory_span frame) const;
+
+    // Returns the position, at or after from, at which the next frame
+    // likely starts, or nullopt if it cannot be guessed. The specified
+    // data starts with a frame of unknown size.
+    virtual std::optional<std::size_t> guess_next_frame(Memory_span data, std::size_t from) const;
+
+    // Inflates the specified data that consists of one or more complete
+    // frames into output. Returns false if the inflated data would be
+    // larger than max_output_size.
+    virtual bool inflate_frames(Memory_span data,
+                                std::vector<std::byte> &output,
+                                std::size_t max_output_size) const;
+
+    // Tries to inflate the frame of unknown size at the beginning of the
+    // specified data in one piece and appends it to output; only called
+    // if the rest of the input is in memory. Returns the number of bytes
+    // consumed, or nullopt if the frame should be inflated serially
+    // instead, for instance because it would inflate to more than
+    // max_output_size bytes.
+    virtual std::optional<std::size_t> inflate_frame(Memory_span data,
+                                                     std::vector<std::byte> &output,
+                                                     std::size_t max_output_size) const;
+
+    std::size_t read_output(Mutable_memory_span destination);
+
+    std::size_t inflate_serial(Mutable_memory_span destination);
+
+    void inflate_segments();
+
+    std::vector<Segment> split_input() const;
+
+    void fill_input();
+
+    Memory_span input() const noexcept;
+
+    void check_if_closed() const;
+
+    Intrusive_ptr<Input_stream> inner_;
+    // The compressed data that has been read from the inner stream but
+    // not inflated yet. Unless we are in serial mode, it starts at a
+    // frame boundary.
+    std::vector<std::byte> input_{};
+    // The data of the inner stream if it is held in memory; in that
+    // case input_ is not used.
+    Memory_slice mapped_input_{};
+    bool mapped_{};
+    std::size_t input_pos_{};
+    bool input_eof_{};
+    std::size_t segment_size_;
+    std::size_t max_num_segments_;
+    // The maximum inflated size of a segment; bounds the memory held by
+    // the inflated segments of a window.
+    std::size_t max_segment_output_size_;
+    std::size_t window_size_;
+    bool speculate_{true};
+    // The inflated segments that have not been read yet.
+    std::deque<std::vector<std::byte>> outputs_{};
+    std::size_t output_pos_{};
+    // The inflater of the frame being inflated serially, if any.
+    std::unique_ptr<Inflater> inflater_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/parallel_s3_reader.h"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+#include "mlio/detail/s3_error.h"
+#include "mlio/detail/thread.h"
+#include "mlio/memory/memory_allocator.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Parallel_s3_reader::Parallel_s3_reader(Read_callback read_object,
+                                       std::size_t size,
+                                       std::size_t offset,
+                                       std::size_t part_size,
+                                       std::size_t num_parts)
+    : read_object_{std::move(read_object)}
+    , size_{size}
+    , part_size_{part_size}
+    , num_parts_{num_parts}
+    , next_offset_{std::min(offset, size)}
+{
+    fill_queue();
+
+    // There is no point in having more threads than parts to read.
+    std::size_t num_threads = std::min(num_parts_, parts_.size());
+
+    try {
+        for (std::size_t i = 0; i < num_threads; i++) {
+            threads_.emplace_back(start_thread(&Parallel_s3_reader::run, this));
+        }
+    }
+    catch (...) {
+        stop();
+
+        throw;
+    }
+}
+
+Parallel_s3_reader::~Parallel_s3_reader()
+{
+    stop();
+}
+
+std::size_t Parallel_s3_reader::read(Mutable_memory_span destination)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (!parts_.empty()) {
+        Part &part = *parts_.front();
+
+        reader_condition_.wait(lock, [&part] {
+            return part.done;
+        });
+
+        if (part.exception) {
+            std::rethrow_exception(part.exception);
+        }
+
+        std::size_t num_bytes_available = part.size - num_bytes_consumed_;
+        if (num_bytes_available > 0) {
+            // The part is done, so no worker touches it anymore.
+            lock.unlock();
+
+            std::size_t size = std::min(num_bytes_available, destination.size());
+
+            auto first = part.block->begin() + as_ssize(num_bytes_consumed_);
+
+            std::copy(first, first + as_ssize(size), destination.begin());
+
+            lock.lock();
+
+            num_bytes_consumed_ += size;
+
+            return size;
+        }
+
+        // The front part is exhausted; recycle its memory for the next
+        // part to queue.
+        spare_blocks_.emplace_back(std::move(part.block));
+
+        parts_.pop_front();
+
+        num_bytes_consumed_ = 0;
+
+        fill_queue();
+
+        worker_condition_.notify_one();
+    }
+
+    return 0;
+}
+
+void Parallel_s3_reader::fill_queue()
+{
+    while (parts_.size() < num_parts_ && next_offset_ < size_) {
+        auto part = std::make_unique<Part>();
+
+        part->offset = next_offset_;
+        part->size = std::min(part_size_, size_ - next_offset_);
+
+        if (spare_blocks_.empty()) {
+            part->block = memory_allocator().allocate(part_size_);
+        }
+        else {
+            part->block = std::move(spare_blocks_.back());
+
+            spare_blocks_.pop_back();
+        }
+
+        next_offset_ += part->size;
+
+        parts_.emplace_back(std::move(part));
+    }
+}
+
+void Parallel_s3_reader::run()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (true) {
+        Part *part = nullptr;
+
+        worker_condition_.wait(lock, [this, &part] {
+            if (stopping_) {
+                return true;
+            }
+
+            part = next_part();
+
+            return part != nullptr;
+        });
+
+        if (stopping_) {
+            return;
+        }
+
+        part->started = true;
+
+        std::exception_ptr exception{};
+
+        lock.unlock();
+
+        try {
+            fetch(*part);
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+
+        part->exception = std::move(exception);
+
+        part->done = true;
+
+        reader_condition_.notify_one();
+    }
+}
+
+Parallel_s3_reader::Part *Parallel_s3_reader::next_part() noexcept
+{
+    for (auto &part : parts_) {
+        if (!part->started) {
+            return part.get();
+        }
+    }
+    return nullptr;
+}
+
+void Parallel_s3_reader::fetch(Part &part)
+{
+    auto destination = make_span(*part.block).first(part.size);
+
+    std::size_t num_bytes_read = 0;
+
+    std::size_t num_attempts = 0;
+
+    while (num_bytes_read < part.size) {
+        try {
+            std::size_t num_bytes = read_object_(part.offset + num_bytes_read,
+                                                 destination.subspan(num_bytes_read));
+            if (num_bytes == 0) {
+                throw S3_error{std::make_error_code(std::errc::io_error),
+                               "The S3 object ended before its expected size.",
+                               true};
+            }
+
+            num_bytes_read += num_bytes;
+
+            // A response that ended prematurely still made progress;
+            // only consecutive failures count against the part.
+            num_attempts = 0;
+        }
+        catch (const S3_error &e) {
+            if (!e.retryable() || ++num_attempts == max_num_attempts_) {
+                throw;
+            }
+
+            if (!wait_before_retry(num_attempts)) {
+                return;
+            }
+        }
+    }
+}
+
+bool Parallel_s3_reader::wait_before_retry(std::size_t num_attempts)
+{
+    auto backoff = initial_backoff_ * (1 << (num_attempts - 1));
+
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    return !retry_condition_.wait_for(lock, backoff, [this] {
+        return stopping_;
+    });
+}
+
+void Parallel_s3_reader::stop() noexcept
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        stopping_ = true;
+    }
+
+    worker_condition_.notify_all();
+
+    retry_condition_.notify_all();
+
+    for (std::thread &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
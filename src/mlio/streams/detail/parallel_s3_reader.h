@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/span.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Reads an S3 object sequentially by keeping a number of ranged GET
+// requests, one per part of the object, in flight on background
+// threads. The parts are returned in order.
+//
+// If the request of a part fails with an S3_error that is retryable, or
+// if its response ends prematurely, the rest of the part is requested
+// again.
+class Parallel_s3_reader {
+    struct Part {
+        Intrusive_ptr<Mutable_memory_block> block{};
+        // The offset of the part within the object.
+        std::size_t offset{};
+        std::size_t size{};
+        std::exception_ptr exception{};
+        bool started{};
+        bool done{};
+    };
+
+public:
+    // Reads the object starting at the specified offset into destination
+    // and returns the number of bytes read; see S3_client::read_object.
+    using Read_callback = std::function<std::size_t(std::size_t, Mutable_memory_span)>;
+
+    explicit Parallel_s3_reader(Read_callback read_object,
+                                std::size_t size,
+                                std::size_t offset,
+                                std::size_t part_size,
+                                std::size_t num_parts);
+
+    Parallel_s3_reader(const Parallel_s3_reader &) = delete;
+
+    Parallel_s3_reader &operator=(const Parallel_s3_reader &) = delete;
+
+    Parallel_s3_reader(Parallel_s3_reader &&) = delete;
+
+    Parallel_s3_reader &operator=(Parallel_s3_reader &&) = delete;
+
+    ~Parallel_s3_reader();
+
+    std::size_t read(Mutable_memory_span destination);
+
+private:
+    void fill_queue();
+
+    void run();
+
+    Part *next_part() noexcept;
+
+    void fetch(Part &part);
+
+    bool wait_before_retry(std::size_t num_attempts);
+
+    void stop() noexcept;
+
+    static constexpr std::size_t max_num_attempts_ = 4;
+    static constexpr std::chrono::milliseconds initial_backoff_{100};
+
+    Read_callback read_object_;
+    std::size_t size_;
+    std::size_t part_size_;
+    std::size_t num_parts_;
+    // The parts that are in flight or hold unread data; the front one is
+    // the part we are currently reading from.
+    std::deque<std::unique_ptr<Part>> parts_{};
+    std::vector<Intrusive_ptr<Mutable_memory_block>> spare_blocks_{};
+    // The number of bytes already read from the front part.
+    std::size_t num_bytes_consumed_{};
+    // The offset of the next part to queue.
+    std::size_t next_offset_;
+    std::vector<std::thread> threads_{};
+    bool stopping_{};
+    std::mutex mutex_{};
+    std::condition_variable worker_condition_{};
+    std::condition_variable reader_condition_{};
+    // Signaled when stopping so that the workers waiting before a retry
+    // wake up; kept apart from worker_condition_ so that notifying an
+    // idle worker cannot be consumed by a backing-off one.
+    std::condition_variable retry_condition_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
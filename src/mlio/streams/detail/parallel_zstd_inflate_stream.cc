@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/parallel_zstd_inflate_stream.h"
+
+#ifdef MLIO_BUILD_ZSTD
+
+#include <utility>
+
+#include "mlio/streams/detail/zstd.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Parallel_zstd_inflate_stream::Parallel_zstd_inflate_stream(Intrusive_ptr<Input_stream> inner)
+    : Parallel_inflate_stream{std::move(inner)}
+{}
+
+Parallel_zstd_inflate_stream::~Parallel_zstd_inflate_stream() = default;
+
+std::unique_ptr<Inflater> Parallel_zstd_inflate_stream::make_inflater() const
+{
+    return std::make_unique<Zstd_inflater>();
+}
+
+std::optional<std::size_t> Parallel_zstd_inflate_stream::frame_size(Memory_span data) const
+{
+    return zstd_frame_size(data);
+}
+
+std::optional<std::size_t>
+Parallel_zstd_inflate_stream::inflated_frame_size(Memory_span frame) const
+{
+    return zstd_frame_content_size(frame);
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
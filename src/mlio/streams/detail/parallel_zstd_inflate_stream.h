@@ -0,0 +1,66 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#ifdef MLIO_BUILD_ZSTD
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+#include "mlio/streams/detail/parallel_inflate_stream.h"
+#include "mlio/streams/input_stream.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+// Inflates a zstd stream in parallel; see Parallel_inflate_stream.
+//
+// The size of a zstd frame can be found by walking its block headers,
+// so files written by multi-threaded compressors like pzstd, which
+// consist of many frames, are split exactly. A frame that does not fit
+// into the read window is inflated serially.
+class Parallel_zstd_inflate_stream final : public Parallel_inflate_stream {
+public:
+    explicit Parallel_zstd_inflate_stream(Intrusive_ptr<Input_stream> inner);
+
+    Parallel_zstd_inflate_stream(const Parallel_zstd_inflate_stream &) = delete;
+
+    Parallel_zstd_inflate_stream &operator=(const Parallel_zstd_inflate_stream &) = delete;
+
+    Parallel_zstd_inflate_stream(Parallel_zstd_inflate_stream &&) = delete;
+
+    Parallel_zstd_inflate_stream &operator=(Parallel_zstd_inflate_stream &&) = delete;
+
+    ~Parallel_zstd_inflate_stream() final;
+
+private:
+    std::unique_ptr<Inflater> make_inflater() const final;
+
+    std::optional<std::size_t> frame_size(Memory_span data) const final;
+
+    std::optional<std::size_t> inflated_frame_size(Memory_span frame) const final;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/text_converter.h"
+
+#include <utility>
+
+#include "mlio/streams/detail/iconv.h"
+#include "mlio/streams/detail/unicode_converter.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Text_converter::~Text_converter() = default;
+
+std::unique_ptr<Text_converter> make_text_converter(Text_encoding &&encoding)
+{
+    std::optional<Unicode_encoding> unicode_encoding = as_unicode_encoding(encoding);
+    if (unicode_encoding) {
+        return std::make_unique<Unicode_converter>(std::move(encoding), *unicode_encoding);
+    }
+
+    return std::make_unique<Iconv_desc>(std::move(encoding));
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
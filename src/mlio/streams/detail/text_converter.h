@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mlio/span.h"
+#include "mlio/text_encoding.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+enum class Conversion_status { ok, incomplete_char, leftover };
+
+// Represents a converter from a particular text encoding to UTF-8.
+class Text_converter {
+public:
+    Text_converter() noexcept = default;
+
+    Text_converter(const Text_converter &) = delete;
+
+    Text_converter &operator=(const Text_converter &) = delete;
+
+    Text_converter(Text_converter &&) = delete;
+
+    Text_converter &operator=(Text_converter &&) = delete;
+
+    virtual ~Text_converter();
+
+    // Converts as much of inp as possible into out. On return both
+    // spans are advanced past the consumed and produced bytes. Returns
+    // incomplete_char if inp ends with a partial character, and
+    // leftover if out is too small to hold the rest of inp.
+    //
+    // Throws Stream_error if inp contains an invalid byte sequence.
+    virtual Conversion_status convert(Memory_span &inp, Mutable_memory_span &out) = 0;
+
+    virtual const Text_encoding &encoding() const noexcept = 0;
+};
+
+// Constructs a converter for the specified encoding. UTF-16, UTF-32,
+// and ISO-8859-1 are converted by built-in routines; all other
+// encodings are converted by iconv.
+std::unique_ptr<Text_converter> make_text_converter(Text_encoding &&encoding);
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/unicode_converter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "mlio/endian.h"
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+using Byte = unsigned char;
+
+// Like glibc's iconv, we fall back to the byte order of the host if
+// UTF-16 or UTF-32 text has no BOM.
+constexpr bool host_is_little_endian = MLIO_BYTE_ORDER_HOST == MLIO_BYTE_ORDER_LITTLE;
+
+template<bool big_endian>
+inline std::uint32_t load_utf16(const Byte *data) noexcept
+{
+    if constexpr (big_endian) {
+        return (std::uint32_t{data[0]} << 8) | data[1];
+    }
+    else {
+        return (std::uint32_t{data[1]} << 8) | data[0];
+    }
+}
+
+template<bool big_endian>
+inline std::uint32_t load_utf32(const Byte *data) noexcept
+{
+    if constexpr (big_endian) {
+        return (std::uint32_t{data[0]} << 24) | (std::uint32_t{data[1]} << 16) |
+               (std::uint32_t{data[2]} << 8) | data[3];
+    }
+    else {
+        return (std::uint32_t{data[3]} << 24) | (std::uint32_t{data[2]} << 16) |
+               (std::uint32_t{data[1]} << 8) | data[0];
+    }
+}
+
+inline std::size_t utf8_size(std::uint32_t code_point) noexcept
+{
+    if (code_point < 0x80) {
+        return 1;
+    }
+    if (code_point < 0x800) {
+        return 2;
+    }
+    if (code_point < 0x1'0000) {
+        return 3;
+    }
+    return 4;
+}
+
+inline void encode_utf8(std::uint32_t code_point, std::size_t size, Byte *out) noexcept
+{
+    switch (size) {
+    case 1:
+        out[0] = static_cast<Byte>(code_point);
+        break;
+
+    case 2:
+        out[0] = static_cast<Byte>(0xC0 | (code_point >> 6));
+        out[1] = static_cast<Byte>(0x80 | (code_point & 0x3F));
+        break;
+
+    case 3:
+        out[0] = static_cast<Byte>(0xE0 | (code_point >> 12));
+        out[1] = static_cast<Byte>(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = static_cast<Byte>(0x80 | (code_point & 0x3F));
+        break;
+
+    default:
+        out[0] = static_cast<Byte>(0xF0 | (code_point >> 18));
+        out[1] = static_cast<Byte>(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = static_cast<Byte>(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = static_cast<Byte>(0x80 | (code_point & 0x3F));
+        break;
+    }
+}
+
+// The fast paths below convert the leading run of ASCII characters in
+// blocks of 16 and return the number of characters converted; the rest
+// is left to the scalar loops.
+
+#ifdef __SSE2__
+
+template<bool big_endian>
+inline __m128i load_utf16_block(const Byte *data) noexcept
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    if constexpr (big_endian) {
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+    return v;
+}
+
+template<bool big_endian>
+inline __m128i load_utf32_block(const Byte *data) noexcept
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    if constexpr (big_endian) {
+        const __m128i byte_mask = _mm_set1_epi32(0xFF00);
+
+        __m128i hi = _mm_or_si128(_mm_slli_epi32(v, 24),
+                                  _mm_slli_epi32(_mm_and_si128(v, byte_mask), 8));
+        __m128i lo = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 8), byte_mask),
+                                  _mm_srli_epi32(v, 24));
+
+        v = _mm_or_si128(hi, lo);
+    }
+    return v;
+}
+
+template<bool big_endian>
+std::size_t convert_ascii_utf16(const Byte *inp, std::size_t size, Byte *out) noexcept
+{
+    // Any bit above the lower 7 bits means a non-ASCII character.
+    const __m128i non_ascii = _mm_set1_epi16(-0x80);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i lo = load_utf16_block<big_endian>(inp + i * 2);
+        __m128i hi = load_utf16_block<big_endian>(inp + i * 2 + 16);
+
+        __m128i bits = _mm_and_si128(_mm_or_si128(lo, hi), non_ascii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+template<bool big_endian>
+std::size_t convert_ascii_utf32(const Byte *inp, std::size_t size, Byte *out) noexcept
+{
+    const __m128i non_ascii = _mm_set1_epi32(-0x80);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = load_utf32_block<big_endian>(inp + i * 4);
+        __m128i b = load_utf32_block<big_endian>(inp + i * 4 + 16);
+        __m128i c = load_utf32_block<big_endian>(inp + i * 4 + 32);
+        __m128i d = load_utf32_block<big_endian>(inp + i * 4 + 48);
+
+        __m128i bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), non_ascii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(bits, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+
+        __m128i lo = _mm_packs_epi32(a, b);
+        __m128i hi = _mm_packs_epi32(c, d);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+std::size_t convert_ascii_latin1(const Byte *inp, std::size_t size, Byte *out) noexcept
+{
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inp + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), v);
+    }
+    return i;
+}
+
+#else
+
+template<bool big_endian>
+std::size_t convert_ascii_utf16(const Byte *, std::size_t, Byte *) noexcept
+{
+    return 0;
+}
+
+template<bool big_endian>
+std::size_t convert_ascii_utf32(const Byte *, std::size_t, Byte *) noexcept
+{
+    return 0;
+}
+
+std::size_t convert_ascii_latin1(const Byte *, std::size_t, Byte *) noexcept
+{
+    return 0;
+}
+
+#endif
+
+[[noreturn]] void throw_invalid_sequence(const Text_encoding &encoding)
+{
+    throw Stream_error{
+        fmt::format("An invalid byte sequence encountered while converting from {0} to UTF-8.",
+                    encoding.name())};
+}
+
+template<bool big_endian>
+Conversion_status
+convert_utf16(const Text_encoding &encoding, Memory_span &inp, Mutable_memory_span &out)
+{
+    auto i_bytes = as_span<const Byte>(inp);
+    auto o_bytes = as_span<Byte>(out);
+
+    std::size_t i = 0;
+    std::size_t o = 0;
+
+    Conversion_status status = Conversion_status::ok;
+
+    while (true) {
+        std::size_t num_chars = std::min((i_bytes.size() - i) / 2, o_bytes.size() - o);
+
+        std::size_t num_ascii_chars =
+            convert_ascii_utf16<big_endian>(i_bytes.data() + i, num_chars, o_bytes.data() + o);
+
+        i += num_ascii_chars * 2;
+        o += num_ascii_chars;
+
+        if (i_bytes.size() - i < 2) {
+            if (i != i_bytes.size()) {
+                status = Conversion_status::incomplete_char;
+            }
+            break;
+        }
+
+        std::uint32_t code_point = load_utf16<big_endian>(i_bytes.data() + i);
+
+        std::size_t num_bytes = 2;
+
+        if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+            // A low surrogate cannot come first.
+            if (code_point >= 0xDC00) {
+                throw_invalid_sequence(encoding);
+            }
+
+            if (i_bytes.size() - i < 4) {
+                status = Conversion_status::incomplete_char;
+                break;
+            }
+
+            std::uint32_t low = load_utf16<big_endian>(i_bytes.data() + i + 2);
+            if (low < 0xDC00 || low > 0xDFFF) {
+                throw_invalid_sequence(encoding);
+            }
+
+            code_point = 0x1'0000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+
+            num_bytes = 4;
+        }
+
+        std::size_t size = utf8_size(code_point);
+        if (o_bytes.size() - o < size) {
+            status = Conversion_status::leftover;
+            break;
+        }
+
+        encode_utf8(code_point, size, o_bytes.data() + o);
+
+        i += num_bytes;
+        o += size;
+    }
+
+    inp = inp.subspan(i);
+    out = out.subspan(o);
+
+    return status;
+}
+
+template<bool big_endian>
+Conversion_status
+convert_utf32(const Text_encoding &encoding, Memory_span &inp, Mutable_memory_span &out)
+{
+    auto i_bytes = as_span<const Byte>(inp);
+    auto o_bytes = as_span<Byte>(out);
+
+    std::size_t i = 0;
+    std::size_t o = 0;
+
+    Conversion_status status = Conversion_status::ok;
+
+    while (true) {
+        std::size_t num_chars = std::min((i_bytes.size() - i) / 4, o_bytes.size() - o);
+
+        std::size_t num_ascii_chars =
+            convert_ascii_utf32<big_endian>(i_bytes.data() + i, num_chars, o_bytes.data() + o);
+
+        i += num_ascii_chars * 4;
+        o += num_ascii_chars;
+
+        if (i_bytes.size() - i < 4) {
+            if (i != i_bytes.size()) {
+                status = Conversion_status::incomplete_char;
+            }
+            break;
+        }
+
+        std::uint32_t code_point = load_utf32<big_endian>(i_bytes.data() + i);
+        if (code_point > 0x10'FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            throw_invalid_sequence(encoding);
+        }
+
+        std::size_t size = utf8_size(code_point);
+        if (o_bytes.size() - o < size) {
+            status = Conversion_status::leftover;
+            break;
+        }
+
+        encode_utf8(code_point, size, o_bytes.data() + o);
+
+        i += 4;
+        o += size;
+    }
+
+    inp = inp.subspan(i);
+    out = out.subspan(o);
+
+    return status;
+}
+
+Conversion_status convert_latin1(Memory_span &inp, Mutable_memory_span &out)
+{
+    auto i_bytes = as_span<const Byte>(inp);
+    auto o_bytes = as_span<Byte>(out);
+
+    std::size_t i = 0;
+    std::size_t o = 0;
+
+    Conversion_status status = Conversion_status::ok;
+
+    while (true) {
+        std::size_t num_chars = std::min(i_bytes.size() - i, o_bytes.size() - o);
+
+        std::size_t num_ascii_chars =
+            convert_ascii_latin1(i_bytes.data() + i, num_chars, o_bytes.data() + o);
+
+        i += num_ascii_chars;
+        o += num_ascii_chars;
+
+        if (i == i_bytes.size()) {
+            break;
+        }
+
+        // Every ISO-8859-1 character maps to the code point of the same
+        // value.
+        std::uint32_t code_point = i_bytes[i];
+
+        std::size_t size = utf8_size(code_point);
+        if (o_bytes.size() - o < size) {
+            status = Conversion_status::leftover;
+            break;
+        }
+
+        encode_utf8(code_point, size, o_bytes.data() + o);
+
+        i += 1;
+        o += size;
+    }
+
+    inp = inp.subspan(i);
+    out = out.subspan(o);
+
+    return status;
+}
+
+}  // namespace
+
+std::optional<Unicode_encoding> as_unicode_encoding(const Text_encoding &encoding)
+{
+    std::string name = encoding.name();
+
+    // Like iconv, treat the names as case-insensitive.
+    std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    });
+
+    if (name == "UTF-16" || name == "UTF16") {
+        return Unicode_encoding::utf16;
+    }
+    if (name == "UTF-16LE" || name == "UTF16LE") {
+        return Unicode_encoding::utf16_le;
+    }
+    if (name == "UTF-16BE" || name == "UTF16BE") {
+        return Unicode_encoding::utf16_be;
+    }
+    if (name == "UTF-32" || name == "UTF32") {
+        return Unicode_encoding::utf32;
+    }
+    if (name == "UTF-32LE" || name == "UTF32LE") {
+        return Unicode_encoding::utf32_le;
+    }
+    if (name == "UTF-32BE" || name == "UTF32BE") {
+        return Unicode_encoding::utf32_be;
+    }
+    if (name == "ISO-8859-1" || name == "ISO8859-1" || name == "ISO_8859-1" || name == "8859_1" ||
+        name == "LATIN1" || name == "L1") {
+        return Unicode_encoding::latin1;
+    }
+    return {};
+}
+
+Unicode_converter::Unicode_converter(Text_encoding &&encoding, Unicode_encoding source) noexcept
+    : encoding_{std::move(encoding)}, source_{source}
+{}
+
+Unicode_converter::~Unicode_converter() = default;
+
+Conversion_status Unicode_converter::convert(Memory_span &inp, Mutable_memory_span &out)
+{
+    if (source_ == Unicode_encoding::utf16 || source_ == Unicode_encoding::utf32) {
+        Conversion_status s = consume_bom(inp);
+        if (s != Conversion_status::ok) {
+            return s;
+        }
+    }
+
+    switch (source_) {
+    case Unicode_encoding::utf16_le:
+        return convert_utf16<false>(encoding_, inp, out);
+
+    case Unicode_encoding::utf16_be:
+        return convert_utf16<true>(encoding_, inp, out);
+
+    case Unicode_encoding::utf32_le:
+        return convert_utf32<false>(encoding_, inp, out);
+
+    case Unicode_encoding::utf32_be:
+        return convert_utf32<true>(encoding_, inp, out);
+
+    case Unicode_encoding::latin1:
+        return convert_latin1(inp, out);
+
+    case Unicode_encoding::utf16:
+    case Unicode_encoding::utf32:
+        break;
+    }
+
+    return Conversion_status::ok;
+}
+
+Conversion_status Unicode_converter::consume_bom(Memory_span &inp) noexcept
+{
+    auto chars = as_span<const Byte>(inp);
+
+    if (source_ == Unicode_encoding::utf16) {
+        if (chars.size() < 2) {
+            return chars.empty() ? Conversion_status::ok : Conversion_status::incomplete_char;
+        }
+
+        bool is_le = chars[0] == 0xFF && chars[1] == 0xFE;
+        bool is_be = chars[0] == 0xFE && chars[1] == 0xFF;
+
+        if (is_le || (!is_be && host_is_little_endian)) {
+            source_ = Unicode_encoding::utf16_le;
+        }
+        else {
+            source_ = Unicode_encoding::utf16_be;
+        }
+
+        if (is_le || is_be) {
+            inp = inp.subspan(2);
+        }
+    }
+    else {
+        if (chars.size() < 4) {
+            return chars.empty() ? Conversion_status::ok : Conversion_status::incomplete_char;
+        }
+
+        bool is_le = chars[0] == 0xFF && chars[1] == 0xFE && chars[2] == 0x00 && chars[3] == 0x00;
+        bool is_be = chars[0] == 0x00 && chars[1] == 0x00 && chars[2] == 0xFE && chars[3] == 0xFF;
+
+        if (is_le || (!is_be && host_is_little_endian)) {
+            source_ = Unicode_encoding::utf32_le;
+        }
+        else {
+            source_ = Unicode_encoding::utf32_be;
+        }
+
+        if (is_le || is_be) {
+            inp = inp.subspan(4);
+        }
+    }
+
+    return Conversion_status::ok;
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
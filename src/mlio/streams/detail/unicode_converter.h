@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "mlio/span.h"
+#include "mlio/streams/detail/text_converter.h"
+#include "mlio/text_encoding.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+enum class Unicode_encoding { utf16, utf16_le, utf16_be, utf32, utf32_le, utf32_be, latin1 };
+
+// Returns the Unicode encoding that corresponds to the specified text
+// encoding, or an empty value if the text has to be converted by iconv.
+std::optional<Unicode_encoding> as_unicode_encoding(const Text_encoding &encoding);
+
+// Converts UTF-16, UTF-32, and ISO-8859-1 text to UTF-8 without going
+// through iconv. Runs of ASCII characters, which make up most of the
+// text we read in practice, are converted 16 characters at a time using
+// SSE2 if available.
+//
+// Like glibc's iconv, UTF-16 and UTF-32 without an explicit byte order
+// consume a leading BOM and otherwise default to the byte order of the
+// host, while the variants with an explicit byte order convert a BOM
+// like any other character.
+class Unicode_converter final : public Text_converter {
+public:
+    explicit Unicode_converter(Text_encoding &&encoding, Unicode_encoding source) noexcept;
+
+    Unicode_converter(const Unicode_converter &) = delete;
+
+    Unicode_converter &operator=(const Unicode_converter &) = delete;
+
+    Unicode_converter(Unicode_converter &&) = delete;
+
+    Unicode_converter &operator=(Unicode_converter &&) = delete;
+
+    ~Unicode_converter() final;
+
+    Conversion_status convert(Memory_span &inp, Mutable_memory_span &out) final;
+
+    const Text_encoding &encoding() const noexcept final
+    {
+        return encoding_;
+    }
+
+private:
+    Conversion_status consume_bom(Memory_span &inp) noexcept;
+
+    Text_encoding encoding_;
+    Unicode_encoding source_;
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
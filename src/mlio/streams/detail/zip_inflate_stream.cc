@@ -0,0 +1,330 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/zip_inflate_stream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mlio/not_supported_error.h"
+#include "mlio/streams/detail/zlib.h"
+#include "mlio/streams/stream_error.h"
+#include "mlio/util/cast.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+namespace {
+
+constexpr std::uint32_t local_header_signature = 0x0403'4b50;
+constexpr std::uint32_t central_header_signature = 0x0201'4b50;
+constexpr std::uint32_t end_of_central_dir_signature = 0x0605'4b50;
+constexpr std::uint32_t data_descriptor_signature = 0x0807'4b50;
+
+constexpr std::uint16_t flag_encrypted = 0x0001;
+constexpr std::uint16_t flag_data_descriptor = 0x0008;
+
+constexpr std::uint16_t method_stored = 0;
+constexpr std::uint16_t method_deflated = 8;
+
+constexpr std::uint16_t zip64_extra_field_id = 0x0001;
+
+template<typename T>
+T load_le(Memory_span data, std::size_t pos) noexcept
+{
+    T value{};
+    for (std::size_t i = sizeof(T); i > 0; i--) {
+        value = static_cast<T>((value << 8) | static_cast<T>(data[pos + i - 1]));
+    }
+    return value;
+}
+
+[[noreturn]] void throw_corrupt_archive()
+{
+    throw Inflate_error{"The zip archive contains invalid or incomplete data."};
+}
+
+}  // namespace
+
+Zip_inflate_stream::Zip_inflate_stream(Intrusive_ptr<Input_stream> inner)
+    : inner_{std::move(inner)}
+{}
+
+Zip_inflate_stream::~Zip_inflate_stream() = default;
+
+std::size_t Zip_inflate_stream::read(Mutable_memory_span destination)
+{
+    check_if_closed();
+
+    if (destination.empty()) {
+        return 0;
+    }
+
+    while (!eof_) {
+        if (!entry_) {
+            eof_ = !read_local_header();
+
+            continue;
+        }
+
+        std::size_t num_bytes_read{};
+        if (entry_->deflated) {
+            num_bytes_read = read_deflated(destination);
+        }
+        else {
+            num_bytes_read = read_stored(destination);
+        }
+
+        if (num_bytes_read > 0) {
+            return num_bytes_read;
+        }
+    }
+
+    return 0;
+}
+
+bool Zip_inflate_stream::read_local_header()
+{
+    std::array<std::byte, 30> header{};
+
+    // An archive might end without a central directory if it was
+    // truncated at an entry boundary; we treat it as the end.
+    if (input().empty()) {
+        return false;
+    }
+
+    read_exact(make_span(header).first(4));
+
+    auto signature = load_le<std::uint32_t>(header, 0);
+    if (signature == central_header_signature || signature == end_of_central_dir_signature) {
+        return false;
+    }
+
+    if (signature != local_header_signature) {
+        throw_corrupt_archive();
+    }
+
+    read_exact(make_span(header).subspan(4));
+
+    auto flags = load_le<std::uint16_t>(header, 6);
+    if ((flags & flag_encrypted) != 0) {
+        throw Not_supported_error{"Encrypted zip archives are not supported."};
+    }
+
+    auto method = load_le<std::uint16_t>(header, 8);
+    if (method != method_stored && method != method_deflated) {
+        throw Not_supported_error{
+            "The zip archive contains an entry compressed with an unsupported method."};
+    }
+
+    std::size_t compressed_size = load_le<std::uint32_t>(header, 18);
+
+    auto name_size = load_le<std::uint16_t>(header, 26);
+    auto extra_size = load_le<std::uint16_t>(header, 28);
+
+    skip(name_size);
+
+    std::vector<std::byte> extra(extra_size);
+
+    read_exact(extra);
+
+    Entry entry{};
+
+    entry.deflated = method == method_deflated;
+
+    entry.has_data_descriptor = (flags & flag_data_descriptor) != 0;
+
+    // Look for the Zip64 extended information that holds the sizes if
+    // they do not fit into 32 bits.
+    Memory_span fields = extra;
+    while (fields.size() >= 4) {
+        auto id = load_le<std::uint16_t>(fields, 0);
+        auto size = load_le<std::uint16_t>(fields, 2);
+        if (fields.size() < 4 + std::size_t{size}) {
+            throw_corrupt_archive();
+        }
+
+        if (id == zip64_extra_field_id) {
+            entry.zip64 = true;
+
+            // The field contains the uncompressed size first.
+            if (compressed_size == 0xffff'ffff && size >= 16) {
+                compressed_size = load_le<std::uint64_t>(fields, 12);
+            }
+        }
+
+        fields = fields.subspan(4 + std::size_t{size});
+    }
+
+    if (!entry.deflated) {
+        // A stored entry of unknown size cannot be delimited.
+        if (entry.has_data_descriptor) {
+            throw Not_supported_error{
+                "The zip archive contains a stored entry whose size is unknown."};
+        }
+
+        entry.num_bytes_left = compressed_size;
+    }
+
+    entry_ = entry;
+
+    return true;
+}
+
+std::size_t Zip_inflate_stream::read_stored(Mutable_memory_span destination)
+{
+    if (entry_->num_bytes_left == 0) {
+        finish_entry();
+
+        return 0;
+    }
+
+    Memory_span inp = input();
+    if (inp.empty()) {
+        throw_corrupt_archive();
+    }
+
+    std::size_t size = std::min({inp.size(), destination.size(), entry_->num_bytes_left});
+
+    std::copy(inp.begin(), inp.begin() + as_ssize(size), destination.begin());
+
+    buffer_pos_ += as_ssize(size);
+
+    entry_->num_bytes_left -= size;
+
+    return size;
+}
+
+std::size_t Zip_inflate_stream::read_deflated(Mutable_memory_span destination)
+{
+    if (inflater_ == nullptr) {
+        // The entries of a zip archive contain raw deflate data.
+        inflater_ = std::make_unique<Zlib_inflater>(-MAX_WBITS);
+    }
+
+    // A deflated entry is always followed by at least the central
+    // directory, so we never run out of input legitimately.
+    Memory_span inp = input();
+    if (inp.empty()) {
+        throw_corrupt_archive();
+    }
+
+    auto out = destination;
+
+    inflater_->inflate(inp, out);
+
+    buffer_pos_ = buffer_.end() - stdx::ssize(inp);
+
+    // The inflater resets itself at the end of the deflate stream, so we
+    // can use it for the next entry.
+    if (inflater_->eof()) {
+        finish_entry();
+    }
+
+    return destination.size() - out.size();
+}
+
+void Zip_inflate_stream::finish_entry()
+{
+    if (entry_->has_data_descriptor) {
+        std::array<std::byte, 4> signature{};
+
+        read_exact(signature);
+
+        // The signature of the data descriptor is optional; if it is
+        // missing, we have just read the CRC-32.
+        std::size_t size = entry_->zip64 ? 16 : 8;
+        if (load_le<std::uint32_t>(signature, 0) == data_descriptor_signature) {
+            size += 4;
+        }
+
+        skip(size);
+    }
+
+    entry_ = std::nullopt;
+}
+
+void Zip_inflate_stream::read_exact(Mutable_memory_span destination)
+{
+    while (!destination.empty()) {
+        Memory_span inp = input();
+        if (inp.empty()) {
+            throw_corrupt_archive();
+        }
+
+        std::size_t size = std::min(inp.size(), destination.size());
+
+        std::copy(inp.begin(), inp.begin() + as_ssize(size), destination.begin());
+
+        buffer_pos_ += as_ssize(size);
+
+        destination = destination.subspan(size);
+    }
+}
+
+void Zip_inflate_stream::skip(std::size_t size)
+{
+    while (size > 0) {
+        Memory_span inp = input();
+        if (inp.empty()) {
+            throw_corrupt_archive();
+        }
+
+        std::size_t n = std::min(inp.size(), size);
+
+        buffer_pos_ += as_ssize(n);
+
+        size -= n;
+    }
+}
+
+Memory_span Zip_inflate_stream::input()
+{
+    if (buffer_pos_ == buffer_.end()) {
+        buffer_ = inner_->read(0x8'0000);  // 512 KiB
+
+        buffer_pos_ = buffer_.begin();
+    }
+
+    return Memory_span{buffer_pos_, buffer_.end()};
+}
+
+void Zip_inflate_stream::close() noexcept
+{
+    inner_->close();
+
+    inflater_ = nullptr;
+
+    buffer_ = {};
+}
+
+bool Zip_inflate_stream::closed() const noexcept
+{
+    return inner_->closed();
+}
+
+void Zip_inflate_stream::check_if_closed() const
+{
+    if (inner_->closed()) {
+        throw Stream_error{"The input stream is closed."};
+    }
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
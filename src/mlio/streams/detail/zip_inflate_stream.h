@@ -0,0 +1,97 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "mlio/intrusive_ptr.h"
+#include "mlio/memory/memory_block.h"
+#include "mlio/memory/memory_slice.h"
+#include "mlio/span.h"
+#include "mlio/streams/input_stream.h"
+#include "mlio/streams/input_stream_base.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+class Zlib_inflater;
+
+// Reads a zip archive sequentially and returns the concatenated content
+// of its members, similar to a multi-member gzip file. The archive is
+// walked through its local file headers, so it does not have to be
+// seekable; the central directory marks the end of the stream. Only
+// stored and deflated members are supported.
+class Zip_inflate_stream final : public Input_stream_base {
+    struct Entry {
+        bool deflated{};
+        bool has_data_descriptor{};
+        bool zip64{};
+        // The number of bytes left to read from a stored entry.
+        std::size_t num_bytes_left{};
+    };
+
+public:
+    explicit Zip_inflate_stream(Intrusive_ptr<Input_stream> inner);
+
+    Zip_inflate_stream(const Zip_inflate_stream &) = delete;
+
+    Zip_inflate_stream &operator=(const Zip_inflate_stream &) = delete;
+
+    Zip_inflate_stream(Zip_inflate_stream &&) = delete;
+
+    Zip_inflate_stream &operator=(Zip_inflate_stream &&) = delete;
+
+    ~Zip_inflate_stream() final;
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void close() noexcept final;
+
+    bool closed() const noexcept final;
+
+private:
+    bool read_local_header();
+
+    std::size_t read_stored(Mutable_memory_span destination);
+
+    std::size_t read_deflated(Mutable_memory_span destination);
+
+    void finish_entry();
+
+    void read_exact(Mutable_memory_span destination);
+
+    void skip(std::size_t size);
+
+    Memory_span input();
+
+    void check_if_closed() const;
+
+    Intrusive_ptr<Input_stream> inner_;
+    Memory_slice buffer_{};
+    Memory_block::iterator buffer_pos_ = buffer_.begin();
+    std::optional<Entry> entry_{};
+    std::unique_ptr<Zlib_inflater> inflater_{};
+    bool eof_{};
+};
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
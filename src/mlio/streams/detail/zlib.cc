@@ -15,7 +15,9 @@
 
 #include "mlio/streams/detail/zlib.h"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <new>
 
 #include "mlio/not_supported_error.h"
@@ -25,10 +27,9 @@ namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
-Zlib_inflater::Zlib_inflater()
+Zlib_inflater::Zlib_inflater(int window_bits)
 {
-    // Inflate both zlib and gzip.
-    int r = ::inflateInit2(&stream_, MAX_WBITS + 32);
+    int r = ::inflateInit2(&stream_, window_bits);
     if (r == Z_OK) {
         return;
     }
@@ -51,8 +52,12 @@ void Zlib_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
 {
     validate_state();
 
-    auto i_buf = as_span<const ::Bytef>(inp);
-    auto o_buf = as_span<::Bytef>(out);
+    // zlib counts in 32-bit integers; larger buffers are processed over
+    // several calls.
+    constexpr std::size_t max_size = std::numeric_limits<::uInt>::max();
+
+    auto i_buf = as_span<const ::Bytef>(inp).first(std::min(inp.size(), max_size));
+    auto o_buf = as_span<::Bytef>(out).first(std::min(out.size(), max_size));
 
     // We do not use the ZLIB_CONST macro because some older
     // distributions we have to support do not have an up-to-date libz.
@@ -63,16 +68,29 @@ void Zlib_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
     stream_.avail_in = static_cast<::uInt>(i_buf.size());
     stream_.avail_out = static_cast<::uInt>(o_buf.size());
 
-    state_ = ::inflate(&stream_, Z_NO_FLUSH);
+    int r = ::inflate(&stream_, Z_NO_FLUSH);
 
-    validate_state();
+    // Z_BUF_ERROR means that no progress was possible; it is not fatal
+    // and occurs when we are asked to flush with no pending output.
+    if (r != Z_BUF_ERROR) {
+        state_ = r;
+
+        validate_state();
+    }
 
     if (state_ == Z_STREAM_END) {
         ::inflateReset(&stream_);
     }
 
-    inp = inp.last(stream_.avail_in);
-    out = out.last(stream_.avail_out);
+    inp = inp.subspan(i_buf.size() - stream_.avail_in);
+    out = out.subspan(o_buf.size() - stream_.avail_out);
+}
+
+void Zlib_inflater::check_eof() const
+{
+    if (state_ != Z_STREAM_END) {
+        throw Inflate_error{"The zlib stream contains invalid or incomplete deflate data."};
+    }
 }
 
 void Zlib_inflater::validate_state() const
@@ -18,14 +18,17 @@
 #include <zlib.h>
 
 #include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 namespace detail {
 
-class Zlib_inflater {
+class Zlib_inflater final : public Inflater {
 public:
-    explicit Zlib_inflater();
+    // By default both zlib and gzip streams are inflated; pass a negative
+    // value for raw deflate data (see inflateInit2).
+    explicit Zlib_inflater(int window_bits = MAX_WBITS + 32);
 
     Zlib_inflater(const Zlib_inflater &) = delete;
 
@@ -35,15 +38,17 @@ public:
 
     Zlib_inflater &operator=(Zlib_inflater &&) = delete;
 
-    ~Zlib_inflater();
+    ~Zlib_inflater() final;
 
-    void inflate(Memory_span &inp, Mutable_memory_span &out);
+    void inflate(Memory_span &inp, Mutable_memory_span &out) final;
 
-    bool eof() const noexcept
+    bool eof() const noexcept final
     {
         return state_ == Z_STREAM_END;
     }
 
+    void check_eof() const final;
+
 private:
     void validate_state() const;
 
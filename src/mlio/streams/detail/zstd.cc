@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#include "mlio/streams/detail/zstd.h"
+
+#ifdef MLIO_BUILD_ZSTD
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+#include <zstd_errors.h>
+
+#include "mlio/streams/stream_error.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+Zstd_inflater::Zstd_inflater() : stream_{::ZSTD_createDStream()}
+{
+    if (stream_ == nullptr) {
+        throw std::bad_alloc{};
+    }
+}
+
+Zstd_inflater::~Zstd_inflater()
+{
+    ::ZSTD_freeDStream(stream_);
+}
+
+void Zstd_inflater::inflate(Memory_span &inp, Mutable_memory_span &out)
+{
+    // At a frame boundary an empty input would make zstd expect a new
+    // frame header.
+    if (inp.empty() && eof_) {
+        return;
+    }
+
+    ::ZSTD_inBuffer i_buf{inp.data(), inp.size(), 0};
+    ::ZSTD_outBuffer o_buf{out.data(), out.size(), 0};
+
+    std::size_t r = ::ZSTD_decompressStream(stream_, &o_buf, &i_buf);
+    if (::ZSTD_isError(r) != 0) {
+        if (::ZSTD_getErrorCode(r) == ZSTD_error_memory_allocation) {
+            throw std::bad_alloc{};
+        }
+        throw Inflate_error{"The zstd stream contains invalid or incomplete data."};
+    }
+
+    // A return value of zero means that a frame has been fully decoded
+    // and flushed.
+    eof_ = r == 0;
+
+    inp = inp.subspan(i_buf.pos);
+    out = out.subspan(o_buf.pos);
+}
+
+void Zstd_inflater::check_eof() const
+{
+    if (!eof_) {
+        throw Inflate_error{"The zstd stream contains invalid or incomplete data."};
+    }
+}
+
+std::optional<std::size_t> zstd_frame_size(Memory_span data) noexcept
+{
+    std::size_t size = ::ZSTD_findFrameCompressedSize(data.data(), data.size());
+    if (::ZSTD_isError(size) != 0) {
+        return {};
+    }
+    return size;
+}
+
+std::optional<std::size_t> zstd_frame_content_size(Memory_span data) noexcept
+{
+    unsigned long long size = ::ZSTD_getFrameContentSize(data.data(), data.size());
+    if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+        return {};
+    }
+
+    return static_cast<std::size_t>(
+        std::min<unsigned long long>(size, std::numeric_limits<std::size_t>::max()));
+}
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
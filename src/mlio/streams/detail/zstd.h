@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019-2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You
+ * may not use this file except in compliance with the License. A copy of
+ * the License is located at
+ *
+ *      http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF
+ * ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#pragma once
+
+#ifdef MLIO_BUILD_ZSTD
+
+#include <cstddef>
+#include <optional>
+
+#include <zstd.h>
+
+#include "mlio/span.h"
+#include "mlio/streams/detail/inflater.h"
+
+namespace mlio {
+inline namespace abi_v1 {
+namespace detail {
+
+class Zstd_inflater final : public Inflater {
+public:
+    explicit Zstd_inflater();
+
+    Zstd_inflater(const Zstd_inflater &) = delete;
+
+    Zstd_inflater &operator=(const Zstd_inflater &) = delete;
+
+    Zstd_inflater(Zstd_inflater &&) = delete;
+
+    Zstd_inflater &operator=(Zstd_inflater &&) = delete;
+
+    ~Zstd_inflater() final;
+
+    void inflate(Memory_span &inp, Mutable_memory_span &out) final;
+
+    bool eof() const noexcept final
+    {
+        return eof_;
+    }
+
+    void check_eof() const final;
+
+private:
+    ::ZSTD_DStream *stream_;
+    bool eof_ = true;
+};
+
+// Returns the size of the zstd frame at the beginning of the specified
+// data, or nullopt if the data does not contain a complete frame.
+std::optional<std::size_t> zstd_frame_size(Memory_span data) noexcept;
+
+// Returns the inflated size of the zstd frame at the beginning of the
+// specified data if it is recorded in the frame header; otherwise
+// nullopt.
+std::optional<std::size_t> zstd_frame_content_size(Memory_span data) noexcept;
+
+}  // namespace detail
+}  // namespace abi_v1
+}  // namespace mlio
+
+#endif
@@ -17,20 +17,22 @@
 
 #include <utility>
 
-#include "mlio/streams/detail/zlib.h"
+#include "mlio/streams/detail/inflate_backend.h"
+#include "mlio/streams/detail/inflater.h"
 #include "mlio/streams/input_stream.h"
 #include "mlio/streams/stream_error.h"
 #include "mlio/util/cast.h"
 
-using mlio::detail::Zlib_inflater;
+using mlio::detail::make_gzip_inflater;
 
 namespace mlio {
 inline namespace abi_v1 {
 
-Gzip_inflate_stream::Gzip_inflate_stream(Intrusive_ptr<Input_stream> inner)
+Gzip_inflate_stream::Gzip_inflate_stream(Intrusive_ptr<Input_stream> inner,
+                                         Inflate_backend backend)
     : inner_{std::move(inner)}
 {
-    inflater_ = std::make_unique<Zlib_inflater>();
+    inflater_ = make_gzip_inflater(backend);
 }
 
 Gzip_inflate_stream::~Gzip_inflate_stream() = default;
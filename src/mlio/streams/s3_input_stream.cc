@@ -20,11 +20,14 @@
 #include <utility>
 
 #include "mlio/detail/s3_utils.h"
+#include "mlio/streams/detail/parallel_s3_reader.h"
 #include "mlio/streams/stream_error.h"
 
 namespace mlio {
 inline namespace abi_v1 {
 
+S3_input_stream::~S3_input_stream() = default;
+
 std::size_t S3_input_stream::read(Mutable_memory_span destination)
 {
     check_if_closed();
@@ -35,7 +38,32 @@ std::size_t S3_input_stream::read(Mutable_memory_span destination)
 
     destination = destination.first(std::min(size_ - position_, destination.size()));
 
-    auto num_bytes_read = client_->read_object(bucket_, key_, version_id_, position_, destination);
+    std::size_t num_bytes_read{};
+
+    // The first read after opening or repositioning the stream might be
+    // a random access; we only start reading ahead once the stream is
+    // read sequentially.
+    if (sequential_) {
+        if (reader_ == nullptr) {
+            auto read_object = [this](std::size_t offset, Mutable_memory_span dest) {
+                return client_->read_object(bucket_, key_, version_id_, offset, dest);
+            };
+
+            reader_ = std::make_unique<detail::Parallel_s3_reader>(
+                std::move(read_object),
+                size_,
+                position_,
+                client_->read_ahead_part_size(),
+                client_->num_read_ahead_parts());
+        }
+
+        num_bytes_read = reader_->read(destination);
+    }
+    else {
+        num_bytes_read = client_->read_object(bucket_, key_, version_id_, position_, destination);
+
+        sequential_ = true;
+    }
 
     position_ += num_bytes_read;
 
@@ -50,11 +78,21 @@ void S3_input_stream::seek(std::size_t position)
         throw std::system_error{std::make_error_code(std::errc::invalid_argument)};
     }
 
+    if (position == position_) {
+        return;
+    }
+
+    reader_ = nullptr;
+
+    sequential_ = false;
+
     position_ = position;
 }
 
 void S3_input_stream::close() noexcept
 {
+    reader_ = nullptr;
+
     closed_ = true;
 }
 
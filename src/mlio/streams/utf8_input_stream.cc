@@ -22,13 +22,13 @@
 
 #include "mlio/logger.h"
 #include "mlio/memory/memory_allocator.h"
-#include "mlio/streams/detail/iconv.h"
+#include "mlio/streams/detail/text_converter.h"
 #include "mlio/streams/input_stream.h"
 #include "mlio/streams/stream_error.h"
 #include "mlio/util/cast.h"
 
-using mlio::detail::Iconv_desc;
-using mlio::detail::Iconv_status;
+using mlio::detail::Conversion_status;
+using mlio::detail::make_text_converter;
 using mlio::detail::Utf8_input_stream_access;
 
 namespace mlio {
@@ -72,7 +72,7 @@ std::size_t Utf8_input_stream::read(Mutable_memory_span destination)
         }
 
         // The output buffer size must be at least 4-bytes. Otherwise
-        // we might end up in an edge case where iconv cannot write
+        // we might end up in an edge case where the converter cannot write
         // anything if the UTF-8 decoded size of the next character is
         // larger than the output size.
         if (destination.size() >= 4) {
@@ -114,7 +114,7 @@ Utf8_input_stream::Utf8_input_stream(Intrusive_ptr<Input_stream> inner, Text_enc
         return;
     }
 
-    converter_ = std::make_unique<Iconv_desc>(std::move(encoding));
+    converter_ = make_text_converter(std::move(encoding));
 
     buffer_ = memory_allocator().allocate(0x200'0000);  // 32 MiB
 
@@ -154,12 +154,12 @@ std::size_t Utf8_input_stream::convert(Mutable_memory_span destination)
 
         Memory_span inp{buffer_pos_, buffer_end_};
 
-        Iconv_status s = converter_->convert(inp, out);
+        Conversion_status s = converter_->convert(inp, out);
 
         // If the buffer ends with a partial multi-byte character, we
         // have to move the leftover bits to the beginning of the
         // buffer and refill the rest.
-        if (s == Iconv_status::incomplete_char) {
+        if (s == Conversion_status::incomplete_char) {
             buffer_pos_ = std::copy(inp.begin(), inp.end(), buffer_->begin());
 
             should_fill_buffer_ = true;
@@ -170,7 +170,7 @@ std::size_t Utf8_input_stream::convert(Mutable_memory_span destination)
         // As the smallest output buffer size that we provide to the
         // decode() function is 4-bytes, we are guaranteed to have at
         // least one UTF-8 character written to the output.
-        if (s == Iconv_status::leftover) {
+        if (s == Conversion_status::leftover) {
             buffer_pos_ = buffer_end_ - stdx::ssize(inp);
 
             continue;
@@ -15,13 +15,20 @@
 
 #include "mlio/text_line_reader.h"
 
+#include <optional>
 #include <string>
 
+#include <fmt/format.h>
+
 #include "mlio/cpu_array.h"
+#include "mlio/data_reader_error.h"
+#include "mlio/data_stores/data_store.h"
 #include "mlio/data_type.h"
+#include "mlio/detail/utf8.h"
 #include "mlio/example.h"
 #include "mlio/instance.h"
 #include "mlio/instance_batch.h"
+#include "mlio/logger.h"
 #include "mlio/record_readers/text_line_record_reader.h"
 #include "mlio/streams/utf8_input_stream.h"
 #include "mlio/tensor.h"
@@ -60,20 +67,66 @@ Intrusive_ptr<Example> Text_line_reader::decode(const Instance_batch &batch) con
     Intrusive_ptr<Dense_tensor> tensor = make_tensor(batch.size());
 
     auto row_pos = tensor->data().as<std::string>().begin();
+
+    std::size_t num_instances_read = 0;
+
     for (const Instance &instance : batch.instances()) {
-        *row_pos++ = as_string_view(instance.bits());
+        if (!params().validate_utf8 || validate_utf8(instance)) {
+            *row_pos++ = as_string_view(instance.bits());
+
+            num_instances_read++;
+        }
+        else {
+            // If the user requested to skip the example in case of an
+            // error, shortcut the loop and return immediately.
+            if (skip_bad_example()) {
+                warn_bad_example(batch, {});
+
+                return {};
+            }
+        }
     }
 
+    warn_bad_example(batch, num_instances_read);
+
     std::vector<Intrusive_ptr<Tensor>> tensors{};
     tensors.emplace_back(std::move(tensor));
 
     auto example = make_intrusive<Example>(schema(), std::move(tensors));
 
-    example->padding = batch.size() - batch.instances().size();
+    example->padding = batch.size() - num_instances_read;
 
     return example;
 }
 
+bool Text_line_reader::validate_utf8(const Instance &instance) const
+{
+    std::optional<std::size_t> offset = detail::find_invalid_utf8(instance.bits());
+    if (offset == std::nullopt) {
+        return true;
+    }
+
+    bool error_bad_example = params().bad_example_handling == Bad_example_handling::error;
+
+    if (warn_bad_instances() || error_bad_example) {
+        auto msg = fmt::format(
+            "The line #{1:n} in the data store '{0}' contains an invalid UTF-8 byte sequence at the byte offset {2:n} of the line.",
+            instance.data_store().id(),
+            instance.index(),
+            *offset);
+
+        if (warn_bad_instances()) {
+            logger::warn(msg);
+        }
+
+        if (error_bad_example) {
+            throw Invalid_instance_error{msg};
+        }
+    }
+
+    return false;
+}
+
 Intrusive_ptr<Dense_tensor> Text_line_reader::make_tensor(std::size_t batch_size)
 {
     Size_vector shape{batch_size, 1};
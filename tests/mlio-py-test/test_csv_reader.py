@@ -159,3 +159,122 @@ def test_csv_nonutf_encoding_with_encoding_param():
         feature_np = as_numpy(nonutf_feature)
     except SystemError as err:
         pytest.fail("Unexpected exception thrown")
+
+
+def test_csv_utf16_encoding_with_encoding_param(tmpdir):
+    csv_file = tmpdir.join("test_utf16.csv")
+    csv_file.write_binary('col_1,col_2\nabc,ф\U0001f600\n'.encode('utf-16'))
+
+    dataset = [mlio.File(str(csv_file))]
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=1)
+    csv_params = mlio.CsvParams(encoding='UTF-16')
+
+    reader = mlio.CsvReader(rdr_prm, csv_params)
+    example = reader.read_example()
+
+    names = [desc.name for desc in example.schema.attributes]
+    assert names == ['col_1', 'col_2']
+
+    assert as_numpy(example['col_2'])[0] == 'ф\U0001f600'
+
+
+def _write_csv_with_invalid_utf8(tmpdir):
+    csv_file = tmpdir.join("test_invalid_utf8.csv")
+    csv_file.write_binary(b'col_1,col_2\na,1\nb\xff,2\nc,3\n')
+    return csv_file
+
+
+def test_csv_validate_utf8_raises_invalid_instance_error(tmpdir):
+    csv_file = _write_csv_with_invalid_utf8(tmpdir)
+
+    dataset = [mlio.File(str(csv_file))]
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=3,
+                                    validate_utf8=True)
+
+    reader = mlio.CsvReader(rdr_prm)
+    with pytest.raises(mlio.InvalidInstanceError):
+        reader.read_example()
+
+
+def test_csv_validate_utf8_pads_invalid_rows(tmpdir):
+    csv_file = _write_csv_with_invalid_utf8(tmpdir)
+
+    dataset = [mlio.File(str(csv_file))]
+    rdr_prm = mlio.DataReaderParams(
+        dataset=dataset,
+        batch_size=3,
+        bad_example_handling=mlio.BadExampleHandling.PAD,
+        validate_utf8=True)
+
+    reader = mlio.CsvReader(rdr_prm)
+    example = reader.read_example()
+
+    assert example.padding == 1
+    assert list(as_numpy(example['col_2'])[:2, 0]) == [1, 3]
+
+
+def test_csv_single_header_with_data_store_sharding(tmpdir):
+    header_file = tmpdir.join("test1.csv")
+    header_file.write('a,b\n1,2\n3,4\n')
+    data_file = tmpdir.join("test2.csv")
+    data_file.write('5,6\n7,8\n')
+
+    dataset = [mlio.File(str(header_file)), mlio.File(str(data_file))]
+    csv_params = mlio.CsvParams(has_single_header=True)
+
+    rows = []
+    for shard_index in range(2):
+        reader_params = mlio.DataReaderParams(
+            dataset=dataset,
+            batch_size=1,
+            shard_index=shard_index,
+            num_shards=2,
+            sharding_strategy=mlio.ShardingStrategy.DATA_STORE)
+        reader = mlio.CsvReader(reader_params, csv_params)
+
+        for example in reader:
+            names = [desc.name for desc in example.schema.attributes]
+            assert names == ['a', 'b']
+
+            rows.append([int(as_numpy(feature).item()) for feature in example])
+
+    assert sorted(rows) == [[1, 2], [3, 4], [5, 6], [7, 8]]
+
+
+def test_csv_single_header_with_interleaved_reading(tmpdir):
+    dataset = []
+    expected_rows = []
+    for i in range(4):
+        csv_file = tmpdir.join("test{}.csv".format(i))
+        if i == 0:
+            csv_file.write('a,b\n')
+        for j in range(3):
+            csv_file.write('{},{}\n'.format(i, j), mode='a')
+            expected_rows.append([i, j])
+
+        dataset.append(mlio.File(str(csv_file)))
+
+    csv_params = mlio.CsvParams(has_single_header=True)
+
+    for deterministic in (True, False):
+        reader_params = mlio.DataReaderParams(
+            dataset=dataset,
+            batch_size=1,
+            interleave_cycle_length=4,
+            deterministic_interleave=deterministic)
+        reader = mlio.CsvReader(reader_params, csv_params)
+
+        for _ in range(3):
+            rows = []
+            for example in reader:
+                names = [desc.name for desc in example.schema.attributes]
+                assert names == ['a', 'b']
+
+                rows.append([int(as_numpy(feature).item())
+                             for feature in example])
+
+            reader.reset()
+
+            assert sorted(rows) == expected_rows
@@ -1,4 +1,12 @@
+import bz2
+import gzip
+import math
 import os
+import struct
+import zipfile
+import zlib
+
+import pytest
 
 import mlio
 from mlio.integ.numpy import as_numpy
@@ -19,3 +27,617 @@ def test_text_line_reader_params():
     record = [as_numpy(feature) for feature in example]
 
     assert record[0] == expected_string
+
+
+def test_data_store_sharding_reads_only_own_stores():
+    filename = os.path.join(resources_dir, 'test.txt')
+    dataset = [mlio.File(filename), mlio.File(filename)]
+
+    num_lines = 0
+    for shard_index in range(2):
+        rdr_prm = mlio.DataReaderParams(
+            dataset=dataset,
+            batch_size=1,
+            shard_index=shard_index,
+            num_shards=2,
+            sharding_strategy=mlio.ShardingStrategy.DATA_STORE)
+
+        reader = mlio.TextLineReader(rdr_prm)
+        shard_lines = sum(1 for _ in reader)
+
+        assert shard_lines == 3
+        num_lines += shard_lines
+
+    assert num_lines == 6
+
+
+def test_record_index_is_built_and_used_for_skipping(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    with open(os.path.join(resources_dir, 'test.txt')) as src:
+        with open(filename, 'w') as dst:
+            dst.write(src.read())
+
+    dataset = [mlio.File(filename)]
+
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=1,
+                                    use_record_index=True,
+                                    record_index_interval=1)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    assert sum(1 for _ in reader) == 3
+
+    assert os.path.exists(filename + '.mlioidx')
+
+    rdr_prm.num_instances_to_skip = 2
+
+    reader = mlio.TextLineReader(rdr_prm)
+    example = reader.read_example()
+    record = [as_numpy(feature) for feature in example]
+
+    assert record[0] == "this is line 3"
+    assert reader.read_example() is None
+
+
+def test_record_index_is_used_to_skip_whole_data_stores(tmp_path):
+    filenames = [str(tmp_path / 'test{}.txt'.format(i)) for i in range(3)]
+    for i, filename in enumerate(filenames):
+        with open(filename, 'w') as f:
+            f.write(''.join('{} {}\n'.format(i, j) for j in range(4)))
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(f) for f in filenames],
+                                    batch_size=1,
+                                    use_record_index=True,
+                                    record_index_interval=2)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    assert sum(1 for _ in reader) == 12
+
+    rdr_prm.num_instances_to_skip = 9
+
+    reader = mlio.TextLineReader(rdr_prm)
+    lines = [as_numpy(example[0])[0] for example in reader]
+
+    assert lines == ["2 1", "2 2", "2 3"]
+
+
+def test_indexed_shuffle_reads_every_instance_once(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    with open(os.path.join(resources_dir, 'test.txt')) as src:
+        with open(filename, 'w') as dst:
+            dst.write(src.read())
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1,
+                                    shuffle_instances=True,
+                                    shuffle_seed=1,
+                                    use_record_index=True)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    for _ in range(2):
+        lines = [as_numpy(example[0])[0] for example in reader]
+        reader.reset()
+
+        assert sorted(lines) == ["this is line 1",
+                                 "this is line 2",
+                                 "this is line 3"]
+
+
+def test_indexed_shuffle_keeps_existing_sparse_index(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    with open(filename, 'w') as f:
+        f.write(''.join('line {}\n'.format(i) for i in range(100)))
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1,
+                                    use_record_index=True,
+                                    record_index_interval=10)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    assert sum(1 for _ in reader) == 100
+
+    with open(filename + '.mlioidx', 'rb') as f:
+        index = f.read()
+
+    rdr_prm.shuffle_instances = True
+
+    reader = mlio.TextLineReader(rdr_prm)
+    lines = [as_numpy(example[0])[0] for example in reader]
+
+    assert sorted(lines) == sorted('line {}'.format(i) for i in range(100))
+
+    with open(filename + '.mlioidx', 'rb') as f:
+        assert f.read() == index
+
+
+def test_indexed_shuffle_falls_back_for_non_seekable_stores(tmp_path):
+    filename = str(tmp_path / 'test.txt.gz')
+    with gzip.open(filename, 'wb') as f:
+        f.write(b'a\nb\nc\n')
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1,
+                                    shuffle_instances=True,
+                                    use_record_index=True)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    lines = [as_numpy(example[0])[0] for example in reader]
+
+    assert sorted(lines) == ["a", "b", "c"]
+
+
+def test_interleaved_reading_alternates_between_stores():
+    filename = os.path.join(resources_dir, 'test.txt')
+    dataset = [mlio.InMemoryStore(b'a\nb\nc\n'), mlio.File(filename)]
+
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=1,
+                                    interleave_cycle_length=2)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    for _ in range(2):
+        lines = [as_numpy(example[0])[0] for example in reader]
+        reader.reset()
+
+        assert lines == ["a", "this is line 1",
+                         "b", "this is line 2",
+                         "c", "this is line 3"]
+
+
+def test_prefetched_data_stores_are_read_in_order():
+    filename = os.path.join(resources_dir, 'test.txt')
+    dataset = [mlio.File(filename),
+               mlio.InMemoryStore(b'a\nb\n'),
+               mlio.File(filename)]
+
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=1,
+                                    num_prefetched_data_stores=2)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    for _ in range(2):
+        lines = [as_numpy(example[0])[0] for example in reader]
+        reader.reset()
+
+        assert lines == ["this is line 1", "this is line 2", "this is line 3",
+                         "a", "b",
+                         "this is line 1", "this is line 2", "this is line 3"]
+
+
+def test_file_io_methods_read_same_lines():
+    filename = os.path.join(resources_dir, 'test.txt')
+
+    lines = {}
+    for io_method in (mlio.FileIoMethod.BLOCKING,
+                      mlio.FileIoMethod.IO_URING,
+                      mlio.FileIoMethod.DIRECT):
+        dataset = [mlio.File(filename, memory_map=False, io_method=io_method)]
+
+        rdr_prm = mlio.DataReaderParams(dataset=dataset, batch_size=1)
+
+        reader = mlio.TextLineReader(rdr_prm)
+
+        lines[io_method] = [as_numpy(example[0])[0] for example in reader]
+
+    assert lines[mlio.FileIoMethod.BLOCKING] == \
+        lines[mlio.FileIoMethod.IO_URING] == \
+        lines[mlio.FileIoMethod.DIRECT]
+
+
+def test_records_larger_than_max_chunk_size_are_read(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    lines = [str(i) * 100 for i in range(10)]
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines))
+
+    dataset = [mlio.File(filename, memory_map=False)]
+
+    rdr_prm = mlio.DataReaderParams(dataset=dataset,
+                                    batch_size=1,
+                                    min_chunk_size=16,
+                                    max_chunk_size=64)
+
+    reader = mlio.TextLineReader(rdr_prm)
+
+    assert [as_numpy(example[0])[0] for example in reader] == lines
+
+
+def test_memory_mapped_file_is_read_in_windows(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    lines = [str(i % 10) * (i % 97 + 1) for i in range(10000)]
+    with open(filename, 'w') as f:
+        f.write('\n'.join(lines))
+
+    dataset = [mlio.File(filename, mmap_window_size=4096)]
+
+    rdr_prm = mlio.DataReaderParams(dataset=dataset, batch_size=1)
+
+    reader = mlio.TextLineReader(rdr_prm)
+
+    assert [as_numpy(example[0])[0] for example in reader] == lines
+
+
+def _bgzf_block(data):
+    compressor = zlib.compressobj(6, zlib.DEFLATED, -15)
+    deflated = compressor.compress(data) + compressor.flush()
+
+    # The BC extra field holds the size of the block minus one.
+    header = b'\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff' + \
+        struct.pack('<H2sHH', 6, b'BC', 2, len(deflated) + 25)
+
+    return header + deflated + struct.pack('<II', zlib.crc32(data), len(data))
+
+
+def test_multi_member_gzip_files_are_read(tmp_path):
+    lines = [str(i) * (i % 50 + 1) for i in range(20000)]
+    data = '\n'.join(lines).encode()
+
+    chunks = [data[i:i + 10000] for i in range(0, len(data), 10000)]
+
+    multi_member = b''.join(gzip.compress(chunk) for chunk in chunks)
+    bgzf = b''.join(_bgzf_block(chunk) for chunk in chunks) + _bgzf_block(b'')
+
+    for name, compressed in (('multi_member', multi_member), ('bgzf', bgzf)):
+        filename = str(tmp_path / (name + '.gz'))
+        with open(filename, 'wb') as f:
+            f.write(compressed)
+
+        dataset = [mlio.File(filename, compression=mlio.Compression.GZIP)]
+
+        rdr_prm = mlio.DataReaderParams(dataset=dataset, batch_size=1)
+
+        reader = mlio.TextLineReader(rdr_prm)
+
+        assert [as_numpy(example[0])[0] for example in reader] == lines
+
+
+def test_gzip_files_are_read_with_each_inflate_backend(tmp_path):
+    small = b''.join(b'%d\n' % i for i in range(100000))
+    # Inflates to more than what the libdeflate backend inflates in one
+    # piece; it has to fall back to streaming.
+    large = small * 120
+
+    backends = [backend for backend in (mlio.InflateBackend.ZLIB,
+                                        mlio.InflateBackend.ISAL,
+                                        mlio.InflateBackend.LIBDEFLATE)
+                if mlio.supports_inflate_backend(backend)]
+
+    for members in ([small], [large], [small, large, small]):
+        data = b''.join(members)
+
+        filename = str(tmp_path / 'test.gz')
+        with open(filename, 'wb') as f:
+            f.write(b''.join(gzip.compress(member, 1) for member in members))
+
+        for backend in backends:
+            for memory_map in (True, False):
+                file = mlio.File(filename,
+                                 memory_map=memory_map,
+                                 inflate_backend=backend)
+
+                stream = file.open_read()
+
+                buf = bytearray(len(data) + 1)
+
+                size = 0
+                while True:
+                    num_bytes_read = stream.read(memoryview(buf)[size:])
+                    if num_bytes_read == 0:
+                        break
+                    size += num_bytes_read
+
+                assert size == len(data)
+                assert buf[:size] == data
+
+
+def test_unsupported_inflate_backend_raises_error(tmp_path):
+    filename = str(tmp_path / 'test.gz')
+    with open(filename, 'wb') as f:
+        f.write(gzip.compress(b'abc'))
+
+    for backend in (mlio.InflateBackend.ISAL, mlio.InflateBackend.LIBDEFLATE):
+        if not mlio.supports_inflate_backend(backend):
+            with pytest.raises(mlio.NotSupportedError):
+                mlio.File(filename, inflate_backend=backend)
+
+
+def test_gzip_files_with_index_are_seekable(tmp_path):
+    lines = [str(i) * (i % 50 + 1) for i in range(20000)]
+    data = '\n'.join(lines).encode()
+
+    filename = str(tmp_path / 'test.gz')
+    with open(filename, 'wb') as f:
+        f.write(gzip.compress(data))
+
+    assert not mlio.File(filename).open_read().seekable
+
+    mlio.build_gzip_index(filename, interval=10000)
+
+    assert os.path.exists(filename + '.mliogzidx')
+
+    stream = mlio.File(filename).open_read()
+
+    assert stream.seekable
+    assert stream.size == len(data)
+
+    buf = bytearray(1000)
+    for position in (400000, 5, 250000, len(data) - 10):
+        stream.seek(position)
+
+        num_bytes_read = stream.read(buf)
+
+        assert num_bytes_read > 0
+        assert buf[:num_bytes_read] == data[position:position + num_bytes_read]
+
+
+def test_gzip_index_is_built_on_read_and_ignored_once_stale(tmp_path):
+    lines = [str(i) * (i % 50 + 1) for i in range(100000)]
+    data = '\n'.join(lines).encode()
+
+    filename = str(tmp_path / 'test.gz')
+    with open(filename, 'wb') as f:
+        f.write(gzip.compress(data))
+
+    def read_all(stream):
+        buf = bytearray(len(data) + 1)
+        size = 0
+        while True:
+            num_bytes_read = stream.read(memoryview(buf)[size:])
+            if num_bytes_read == 0:
+                break
+            size += num_bytes_read
+        return buf[:size]
+
+    assert read_all(mlio.File(filename, gzip_index_interval=50000).open_read()) == data
+
+    # The ranges between the access points are inflated in parallel.
+    stream = mlio.File(filename).open_read()
+
+    assert stream.seekable
+    assert read_all(stream) == data
+
+    # Read across several access points after a seek.
+    stream.seek(123456)
+
+    assert read_all(stream) == data[123456:]
+
+    stat = os.stat(filename)
+    os.utime(filename, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1000000000))
+
+    assert not mlio.File(filename).open_read().seekable
+
+
+def test_bzip2_and_zip_compressions_are_inferred(tmp_path):
+    lines = [str(i) * (i % 50 + 1) for i in range(20000)]
+    data = '\n'.join(lines).encode()
+
+    with open(str(tmp_path / 'test.bz2'), 'wb') as f:
+        # Several concatenated streams, as written by pbzip2.
+        f.write(bz2.compress(data[:50000]) + bz2.compress(data[50000:]))
+
+    with zipfile.ZipFile(str(tmp_path / 'test.zip'), 'w') as f:
+        f.writestr('a.txt', data[:50000], compress_type=zipfile.ZIP_STORED)
+        f.writestr('b.txt', data[50000:], compress_type=zipfile.ZIP_DEFLATED)
+
+    for name in ('test.bz2', 'test.zip'):
+        dataset = [mlio.File(str(tmp_path / name))]
+
+        rdr_prm = mlio.DataReaderParams(dataset=dataset, batch_size=1)
+
+        reader = mlio.TextLineReader(rdr_prm)
+
+        assert [as_numpy(example[0])[0] for example in reader] == lines
+
+
+def test_parquet_reader_reads_projected_columns(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    filename = str(tmp_path / 'test.parquet')
+    ints = list(range(100))
+    floats = [None if i % 7 == 0 else i * 0.5 for i in ints]
+    table = pa.table({'i': ints,
+                      'f': floats,
+                      's': [str(i) for i in ints]})
+    pq.write_table(table, filename, row_group_size=10)
+
+    parquet_params = mlio.ParquetParams(column_names=['f', 'i'])
+
+    rows = []
+    for shard_index in range(2):
+        rdr_prm = mlio.DataReaderParams(
+            dataset=[mlio.File(filename)],
+            batch_size=10,
+            shard_index=shard_index,
+            num_shards=2,
+            sharding_strategy=mlio.ShardingStrategy.ROW_GROUP)
+
+        reader = mlio.ParquetReader(rdr_prm, parquet_params)
+
+        for example in reader:
+            f, i = (as_numpy(feature).squeeze() for feature in example)
+            rows.extend(zip(i.tolist(), f.tolist()))
+
+    rows.sort()
+
+    assert [i for i, _ in rows] == ints
+    assert all(math.isnan(f) if e is None else f == e
+               for (_, f), e in zip(rows, floats))
+
+
+
+def test_parquet_row_group_sharding_with_interleaved_reading(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    dataset = []
+    for i in range(4):
+        filename = str(tmp_path / 'test{}.parquet'.format(i))
+        pq.write_table(pa.table({'i': list(range(i * 10, (i + 1) * 10))}),
+                       filename)
+        dataset.append(mlio.File(filename))
+
+    rows = []
+    for shard_index in range(2):
+        rdr_prm = mlio.DataReaderParams(
+            dataset=dataset,
+            batch_size=10,
+            shard_index=shard_index,
+            num_shards=2,
+            sharding_strategy=mlio.ShardingStrategy.ROW_GROUP,
+            interleave_cycle_length=2)
+
+        reader = mlio.ParquetReader(rdr_prm)
+
+        shard_rows = []
+        for example in reader:
+            shard_rows.extend(as_numpy(example[0]).squeeze().tolist())
+
+        # The single row groups of the files are rotated across the
+        # shards even though interleaving opens the files via a proxy.
+        assert len(shard_rows) == 20
+
+        rows.extend(shard_rows)
+
+    assert sorted(rows) == list(range(40))
+
+
+def test_parquet_reader_rejects_deeply_nested_metadata(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    filename = str(tmp_path / 'test.parquet')
+    pq.write_table(pa.table({'i': list(range(10))}), filename)
+
+    with open(filename, 'rb') as f:
+        data = f.read()
+
+    # Append an unknown field holding deeply nested structs to the file
+    # metadata, right before its stop field.
+    footer_size = struct.unpack('<I', data[-8:-4])[0]
+    footer = data[-8 - footer_size:-8]
+
+    depth = 100000
+    field = b'\x0c\xc8\x01' + b'\x1c' * depth + b'\x00' * (depth + 1)
+
+    footer = footer[:-1] + field + footer[-1:]
+
+    with open(filename, 'wb') as f:
+        f.write(data[:-8 - footer_size])
+        f.write(footer)
+        f.write(struct.pack('<I', len(footer)))
+        f.write(b'PAR1')
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1)
+
+    reader = mlio.ParquetReader(rdr_prm)
+
+    with pytest.raises(mlio.MLIOError):
+        reader.read_example()
+
+
+def test_parquet_reader_rejects_deeply_nested_schema(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    filename = str(tmp_path / 'test.parquet')
+
+    column = pa.array(list(range(10)))
+    for _ in range(100):
+        column = pa.StructArray.from_arrays([column], names=['s'])
+
+    pq.write_table(pa.table({'s': column}), filename)
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1)
+
+    reader = mlio.ParquetReader(rdr_prm)
+
+    with pytest.raises(mlio.MLIOError):
+        reader.read_example()
+
+
+def _write_sparse_recordio(filename, rows, num_columns):
+    def varint(n):
+        b = bytearray()
+        while n > 0x7f:
+            b.append(n & 0x7f | 0x80)
+            n >>= 7
+        b.append(n)
+        return bytes(b)
+
+    def field(num, payload):
+        return varint(num << 3 | 2) + varint(len(payload)) + payload
+
+    with open(filename, 'wb') as f:
+        for keys in rows:
+            values = struct.pack('<%df' % len(keys), *keys)
+            tensor = field(1, values) + \
+                field(2, b''.join(varint(k) for k in keys)) + \
+                field(3, varint(num_columns))
+            entry = field(1, b'values') + field(2, field(2, tensor))
+            record = field(1, entry)
+            padding = b'\0' * (-len(record) % 4)
+            f.write(struct.pack('<II', 0xced7230a, len(record)))
+            f.write(record + padding)
+
+
+def test_recordio_protobuf_reader_reads_csr_tensors(tmp_path):
+    filename = str(tmp_path / 'test.pr')
+    rows = [[1, 5], [], [0, 2, 9], [7], [3, 4]]
+    _write_sparse_recordio(filename, rows, num_columns=10)
+
+    rdr_prm = mlio.DataReaderParams(
+        dataset=[mlio.File(filename)],
+        batch_size=2,
+        last_example_handling=mlio.LastExampleHandling.PAD)
+
+    rp_prm = mlio.RecordIOProtobufParams(
+        sparse_tensor_format=mlio.SparseTensorFormat.CSR)
+
+    reader = mlio.RecordIOProtobufReader(rdr_prm, rp_prm)
+
+    indptrs = []
+    indices = []
+    for example in reader:
+        tensor = example[0]
+        assert isinstance(tensor, mlio.CsrTensor)
+        assert tensor.shape == (2, 10)
+        assert tensor.indices.data_type == mlio.DataType.INT32
+        indptrs.append(list(memoryview(tensor.indptr)))
+        indices.extend(memoryview(tensor.indices))
+        assert list(memoryview(tensor.data)) == \
+            [float(k) for k in memoryview(tensor.indices)]
+
+    assert indptrs == [[0, 2, 2], [0, 3, 4], [0, 2, 2]]
+    assert indices == [k for keys in rows for k in keys]
+
+
+def test_record_index_is_ignored_if_data_store_changes(tmp_path):
+    filename = str(tmp_path / 'test.txt')
+    with open(filename, 'w') as f:
+        f.write('aaaa\nbbbb\ncccc\n')
+
+    rdr_prm = mlio.DataReaderParams(dataset=[mlio.File(filename)],
+                                    batch_size=1,
+                                    use_record_index=True,
+                                    record_index_interval=1)
+
+    reader = mlio.TextLineReader(rdr_prm)
+    assert sum(1 for _ in reader) == 3
+
+    # Rewrite the file with the same size, but different line offsets.
+    with open(filename, 'w') as f:
+        f.write('aaaaaaaa\nbb\ncc\n')
+    stat = os.stat(filename)
+    os.utime(filename, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1000000000))
+
+    rdr_prm.num_instances_to_skip = 2
+
+    reader = mlio.TextLineReader(rdr_prm)
+    example = reader.read_example()
+    record = [as_numpy(feature) for feature in example]
+
+    assert record[0] == "cc"
+    assert reader.read_example() is None
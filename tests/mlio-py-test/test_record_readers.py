@@ -0,0 +1,54 @@
+import pytest
+
+import mlio
+
+
+def test_parquet_record_reader_splits_concatenated_files(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    blobs = []
+    for i in range(3):
+        filename = str(tmp_path / 'test{}.parquet'.format(i))
+        table = pa.table({'i': list(range(i * 100, (i + 1) * 100))})
+        pq.write_table(table, filename, row_group_size=10 * (i + 1))
+        with open(filename, 'rb') as f:
+            blobs.append(f.read())
+
+    filename = str(tmp_path / 'test.bin')
+    with open(filename, 'wb') as f:
+        f.write(b''.join(blobs))
+
+    file_ends = []
+    for blob in blobs:
+        file_ends.append(len(blob) + (file_ends[-1] if file_ends else 0))
+
+    for reader in [
+            mlio.ParquetRecordReader(mlio.File(filename).open_read()),
+            mlio.ParquetRecordReader(mlio.File(filename).open_read(),
+                                     file_ends=file_ends)]:
+        assert [bytes(memoryview(record)) for record in reader] == blobs
+
+
+def test_parquet_record_reader_rejects_data_past_last_file(tmp_path):
+    pa = pytest.importorskip('pyarrow')
+    pq = pytest.importorskip('pyarrow.parquet')
+
+    filename = str(tmp_path / 'test.parquet')
+    pq.write_table(pa.table({'i': list(range(100))}), filename)
+    with open(filename, 'rb') as f:
+        blob = f.read()
+
+    filename = str(tmp_path / 'test.bin')
+    with open(filename, 'wb') as f:
+        f.write(blob + blob + b'garbage')
+
+    reader = mlio.ParquetRecordReader(mlio.File(filename).open_read(),
+                                      file_ends=[len(blob), 2 * len(blob)])
+
+    assert bytes(memoryview(reader.peek_record())) == blob
+    assert bytes(memoryview(reader.read_record())) == blob
+    assert bytes(memoryview(reader.read_record())) == blob
+
+    with pytest.raises(mlio.MLIOError):
+        reader.read_record()
@@ -0,0 +1,44 @@
+#include "mlio-test/temp_dir.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <ftw.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+namespace mlio {
+
+Temp_dir::Temp_dir()
+{
+    const ::testing::TestInfo *info = ::testing::UnitTest::GetInstance()->current_test_info();
+
+    std::string name = "mlio-test";
+    if (info != nullptr) {
+        name = name + "-" + info->test_suite_name() + "-" + info->name();
+    }
+
+    std::string tmpl = ::testing::TempDir() + name + "-XXXXXX";
+
+    std::vector<char> buffer(tmpl.begin(), tmpl.end());
+    buffer.push_back('\0');
+
+    if (::mkdtemp(buffer.data()) == nullptr) {
+        ADD_FAILURE() << "The temporary directory '" << tmpl << "' cannot be created.";
+    }
+
+    path_ = buffer.data();
+}
+
+Temp_dir::~Temp_dir()
+{
+    auto remove = [](const char *path, const struct ::stat *, int, ::FTW *) {
+        return std::remove(path);
+    };
+
+    ::nftw(path_.c_str(), remove, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+}  // namespace mlio
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+namespace mlio {
+
+// Represents a temporary directory that is unique to the running test
+// so that the tests do not clash over their files when run in parallel.
+// The directory and its contents are removed on destruction.
+class Temp_dir {
+public:
+    Temp_dir();
+
+    Temp_dir(const Temp_dir &) = delete;
+
+    Temp_dir &operator=(const Temp_dir &) = delete;
+
+    Temp_dir(Temp_dir &&) = delete;
+
+    Temp_dir &operator=(Temp_dir &&) = delete;
+
+    ~Temp_dir();
+
+    // Returns the path of the specified file in the directory.
+    std::string path(const std::string &filename) const
+    {
+        return path_ + "/" + filename;
+    }
+
+private:
+    std::string path_{};
+};
+
+}  // namespace mlio
@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include "mlio/record_readers/detail/chunk_size_tuner.h"
+
+namespace mlio {
+namespace {
+
+using namespace std::chrono_literals;
+
+using detail::Chunk_size_tuner;
+
+constexpr std::size_t mib = 0x10'0000;
+
+// The consumer waits on the stream; larger chunks should be read.
+Chunk_size_tuner::Observation slow_stream(std::size_t chunk_size)
+{
+    return {chunk_size, 0, 10ms, 1ms, true};
+}
+
+// The stream keeps up, but the blocks cannot be recycled; smaller
+// chunks should be read.
+Chunk_size_tuner::Observation held_blocks(std::size_t chunk_size)
+{
+    return {chunk_size, 0, 0ms, 10ms, false};
+}
+
+// Neither of the above.
+Chunk_size_tuner::Observation steady(std::size_t chunk_size)
+{
+    return {chunk_size, 0, 0ms, 10ms, true};
+}
+
+}  // namespace
+
+class Test_chunk_size_tuner : public ::testing::Test {
+protected:
+    Test_chunk_size_tuner() = default;
+
+    ~Test_chunk_size_tuner() override;
+};
+
+Test_chunk_size_tuner::~Test_chunk_size_tuner() = default;
+
+TEST_F(Test_chunk_size_tuner, test_size_grows_after_three_votes)
+{
+    Chunk_size_tuner tuner{};
+
+    std::size_t size = tuner.size();
+
+    tuner.observe(slow_stream(size));
+    tuner.observe(slow_stream(size));
+
+    EXPECT_EQ(tuner.size(), size);
+
+    tuner.observe(slow_stream(size));
+
+    EXPECT_EQ(tuner.size(), size * 2);
+}
+
+TEST_F(Test_chunk_size_tuner, test_size_shrinks_after_three_votes)
+{
+    Chunk_size_tuner tuner{};
+
+    std::size_t size = tuner.size();
+
+    tuner.observe(held_blocks(size));
+    tuner.observe(held_blocks(size));
+
+    EXPECT_EQ(tuner.size(), size);
+
+    tuner.observe(held_blocks(size));
+
+    EXPECT_EQ(tuner.size(), size / 2);
+}
+
+TEST_F(Test_chunk_size_tuner, test_interrupted_votes_do_not_resize)
+{
+    Chunk_size_tuner tuner{};
+
+    std::size_t size = tuner.size();
+
+    // Votes in the opposite direction or no vote at all start the count
+    // over.
+    for (int i = 0; i < 4; i++) {
+        tuner.observe(slow_stream(size));
+        tuner.observe(slow_stream(size));
+        tuner.observe(held_blocks(size));
+        tuner.observe(held_blocks(size));
+        tuner.observe(steady(size));
+    }
+
+    EXPECT_EQ(tuner.size(), size);
+}
+
+TEST_F(Test_chunk_size_tuner, test_size_stays_within_bounds)
+{
+    Chunk_size_tuner tuner{};
+
+    tuner.set_bounds(3 * mib, 5 * mib);
+
+    // The bounds are rounded to powers of two.
+    EXPECT_EQ(tuner.size(), 4 * mib);
+
+    for (int i = 0; i < 6; i++) {
+        tuner.observe(held_blocks(tuner.size()));
+    }
+
+    EXPECT_EQ(tuner.size(), 4 * mib);
+
+    tuner.set_bounds(1 * mib, 8 * mib);
+
+    for (int i = 0; i < 9; i++) {
+        tuner.observe(slow_stream(tuner.size()));
+    }
+
+    EXPECT_EQ(tuner.size(), 8 * mib);
+}
+
+TEST_F(Test_chunk_size_tuner, test_max_size_below_default_min_size)
+{
+    Chunk_size_tuner tuner{};
+
+    tuner.set_bounds(0, 256 * 1024);
+
+    EXPECT_EQ(tuner.size(), 256 * 1024);
+
+    for (int i = 0; i < 3; i++) {
+        tuner.observe(held_blocks(tuner.size()));
+    }
+
+    // The default lower bound gives way to the specified upper bound.
+    EXPECT_EQ(tuner.size(), 256 * 1024);
+}
+
+TEST_F(Test_chunk_size_tuner, test_size_hint_exceeds_max_size)
+{
+    Chunk_size_tuner tuner{};
+
+    tuner.set_bounds(0, 2 * mib);
+
+    // A 40 MiB record along with room for a leftover needs a 64 MiB
+    // chunk.
+    tuner.set_size_hint(40 * mib);
+
+    EXPECT_EQ(tuner.size(), 64 * mib);
+
+    for (int i = 0; i < 3; i++) {
+        tuner.observe(held_blocks(tuner.size()));
+    }
+
+    EXPECT_EQ(tuner.size(), 64 * mib);
+}
+
+TEST_F(Test_chunk_size_tuner, test_chunk_without_record_doubles_size)
+{
+    Chunk_size_tuner tuner{};
+
+    tuner.set_bounds(0, 2 * mib);
+
+    std::size_t size = tuner.size();
+
+    tuner.observe({size, size, 0ms, 0ms, true});
+
+    EXPECT_EQ(tuner.size(), size * 2);
+}
+
+}  // namespace mlio
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#ifdef MLIO_BUILD_LZ4
+#include <lz4frame.h>
+#endif
+
+#ifdef MLIO_BUILD_ZSTD
+#include <zstd.h>
+#endif
+
+#include "mlio-test/temp_dir.h"
+#include "mlio/data_stores/detail/util.h"
+#include "mlio/streams/detail/zstd.h"
+
+namespace mlio {
+namespace {
+
+#if defined(MLIO_BUILD_ZSTD) || defined(MLIO_BUILD_LZ4)
+
+// Returns compressible text of the specified size.
+std::string make_text(std::size_t size)
+{
+    std::mt19937 gen{};
+    std::uniform_int_distribution<int> dist{0, 9999};
+
+    std::string text{};
+    while (text.size() < size) {
+        text += "line " + std::to_string(dist(gen)) + "\n";
+    }
+    text.resize(size);
+
+    return text;
+}
+
+#endif
+
+#ifdef MLIO_BUILD_ZSTD
+
+// Returns incompressible data of the specified size.
+std::string make_random_data(std::size_t size)
+{
+    std::mt19937 gen{};
+
+    std::string data(size, '\0');
+    std::generate(data.begin(), data.end(), [&gen] {
+        return static_cast<char>(gen());
+    });
+
+    return data;
+}
+
+std::string
+compress_zstd(const std::string &text, bool content_size = true, bool checksum = false)
+{
+    ::ZSTD_CCtx *ctx = ::ZSTD_createCCtx();
+
+    ::ZSTD_CCtx_setParameter(ctx, ::ZSTD_c_contentSizeFlag, content_size ? 1 : 0);
+    ::ZSTD_CCtx_setParameter(ctx, ::ZSTD_c_checksumFlag, checksum ? 1 : 0);
+
+    std::string frame(::ZSTD_compressBound(text.size()), '\0');
+
+    std::size_t size = ::ZSTD_compress2(ctx, frame.data(), frame.size(), text.data(), text.size());
+
+    ::ZSTD_freeCCtx(ctx);
+
+    EXPECT_EQ(::ZSTD_isError(size), 0U);
+
+    frame.resize(size);
+
+    return frame;
+}
+
+std::optional<std::size_t> zstd_frame_size(const std::string &data)
+{
+    return detail::zstd_frame_size(as_span<const std::byte>(make_span(data)));
+}
+
+#endif
+
+#ifdef MLIO_BUILD_LZ4
+
+std::string compress_lz4(const std::string &text)
+{
+    std::string frame(::LZ4F_compressFrameBound(text.size(), nullptr), '\0');
+
+    std::size_t size =
+        ::LZ4F_compressFrame(frame.data(), frame.size(), text.data(), text.size(), nullptr);
+
+    EXPECT_EQ(::LZ4F_isError(size), 0U);
+
+    frame.resize(size);
+
+    return frame;
+}
+
+#endif
+
+}  // namespace
+
+class Test_compression : public ::testing::Test {
+protected:
+    Test_compression() = default;
+
+    ~Test_compression() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+
+    std::string write_file(const std::string &extension, const std::string &data)
+    {
+        std::string path = temp_dir_.path("test_compression" + extension);
+
+        std::ofstream file{path, std::ios::binary};
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+        return path;
+    }
+
+    // Reads the file with the inferred compression, both through a
+    // memory map and through a read window.
+    static void check_read(const std::string &path, const std::string &expected)
+    {
+        for (bool memory_map : {true, false}) {
+            auto stream = File{path, File_options{memory_map}}.open_read();
+
+            EXPECT_EQ(read_all(*stream), expected) << "memory_map=" << memory_map;
+        }
+    }
+
+    static std::string read_all(Input_stream &stream)
+    {
+        std::string output{};
+
+        std::vector<std::byte> buffer(0x1'0000);
+
+        std::size_t num_bytes_read = 0;
+        while ((num_bytes_read = stream.read(make_span(buffer))) != 0) {
+            auto first = reinterpret_cast<const char *>(buffer.data());
+
+            output.append(first, num_bytes_read);
+        }
+
+        return output;
+    }
+
+    Temp_dir temp_dir_{};
+};
+
+Test_compression::~Test_compression() = default;
+
+TEST_F(Test_compression, test_compression_is_inferred_from_extension)
+{
+    EXPECT_EQ(detail::infer_compression("data.zst"), Compression::zstd);
+    EXPECT_EQ(detail::infer_compression("data.zstd"), Compression::zstd);
+    EXPECT_EQ(detail::infer_compression("data.lz4"), Compression::lz4);
+    EXPECT_EQ(detail::infer_compression("data.gz"), Compression::gzip);
+    EXPECT_EQ(detail::infer_compression("data.csv"), Compression::none);
+    EXPECT_EQ(detail::infer_compression(".zst"), Compression::none);
+}
+
+TEST_F(Test_compression, test_compression_not_built_raises_not_supported_error)
+{
+    std::vector<Compression> compressions{};
+
+#ifndef MLIO_BUILD_ZSTD
+    compressions.emplace_back(Compression::zstd);
+#endif
+#ifndef MLIO_BUILD_LZ4
+    compressions.emplace_back(Compression::lz4);
+#endif
+#ifndef MLIO_BUILD_BZIP2
+    compressions.emplace_back(Compression::bzip2);
+#endif
+
+    for (Compression compression : compressions) {
+        auto stream = make_intrusive<Memory_input_stream>(Memory_slice{});
+
+        EXPECT_THROW(make_inflate_stream(std::move(stream), compression), Not_supported_error)
+            << "compression=" << compression;
+    }
+}
+
+#ifdef MLIO_BUILD_ZSTD
+
+TEST_F(Test_compression, test_zstd_single_frame)
+{
+    std::string text = make_text(0x10'0000);
+
+    std::string frame = compress_zstd(text);
+
+    EXPECT_EQ(zstd_frame_size(frame), frame.size());
+
+    check_read(write_file(".zst", frame), text);
+}
+
+TEST_F(Test_compression, test_zstd_multiple_frames)
+{
+    std::string text{};
+    std::string data{};
+
+    // Incompressible data so that the frames add up to several segments
+    // that are inflated in parallel.
+    for (std::size_t i = 0; i < 12; i++) {
+        std::string part = make_random_data(0x10'0000 + i * 1000);
+
+        std::string frame = compress_zstd(part);
+
+        // Data following the frame is not part of it.
+        std::string frame_and_more = frame + "more";
+
+        EXPECT_EQ(zstd_frame_size(frame_and_more), frame.size());
+
+        text += part;
+        data += frame;
+    }
+
+    check_read(write_file(".zst", data), text);
+}
+
+TEST_F(Test_compression, test_zstd_frames_without_content_size)
+{
+    std::string text{};
+    std::string data{};
+
+    for (std::size_t i = 0; i < 4; i++) {
+        std::string part = make_text(0x4'0000);
+
+        std::string frame = compress_zstd(part, false);
+
+        // The frame size is found by walking the block headers.
+        EXPECT_EQ(zstd_frame_size(frame), frame.size());
+
+        text += part;
+        data += frame;
+    }
+
+    check_read(write_file(".zst", data), text);
+}
+
+TEST_F(Test_compression, test_highly_compressible_zstd_frames)
+{
+    // The frames inflate to more than the output bound of a window; with
+    // the content size recorded, the segments are cut by it; without,
+    // they are discarded and inflated again in smaller pieces.
+    for (bool content_size : {true, false}) {
+        std::string text{};
+        std::string data{};
+
+        for (std::size_t i = 0; i < 6; i++) {
+            std::string part(0x100'0000, static_cast<char>('a' + i));
+
+            text += part;
+            data += compress_zstd(part, content_size);
+        }
+
+        check_read(write_file(".zst", data), text);
+    }
+}
+
+TEST_F(Test_compression, test_truncated_zstd_frame_raises_error)
+{
+    std::string frame = compress_zstd(make_text(0x4'0000));
+
+    frame.resize(frame.size() - 10);
+
+    EXPECT_EQ(zstd_frame_size(frame), std::nullopt);
+
+    std::string path = write_file(".zst", frame);
+
+    for (bool memory_map : {true, false}) {
+        auto stream = File{path, File_options{memory_map}}.open_read();
+
+        EXPECT_THROW(read_all(*stream), Inflate_error) << "memory_map=" << memory_map;
+    }
+}
+
+TEST_F(Test_compression, test_corrupt_zstd_frame_raises_error)
+{
+    std::string frame = compress_zstd(make_text(0x4'0000), true, true);
+
+    // Flip the bits of the content checksum at the end of the frame.
+    frame.back() = static_cast<char>(~frame.back());
+
+    std::string path = write_file(".zst", frame);
+
+    for (bool memory_map : {true, false}) {
+        auto stream = File{path, File_options{memory_map}}.open_read();
+
+        EXPECT_THROW(read_all(*stream), Inflate_error) << "memory_map=" << memory_map;
+    }
+}
+
+#endif
+
+#ifdef MLIO_BUILD_LZ4
+
+TEST_F(Test_compression, test_lz4_frame)
+{
+    std::string text = make_text(0x10'0000);
+
+    check_read(write_file(".lz4", compress_lz4(text)), text);
+}
+
+TEST_F(Test_compression, test_truncated_lz4_frame_raises_error)
+{
+    std::string frame = compress_lz4(make_text(0x4'0000));
+
+    frame.resize(frame.size() / 2);
+
+    std::string path = write_file(".lz4", frame);
+
+    for (bool memory_map : {true, false}) {
+        auto stream = File{path, File_options{memory_map}}.open_read();
+
+        EXPECT_THROW(read_all(*stream), Inflate_error) << "memory_map=" << memory_map;
+    }
+}
+
+#endif
+
+}  // namespace mlio
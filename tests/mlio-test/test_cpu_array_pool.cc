@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+namespace mlio {
+
+class Test_cpu_array_pool : public ::testing::Test {
+protected:
+    Test_cpu_array_pool() = default;
+
+    ~Test_cpu_array_pool() override;
+
+protected:
+    std::string const csv_path_ = "../resources/test.csv";
+};
+
+Test_cpu_array_pool::~Test_cpu_array_pool() = default;
+
+TEST_F(Test_cpu_array_pool, test_buffer_is_recycled)
+{
+    auto pool = mlio::make_intrusive<mlio::Cpu_array_pool>(1024);
+
+    auto arr = pool->allocate(Data_type::int32, 16);
+    const void *data = arr->data();
+
+    EXPECT_EQ(pool->size(), 0);
+
+    arr = nullptr;
+
+    EXPECT_EQ(pool->size(), 16 * sizeof(std::int32_t));
+
+    arr = pool->allocate(Data_type::int32, 16);
+
+    EXPECT_EQ(arr->data(), data);
+    EXPECT_EQ(pool->size(), 0);
+}
+
+TEST_F(Test_cpu_array_pool, test_buffer_is_recycled_across_data_types_of_same_byte_size)
+{
+    auto pool = mlio::make_intrusive<mlio::Cpu_array_pool>(1024);
+
+    auto arr = pool->allocate(Data_type::float32, 8);
+    const void *data = arr->data();
+
+    arr = nullptr;
+
+    arr = pool->allocate(Data_type::uint32, 8);
+
+    EXPECT_EQ(arr->data(), data);
+    EXPECT_EQ(arr->data_type(), Data_type::uint32);
+}
+
+TEST_F(Test_cpu_array_pool, test_zero_init_is_skipped)
+{
+    auto pool = mlio::make_intrusive<mlio::Cpu_array_pool>(1024);
+
+    auto arr = pool->allocate(Data_type::int32, 4);
+    for (auto &value : as_span<std::int32_t>(*arr)) {
+        value = 7;
+    }
+
+    arr = nullptr;
+
+    arr = pool->allocate(Data_type::int32, 4, false);
+    for (auto value : as_span<std::int32_t>(*arr)) {
+        EXPECT_EQ(value, 7);
+    }
+
+    arr = nullptr;
+
+    arr = pool->allocate(Data_type::int32, 4);
+    for (auto value : as_span<std::int32_t>(*arr)) {
+        EXPECT_EQ(value, 0);
+    }
+}
+
+TEST_F(Test_cpu_array_pool, test_pool_size_is_bounded_by_max_size)
+{
+    auto pool = mlio::make_intrusive<mlio::Cpu_array_pool>(64);
+
+    auto arr1 = pool->allocate(Data_type::int64, 8);
+    auto arr2 = pool->allocate(Data_type::int64, 8);
+
+    arr1 = nullptr;
+    arr2 = nullptr;
+
+    EXPECT_EQ(pool->size(), 64);
+
+    pool->clear();
+
+    EXPECT_EQ(pool->size(), 0);
+}
+
+TEST_F(Test_cpu_array_pool, test_array_outlives_pool)
+{
+    auto pool = mlio::make_intrusive<mlio::Cpu_array_pool>(1024);
+
+    auto arr = pool->allocate(Data_type::float64, 4);
+
+    pool = nullptr;
+
+    as_span<double>(*arr)[3] = 1.0;
+
+    EXPECT_EQ(as_span<double>(*arr)[3], 1.0);
+}
+
+TEST_F(Test_cpu_array_pool, test_csv_reader_with_tensor_pool)
+{
+    mlio::Data_reader_params prm{};
+    prm.dataset.emplace_back(mlio::make_intrusive<mlio::File>(csv_path_));
+    prm.batch_size = 2;
+    prm.last_example_handling = Last_example_handling::pad;
+    prm.tensor_pool_size = 1024;
+
+    mlio::Csv_params csv_prm{};
+    csv_prm.header_row_index = std::nullopt;
+    csv_prm.default_data_type = Data_type::int64;
+
+    auto reader = mlio::make_intrusive<mlio::Csv_reader>(prm, csv_prm);
+
+    // The buffers of the first epoch get recycled in the following ones;
+    // the padded rows of the last batch must still read as zero.
+    for (auto i = 0; i < 3; i++) {
+        mlio::Intrusive_ptr<mlio::Example> exm = reader->read_example();
+        ASSERT_NE(exm, nullptr);
+
+        auto tsr = static_cast<Dense_tensor *>(exm->features()[1].get());
+        auto values = tsr->data().as<std::int64_t>();
+        EXPECT_EQ(values[0], 0);
+        EXPECT_EQ(values[1], 0);
+
+        exm = reader->read_example();
+        ASSERT_NE(exm, nullptr);
+
+        EXPECT_EQ(exm->padding, 1);
+
+        tsr = static_cast<Dense_tensor *>(exm->features()[1].get());
+        values = tsr->data().as<std::int64_t>();
+        EXPECT_EQ(values[0], 1);
+        EXPECT_EQ(values[1], 0);
+
+        exm = nullptr;
+
+        EXPECT_EQ(reader->read_example(), nullptr);
+
+        reader->reset();
+    }
+}
+
+}  // namespace mlio
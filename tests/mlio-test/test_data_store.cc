@@ -0,0 +1,126 @@
+#include "mlio-test/test_data_store.h"
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mlio {
+
+std::size_t Test_input_stream::read(Mutable_memory_span destination)
+{
+    std::size_t size = std::min(destination.size(), text_.size() - position_);
+
+    auto first = text_.begin() + static_cast<std::ptrdiff_t>(position_);
+    auto last = first + static_cast<std::ptrdiff_t>(size);
+
+    std::transform(first, last, destination.begin(), [](char c) {
+        return static_cast<std::byte>(c);
+    });
+
+    position_ += size;
+
+    return size;
+}
+
+void Test_input_stream::seek(std::size_t position)
+{
+    if (num_seeks_ == nullptr) {
+        Input_stream_base::seek(position);
+    }
+
+    (*num_seeks_)++;
+
+    position_ = std::min(position, text_.size());
+}
+
+std::size_t Test_input_stream::size() const
+{
+    if (num_seeks_ == nullptr) {
+        return Input_stream_base::size();
+    }
+    return text_.size();
+}
+
+std::size_t Test_input_stream::position() const
+{
+    if (num_seeks_ == nullptr) {
+        return Input_stream_base::position();
+    }
+    return position_;
+}
+
+Intrusive_ptr<Input_stream> Test_data_store::open_read() const
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    num_opens_++;
+
+    condition_.notify_all();
+
+    condition_.wait(lock, [this] {
+        return !blocked_;
+    });
+
+    if (fails_) {
+        throw std::system_error{std::make_error_code(std::errc::no_such_file_or_directory)};
+    }
+
+    return make_intrusive<Test_input_stream>(text_, seekable_ ? &num_seeks_ : nullptr);
+}
+
+void Test_data_store::block()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    blocked_ = true;
+}
+
+void Test_data_store::release()
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        blocked_ = false;
+    }
+
+    condition_.notify_all();
+}
+
+void Test_data_store::wait_for_opens(std::size_t num_opens) const
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    condition_.wait(lock, [this, num_opens] {
+        return num_opens_ >= num_opens;
+    });
+}
+
+std::size_t Test_data_store::num_opens() const
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    return num_opens_;
+}
+
+std::string read_text(Input_stream &stream)
+{
+    std::string text{};
+
+    std::vector<std::byte> buffer(7);
+
+    std::size_t num_bytes_read = 0;
+    while ((num_bytes_read = stream.read(make_span(buffer))) != 0) {
+        std::transform(buffer.begin(),
+                       buffer.begin() + static_cast<std::ptrdiff_t>(num_bytes_read),
+                       std::back_inserter(text),
+                       [](std::byte b) {
+                           return static_cast<char>(b);
+                       });
+    }
+
+    return text;
+}
+
+}  // namespace mlio
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <mlio.h>
+
+namespace mlio {
+
+// Serves the specified text without support for zero-copy reading so
+// that the prefetcher reads its first bytes ahead. If num_seeks is not
+// null, the stream is seekable and counts its seeks.
+class Test_input_stream final : public Input_stream_base {
+public:
+    explicit Test_input_stream(std::string text, std::size_t *num_seeks = nullptr) noexcept
+        : text_{std::move(text)}, num_seeks_{num_seeks}
+    {}
+
+    using Input_stream_base::read;
+
+    std::size_t read(Mutable_memory_span destination) final;
+
+    void seek(std::size_t position) final;
+
+    void close() noexcept final
+    {
+        closed_ = true;
+    }
+
+    std::size_t size() const final;
+
+    std::size_t position() const final;
+
+    bool closed() const noexcept final
+    {
+        return closed_;
+    }
+
+    bool seekable() const noexcept final
+    {
+        return num_seeks_ != nullptr;
+    }
+
+private:
+    std::string text_;
+    std::size_t *num_seeks_;
+    std::size_t position_{};
+    bool closed_{};
+};
+
+// Records the calls to open_read(). The calls can be made to fail or to
+// block until the store is released.
+class Test_data_store final : public Data_store {
+public:
+    explicit Test_data_store(std::string id, std::string text) noexcept
+        : id_{std::move(id)}, text_{std::move(text)}
+    {}
+
+    Intrusive_ptr<Input_stream> open_read() const final;
+
+    std::string repr() const final
+    {
+        return id_;
+    }
+
+    const std::string &id() const final
+    {
+        return id_;
+    }
+
+    const std::string &text() const noexcept
+    {
+        return text_;
+    }
+
+    void fail() noexcept
+    {
+        fails_ = true;
+    }
+
+    // Makes the streams of the data store seekable.
+    void make_seekable() noexcept
+    {
+        seekable_ = true;
+    }
+
+    // Gets the number of seeks made on the streams of the data store.
+    std::size_t num_seeks() const noexcept
+    {
+        return num_seeks_;
+    }
+
+    void block();
+
+    void release();
+
+    // Waits until open_read() has been called the specified number of
+    // times.
+    void wait_for_opens(std::size_t num_opens) const;
+
+    std::size_t num_opens() const;
+
+private:
+    std::string id_;
+    std::string text_;
+    bool fails_{};
+    bool seekable_{};
+    mutable std::size_t num_seeks_{};
+    mutable bool blocked_{};
+    mutable std::size_t num_opens_{};
+    mutable std::mutex mutex_{};
+    mutable std::condition_variable condition_{};
+};
+
+// Reads the specified stream to its end in small chunks.
+std::string read_text(Input_stream &stream);
+
+}  // namespace mlio
@@ -0,0 +1,153 @@
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio-test/test_data_store.h"
+#include "mlio/instance_readers/data_store_prefetcher.h"
+
+namespace mlio {
+
+class Test_data_store_prefetcher : public ::testing::Test {
+protected:
+    Test_data_store_prefetcher() = default;
+
+    ~Test_data_store_prefetcher() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+
+    void SetUp() override
+    {
+        for (std::size_t i = 0; i < num_stores_; i++) {
+            std::string id = "store-" + std::to_string(i);
+
+            std::string text = id + " line-0\n" + id + " line-1\n";
+
+            auto store = make_intrusive<Test_data_store>(std::move(id), std::move(text));
+
+            stores_.emplace_back(store.get());
+
+            dataset_.emplace_back(std::move(store));
+        }
+    }
+
+    static constexpr std::size_t num_stores_ = 6;
+    static constexpr std::size_t num_prefetched_stores_ = 2;
+
+    std::vector<Intrusive_ptr<Data_store>> dataset_{};
+    std::vector<Test_data_store *> stores_{};
+};
+
+Test_data_store_prefetcher::~Test_data_store_prefetcher() = default;
+
+TEST_F(Test_data_store_prefetcher, test_prefetched_stream_is_returned_once)
+{
+    detail::Data_store_prefetcher prefetcher{num_prefetched_stores_};
+
+    prefetcher.prefetch(dataset_.cbegin(), dataset_.cend());
+
+    stores_[0]->wait_for_opens(1);
+    stores_[1]->wait_for_opens(1);
+
+    auto store = prefetcher.take(*stores_[0]);
+
+    ASSERT_NE(store, nullptr);
+
+    EXPECT_EQ(store->id(), stores_[0]->id());
+    EXPECT_FALSE(store->stream_taken());
+
+    EXPECT_EQ(read_text(*store->open_read()), stores_[0]->text());
+    EXPECT_TRUE(store->stream_taken());
+    EXPECT_EQ(stores_[0]->num_opens(), 1U);
+
+    // Any further call opens the inner data store again.
+    EXPECT_EQ(read_text(*store->open_read()), stores_[0]->text());
+    EXPECT_EQ(stores_[0]->num_opens(), 2U);
+
+    // Only num_prefetched_stores_ data stores are opened ahead.
+    EXPECT_EQ(stores_[2]->num_opens(), 0U);
+}
+
+TEST_F(Test_data_store_prefetcher, test_seek_within_prefetched_bytes_keeps_inner_stream)
+{
+    stores_[0]->make_seekable();
+
+    detail::Data_store_prefetcher prefetcher{num_prefetched_stores_};
+
+    prefetcher.prefetch(dataset_.cbegin(), dataset_.cend());
+
+    stores_[0]->wait_for_opens(1);
+
+    auto store = prefetcher.take(*stores_[0]);
+
+    ASSERT_NE(store, nullptr);
+
+    // Sniffing the BOM seeks back to the beginning of the stream; the
+    // bytes read ahead must not be read again.
+    auto stream = make_utf8_stream(store->open_read());
+
+    EXPECT_EQ(read_text(*stream), stores_[0]->text());
+    EXPECT_EQ(stores_[0]->num_seeks(), 0U);
+
+    // Once the stream is read past the bytes read ahead, a seek goes to
+    // the inner stream.
+    stream->seek(3);
+
+    EXPECT_EQ(read_text(*stream), stores_[0]->text().substr(3));
+    EXPECT_EQ(stores_[0]->num_seeks(), 1U);
+}
+
+TEST_F(Test_data_store_prefetcher, test_open_error_is_rethrown_by_take)
+{
+    stores_[1]->fail();
+
+    detail::Data_store_prefetcher prefetcher{num_prefetched_stores_};
+
+    prefetcher.prefetch(dataset_.cbegin(), dataset_.cend());
+
+    stores_[0]->wait_for_opens(1);
+    stores_[1]->wait_for_opens(1);
+
+    EXPECT_NE(prefetcher.take(*stores_[0]), nullptr);
+
+    EXPECT_THROW(prefetcher.take(*stores_[1]), std::system_error);
+}
+
+TEST_F(Test_data_store_prefetcher, test_clear_drops_store_in_flight)
+{
+    stores_[0]->block();
+
+    detail::Data_store_prefetcher prefetcher{num_prefetched_stores_};
+
+    prefetcher.prefetch(dataset_.cbegin(), dataset_.cend());
+
+    // The worker is now blocked on opening the first data store.
+    stores_[0]->wait_for_opens(1);
+
+    prefetcher.clear();
+
+    EXPECT_EQ(prefetcher.take(*stores_[0]), nullptr);
+
+    stores_[0]->release();
+
+    // The stream opened before the call to clear() must not be handed
+    // out; the data store is opened again.
+    prefetcher.prefetch(dataset_.cbegin(), dataset_.cend());
+
+    stores_[0]->wait_for_opens(2);
+
+    auto store = prefetcher.take(*stores_[0]);
+
+    ASSERT_NE(store, nullptr);
+
+    EXPECT_EQ(read_text(*store->open_read()), stores_[0]->text());
+}
+
+}  // namespace mlio
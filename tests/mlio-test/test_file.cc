@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio-test/temp_dir.h"
+
+namespace mlio {
+
+class Test_file : public ::testing::Test {
+protected:
+    Test_file() = default;
+
+    ~Test_file() override;
+
+    void SetUp() override
+    {
+        mlio::initialize();
+
+        data_.resize(0x80'0000 + 0x1'2345);
+
+        std::mt19937 gen{};
+        std::generate(data_.begin(), data_.end(), [&gen] {
+            return static_cast<char>(gen());
+        });
+
+        std::ofstream file{path_, std::ios::binary};
+        file.write(data_.data(), static_cast<std::streamsize>(data_.size()));
+    }
+
+    // Reads the whole stream using the specified read sizes in turn and
+    // checks the data.
+    void check_read(Input_stream &stream, const std::vector<std::size_t> &read_sizes) const
+    {
+        std::vector<std::byte> buffer(data_.size());
+
+        std::size_t position = 0;
+        for (std::size_t i = 0; position < buffer.size(); i++) {
+            std::size_t size = std::min(read_sizes[i % read_sizes.size()],
+                                        buffer.size() - position);
+
+            std::size_t num_bytes_read = stream.read(make_span(buffer).subspan(position, size));
+
+            ASSERT_NE(num_bytes_read, 0U);
+
+            position += num_bytes_read;
+        }
+
+        EXPECT_EQ(stream.read(make_span(buffer)), 0U);
+
+        EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), data_.begin(), [](auto b, char c) {
+            return b == static_cast<std::byte>(c);
+        }));
+    }
+
+    Temp_dir temp_dir_{};
+    std::string const path_ = temp_dir_.path("test_file.bin");
+    std::vector<char> data_{};
+};
+
+Test_file::~Test_file() = default;
+
+TEST_F(Test_file, test_io_methods_read_same_data)
+{
+    // Small reads go through the read-ahead queue of the io_uring stream
+    // while large ones are done directly into the destination.
+    std::vector<std::vector<std::size_t>> read_patterns{
+        {1000}, {0x10'0000}, {0x30'0001}, {777, 0x10'0000, 0x10'0000, 5000}};
+
+    for (File_io_method io_method :
+         {File_io_method::blocking, File_io_method::io_uring, File_io_method::direct}) {
+        for (const std::vector<std::size_t> &read_sizes : read_patterns) {
+            File file{path_, File_options{false, Compression::none, io_method}};
+
+            auto stream = file.open_read();
+
+            check_read(*stream, read_sizes);
+        }
+    }
+}
+
+TEST_F(Test_file, test_io_methods_seek)
+{
+    for (File_io_method io_method :
+         {File_io_method::blocking, File_io_method::io_uring, File_io_method::direct}) {
+        File file{path_, File_options{false, Compression::none, io_method}};
+
+        auto stream = file.open_read();
+
+        std::vector<std::byte> buffer(0x20'0000);
+
+        // Seek after a large read and after a small one.
+        for (std::size_t read_size : {buffer.size(), std::size_t{100}}) {
+            stream->read(make_span(buffer).first(read_size));
+
+            for (std::size_t position : {std::size_t{12345}, data_.size() - 100, std::size_t{0}}) {
+                stream->seek(position);
+
+                std::size_t num_bytes_read = stream->read(make_span(buffer));
+
+                ASSERT_NE(num_bytes_read, 0U);
+
+                auto first = data_.begin() + static_cast<std::ptrdiff_t>(position);
+
+                EXPECT_TRUE(std::equal(buffer.begin(),
+                                       buffer.begin() + static_cast<std::ptrdiff_t>(num_bytes_read),
+                                       first,
+                                       [](auto b, char c) {
+                                           return b == static_cast<std::byte>(c);
+                                       }));
+            }
+        }
+    }
+}
+
+TEST_F(Test_file, test_io_methods_read_small_files)
+{
+    std::string const path = temp_dir_.path("test_file_small.bin");
+
+    // Files smaller than a single read-ahead buffer, including an empty
+    // one.
+    for (std::size_t size : {std::size_t{0}, std::size_t{100}, std::size_t{0x1'2345}}) {
+        {
+            std::ofstream file{path, std::ios::binary};
+            file.write(data_.data(), static_cast<std::streamsize>(size));
+        }
+
+        for (File_io_method io_method :
+             {File_io_method::blocking, File_io_method::io_uring, File_io_method::direct}) {
+            File file{path, File_options{false, Compression::none, io_method}};
+
+            auto stream = file.open_read();
+
+            std::vector<std::byte> buffer(size + 1);
+
+            std::size_t num_bytes_read = 0;
+            while (std::size_t n = stream->read(make_span(buffer).subspan(num_bytes_read))) {
+                num_bytes_read += n;
+            }
+
+            ASSERT_EQ(num_bytes_read, size);
+
+            EXPECT_TRUE(std::equal(buffer.begin(),
+                                   buffer.begin() + static_cast<std::ptrdiff_t>(size),
+                                   data_.begin(),
+                                   [](auto b, char c) {
+                                       return b == static_cast<std::byte>(c);
+                                   }));
+        }
+    }
+}
+
+TEST_F(Test_file, test_repr_shows_non_default_options)
+{
+    std::string prefix = "<File path='" + path_ + "' memory_map='true' compression='none'";
+
+    EXPECT_EQ(File{path_}.repr(), prefix + ">");
+
+    File_options opts{};
+    opts.io_method = File_io_method::io_uring;
+    opts.gzip_index_interval = 100;
+
+    EXPECT_EQ(File(path_, opts).repr(),
+              prefix + " io_method='io_uring' gzip_index_interval='100'>");
+}
+
+TEST_F(Test_file, test_legacy_constructor_sets_options)
+{
+    File file{path_, false, Compression::none};
+
+    EXPECT_EQ(file.repr(),
+              "<File path='" + path_ + "' memory_map='false' compression='none'>");
+}
+
+TEST_F(Test_file, test_direct_io_reads_aligned_destination_without_staging)
+{
+    File file{path_, File_options{false, Compression::none, File_io_method::direct}};
+
+    auto stream = file.open_read();
+
+    std::size_t size = 0x10'0000 + 100;
+
+    auto *ptr = static_cast<std::byte *>(std::aligned_alloc(0x1000, 0x40'0000));
+
+    ASSERT_NE(ptr, nullptr);
+
+    // An aligned read at an aligned position bypasses the staging buffer;
+    // therefore only the aligned part of it is read.
+    std::size_t num_bytes_read = stream->read(Mutable_memory_span{ptr, size});
+
+    EXPECT_EQ(num_bytes_read, 0x10'0000U);
+
+    // An unaligned read is served from the staging buffer.
+    std::size_t num_bytes_read_2 = stream->read(Mutable_memory_span{ptr + num_bytes_read + 1, size});
+
+    EXPECT_EQ(num_bytes_read_2, size);
+
+    auto equal = [](auto b, char c) {
+        return b == static_cast<std::byte>(c);
+    };
+
+    EXPECT_TRUE(std::equal(ptr, ptr + num_bytes_read, data_.begin(), equal));
+
+    EXPECT_TRUE(std::equal(ptr + num_bytes_read + 1,
+                           ptr + num_bytes_read + 1 + num_bytes_read_2,
+                           data_.begin() + 0x10'0000,
+                           equal));
+
+    std::free(ptr);  // NOLINT
+}
+
+}  // namespace mlio
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+namespace mlio {
+
+class Test_instance : public ::testing::Test {
+protected:
+    Test_instance() = default;
+
+    ~Test_instance() override;
+
+    static Memory_slice make_slice(std::size_t size, std::byte value)
+    {
+        auto block = make_intrusive<Heap_memory_block>(size);
+
+        std::fill(block->begin(), block->end(), value);
+
+        return Memory_slice{block};
+    }
+
+protected:
+    In_memory_store store_{Memory_slice{}};
+};
+
+Test_instance::~Test_instance() = default;
+
+TEST_F(Test_instance, test_fragments_are_not_copied)
+{
+    Memory_slice first = make_slice(3, std::byte{1});
+    Memory_slice second = make_slice(5, std::byte{2});
+
+    std::vector<Memory_slice> fragments{first, second};
+
+    Instance instance{store_, 4, std::move(fragments)};
+
+    EXPECT_TRUE(instance.has_bits());
+    EXPECT_TRUE(instance.has_fragments());
+
+    EXPECT_EQ(instance.index(), 4U);
+    EXPECT_EQ(instance.size(), 8U);
+
+    auto view = instance.fragments();
+
+    ASSERT_EQ(view.size(), 2U);
+
+    EXPECT_EQ(view[0].data(), first.data());
+    EXPECT_EQ(view[1].data(), second.data());
+}
+
+TEST_F(Test_instance, test_bits_merges_fragments_lazily)
+{
+    mlio::initialize();
+
+    std::vector<Memory_slice> fragments{make_slice(3, std::byte{1}),
+                                        make_slice(5, std::byte{2}),
+                                        make_slice(2, std::byte{3})};
+
+    Instance instance{store_, 0, std::move(fragments)};
+
+    const Memory_slice &bits = instance.bits();
+
+    ASSERT_EQ(bits.size(), 10U);
+
+    std::vector<std::byte> expected{};
+    expected.insert(expected.end(), 3, std::byte{1});
+    expected.insert(expected.end(), 5, std::byte{2});
+    expected.insert(expected.end(), 2, std::byte{3});
+
+    EXPECT_TRUE(std::equal(bits.begin(), bits.end(), expected.begin(), expected.end()));
+
+    // The merged copy is cached.
+    EXPECT_EQ(instance.bits().data(), bits.data());
+
+    // The fragments are still available after the merge.
+    EXPECT_EQ(instance.fragments().size(), 3U);
+}
+
+TEST_F(Test_instance, test_fragments_of_contiguous_instance)
+{
+    Memory_slice bits = make_slice(6, std::byte{7});
+
+    Instance instance{store_, 0, Memory_slice{bits}};
+
+    EXPECT_FALSE(instance.has_fragments());
+
+    EXPECT_EQ(instance.size(), 6U);
+
+    auto view = instance.fragments();
+
+    ASSERT_EQ(view.size(), 1U);
+
+    EXPECT_EQ(view[0].data(), bits.data());
+    EXPECT_EQ(view[0].size(), 6U);
+}
+
+}  // namespace mlio
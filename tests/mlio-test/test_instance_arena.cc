@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio/instance_readers/instance_arena.h"
+
+namespace mlio {
+
+class Test_instance_arena : public ::testing::Test {
+protected:
+    Test_instance_arena() = default;
+
+    ~Test_instance_arena() override;
+
+    Instance make_instance(std::size_t index, std::size_t size) const
+    {
+        auto block = make_intrusive<Heap_memory_block>(size);
+
+        std::fill(block->begin(), block->end(), static_cast<std::byte>(index));
+
+        return Instance{store_, index, Memory_slice{block}};
+    }
+
+    static bool has_payload(const Instance &instance, std::size_t index, std::size_t size)
+    {
+        if (instance.has_fragments() || instance.bits().size() != size) {
+            return false;
+        }
+
+        return std::all_of(instance.bits().begin(), instance.bits().end(), [index](auto b) {
+            return b == static_cast<std::byte>(index);
+        });
+    }
+
+protected:
+    static constexpr std::size_t page_size_ = 0x4000000;
+    static constexpr std::size_t mib_ = 0x100000;
+
+    In_memory_store store_{Memory_slice{}};
+};
+
+Test_instance_arena::~Test_instance_arena() = default;
+
+TEST_F(Test_instance_arena, test_pack_copies_payload)
+{
+    detail::Instance_arena arena{page_size_};
+
+    Instance original = make_instance(7, 100);
+
+    Instance packed = arena.pack(original);
+
+    EXPECT_NE(packed.bits().data(), original.bits().data());
+    EXPECT_EQ(packed.index(), 7U);
+    EXPECT_TRUE(has_payload(packed, 7, 100));
+
+    EXPECT_EQ(arena.num_used_bytes(), 100U);
+    EXPECT_EQ(arena.num_live_bytes(), 100U);
+}
+
+TEST_F(Test_instance_arena, test_pack_merges_fragments)
+{
+    detail::Instance_arena arena{page_size_};
+
+    std::vector<Memory_slice> fragments{};
+    fragments.emplace_back(make_instance(3, 10).bits());
+    fragments.emplace_back(make_instance(3, 20).bits());
+
+    Instance packed = arena.pack(Instance{store_, 3, std::move(fragments)});
+
+    EXPECT_TRUE(has_payload(packed, 3, 30));
+}
+
+TEST_F(Test_instance_arena, test_release_drops_empty_page)
+{
+    detail::Instance_arena arena{page_size_};
+
+    Instance a = arena.pack(make_instance(1, 1024));
+
+    // Does not fit into the first page; becomes the current page.
+    Instance b = arena.pack(make_instance(2, page_size_));
+
+    EXPECT_EQ(arena.num_used_bytes(), page_size_ + 1024);
+
+    arena.release(a);
+
+    EXPECT_EQ(arena.num_used_bytes(), page_size_);
+    EXPECT_EQ(arena.num_live_bytes(), page_size_);
+
+    // The popped instance keeps its payload.
+    EXPECT_TRUE(has_payload(a, 1, 1024));
+}
+
+TEST_F(Test_instance_arena, test_release_drops_empty_current_page_once_replaced)
+{
+    detail::Instance_arena arena{page_size_};
+
+    Instance a = arena.pack(make_instance(1, 1024));
+
+    arena.release(a);
+
+    EXPECT_EQ(arena.num_used_bytes(), 1024U);
+    EXPECT_EQ(arena.num_live_bytes(), 0U);
+
+    Instance b = arena.pack(make_instance(2, page_size_ - 512));
+
+    EXPECT_EQ(arena.num_used_bytes(), page_size_ - 512);
+    EXPECT_EQ(arena.num_live_bytes(), page_size_ - 512);
+
+    EXPECT_TRUE(has_payload(a, 1, 1024));
+    EXPECT_TRUE(has_payload(b, 2, page_size_ - 512));
+}
+
+TEST_F(Test_instance_arena, test_compact_moves_instances_of_sparse_pages)
+{
+    detail::Instance_arena arena{page_size_};
+
+    // Fills the first page with 64 instances and puts the remaining 36
+    // into the second one.
+    std::vector<Instance> packed{};
+    for (std::size_t i = 0; i < 100; i++) {
+        packed.emplace_back(arena.pack(make_instance(i, mib_)));
+    }
+
+    std::vector<Instance> instances{};
+    for (std::size_t i = 0; i < 100; i++) {
+        if (i == 0 || i == 1 || i == 64) {
+            instances.emplace_back(std::move(packed[i]));
+        }
+        else {
+            arena.release(packed[i]);
+        }
+    }
+
+    EXPECT_EQ(arena.num_used_bytes(), 100 * mib_);
+    EXPECT_EQ(arena.num_live_bytes(), 3 * mib_);
+
+    arena.compact(instances);
+
+    // The first page gets dropped once its instances are moved.
+    EXPECT_EQ(arena.num_used_bytes(), 38 * mib_);
+    EXPECT_EQ(arena.num_live_bytes(), 3 * mib_);
+
+    EXPECT_TRUE(has_payload(instances[0], 0, mib_));
+    EXPECT_TRUE(has_payload(instances[1], 1, mib_));
+    EXPECT_TRUE(has_payload(instances[2], 64, mib_));
+}
+
+TEST_F(Test_instance_arena, test_compact_is_skipped_if_live_bytes_dominate)
+{
+    detail::Instance_arena arena{page_size_};
+
+    std::vector<Instance> instances{};
+    for (std::size_t i = 0; i < 10; i++) {
+        instances.emplace_back(arena.pack(make_instance(i, mib_)));
+    }
+
+    arena.release(instances.back());
+    instances.pop_back();
+
+    std::vector<const std::byte *> data{};
+    for (const Instance &instance : instances) {
+        data.emplace_back(instance.bits().data());
+    }
+
+    arena.compact(instances);
+
+    for (std::size_t i = 0; i < instances.size(); i++) {
+        EXPECT_EQ(instances[i].bits().data(), data[i]);
+    }
+}
+
+TEST_F(Test_instance_arena, test_pages_beyond_threshold_are_file_backed)
+{
+    // The first page stays on the heap; the rest spill to temporary
+    // files.
+    detail::Instance_arena arena{page_size_};
+
+    std::vector<Instance> instances{};
+    for (std::size_t i = 0; i < 3; i++) {
+        instances.emplace_back(arena.pack(make_instance(i, page_size_)));
+    }
+
+    for (std::size_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(has_payload(instances[i], i, page_size_));
+    }
+
+    for (const Instance &instance : instances) {
+        arena.release(instance);
+    }
+
+    EXPECT_EQ(arena.num_live_bytes(), 0U);
+}
+
+TEST_F(Test_instance_arena, test_zero_threshold_spills_all_pages)
+{
+    detail::Instance_arena arena{0};
+
+    Instance packed = arena.pack(make_instance(5, 4096));
+
+    EXPECT_TRUE(has_payload(packed, 5, 4096));
+
+    arena.clear();
+
+    EXPECT_EQ(arena.num_used_bytes(), 0U);
+
+    EXPECT_TRUE(has_payload(packed, 5, 4096));
+}
+
+}  // namespace mlio
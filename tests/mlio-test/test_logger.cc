@@ -0,0 +1,63 @@
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+namespace mlio {
+
+class Test_logger : public ::testing::Test {
+protected:
+    Test_logger() = default;
+
+    ~Test_logger() override;
+
+    void SetUp() override
+    {
+        previous_handler_ = set_log_message_handler([this](Log_level, std::string_view msg) {
+            messages_.emplace_back(msg);
+        });
+
+        set_log_level(Log_level::info);
+    }
+
+    void TearDown() override
+    {
+        set_log_level(Log_level::warning);
+
+        set_log_message_handler(std::move(previous_handler_));
+    }
+
+    Log_message_handler previous_handler_{};
+    std::vector<std::string> messages_{};
+};
+
+Test_logger::~Test_logger() = default;
+
+TEST_F(Test_logger, test_messages_of_library_components_reach_handler)
+{
+    // The handler and the level set through the public API must be the
+    // ones used by the components of the library.
+    In_memory_store store{Memory_slice{}};
+
+    store.open_read();
+
+    ASSERT_EQ(messages_.size(), 1U);
+
+    EXPECT_NE(messages_[0].find("is being opened"), std::string::npos);
+}
+
+TEST_F(Test_logger, test_level_set_through_public_api_filters_messages)
+{
+    set_log_level(Log_level::warning);
+
+    In_memory_store store{Memory_slice{}};
+
+    store.open_read();
+
+    EXPECT_TRUE(messages_.empty());
+}
+
+}  // namespace mlio
@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+#include <unistd.h>
+
+#include "mlio-test/temp_dir.h"
+#include "mlio/record_readers/detail/mapped_chunk_reader.h"
+
+namespace mlio {
+
+class Test_mapped_chunk_reader : public ::testing::Test {
+protected:
+    Test_mapped_chunk_reader() = default;
+
+    ~Test_mapped_chunk_reader() override;
+
+    void SetUp() override
+    {
+        mlio::initialize();
+
+        std::vector<char> data(file_size_, 'a');
+
+        std::ofstream file{path_, std::ios::binary};
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    detail::Mapped_chunk_reader make_reader(std::size_t offset = 0) const
+    {
+        auto mapping = make_intrusive<File_mapped_memory_block>(path_);
+
+        return detail::Mapped_chunk_reader{std::move(mapping), offset, window_size_};
+    }
+
+    std::size_t const page_size_ = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t const window_size_ = page_size_ * 4;
+    // The last window is a partial one.
+    std::size_t const file_size_ = window_size_ * 8 + 123;
+    Temp_dir temp_dir_{};
+    std::string const path_ = temp_dir_.path("test_mapped_chunk_reader.bin");
+};
+
+Test_mapped_chunk_reader::~Test_mapped_chunk_reader() = default;
+
+TEST_F(Test_mapped_chunk_reader, test_pages_are_released_behind_sequential_reads)
+{
+    detail::Mapped_chunk_reader reader = make_reader();
+
+    std::size_t offset = 0;
+    while (!reader.eof()) {
+        Memory_slice chunk = reader.read_chunk({});
+
+        offset += chunk.size();
+
+        // The pages are released as soon as the window is dropped.
+        chunk = {};
+
+        EXPECT_EQ(reader.released_offset(), offset & ~(page_size_ - 1));
+    }
+
+    EXPECT_EQ(offset, file_size_);
+}
+
+TEST_F(Test_mapped_chunk_reader, test_pages_of_referenced_windows_are_kept)
+{
+    detail::Mapped_chunk_reader reader = make_reader();
+
+    Memory_slice chunk0 = reader.read_chunk({});
+    Memory_slice chunk1 = reader.read_chunk({});
+    Memory_slice chunk2 = reader.read_chunk({});
+
+    // The oldest window is still referenced.
+    chunk1 = {};
+
+    EXPECT_EQ(reader.released_offset(), 0U);
+
+    chunk0 = {};
+
+    EXPECT_EQ(reader.released_offset(), window_size_ * 2);
+
+    chunk2 = {};
+
+    EXPECT_EQ(reader.released_offset(), window_size_ * 3);
+}
+
+TEST_F(Test_mapped_chunk_reader, test_pages_before_start_offset_are_kept)
+{
+    // Start in the middle of the second page.
+    detail::Mapped_chunk_reader reader = make_reader(page_size_ + 10);
+
+    EXPECT_EQ(reader.released_offset(), page_size_ * 2);
+
+    Memory_slice chunk = reader.read_chunk({});
+
+    chunk = {};
+
+    EXPECT_EQ(reader.released_offset(), page_size_ * 5);
+}
+
+}  // namespace mlio
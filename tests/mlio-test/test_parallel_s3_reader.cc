@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio/detail/s3_error.h"
+#include "mlio/streams/detail/parallel_s3_reader.h"
+
+namespace mlio {
+namespace {
+
+// Serves an in-memory object like S3_client::read_object(). Within
+// every 32 KiB, requests at lower offsets take longer so that the parts
+// that are in flight complete in reverse order. The failures to inject
+// are specified per request offset.
+class Test_object {
+public:
+    explicit Test_object(std::size_t size)
+    {
+        data_.resize(size);
+
+        std::mt19937 gen{};
+        std::generate(data_.begin(), data_.end(), [&gen] {
+            return static_cast<std::byte>(gen());
+        });
+    }
+
+    std::size_t read(std::size_t offset, Mutable_memory_span destination)
+    {
+        auto delay = static_cast<long>(0x8000 - offset % 0x8000) / 0x10;
+
+        std::this_thread::sleep_for(std::chrono::microseconds{delay});
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            num_requests_[offset]++;
+
+            auto pos = failures_.find(offset);
+            if (pos != failures_.end() && pos->second.num_failures > 0) {
+                pos->second.num_failures--;
+
+                throw detail::S3_error{std::make_error_code(std::errc::io_error),
+                                       "The S3 object cannot be accessed.",
+                                       pos->second.retryable};
+            }
+        }
+
+        std::size_t size = std::min(destination.size(), data_.size() - offset);
+
+        // Simulate a response that ends prematurely.
+        if (truncate_responses && size > 1000) {
+            size /= 2;
+        }
+
+        auto first = data_.begin() + static_cast<std::ptrdiff_t>(offset);
+
+        std::copy(first, first + static_cast<std::ptrdiff_t>(size), destination.begin());
+
+        return size;
+    }
+
+    void fail(std::size_t offset, std::size_t num_failures, bool retryable)
+    {
+        failures_[offset] = Failure{num_failures, retryable};
+    }
+
+    std::size_t num_requests(std::size_t offset)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        return num_requests_[offset];
+    }
+
+    const std::vector<std::byte> &data() const noexcept
+    {
+        return data_;
+    }
+
+    bool truncate_responses{};
+
+private:
+    struct Failure {
+        std::size_t num_failures{};
+        bool retryable{};
+    };
+
+    std::vector<std::byte> data_{};
+    std::mutex mutex_{};
+    std::map<std::size_t, Failure> failures_{};
+    std::map<std::size_t, std::size_t> num_requests_{};
+};
+
+}  // namespace
+
+class Test_parallel_s3_reader : public ::testing::Test {
+protected:
+    Test_parallel_s3_reader() = default;
+
+    ~Test_parallel_s3_reader() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+
+    std::unique_ptr<detail::Parallel_s3_reader> make_reader(std::size_t offset = 0)
+    {
+        auto read_object = [this](std::size_t o, Mutable_memory_span destination) {
+            return object_.read(o, destination);
+        };
+
+        return std::make_unique<detail::Parallel_s3_reader>(
+            std::move(read_object), object_.data().size(), offset, part_size_, num_parts_);
+    }
+
+    // Reads the rest of the object in small reads that straddle the part
+    // boundaries.
+    static std::vector<std::byte> read_all(detail::Parallel_s3_reader &reader)
+    {
+        std::vector<std::byte> output{};
+
+        std::vector<std::byte> buffer(777);
+
+        std::size_t num_bytes_read = 0;
+        while ((num_bytes_read = reader.read(make_span(buffer))) != 0) {
+            output.insert(output.end(),
+                          buffer.begin(),
+                          buffer.begin() + static_cast<std::ptrdiff_t>(num_bytes_read));
+        }
+
+        return output;
+    }
+
+    static constexpr std::size_t part_size_ = 0x2000;
+    static constexpr std::size_t num_parts_ = 4;
+
+    // An odd size so that the last part is a partial one.
+    Test_object object_{part_size_ * 20 + 123};
+};
+
+Test_parallel_s3_reader::~Test_parallel_s3_reader() = default;
+
+TEST_F(Test_parallel_s3_reader, test_parts_are_returned_in_order)
+{
+    const std::vector<std::byte> &data = object_.data();
+
+    for (std::size_t offset : {std::size_t{0}, std::size_t{5000}}) {
+        auto reader = make_reader(offset);
+
+        std::vector<std::byte> output = read_all(*reader);
+
+        ASSERT_EQ(output.size(), data.size() - offset);
+
+        EXPECT_TRUE(std::equal(
+            output.begin(), output.end(), data.begin() + static_cast<std::ptrdiff_t>(offset)));
+    }
+}
+
+TEST_F(Test_parallel_s3_reader, test_transient_errors_are_retried)
+{
+    object_.fail(part_size_, 2, true);
+    object_.fail(part_size_ * 7, 1, true);
+
+    // The rest of a part is requested again if its response ends
+    // prematurely.
+    object_.truncate_responses = true;
+
+    auto reader = make_reader();
+
+    std::vector<std::byte> output = read_all(*reader);
+
+    EXPECT_EQ(output, object_.data());
+
+    EXPECT_EQ(object_.num_requests(part_size_), 3U);
+    EXPECT_EQ(object_.num_requests(part_size_ * 7), 2U);
+}
+
+TEST_F(Test_parallel_s3_reader, test_permanent_errors_are_not_retried)
+{
+    object_.fail(part_size_ * 2, 1, false);
+
+    auto reader = make_reader();
+
+    EXPECT_THROW(read_all(*reader), detail::S3_error);
+
+    EXPECT_EQ(object_.num_requests(part_size_ * 2), 1U);
+}
+
+TEST_F(Test_parallel_s3_reader, test_retries_are_bounded)
+{
+    object_.fail(part_size_ * 3, 100, true);
+
+    auto reader = make_reader();
+
+    EXPECT_THROW(read_all(*reader), detail::S3_error);
+
+    EXPECT_EQ(object_.num_requests(part_size_ * 3), 4U);
+}
+
+}  // namespace mlio
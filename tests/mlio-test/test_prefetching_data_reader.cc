@@ -0,0 +1,221 @@
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio-test/test_data_store.h"
+
+namespace mlio {
+namespace {
+
+std::vector<std::string> read_values(Data_reader &reader)
+{
+    std::vector<std::string> values{};
+
+    Intrusive_ptr<Example> example{};
+    while ((example = reader.read_example()) != nullptr) {
+        auto tensor = static_cast<Dense_tensor *>(example->find_feature("value").get());
+
+        for (const std::string &value : tensor->data().as<std::string>()) {
+            values.emplace_back(value);
+        }
+    }
+
+    return values;
+}
+
+// Treats each data store as a single data instance without making a
+// record reader, like the image reader does for raw image files. It
+// waits for the prefetcher to pick up the second data store before
+// moving on so that the prefetched data store is the one passed to the
+// factory.
+class Store_id_reader final : public Parallel_data_reader {
+public:
+    explicit Store_id_reader(Data_reader_params params, const Test_data_store &second_store)
+        : Parallel_data_reader{std::move(params)}, second_store_{&second_store}
+    {}
+
+    Store_id_reader(const Store_id_reader &) = delete;
+
+    Store_id_reader &operator=(const Store_id_reader &) = delete;
+
+    Store_id_reader(Store_id_reader &&) = delete;
+
+    Store_id_reader &operator=(Store_id_reader &&) = delete;
+
+    ~Store_id_reader() final;
+
+private:
+    Intrusive_ptr<Record_reader> make_record_reader(const Data_store &store) final
+    {
+        if (store != *second_store_ && second_store_->num_opens() == 0) {
+            second_store_->wait_for_opens(1);
+        }
+
+        return nullptr;
+    }
+
+    Intrusive_ptr<const Schema> infer_schema(const std::optional<Instance> &) final
+    {
+        std::vector<Attribute> attrs{};
+        attrs.emplace_back("value", Data_type::string, Size_vector{params().batch_size, 1});
+
+        return make_intrusive<Schema>(std::move(attrs));
+    }
+
+    Intrusive_ptr<Example> decode(const Instance_batch &batch) const final
+    {
+        auto tensor = make_intrusive<Dense_tensor>(
+            Size_vector{batch.size(), 1}, make_cpu_array(Data_type::string, batch.size()));
+
+        auto row_pos = tensor->data().as<std::string>().begin();
+        for (const Instance &instance : batch.instances()) {
+            *row_pos++ = instance.data_store().id();
+        }
+
+        std::vector<Intrusive_ptr<Tensor>> tensors{};
+        tensors.emplace_back(std::move(tensor));
+
+        return make_intrusive<Example>(schema(), std::move(tensors));
+    }
+
+    const Test_data_store *second_store_;
+};
+
+Store_id_reader::~Store_id_reader()
+{
+    stop();
+}
+
+}  // namespace
+
+class Test_prefetching_data_reader : public ::testing::Test {
+protected:
+    Test_prefetching_data_reader() = default;
+
+    ~Test_prefetching_data_reader() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+
+    void SetUp() override
+    {
+        for (std::size_t i = 0; i < num_stores_; i++) {
+            std::string id = "store-" + std::to_string(i);
+
+            std::string text = id + " line-0\n" + id + " line-1\n";
+
+            auto store = make_intrusive<Test_data_store>(std::move(id), std::move(text));
+
+            stores_.emplace_back(store.get());
+
+            dataset_.emplace_back(std::move(store));
+        }
+    }
+
+    Data_reader_params make_params() const
+    {
+        Data_reader_params params{};
+        params.dataset = dataset_;
+        params.batch_size = 1;
+        params.num_prefetched_data_stores = num_prefetched_stores_;
+
+        return params;
+    }
+
+    std::vector<std::string> expected_lines() const
+    {
+        std::vector<std::string> lines{};
+        for (const Test_data_store *store : stores_) {
+            lines.emplace_back(store->id() + " line-0");
+            lines.emplace_back(store->id() + " line-1");
+        }
+
+        return lines;
+    }
+
+    static constexpr std::size_t num_stores_ = 6;
+    static constexpr std::size_t num_prefetched_stores_ = 2;
+
+    std::vector<Intrusive_ptr<Data_store>> dataset_{};
+    std::vector<Test_data_store *> stores_{};
+};
+
+Test_prefetching_data_reader::~Test_prefetching_data_reader() = default;
+
+TEST_F(Test_prefetching_data_reader, test_reader_reads_more_stores_than_prefetched)
+{
+    auto reader = make_intrusive<Text_line_reader>(make_params());
+
+    EXPECT_EQ(read_values(*reader), expected_lines());
+
+    // Every data store is opened exactly once, either by the prefetcher
+    // or by the reader itself.
+    for (const Test_data_store *store : stores_) {
+        EXPECT_EQ(store->num_opens(), 1U) << store->id();
+    }
+}
+
+TEST_F(Test_prefetching_data_reader, test_reader_reads_all_stores_after_reset)
+{
+    auto reader = make_intrusive<Text_line_reader>(make_params());
+
+    for (std::size_t i = 0; i < 3; i++) {
+        ASSERT_NE(reader->read_example(), nullptr);
+    }
+
+    // Reset while the upcoming data stores are being prefetched.
+    reader->reset();
+
+    EXPECT_EQ(read_values(*reader), expected_lines());
+}
+
+TEST_F(Test_prefetching_data_reader, test_reader_reports_open_error_of_prefetched_store)
+{
+    stores_[3]->fail();
+
+    auto reader = make_intrusive<Text_line_reader>(make_params());
+
+    try {
+        read_values(*reader);
+
+        FAIL() << "The open error was not reported.";
+    }
+    catch (const Data_reader_error &e) {
+        EXPECT_EQ(std::string{e.what()}, "The data store 'store-3' does not exist.");
+    }
+}
+
+TEST_F(Test_prefetching_data_reader, test_prefetching_stops_if_factory_does_not_read_store)
+{
+    auto reader = make_intrusive<Store_id_reader>(make_params(), *stores_[1]);
+
+    std::vector<std::string> ids{};
+    for (const Test_data_store *store : stores_) {
+        ids.emplace_back(store->id());
+    }
+
+    EXPECT_EQ(read_values(*reader), ids);
+
+    // The instance reader opens every data store itself to read it as a
+    // single instance; the second data store is additionally opened by
+    // the prefetcher.
+    EXPECT_EQ(stores_[0]->num_opens(), 1U);
+    EXPECT_EQ(stores_[1]->num_opens(), 2U);
+
+    // The reader drops the prefetcher once it sees that the factory did
+    // not take the prefetched stream of the second data store, so the
+    // data stores beyond the ones scheduled at that point are opened
+    // only once.
+    for (std::size_t i = 2 + num_prefetched_stores_; i < num_stores_; i++) {
+        EXPECT_EQ(stores_[i]->num_opens(), 1U) << stores_[i]->id();
+    }
+}
+
+}  // namespace mlio
@@ -1,3 +1,12 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <mlio.h>
 
@@ -9,6 +18,34 @@ protected:
 
     ~Test_recordio_protobuf_reader() override;
 
+    // Re-frames the records of the specified RecordIO file by splitting
+    // the payload of each record into the specified number of parts.
+    static Memory_slice split_records(const std::string &path, std::size_t num_parts);
+
+    static std::vector<std::vector<float>> read_values(Data_reader_params prm);
+
+    // Frames the specified payloads as complete RecordIO records.
+    static Memory_slice frame_records(const std::vector<std::string> &payloads);
+
+    // Helpers that encode Protocol Buffers fields in their wire format.
+    static void append_varint(std::string &message, std::uint64_t value);
+
+    static void append_tag(std::string &message, std::uint32_t field_number, std::uint32_t wire_type);
+
+    static void append_fixed32(std::string &message, float value);
+
+    static void
+    append_field(std::string &message, std::uint32_t field_number, const std::string &value);
+
+    static std::string pack_floats(const std::vector<float> &values);
+
+    static std::string pack_varints(const std::vector<std::int64_t> &values);
+
+    // Makes a record that has a single feature whose value is the
+    // specified tensor message stored in the specified field of Value.
+    static std::string
+    make_record(const std::string &name, std::uint32_t value_field, const std::string &tensor);
+
 protected:
     std::string const resources_path_ = "../resources/recordio/";
     std::string const complete_records_path_ = resources_path_ + "complete_records.pr";
@@ -18,6 +55,190 @@ protected:
 
 Test_recordio_protobuf_reader::~Test_recordio_protobuf_reader() = default;
 
+Memory_slice Test_recordio_protobuf_reader::split_records(const std::string &path,
+                                                          std::size_t num_parts)
+{
+    std::ifstream file{path, std::ios::binary};
+
+    std::vector<char> source{std::istreambuf_iterator<char>{file},
+                             std::istreambuf_iterator<char>{}};
+
+    std::vector<char> target{};
+
+    auto append_record = [&target](std::uint32_t flag, const char *payload, std::size_t size) {
+        std::uint32_t magic = 0xced7230a;
+        std::uint32_t header = (flag << 29) | static_cast<std::uint32_t>(size);
+
+        target.insert(target.end(), reinterpret_cast<const char *>(&magic),
+                      reinterpret_cast<const char *>(&magic) + sizeof(magic));
+        target.insert(target.end(), reinterpret_cast<const char *>(&header),
+                      reinterpret_cast<const char *>(&header) + sizeof(header));
+
+        target.insert(target.end(), payload, payload + size);
+
+        target.resize((target.size() + 3) & ~std::size_t{3});
+    };
+
+    std::size_t pos = 0;
+    while (pos + 8 <= source.size()) {
+        std::uint32_t header{};
+        std::memcpy(&header, source.data() + pos + 4, sizeof(header));
+
+        std::size_t size = header & ((1U << 29) - 1);
+
+        const char *payload = source.data() + pos + 8;
+
+        std::size_t part_size = (size + num_parts - 1) / num_parts;
+
+        for (std::size_t part_offset = 0; part_offset < size; part_offset += part_size) {
+            std::uint32_t flag{};
+            if (part_offset == 0) {
+                flag = 1;  // begin
+            }
+            else if (part_offset + part_size >= size) {
+                flag = 3;  // end
+            }
+            else {
+                flag = 2;  // middle
+            }
+
+            append_record(flag, payload + part_offset, std::min(part_size, size - part_offset));
+        }
+
+        pos += 8 + ((size + 3) & ~std::size_t{3});
+    }
+
+    auto block = make_intrusive<Heap_memory_block>(target.size());
+
+    std::transform(target.begin(), target.end(), block->begin(), [](char c) {
+        return static_cast<std::byte>(c);
+    });
+
+    return Memory_slice{block};
+}
+
+std::vector<std::vector<float>>
+Test_recordio_protobuf_reader::read_values(Data_reader_params prm)
+{
+    prm.batch_size = 1;
+
+    auto reader = make_intrusive<Recordio_protobuf_reader>(prm);
+
+    std::vector<std::vector<float>> values{};
+
+    Intrusive_ptr<Example> exm;
+    while ((exm = reader->read_example()) != nullptr) {
+        auto tsr = static_cast<Dense_tensor *>(exm->find_feature("values").get());
+
+        EXPECT_EQ(tsr->data_type(), Data_type::float32);
+
+        auto data = tsr->data().as<float>();
+
+        values.emplace_back(data.begin(), data.end());
+    }
+
+    return values;
+}
+
+Memory_slice Test_recordio_protobuf_reader::frame_records(const std::vector<std::string> &payloads)
+{
+    std::string target{};
+
+    for (const std::string &payload : payloads) {
+        std::uint32_t magic = 0xced7230a;
+        std::uint32_t header = static_cast<std::uint32_t>(payload.size());
+
+        target.append(reinterpret_cast<const char *>(&magic), sizeof(magic));
+        target.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        target += payload;
+
+        target.resize((target.size() + 3) & ~std::size_t{3});
+    }
+
+    auto block = make_intrusive<Heap_memory_block>(target.size());
+
+    std::transform(target.begin(), target.end(), block->begin(), [](char c) {
+        return static_cast<std::byte>(c);
+    });
+
+    return Memory_slice{block};
+}
+
+void Test_recordio_protobuf_reader::append_varint(std::string &message, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        message += static_cast<char>((value & 0x7f) | 0x80);
+
+        value >>= 7;
+    }
+
+    message += static_cast<char>(value);
+}
+
+void Test_recordio_protobuf_reader::append_tag(std::string &message,
+                                               std::uint32_t field_number,
+                                               std::uint32_t wire_type)
+{
+    append_varint(message, (field_number << 3) | wire_type);
+}
+
+void Test_recordio_protobuf_reader::append_fixed32(std::string &message, float value)
+{
+    std::uint32_t bits{};
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    for (std::size_t i = 0; i < sizeof(bits); i++) {
+        message += static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+}
+
+void Test_recordio_protobuf_reader::append_field(std::string &message,
+                                                 std::uint32_t field_number,
+                                                 const std::string &value)
+{
+    append_tag(message, field_number, 2);
+
+    append_varint(message, value.size());
+
+    message += value;
+}
+
+std::string Test_recordio_protobuf_reader::pack_floats(const std::vector<float> &values)
+{
+    std::string run{};
+    for (float value : values) {
+        append_fixed32(run, value);
+    }
+    return run;
+}
+
+std::string Test_recordio_protobuf_reader::pack_varints(const std::vector<std::int64_t> &values)
+{
+    std::string run{};
+    for (std::int64_t value : values) {
+        append_varint(run, static_cast<std::uint64_t>(value));
+    }
+    return run;
+}
+
+std::string Test_recordio_protobuf_reader::make_record(const std::string &name,
+                                                       std::uint32_t value_field,
+                                                       const std::string &tensor)
+{
+    std::string value{};
+    append_field(value, value_field, tensor);
+
+    std::string entry{};
+    append_field(entry, 1, name);
+    append_field(entry, 2, value);
+
+    std::string record{};
+    append_field(record, 1, entry);
+
+    return record;
+}
+
 TEST_F(Test_recordio_protobuf_reader, test_complete_records_path)
 {
     mlio::Data_reader_params prm{};
@@ -113,4 +334,312 @@ TEST_F(Test_recordio_protobuf_reader, test_corrupt_split_records_patH)
     }
 }
 
+TEST_F(Test_recordio_protobuf_reader, test_split_records_match_complete_records)
+{
+    mlio::initialize();
+
+    Data_reader_params complete_prm{};
+    complete_prm.dataset.emplace_back(make_intrusive<File>(complete_records_path_));
+
+    std::vector<std::vector<float>> expected = read_values(complete_prm);
+
+    ASSERT_FALSE(expected.empty());
+
+    // Split each payload into a begin, middle, and end record so that
+    // the instances are read as fragments and decoded piecewise.
+    Data_reader_params split_prm{};
+    split_prm.dataset.emplace_back(
+        make_intrusive<In_memory_store>(split_records(complete_records_path_, 3)));
+
+    EXPECT_EQ(read_values(split_prm), expected);
+
+    // Splits the payloads into parts of only a few bytes.
+    Data_reader_params fine_prm{};
+    fine_prm.dataset.emplace_back(
+        make_intrusive<In_memory_store>(split_records(complete_records_path_, 16)));
+
+    EXPECT_EQ(read_values(fine_prm), expected);
+}
+
+TEST_F(Test_recordio_protobuf_reader, test_split_records_with_shuffle_buffer)
+{
+    mlio::initialize();
+
+    Data_reader_params complete_prm{};
+    complete_prm.dataset.emplace_back(make_intrusive<File>(complete_records_path_));
+
+    std::vector<std::vector<float>> expected = read_values(complete_prm);
+
+    // The fragments get merged into the shuffle buffer, both with and
+    // without a memory threshold.
+    for (std::size_t threshold : {std::size_t{0}, std::size_t{0x10000000}}) {
+        Data_reader_params prm{};
+        prm.dataset.emplace_back(
+            make_intrusive<In_memory_store>(split_records(complete_records_path_, 3)));
+        prm.shuffle_instances = true;
+        prm.shuffle_window = 2;
+        prm.shuffle_buffer_memory_threshold = threshold;
+
+        std::vector<std::vector<float>> values = read_values(prm);
+
+        std::sort(values.begin(), values.end());
+
+        std::vector<std::vector<float>> sorted_expected = expected;
+
+        std::sort(sorted_expected.begin(), sorted_expected.end());
+
+        EXPECT_EQ(values, sorted_expected);
+    }
+}
+
+TEST_F(Test_recordio_protobuf_reader, test_unpacked_and_split_fields_match_packed_ones)
+{
+    mlio::initialize();
+
+    std::vector<float> values{1.5F, -2.0F, 3.25F, 4.0F, 5.0F};
+
+    std::string packed{};
+    append_field(packed, 1, pack_floats(values));
+
+    std::string unpacked{};
+    for (float value : values) {
+        append_tag(unpacked, 1, 5);
+        append_fixed32(unpacked, value);
+    }
+
+    // Two packed runs with an unpacked element in between, interleaved
+    // with unknown fields and a value with an unexpected wire type; the
+    // latter two must be skipped.
+    std::string split{};
+    append_field(split, 1, pack_floats({1.5F, -2.0F}));
+    append_tag(split, 4, 0);
+    append_varint(split, 300);
+    append_tag(split, 1, 5);
+    append_fixed32(split, 3.25F);
+    append_tag(split, 1, 0);
+    append_varint(split, 7);
+    append_tag(split, 5, 1);
+    split += std::string(8, '\x7f');
+    append_field(split, 6, "unknown");
+    append_field(split, 1, pack_floats({4.0F, 5.0F}));
+
+    Data_reader_params prm{};
+    prm.dataset.emplace_back(make_intrusive<In_memory_store>(frame_records({
+        make_record("values", 2, packed),
+        make_record("values", 2, unpacked),
+        make_record("values", 2, split),
+    })));
+
+    std::vector<std::vector<float>> expected(3, values);
+
+    EXPECT_EQ(read_values(prm), expected);
+}
+
+TEST_F(Test_recordio_protobuf_reader, test_split_sparse_fields)
+{
+    mlio::initialize();
+
+    // An Int32Tensor whose values, keys, and shape are each split into
+    // packed runs and unpacked elements. Negative int32 values are
+    // stored as sign-extended 64-bit varints.
+    std::string tensor{};
+    append_field(tensor, 1, pack_varints({-1}));
+    append_tag(tensor, 2, 0);
+    append_varint(tensor, 1);
+    append_tag(tensor, 1, 0);
+    append_varint(tensor, 2);
+    append_tag(tensor, 3, 0);
+    append_varint(tensor, 10);
+    append_field(tensor, 2, pack_varints({4, 9}));
+    append_field(tensor, 1, pack_varints({-300}));
+
+    Data_reader_params prm{};
+    prm.dataset.emplace_back(
+        make_intrusive<In_memory_store>(frame_records({make_record("ints", 7, tensor)})));
+    prm.batch_size = 1;
+
+    auto reader = make_intrusive<Recordio_protobuf_reader>(prm);
+
+    Intrusive_ptr<Example> exm = reader->read_example();
+
+    ASSERT_NE(exm, nullptr);
+
+    auto tsr = dynamic_cast<Coo_tensor *>(exm->find_feature("ints").get());
+
+    ASSERT_NE(tsr, nullptr);
+
+    EXPECT_EQ(tsr->shape(), (Size_vector{1, 10}));
+
+    auto data = tsr->data().as<std::int32_t>();
+    auto keys = tsr->indices(1).as<std::size_t>();
+
+    EXPECT_EQ(std::vector<std::int32_t>(data.begin(), data.end()),
+              (std::vector<std::int32_t>{-1, 2, -300}));
+
+    EXPECT_EQ(std::vector<std::size_t>(keys.begin(), keys.end()),
+              (std::vector<std::size_t>{1, 4, 9}));
+
+    EXPECT_EQ(reader->read_example(), nullptr);
+}
+
+TEST_F(Test_recordio_protobuf_reader, test_malformed_records)
+{
+    mlio::initialize();
+
+    std::vector<float> values{1.0F, 2.0F, 3.0F};
+
+    std::string packed{};
+    append_field(packed, 1, pack_floats(values));
+
+    std::string valid = make_record("values", 2, packed);
+
+    std::vector<std::string> records{valid};
+
+    // Every proper prefix of a record cuts a length-delimited field.
+    for (std::size_t i = 1; i < valid.size(); i++) {
+        records.emplace_back(valid.substr(0, i));
+    }
+
+    std::vector<std::string> tensors(7);
+    // A packed run of floats whose size is not a multiple of four.
+    append_field(tensors[0], 1, std::string(6, '\0'));
+    // A packed run of varints whose last varint is not terminated.
+    append_field(tensors[1], 2, "\x01\x81");
+    // A varint that is longer than ten bytes.
+    append_tag(tensors[2], 4, 0);
+    tensors[2] += std::string(10, '\x80') + '\x01';
+    // A deprecated group.
+    append_tag(tensors[3], 4, 3);
+    // A field number of zero.
+    append_tag(tensors[4], 0, 0);
+    append_varint(tensors[4], 1);
+    // A length-delimited field that is longer than its message.
+    append_tag(tensors[5], 1, 2);
+    append_varint(tensors[5], 100);
+    tensors[5] += pack_floats(values);
+    // An element that is cut short.
+    append_tag(tensors[6], 1, 5);
+    tensors[6] += "\x01\x02";
+
+    for (const std::string &tensor : tensors) {
+        records.emplace_back(make_record("values", 2, packed + tensor));
+    }
+
+    records.emplace_back(valid);
+
+    Data_reader_params prm{};
+    prm.dataset.emplace_back(make_intrusive<In_memory_store>(frame_records(records)));
+    prm.bad_example_handling = Bad_example_handling::skip;
+
+    std::vector<std::vector<float>> expected(2, values);
+
+    EXPECT_EQ(read_values(prm), expected);
+
+    prm.bad_example_handling = Bad_example_handling::error;
+
+    EXPECT_THROW(read_values(prm), Data_reader_error);
+}
+
+TEST_F(Test_recordio_protobuf_reader, test_parallel_sparse_decoding_matches_serial_decoding)
+{
+    mlio::initialize();
+
+    std::size_t batch_size = 1000;
+
+    std::size_t num_columns = 100'000;
+
+    // The reader estimates the number of values per instance from the
+    // first record; with 10,000 values the batches are well above the
+    // cut-off for parallel decoding. The remaining records have a varying
+    // number of values, including none.
+    std::vector<std::string> records{};
+    for (std::size_t i = 0; i < 2 * batch_size; i++) {
+        std::size_t num_values = i == 0 ? 10'000 : i % 7;
+
+        std::vector<float> values{};
+        std::vector<std::int64_t> keys{};
+        for (std::size_t j = 0; j < num_values; j++) {
+            values.emplace_back(static_cast<float>(i * 10 + j));
+            keys.emplace_back(static_cast<std::int64_t>((i * 13 + j * 101) % num_columns));
+        }
+
+        std::string tensor{};
+        append_field(tensor, 1, pack_floats(values));
+        append_field(tensor, 2, pack_varints(keys));
+        append_field(tensor, 3, pack_varints({static_cast<std::int64_t>(num_columns)}));
+
+        records.emplace_back(make_record("values", 2, tensor));
+    }
+
+    Memory_slice data = frame_records(records);
+
+    auto read_tensors = [&data, batch_size](Bad_example_handling handling) {
+        Data_reader_params prm{};
+        prm.dataset.emplace_back(make_intrusive<In_memory_store>(data));
+        prm.batch_size = batch_size;
+        prm.bad_example_handling = handling;
+
+        auto reader = make_intrusive<Recordio_protobuf_reader>(prm);
+
+        std::vector<Intrusive_ptr<Tensor>> tensors{};
+
+        Intrusive_ptr<Example> exm;
+        while ((exm = reader->read_example()) != nullptr) {
+            tensors.emplace_back(exm->find_feature("values"));
+        }
+
+        return tensors;
+    };
+
+    // The pad mode always decodes serially.
+    std::vector<Intrusive_ptr<Tensor>> parallel_tensors = read_tensors(Bad_example_handling::error);
+    std::vector<Intrusive_ptr<Tensor>> serial_tensors = read_tensors(Bad_example_handling::pad);
+
+    ASSERT_EQ(parallel_tensors.size(), 2U);
+    ASSERT_EQ(serial_tensors.size(), 2U);
+
+    for (std::size_t i = 0; i < parallel_tensors.size(); i++) {
+        auto *parallel = dynamic_cast<Coo_tensor *>(parallel_tensors[i].get());
+        auto *serial = dynamic_cast<Coo_tensor *>(serial_tensors[i].get());
+
+        ASSERT_NE(parallel, nullptr);
+        ASSERT_NE(serial, nullptr);
+
+        EXPECT_EQ(parallel->shape(), (Size_vector{batch_size, num_columns}));
+
+        auto parallel_data = parallel->data().as<float>();
+        auto serial_data = serial->data().as<float>();
+
+        EXPECT_TRUE(std::equal(parallel_data.begin(),
+                               parallel_data.end(),
+                               serial_data.begin(),
+                               serial_data.end()));
+
+        for (std::size_t dim = 0; dim < 2; dim++) {
+            auto parallel_indices = parallel->indices(dim).as<std::size_t>();
+            auto serial_indices = serial->indices(dim).as<std::size_t>();
+
+            EXPECT_TRUE(std::equal(parallel_indices.begin(),
+                                   parallel_indices.end(),
+                                   serial_indices.begin(),
+                                   serial_indices.end()));
+        }
+
+        // The rows must be in order and each row must have as many
+        // values as its record.
+        auto rows = parallel->indices(0).as<std::size_t>();
+
+        EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end()));
+
+        for (std::size_t row = 0; row < batch_size; row++) {
+            std::size_t record_idx = i * batch_size + row;
+
+            std::size_t num_values = record_idx == 0 ? 10'000 : record_idx % 7;
+
+            EXPECT_EQ(static_cast<std::size_t>(std::count(rows.begin(), rows.end(), row)),
+                      num_values);
+        }
+    }
+}
+
 }  // namespace mlio
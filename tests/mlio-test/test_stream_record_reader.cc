@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mlio.h>
+
+#include "mlio-test/temp_dir.h"
+
+namespace mlio {
+namespace {
+
+// Serves the specified text in small reads. Reads beyond the slow
+// offset are delayed to simulate a high-latency stream.
+class Test_input_stream final : public Input_stream {
+public:
+    explicit Test_input_stream(std::string text) noexcept : text_{std::move(text)}
+    {}
+
+    Test_input_stream(const Test_input_stream &) = delete;
+
+    Test_input_stream &operator=(const Test_input_stream &) = delete;
+
+    Test_input_stream(Test_input_stream &&) = delete;
+
+    Test_input_stream &operator=(Test_input_stream &&) = delete;
+
+    ~Test_input_stream() final;
+
+    std::size_t read(Mutable_memory_span destination) final
+    {
+        if (position_ >= fail_offset) {
+            throw Stream_error{"The stream has failed."};
+        }
+
+        std::size_t size = std::min({destination.size(), max_read_size, text_.size() - position_});
+
+        auto first = text_.begin() + static_cast<std::ptrdiff_t>(position_);
+        auto last = first + static_cast<std::ptrdiff_t>(size);
+
+        std::transform(first, last, destination.begin(), [](char c) {
+            return static_cast<std::byte>(c);
+        });
+
+        if (position_ >= slow_offset) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+            num_slow_reads_++;
+        }
+
+        position_ += size;
+
+        return size;
+    }
+
+    Memory_slice read(std::size_t) final
+    {
+        throw Not_supported_error{"The stream does not support zero-copy reading."};
+    }
+
+    void seek(std::size_t position) final
+    {
+        position_ = std::min(position, text_.size());
+    }
+
+    void close() noexcept final
+    {}
+
+    std::size_t size() const final
+    {
+        return text_.size();
+    }
+
+    std::size_t position() const final
+    {
+        return position_;
+    }
+
+    bool closed() const noexcept final
+    {
+        return false;
+    }
+
+    bool seekable() const noexcept final
+    {
+        return true;
+    }
+
+    bool supports_zero_copy() const noexcept final
+    {
+        return false;
+    }
+
+    std::size_t num_slow_reads() const noexcept
+    {
+        return num_slow_reads_;
+    }
+
+    std::size_t max_read_size = 1000;
+    std::size_t slow_offset = std::string::npos;
+    std::size_t fail_offset = std::string::npos;
+
+private:
+    std::string text_;
+    std::size_t position_{};
+    std::atomic_size_t num_slow_reads_{};
+};
+
+Test_input_stream::~Test_input_stream() = default;
+
+// Reads newline-terminated records.
+class Line_record_reader final : public Stream_record_reader {
+public:
+    explicit Line_record_reader(Intrusive_ptr<Input_stream> stream)
+        : Stream_record_reader{std::move(stream)}
+    {}
+
+private:
+    std::optional<Record> decode_record(Memory_slice &chunk, bool ignore_leftover) final
+    {
+        auto pos = std::find(chunk.begin(), chunk.end(), std::byte{'\n'});
+        if (pos == chunk.end()) {
+            if (ignore_leftover || chunk.empty()) {
+                return {};
+            }
+
+            throw Corrupt_record_error{"The last line has no newline."};
+        }
+
+        auto size = static_cast<std::size_t>(pos - chunk.begin());
+
+        Record record{chunk.first(size)};
+
+        chunk = chunk.subslice(size + 1);
+
+        return record;
+    }
+};
+
+std::string as_string(const Record &record)
+{
+    std::string str(record.payload().size(), '\0');
+
+    std::transform(record.payload().begin(), record.payload().end(), str.begin(), [](auto b) {
+        return static_cast<char>(b);
+    });
+
+    return str;
+}
+
+}  // namespace
+
+class Test_stream_record_reader : public ::testing::Test {
+protected:
+    Test_stream_record_reader() = default;
+
+    ~Test_stream_record_reader() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+
+    static std::vector<std::string> make_lines(std::size_t num_lines)
+    {
+        std::vector<std::string> lines{};
+        for (std::size_t i = 0; i < num_lines; i++) {
+            std::size_t size = 10 + i % 50;
+            // Records that do not fit into the space reserved for the
+            // leftover of the previous chunk.
+            if (i % 997 == 0) {
+                size = 3000;
+            }
+            // A record that does not fit into a single chunk.
+            if (i == 5000) {
+                size = 20000;
+            }
+            lines.emplace_back(size, static_cast<char>('a' + i % 26));
+        }
+        return lines;
+    }
+
+    static std::string join(const std::vector<std::string> &lines)
+    {
+        std::string text{};
+        for (const std::string &line : lines) {
+            text += line;
+            text += '\n';
+        }
+        return text;
+    }
+};
+
+Test_stream_record_reader::~Test_stream_record_reader() = default;
+
+TEST_F(Test_stream_record_reader, test_records_are_read_across_read_ahead_chunks)
+{
+    std::vector<std::string> lines = make_lines(20000);
+
+    auto stream = make_intrusive<Test_input_stream>(join(lines));
+
+    Line_record_reader reader{stream};
+
+    // Use small chunks so that most of them are read ahead.
+    reader.set_chunk_size_bounds(4096, 4096);
+
+    for (std::size_t i = 0; i < 2; i++) {
+        std::size_t num_lines = 0;
+
+        std::optional<Record> record{};
+        while ((record = reader.read_record()) != std::nullopt) {
+            ASSERT_LT(num_lines, lines.size());
+
+            ASSERT_EQ(as_string(*record), lines[num_lines]);
+
+            num_lines++;
+        }
+
+        EXPECT_EQ(num_lines, lines.size());
+
+        reader.seek(0);
+    }
+}
+
+TEST_F(Test_stream_record_reader, test_seek_during_read_ahead)
+{
+    std::vector<std::string> lines = make_lines(2000);
+
+    auto stream = make_intrusive<Test_input_stream>(join(lines));
+
+    Line_record_reader reader{stream};
+
+    reader.set_chunk_size_bounds(4096, 4096);
+
+    std::vector<std::size_t> offsets{};
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        reader.read_record();
+
+        offsets.emplace_back(reader.record_offset());
+    }
+
+    // Jump back and forth while chunks are being read ahead.
+    for (std::size_t i : std::initializer_list<std::size_t>{1500, 10, 1999, 700}) {
+        reader.seek(offsets[i]);
+
+        for (std::size_t j = i; j < std::min(i + 300, lines.size()); j++) {
+            std::optional<Record> record = reader.read_record();
+
+            ASSERT_NE(record, std::nullopt);
+
+            EXPECT_EQ(as_string(*record), lines[j]);
+        }
+    }
+}
+
+TEST_F(Test_stream_record_reader, test_read_ahead_error_is_propagated)
+{
+    std::vector<std::string> lines = make_lines(20000);
+
+    auto stream = make_intrusive<Test_input_stream>(join(lines));
+
+    stream->fail_offset = 100000;
+
+    Line_record_reader reader{stream};
+
+    reader.set_chunk_size_bounds(4096, 4096);
+
+    std::size_t num_lines = 0;
+
+    EXPECT_THROW(
+        {
+            while (reader.read_record() != std::nullopt) {
+                num_lines++;
+            }
+        },
+        Stream_error);
+
+    EXPECT_GT(num_lines, 0U);
+}
+
+TEST_F(Test_stream_record_reader, test_destruction_does_not_wait_for_read_ahead)
+{
+    std::size_t chunk_size = 0x10'0000;
+
+    std::vector<std::string> lines(0x10'0000 / 25, std::string(99, 'x'));
+
+    auto stream = make_intrusive<Test_input_stream>(join(lines));
+
+    // Every read beyond the second chunk takes a millisecond; reading a
+    // whole chunk would take about a quarter of a second.
+    stream->max_read_size = 4096;
+    stream->slow_offset = chunk_size * 2;
+
+    {
+        Line_record_reader reader{stream};
+
+        reader.set_chunk_size_bounds(chunk_size, chunk_size);
+
+        // Read into the second chunk so that the third one is being
+        // read ahead.
+        while (reader.read_record() != std::nullopt) {
+            if (reader.position() > chunk_size + 0x1000) {
+                break;
+            }
+        }
+
+        while (stream->num_slow_reads() == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::size_t num_slow_reads = stream->num_slow_reads();
+
+    EXPECT_LT(num_slow_reads, 32U);
+
+    // The stream is not read anymore once the reader is gone.
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    EXPECT_EQ(stream->num_slow_reads(), num_slow_reads);
+}
+
+TEST_F(Test_stream_record_reader, test_direct_io_chunks_are_aligned)
+{
+    Temp_dir temp_dir{};
+
+    std::string path = temp_dir.path("test_stream_record_reader.txt");
+
+    // Records of exactly one page; if the chunks are read at aligned
+    // addresses, so is every record.
+    std::vector<std::string> lines(2048);
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        lines[i] = std::string(0xfff, static_cast<char>('a' + i % 26));
+    }
+
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << join(lines);
+    }
+
+    File file{path, File_options{false, Compression::none, File_io_method::direct}};
+
+    // Unlike the file-backed allocator, the heap allocator does not
+    // return page-aligned blocks.
+    for (bool use_heap : {true, false}) {
+        if (use_heap) {
+            set_memory_allocator(std::make_unique<Heap_memory_allocator>());
+        }
+        else {
+            set_memory_allocator(std::make_unique<File_backed_memory_allocator>());
+        }
+
+        Line_record_reader reader{file.open_read()};
+
+        reader.set_chunk_size_bounds(0x10'0000, 0x10'0000);
+
+        std::size_t num_lines = 0;
+
+        std::optional<Record> record{};
+        while ((record = reader.read_record()) != std::nullopt) {
+            ASSERT_LT(num_lines, lines.size());
+
+            auto address = reinterpret_cast<std::uintptr_t>(record->payload().data());
+
+            EXPECT_EQ(address % 0x1000, 0U);
+
+            ASSERT_EQ(as_string(*record), lines[num_lines]);
+
+            num_lines++;
+        }
+
+        EXPECT_EQ(num_lines, lines.size());
+    }
+}
+
+}  // namespace mlio
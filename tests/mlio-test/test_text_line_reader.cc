@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <mlio.h>
 
@@ -91,4 +96,61 @@ TEST_F(Test_text_line_reader, test_text_line_reader_batch_less_than_features)
     EXPECT_TRUE(true);
 }
 
+TEST_F(Test_text_line_reader, test_text_line_reader_shuffle_buffer_spilled_to_file)
+{
+    mlio::Data_reader_params prm{};
+    prm.dataset.emplace_back(mlio::make_intrusive<mlio::File>(file_path_));
+    prm.batch_size = 1;
+    prm.shuffle_instances = true;
+    prm.shuffle_window = 2;
+    prm.shuffle_buffer_memory_threshold = 0;
+
+    auto reader = mlio::make_intrusive<mlio::Text_line_reader>(prm);
+    for (auto i = 0; i < 2; i++) {
+        std::vector<std::string> lines{};
+
+        mlio::Intrusive_ptr<mlio::Example> exm;
+        while ((exm = reader->read_example()) != nullptr) {
+            auto lbl = static_cast<Dense_tensor *>(exm->find_feature("value").get());
+            lines.emplace_back(lbl->data().as<std::string>()[0]);
+        }
+        reader->reset();
+
+        std::sort(lines.begin(), lines.end());
+
+        std::vector<std::string> expected{expected_line_1_, expected_line_2_, expected_line_3_};
+
+        EXPECT_EQ(lines, expected);
+    }
+}
+
+TEST_F(Test_text_line_reader, test_text_line_reader_small_chunks)
+{
+    mlio::Data_reader_params prm{};
+    prm.dataset.emplace_back(mlio::make_intrusive<mlio::File>(file_path_));
+    prm.batch_size = 3;
+    prm.max_chunk_size = 16;
+
+    auto reader = mlio::make_intrusive<mlio::Text_line_reader>(prm);
+
+    auto exm = reader->read_example();
+    ASSERT_NE(exm, nullptr);
+
+    auto lbl = static_cast<Dense_tensor *>(exm->find_feature("value").get());
+    auto strings = lbl->data().as<std::string>();
+    EXPECT_EQ(strings[0], expected_line_1_);
+    EXPECT_EQ(strings[1], expected_line_2_);
+    EXPECT_EQ(strings[2], expected_line_3_);
+}
+
+TEST_F(Test_text_line_reader, test_text_line_reader_inverted_chunk_size_bounds)
+{
+    mlio::Data_reader_params prm{};
+    prm.dataset.emplace_back(mlio::make_intrusive<mlio::File>(file_path_));
+    prm.min_chunk_size = 0x20'0000;
+    prm.max_chunk_size = 0x10'0000;
+
+    EXPECT_THROW(mlio::make_intrusive<mlio::Text_line_reader>(prm), std::invalid_argument);
+}
+
 }  // namespace mlio
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <iconv.h>
+#include <mlio.h>
+
+#include "mlio/endian.h"
+#include "mlio/streams/detail/text_converter.h"
+
+namespace mlio {
+namespace {
+
+using detail::Conversion_status;
+using detail::make_text_converter;
+
+constexpr bool host_is_little_endian = MLIO_BYTE_ORDER_HOST == MLIO_BYTE_ORDER_LITTLE;
+
+// Converts the specified text from one encoding to another using iconv.
+std::string iconv_convert(const std::string &text, const char *from, const char *to)
+{
+    ::iconv_t desc = ::iconv_open(to, from);
+    if (desc == reinterpret_cast<::iconv_t>(-1)) {
+        ADD_FAILURE() << "iconv does not support the conversion from " << from << " to " << to;
+
+        return {};
+    }
+
+    std::string output(text.size() * 4 + 4, '\0');
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    auto i_data = const_cast<char *>(text.data());
+    auto i_left = text.size();
+
+    auto o_data = output.data();
+    auto o_left = output.size();
+
+    std::size_t r = ::iconv(desc, &i_data, &i_left, &o_data, &o_left);
+
+    ::iconv_close(desc);
+
+    EXPECT_NE(static_cast<std::ptrdiff_t>(r), -1) << "iconv failed to convert from " << from;
+
+    output.resize(output.size() - o_left);
+
+    return output;
+}
+
+std::string encode(const std::string &utf8, const char *encoding)
+{
+    return iconv_convert(utf8, "UTF-8", encoding);
+}
+
+std::string decode_with_iconv(const std::string &bytes, const char *encoding)
+{
+    return iconv_convert(bytes, encoding, "UTF-8");
+}
+
+// Reads the specified bytes through a UTF-8 stream in reads of the
+// specified size.
+std::string
+decode(const std::string &bytes, const char *encoding, std::size_t read_size = 0x1'0000)
+{
+    auto block = make_intrusive<Heap_memory_block>(bytes.size());
+
+    std::transform(bytes.begin(), bytes.end(), block->begin(), [](char c) {
+        return static_cast<std::byte>(c);
+    });
+
+    auto stream = make_utf8_stream(make_intrusive<Memory_input_stream>(std::move(block)),
+                                   Text_encoding{encoding});
+
+    std::string output{};
+
+    std::vector<std::byte> buffer(read_size);
+
+    std::size_t num_bytes_read = 0;
+    while ((num_bytes_read = stream->read(make_span(buffer))) != 0) {
+        auto first = reinterpret_cast<const char *>(buffer.data());
+
+        output.append(first, num_bytes_read);
+    }
+
+    return output;
+}
+
+// Converts the specified bytes in two calls split at the specified
+// position, the way Utf8_input_stream does when the bytes span two
+// buffer refills.
+std::string decode_split(const std::string &bytes, const char *encoding, std::size_t split)
+{
+    auto converter = make_text_converter(Text_encoding{encoding});
+
+    std::string output(bytes.size() * 2, '\0');
+
+    auto all = as_span<const std::byte>(make_span(bytes));
+
+    Mutable_memory_span out = as_span<std::byte>(make_span(output));
+
+    Memory_span inp = all.first(split);
+
+    Conversion_status s = converter->convert(inp, out);
+
+    // The bytes of a partial character are left in the input.
+    std::size_t num_leftover_bytes = inp.size();
+    if (s == Conversion_status::incomplete_char) {
+        EXPECT_NE(num_leftover_bytes, 0U) << "split=" << split;
+    }
+    else {
+        EXPECT_EQ(s, Conversion_status::ok) << "split=" << split;
+        EXPECT_EQ(num_leftover_bytes, 0U) << "split=" << split;
+    }
+
+    inp = all.subspan(split - num_leftover_bytes);
+
+    s = converter->convert(inp, out);
+
+    EXPECT_EQ(s, Conversion_status::ok) << "split=" << split;
+    EXPECT_TRUE(inp.empty()) << "split=" << split;
+
+    output.resize(output.size() - out.size());
+
+    return output;
+}
+
+// Mixes runs of ASCII characters that are long enough to be converted in
+// blocks with two, three, and four byte characters, including characters
+// that are encoded as surrogate pairs in UTF-16.
+std::string make_text()
+{
+    std::string text{};
+    for (int i = 0; i < 20; i++) {
+        text += "The quick brown fox jumps over the lazy dog, ";
+        text += "Grüße aus Köln; ";
+        text += "0123456789abcdef€";
+        text += "\xF0\x9F\x98\x80";  // U+1F600
+        text += std::string(static_cast<std::size_t>(i), 'x');
+        text += "日本語のテキスト\n";
+    }
+    return text;
+}
+
+}  // namespace
+
+class Test_unicode_converter : public ::testing::Test {
+protected:
+    Test_unicode_converter() = default;
+
+    ~Test_unicode_converter() override;
+
+    static void SetUpTestSuite()
+    {
+        mlio::initialize();
+    }
+};
+
+Test_unicode_converter::~Test_unicode_converter() = default;
+
+TEST_F(Test_unicode_converter, test_utf16_and_utf32_match_iconv)
+{
+    std::string text = make_text();
+
+    for (const char *encoding : {"UTF-16LE", "UTF-16BE", "UTF-32LE", "UTF-32BE"}) {
+        std::string bytes = encode(text, encoding);
+
+        EXPECT_EQ(decode_with_iconv(bytes, encoding), text) << encoding;
+
+        EXPECT_EQ(decode(bytes, encoding), text) << encoding;
+    }
+}
+
+TEST_F(Test_unicode_converter, test_small_reads)
+{
+    std::string text = make_text();
+
+    for (const char *encoding : {"UTF-16LE", "UTF-32BE"}) {
+        std::string bytes = encode(text, encoding);
+
+        // Reads smaller than a UTF-8 character go through an internal
+        // buffer.
+        for (std::size_t read_size = 1; read_size <= 5; read_size++) {
+            EXPECT_EQ(decode(bytes, encoding, read_size), text)
+                << encoding << " read_size=" << read_size;
+        }
+    }
+}
+
+TEST_F(Test_unicode_converter, test_generic_utf16_and_utf32_with_bom)
+{
+    std::string text = make_text();
+
+    std::vector<std::pair<const char *, const char *>> encodings{
+        {"UTF-16", "UTF-16LE"},
+        {"UTF-16", "UTF-16BE"},
+        {"UTF-32", "UTF-32LE"},
+        {"UTF-32", "UTF-32BE"},
+    };
+
+    for (auto [generic, encoding] : encodings) {
+        // A leading BOM specifies the byte order and is consumed.
+        std::string bytes = encode("\xEF\xBB\xBF" + text, encoding);
+
+        EXPECT_EQ(decode_with_iconv(bytes, generic), text) << encoding;
+
+        EXPECT_EQ(decode(bytes, generic), text) << encoding;
+    }
+}
+
+TEST_F(Test_unicode_converter, test_generic_utf16_and_utf32_without_bom)
+{
+    std::string text = make_text();
+
+    // Without a BOM the text is in the byte order of the host.
+    std::vector<std::pair<const char *, const char *>> encodings{};
+    if (host_is_little_endian) {
+        encodings = {{"UTF-16", "UTF-16LE"}, {"UTF-32", "UTF-32LE"}};
+    }
+    else {
+        encodings = {{"UTF-16", "UTF-16BE"}, {"UTF-32", "UTF-32BE"}};
+    }
+
+    for (auto [generic, encoding] : encodings) {
+        std::string bytes = encode(text, encoding);
+
+        EXPECT_EQ(decode_with_iconv(bytes, generic), text) << encoding;
+
+        EXPECT_EQ(decode(bytes, generic), text) << encoding;
+    }
+
+    // A BOM that does not come first is a regular character.
+    std::string bytes = encode("abc\xEF\xBB\xBF", encodings[0].second);
+
+    EXPECT_EQ(decode(bytes, "UTF-16"), "abc\xEF\xBB\xBF");
+}
+
+TEST_F(Test_unicode_converter, test_explicit_byte_order_keeps_bom)
+{
+    std::string bytes = encode("\xEF\xBB\xBF" "abc", "UTF-16LE");
+
+    EXPECT_EQ(decode_with_iconv(bytes, "UTF-16LE"), "\xEF\xBB\xBF" "abc");
+
+    EXPECT_EQ(decode(bytes, "UTF-16LE"), "\xEF\xBB\xBF" "abc");
+}
+
+TEST_F(Test_unicode_converter, test_latin1_matches_iconv)
+{
+    std::string bytes{};
+
+    // Every character, with runs of ASCII characters in between.
+    for (int c = 1; c < 0x100; c++) {
+        bytes += static_cast<char>(c);
+        if (c % 0x20 == 0) {
+            bytes += "0123456789abcdef0123456789abcdef";
+        }
+    }
+
+    std::string expected = decode_with_iconv(bytes, "ISO-8859-1");
+
+    EXPECT_EQ(expected.size(), bytes.size() + 0x80);
+
+    EXPECT_EQ(decode(bytes, "ISO-8859-1"), expected);
+    EXPECT_EQ(decode(bytes, "latin1"), expected);
+}
+
+TEST_F(Test_unicode_converter, test_surrogate_pairs)
+{
+    // U+10000, U+1F600, and U+10FFFF.
+    std::string le{"\x00\xD8\x00\xDC" "\x3D\xD8\x00\xDE" "\xFF\xDB\xFF\xDF", 12};
+    std::string be{"\xD8\x00\xDC\x00" "\xD8\x3D\xDE\x00" "\xDB\xFF\xDF\xFF", 12};
+
+    std::string expected = "\xF0\x90\x80\x80" "\xF0\x9F\x98\x80" "\xF4\x8F\xBF\xBF";
+
+    EXPECT_EQ(decode(le, "UTF-16LE"), expected);
+    EXPECT_EQ(decode(be, "UTF-16BE"), expected);
+
+    EXPECT_EQ(decode_with_iconv(le, "UTF-16LE"), expected);
+}
+
+TEST_F(Test_unicode_converter, test_invalid_utf16_raises_error)
+{
+    std::vector<std::string> invalid_sequences{
+        // A high surrogate followed by a regular character.
+        std::string{"a\x00\x00\xD8" "b\x00", 6},
+        // A high surrogate followed by another high surrogate.
+        std::string{"\x00\xD8\x00\xD8", 4},
+        // A low surrogate that comes first.
+        std::string{"a\x00\x00\xDC\x00\xD8", 6},
+        // A high surrogate at the end of the text.
+        std::string{"a\x00\x00\xD8", 4},
+        // A partial code unit at the end of the text.
+        std::string{"a\x00" "b", 3},
+    };
+
+    for (const std::string &bytes : invalid_sequences) {
+        EXPECT_THROW(decode(bytes, "UTF-16LE"), Stream_error);
+    }
+}
+
+TEST_F(Test_unicode_converter, test_invalid_utf32_raises_error)
+{
+    std::vector<std::string> invalid_sequences{
+        // Above U+10FFFF.
+        std::string{"\x00\x00\x11\x00", 4},
+        std::string{"\xFF\xFF\xFF\xFF", 4},
+        // A surrogate.
+        std::string{"\x00\xD8\x00\x00", 4},
+        // A partial code unit at the end of the text.
+        std::string{"a\x00\x00\x00\x00\x00", 6},
+    };
+
+    for (const std::string &bytes : invalid_sequences) {
+        EXPECT_THROW(decode(bytes, "UTF-32LE"), Stream_error);
+    }
+
+    // The largest code point is valid.
+    EXPECT_EQ(decode(std::string{"\xFF\xFF\x10\x00", 4}, "UTF-32LE"), "\xF4\x8F\xBF\xBF");
+}
+
+TEST_F(Test_unicode_converter, test_character_split_across_inputs)
+{
+    std::string text = "abc\xF0\x9F\x98\x80" "d€0123456789abcdef0123";
+
+    for (const char *encoding :
+         {"UTF-16LE", "UTF-16BE", "UTF-32LE", "UTF-32BE", "UTF-16", "UTF-32"}) {
+        // For the generic encodings the BOM might be split as well.
+        std::string bytes = encode(text, encoding);
+
+        for (std::size_t split = 0; split <= bytes.size(); split++) {
+            EXPECT_EQ(decode_split(bytes, encoding, split), text)
+                << encoding << " split=" << split;
+        }
+    }
+}
+
+TEST_F(Test_unicode_converter, test_surrogate_pair_split_across_buffer_refill)
+{
+    // The stream converts the text in 32 MiB buffers; place a surrogate
+    // pair across the end of the first buffer.
+    constexpr std::size_t buffer_size = 0x200'0000;
+
+    std::string text(buffer_size / 2 - 1, 'a');
+    text += "\xF0\x9F\x98\x80";
+    text += "bcd";
+
+    std::string bytes = encode(text, "UTF-16LE");
+
+    ASSERT_EQ(bytes.size(), buffer_size + 8);
+
+    EXPECT_EQ(decode(bytes, "UTF-16LE"), text);
+}
+
+}  // namespace mlio